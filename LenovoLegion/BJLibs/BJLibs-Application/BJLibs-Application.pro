@@ -65,7 +65,9 @@ HEADERS += \
             Core/ExceptionBuilder.h \
             Core/Exception.h \
             Core/Logger.h \
+            Core/LoggerFormat.h \
             Core/LoggerHolder.h \
+            Core/LoggerRing.h \
             Core/RunGuard.h \
             Core/StackTrace.h \
             Dbf/QDbfTable.h \
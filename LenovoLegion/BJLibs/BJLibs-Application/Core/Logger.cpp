@@ -10,9 +10,10 @@
 
 #include <QCoreApplication>
 #include <QDateTime>
-#include <QTextStream>
 #include <QFileDevice>
 
+#include <chrono>
+
 
 namespace bj { namespace framework {
 
@@ -30,6 +31,17 @@ void Logger::setSeverity(const SEVERITY_BITSET& severity)
     m_severity.store(severity,std::memory_order_relaxed);
 }
 
+void Logger::setOverflowPolicy(OVERFLOW_POLICY policy)
+{
+    m_overflowPolicy.store(policy,std::memory_order_relaxed);
+}
+
+void Logger::setRotation(qint64 maxFileSize, quint8 maxBackupFiles)
+{
+    m_maxFileSize.store(maxFileSize,std::memory_order_relaxed);
+    m_maxBackupFiles.store(maxBackupFiles,std::memory_order_relaxed);
+}
+
 void Logger::init(const std::string &pathToLogFile)
 {
     std::unique_lock<std::mutex> m_guard(m_mutex);
@@ -45,6 +57,9 @@ void Logger::init(const std::string &pathToLogFile)
     {
         THROW_EXCEPTION(exception_T,ERROR_CODES::FILE_OPEN_ERROR,std::string("I can not open the file: ").append(pathToLogFile));
     }
+
+    m_running.store(true);
+    m_writer = std::thread(&Logger::writerThread,this);
 }
 
 void Logger::write(const QString &data,SEVERITY severity)
@@ -53,69 +68,256 @@ void Logger::write(const QString &data,SEVERITY severity)
         return;
     }
 
-    if(!m_logFile.isOpen())
+    push({QDateTime::currentMSecsSinceEpoch(),severity,data});
+}
+
+void Logger::write(const std::stringstream &data, Logger::SEVERITY severity)
+{
+    if(m_severity.load(std::memory_order_relaxed)[severity]  == false) {
+        return;
+    }
+
+    push({QDateTime::currentMSecsSinceEpoch(),severity,QString::fromStdString(data.str())});
+}
+
+void Logger::flush()
+{
+    if(!m_running.load())
+    {
+        return;
+    }
+
+    const size_t target = m_ring.pushed();
+
+    wakeUpWriter();
+    waitForWriter([this,target] {
+        return m_written.load(std::memory_order_acquire) >= target;
+    });
+}
+
+quint64 Logger::droppedRecords() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void Logger::push(Record &&record)
+{
+    if(!m_running.load(std::memory_order_acquire))
     {
         THROW_EXCEPTION(exception_T,ERROR_CODES::FILE_OPEN_ERROR,std::string("The log file engine was not initialized : "));
     }
 
-    QString text = data;
+    if(m_writeError.exchange(false,std::memory_order_relaxed))
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::FILE_OPEN_ERROR,std::string("I can not write to log file: ").append(m_logFile.fileName().toStdString()));
+    }
+
+    const SEVERITY severity = record.m_severity;
+
+    while (!m_ring.push(std::move(record)))
+    {
+        if(m_overflowPolicy.load(std::memory_order_relaxed) != OVERFLOW_POLICY::BLOCK)
+        {
+            m_dropped.fetch_add(1,std::memory_order_relaxed);
+            wakeUpWriter();
+            return;
+        }
+
+        wakeUpWriter();
+        waitForWriter([this] {
+            return m_ring.pushed() - m_written.load(std::memory_order_acquire) < m_ring.capacity();
+        });
+    }
+
+    if(severity == SEVERITY::ERROR)
+    {
+        flush();
+        return;
+    }
+
+    /*
+     * Pairs with the store of m_writerWaiting in writerThread(), a missed
+     * wake up is bounded by the writer wait timeout anyway
+     */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if(m_writerWaiting.load(std::memory_order_relaxed))
+    {
+        wakeUpWriter();
+    }
+}
+
+void Logger::wakeUpWriter()
+{
+    std::unique_lock<std::mutex> m_guard(m_mutex);
+    m_writerCondition.notify_one();
+}
+
+void Logger::waitForWriter(const std::function<bool ()> &done)
+{
+    std::unique_lock<std::mutex> m_guard(m_mutex);
+
+    m_producersWaiting.fetch_add(1);
+
+    while (!done() && m_running.load())
+    {
+        m_producersCondition.wait_for(m_guard,std::chrono::milliseconds(10));
+    }
 
-    text = QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss.zzz ") + dictonary[severity] + text ;
+    m_producersWaiting.fetch_sub(1);
+}
 
+void Logger::writerThread()
+{
+    for (;;)
     {
+        if(writeBatch() > 0)
+        {
+            continue;
+        }
+
         std::unique_lock<std::mutex> m_guard(m_mutex);
 
-        QTextStream out(&m_logFile);
-        out.setEncoding(QStringConverter::Utf8);
+        if(m_producersWaiting.load() > 0)
+        {
+            m_producersCondition.notify_all();
+        }
+
+        if(!m_running.load() && m_ring.pushed() == m_written.load())
+        {
+            break;
+        }
 
-        out << text;
-        Qt::endl(out);
+        m_writerWaiting.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
 
-        if(m_logFile.error() != QFileDevice::NoError)
+        if(m_ring.pushed() == m_written.load() && m_running.load())
         {
-            THROW_EXCEPTION(exception_T,ERROR_CODES::FILE_OPEN_ERROR,std::string("I can not write to log file: ").append(m_logFile.fileName().toStdString()));
+            m_writerCondition.wait_for(m_guard,std::chrono::milliseconds(100));
         }
+
+        m_writerWaiting.store(false);
     }
 }
 
-void Logger::write(const std::stringstream &data, Logger::SEVERITY severity)
+size_t Logger::writeBatch()
 {
-    if(m_severity.load(std::memory_order_relaxed)[severity]  == false) {
-        return;
+    QByteArray batch;
+    Record     record;
+    size_t     count = 0;
+
+    while (count < WRITE_BATCH_SIZE && m_ring.pop(record))
+    {
+        batch.append(QDateTime::fromMSecsSinceEpoch(record.m_timestamp).toString("dd.MM.yyyy hh:mm:ss.zzz ").toUtf8());
+        batch.append(dictonary[record.m_severity].toUtf8());
+        batch.append(record.m_text.toUtf8());
+        batch.append('\n');
+        ++count;
     }
 
-    if(!m_logFile.isOpen())
+    const quint64 dropped = m_dropped.load(std::memory_order_relaxed);
+
+    if(dropped != m_droppedReported && m_overflowPolicy.load(std::memory_order_relaxed) == OVERFLOW_POLICY::COUNT)
     {
-        THROW_EXCEPTION(exception_T,ERROR_CODES::FILE_OPEN_ERROR,std::string("The log file engine was not initialized : "));
+        batch.append(QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss.zzz ").toUtf8());
+        batch.append(dictonary[SEVERITY::WARNING].toUtf8());
+        batch.append(QString("Log ring overflow, %1 records dropped").arg(dropped - m_droppedReported).toUtf8());
+        batch.append('\n');
+    }
+    m_droppedReported = dropped;
+
+    if(batch.isEmpty())
+    {
+        return 0;
     }
 
-    QString text = QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss.zzz ") + dictonary[severity] + data.str().c_str();
+    const qint64 maxFileSize = m_maxFileSize.load(std::memory_order_relaxed);
+
+    if(maxFileSize > 0 && m_logFile.size() > 0 && m_logFile.size() + batch.size() > maxFileSize)
+    {
+        rotate();
+    }
 
+    if(m_logFile.write(batch) != batch.size() || !m_logFile.flush() || m_logFile.error() != QFileDevice::NoError)
+    {
+        m_logFile.unsetError();
+        m_writeError.store(true,std::memory_order_relaxed);
+    }
+
+    m_written.fetch_add(count,std::memory_order_release);
+
+    if(m_producersWaiting.load() > 0)
     {
         std::unique_lock<std::mutex> m_guard(m_mutex);
+        m_producersCondition.notify_all();
+    }
 
-        QTextStream out(&m_logFile);
-        out.setEncoding(QStringConverter::Utf8);
+    return count;
+}
 
-        out << text;
-        Qt::endl(out);
+void Logger::rotate()
+{
+    const QString fileName       = m_logFile.fileName();
+    const quint8  maxBackupFiles = m_maxBackupFiles.load(std::memory_order_relaxed);
 
-        if(m_logFile.error() != QFileDevice::NoError)
-        {
-            THROW_EXCEPTION(exception_T,ERROR_CODES::FILE_OPEN_ERROR,std::string("I can not write to log file: ").append(m_logFile.fileName().toStdString()));
-        }
+    m_logFile.close();
+
+    for (quint8 i = maxBackupFiles; i > 1; --i)
+    {
+        QFile::remove(QString("%1.%2").arg(fileName).arg(i));
+        QFile::rename(QString("%1.%2").arg(fileName).arg(i - 1),QString("%1.%2").arg(fileName).arg(i));
+    }
+
+    if(maxBackupFiles > 0)
+    {
+        QFile::remove(QString("%1.1").arg(fileName));
+        QFile::rename(fileName,QString("%1.1").arg(fileName));
+    }
+    else
+    {
+        QFile::remove(fileName);
+    }
+
+    if(!m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+    {
+        m_writeError.store(true,std::memory_order_relaxed);
+    }
+}
+
+void Logger::stop()
+{
+    {
+        std::unique_lock<std::mutex> m_guard(m_mutex);
+        m_running.store(false);
+        m_writerCondition.notify_one();
+    }
+
+    if(m_writer.joinable())
+    {
+        m_writer.join();
     }
 }
 
 
 Logger::Logger()
-    : m_severity(0xF)
+    : m_severity(0xF),
+      m_overflowPolicy(OVERFLOW_POLICY::COUNT),
+      m_maxFileSize(MAX_FILE_SIZE_DEFAULT),
+      m_maxBackupFiles(MAX_BACKUP_FILES),
+      m_ring(RING_CAPACITY),
+      m_written(0),
+      m_dropped(0),
+      m_droppedReported(0),
+      m_running(false),
+      m_writeError(false),
+      m_writerWaiting(false),
+      m_producersWaiting(0)
 {}
 
 Logger::~Logger()
 {
+    stop();
     m_logFile.close();
 }
 
 }}
-
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "ExceptionBuilder.h"
+#include "LoggerRing.h"
 
 #include <QFile>
 #include <QString>
@@ -16,9 +17,24 @@
 #include <atomic>
 #include <sstream>
 #include <bitset>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+
+/*
+ * Compile time minimum level (0 = TRACE, 1 = DEBUG, 2 = INFO, 3 = WARNING, 4 = ERROR),
+ * statements below it are removed by the LOG_* macros, e.g. DEFINES += BL_LOG_MIN_LEVEL=2
+ */
+#ifndef BL_LOG_MIN_LEVEL
+#define BL_LOG_MIN_LEVEL 0
+#endif
 
 namespace bj { namespace framework {
 
+/*
+ * The callers only push records into the ring, formatting and file I/O
+ * are done by the writer thread started in init()
+ */
 class Logger
 {
 
@@ -32,10 +48,26 @@ public:
         TRACE  =  4
     };
 
+    enum OVERFLOW_POLICY : quint8 {
+        DROP    = 0,    // Drop the record silently
+        BLOCK   = 1,    // Wait until the writer makes room
+        COUNT   = 2     // Drop the record, the number of dropped records is written to the log
+    };
+
     using SEVERITY_BITSET =  std::bitset<5>;
 
+    static constexpr size_t  RING_CAPACITY          = 8192;
+    static constexpr size_t  WRITE_BATCH_SIZE       = 256;
+    static constexpr qint64  MAX_FILE_SIZE_DEFAULT  = 10 * 1024 * 1024;
+    static constexpr quint8  MAX_BACKUP_FILES       = 3;
+
 private:
 
+    struct Record {
+        qint64   m_timestamp = 0;
+        SEVERITY m_severity  = INFO;
+        QString  m_text;
+    };
 
     static QMap<Logger::SEVERITY,QString>  dictonary;
 
@@ -54,23 +86,100 @@ public:
 
     void setSeverity(const SEVERITY_BITSET& severity);
 
+    bool isEnabled(SEVERITY severity) const
+    {
+        return m_severity.load(std::memory_order_relaxed)[severity];
+    }
+
+    static constexpr bool isCompiledIn(SEVERITY severity)
+    {
+        return level(severity) >= BL_LOG_MIN_LEVEL;
+    }
+    void setOverflowPolicy(OVERFLOW_POLICY policy);
+
+    /*
+     * maxFileSize = 0 disables the rotation
+     */
+    void setRotation(qint64 maxFileSize,quint8 maxBackupFiles);
+
     void init(const std::string& pathToLogFile);
     void write(const QString& data,SEVERITY severity = INFO);
     void write(const std::stringstream& data,SEVERITY severity = INFO);
 
+    /*
+     * Waits until all records pushed before the call are written to the file,
+     * records with ERROR severity are flushed implicitly
+     */
+    void flush();
+
+    quint64 droppedRecords() const;
+
 private:
-     std::atomic<SEVERITY_BITSET>  m_severity;
 
-     std::mutex         m_mutex;
-     QFile              m_logFile;
+    static constexpr int level(SEVERITY severity)
+    {
+        switch (severity) {
+            case TRACE:   return 0;
+            case DEBUG:   return 1;
+            case INFO:    return 2;
+            case WARNING: return 3;
+            case ERROR:   return 4;
+        }
+
+        return 4;
+    }
+
+    void push(Record&& record);
+    void wakeUpWriter();
+    void waitForWriter(const std::function<bool ()>& done);
+
+    void writerThread();
+    size_t writeBatch();
+    void rotate();
+    void stop();
+
+private:
+     std::atomic<SEVERITY_BITSET>  m_severity;
+     std::atomic<OVERFLOW_POLICY>  m_overflowPolicy;
+     std::atomic<qint64>           m_maxFileSize;
+     std::atomic<quint8>           m_maxBackupFiles;
+
+     LoggerRing<Record>            m_ring;
+     std::atomic<size_t>           m_written;
+     std::atomic<quint64>          m_dropped;
+     quint64                       m_droppedReported;
+
+     std::atomic<bool>             m_running;
+     std::atomic<bool>             m_writeError;
+     std::atomic<bool>             m_writerWaiting;
+     std::atomic<int>              m_producersWaiting;
+
+     std::mutex                    m_mutex;
+     std::condition_variable       m_writerCondition;
+     std::condition_variable       m_producersCondition;
+     std::thread                   m_writer;
+
+     QFile                         m_logFile;
 };
 
 
-#define LOG_INFO(x,__LoggerSingletonHolder__)     __LoggerSingletonHolder__::getInstance().write(x,bj::framework::Logger::SEVERITY::INFO)
-#define LOG_WARNING(x,__LoggerSingletonHolder__)  __LoggerSingletonHolder__::getInstance().write(x,bj::framework::Logger::SEVERITY::WARNING)
-#define LOG_DEBUG(x,__LoggerSingletonHolder__)    __LoggerSingletonHolder__::getInstance().write(x,bj::framework::Logger::SEVERITY::DEBUG)
-#define LOG_ERROR(x,__LoggerSingletonHolder__)    __LoggerSingletonHolder__::getInstance().write(x,bj::framework::Logger::SEVERITY::ERROR)
-#define LOG_TRACE(x,__LoggerSingletonHolder__)    __LoggerSingletonHolder__::getInstance().write(x,bj::framework::Logger::SEVERITY::TRACE)
+/*
+ * The argument is evaluated only when the severity is compiled in and enabled
+ */
+#define LOG_SEVERITY(x,__severity__,__LoggerSingletonHolder__)                              \
+    do {                                                                                    \
+        if constexpr (bj::framework::Logger::isCompiledIn(__severity__)) {                  \
+            if(__LoggerSingletonHolder__::getInstance().isEnabled(__severity__)) {          \
+                __LoggerSingletonHolder__::getInstance().write(x,__severity__);             \
+            }                                                                               \
+        }                                                                                   \
+    } while(0)
+
+#define LOG_INFO(x,__LoggerSingletonHolder__)     LOG_SEVERITY(x,bj::framework::Logger::SEVERITY::INFO,__LoggerSingletonHolder__)
+#define LOG_WARNING(x,__LoggerSingletonHolder__)  LOG_SEVERITY(x,bj::framework::Logger::SEVERITY::WARNING,__LoggerSingletonHolder__)
+#define LOG_DEBUG(x,__LoggerSingletonHolder__)    LOG_SEVERITY(x,bj::framework::Logger::SEVERITY::DEBUG,__LoggerSingletonHolder__)
+#define LOG_ERROR(x,__LoggerSingletonHolder__)    LOG_SEVERITY(x,bj::framework::Logger::SEVERITY::ERROR,__LoggerSingletonHolder__)
+#define LOG_TRACE(x,__LoggerSingletonHolder__)    LOG_SEVERITY(x,bj::framework::Logger::SEVERITY::TRACE,__LoggerSingletonHolder__)
 
 
 
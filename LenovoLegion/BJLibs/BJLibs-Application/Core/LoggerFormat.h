@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <type_traits>
+
+namespace bj { namespace framework {
+
+/*
+ * Minimal "{}" formatter for the LOGF_* macros, placeholders are replaced by
+ * the arguments in order. It is evaluated only when the severity is enabled.
+ */
+class LoggerFormat
+{
+public:
+
+    template<typename... Args>
+    static QString format(const char* pattern,const Args&... args)
+    {
+        QString result;
+
+        (appendNext(result,pattern,args),...);
+
+        result.append(QString::fromUtf8(pattern));
+
+        return result;
+    }
+
+private:
+
+    template<typename T>
+    static void appendNext(QString& result,const char*& pattern,const T& arg)
+    {
+        const char* placeholder = std::strstr(pattern,"{}");
+
+        if(placeholder == nullptr)
+        {
+            return;
+        }
+
+        result.append(QString::fromUtf8(pattern,placeholder - pattern));
+        appendArgument(result,arg);
+        pattern = placeholder + 2;
+    }
+
+    template<typename T>
+    static void appendArgument(QString& result,const T& arg)
+    {
+        using Type = std::decay_t<T>;
+
+        if constexpr (std::is_same_v<Type,QString>) {
+            result.append(arg);
+        } else if constexpr (std::is_same_v<Type,QByteArray>) {
+            result.append(QString::fromUtf8(arg));
+        } else if constexpr (std::is_array_v<T>) {
+            result.append(QString::fromUtf8(arg));
+        } else if constexpr (std::is_same_v<Type,const char*> || std::is_same_v<Type,char*>) {
+            result.append(arg != nullptr ? QString::fromUtf8(arg) : QString("(null)"));
+        } else if constexpr (std::is_same_v<Type,std::string> || std::is_same_v<Type,std::string_view>) {
+            result.append(QString::fromUtf8(arg.data(),static_cast<qsizetype>(arg.size())));
+        } else if constexpr (std::is_same_v<Type,std::filesystem::path>) {
+            result.append(QString::fromStdString(arg.string()));
+        } else if constexpr (std::is_same_v<Type,bool>) {
+            result.append(arg ? "true" : "false");
+        } else if constexpr (std::is_same_v<Type,char>) {
+            result.append(QChar(arg));
+        } else if constexpr (std::is_enum_v<Type>) {
+            result.append(QString::number(static_cast<std::underlying_type_t<Type>>(arg)));
+        } else if constexpr (std::is_arithmetic_v<Type>) {
+            result.append(QString::number(arg));
+        } else if constexpr (std::is_pointer_v<Type>) {
+            result.append(QString("0x%1").arg(reinterpret_cast<quintptr>(arg),0,16));
+        } else {
+            static_assert(!sizeof(Type),"LoggerFormat: unsupported argument type");
+        }
+    }
+};
+
+}}
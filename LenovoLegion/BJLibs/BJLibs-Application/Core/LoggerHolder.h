@@ -8,6 +8,7 @@
 #pragma once
 
 #include <Core/Logger.h>
+#include <Core/LoggerFormat.h>
 #include <Core/StackTrace.h>
 
 #include <Singleton/CPP11ThreadModel.h>
@@ -22,3 +23,12 @@ using LoggerHolder = bj::framework::SingletonHolder<bj::framework::Logger,bj::fr
 #define LOG_E(x)  LOG_ERROR(x,LoggerHolder);
 #define LOG_W(x)  LOG_WARNING(x,LoggerHolder);
 #define LOG_T(x)  LOG_TRACE(x,LoggerHolder);
+
+/*
+ * Deferred formatting, e.g. LOGF_T("type={}, length={}",header.m_type,header.m_dataLength)
+ */
+#define LOGF_I(...)  LOG_INFO(bj::framework::LoggerFormat::format(__VA_ARGS__),LoggerHolder);
+#define LOGF_D(...)  LOG_DEBUG(bj::framework::LoggerFormat::format(__VA_ARGS__),LoggerHolder);
+#define LOGF_E(...)  LOG_ERROR(bj::framework::LoggerFormat::format(__VA_ARGS__),LoggerHolder);
+#define LOGF_W(...)  LOG_WARNING(bj::framework::LoggerFormat::format(__VA_ARGS__),LoggerHolder);
+#define LOGF_T(...)  LOG_TRACE(bj::framework::LoggerFormat::format(__VA_ARGS__),LoggerHolder);
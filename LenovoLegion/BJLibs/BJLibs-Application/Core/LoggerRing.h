@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+namespace bj { namespace framework {
+
+/*
+ * Bounded multi producer / single consumer ring (sequence per slot).
+ * Producers never take a lock, a full ring is reported back to the caller.
+ */
+template<typename T>
+class LoggerRing
+{
+private:
+
+    struct alignas(64) Slot {
+        std::atomic<size_t> m_sequence;
+        T                   m_value;
+    };
+
+public:
+
+    explicit LoggerRing(size_t capacity) :
+        m_mask(roundUp(capacity) - 1),
+        m_slots(m_mask + 1),
+        m_head(0),
+        m_tail(0)
+    {
+        for (size_t i = 0; i < m_slots.size(); ++i)
+        {
+            m_slots[i].m_sequence.store(i,std::memory_order_relaxed);
+        }
+    }
+
+    LoggerRing(const LoggerRing&)            = delete;
+    LoggerRing& operator=(const LoggerRing&) = delete;
+
+    /*
+     * Returns false when the ring is full
+     */
+    bool push(T&& value)
+    {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            Slot&  slot = m_slots[pos & m_mask];
+            size_t seq  = slot.m_sequence.load(std::memory_order_acquire);
+
+            if(seq == pos)
+            {
+                if(m_head.compare_exchange_weak(pos,pos + 1,std::memory_order_relaxed))
+                {
+                    slot.m_value = std::move(value);
+                    slot.m_sequence.store(pos + 1,std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(seq < pos)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /*
+     * Consumer side, only one thread may call it
+     */
+    bool pop(T& value)
+    {
+        Slot&  slot = m_slots[m_tail & m_mask];
+
+        if(slot.m_sequence.load(std::memory_order_acquire) != m_tail + 1)
+        {
+            return false;
+        }
+
+        value = std::move(slot.m_value);
+        slot.m_sequence.store(m_tail + m_mask + 1,std::memory_order_release);
+        ++m_tail;
+
+        return true;
+    }
+
+    size_t capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    /*
+     * Number of the records reserved by producers so far
+     */
+    size_t pushed() const
+    {
+        return m_head.load(std::memory_order_acquire);
+    }
+
+private:
+
+    static size_t roundUp(size_t value)
+    {
+        size_t result = 2;
+
+        while (result < value)
+        {
+            result <<= 1;
+        }
+
+        return result;
+    }
+
+private:
+
+    const size_t             m_mask;
+    std::vector<Slot>        m_slots;
+
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) size_t              m_tail;
+};
+
+}}
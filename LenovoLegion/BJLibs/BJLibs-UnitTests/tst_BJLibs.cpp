@@ -9,6 +9,7 @@
 
 // add necessary includes here
 #include <Core/Logger.h>
+#include <Core/LoggerFormat.h>
 #include <Core/StackTrace.h>
 
 #include <Singleton/CPP11ThreadModel.h>
@@ -31,6 +32,7 @@ public:
 
 private slots:
     void test_Logger();
+    void test_LoggerLatency();
     void test_StackTrace();
     void test_bigInteger();
     void test_connectX();
@@ -58,6 +60,105 @@ void BJLibs::test_Logger()
         LOG_ERROR("TEST->ERROR",LoggerHolder);
         LOG_WARNING("TEST->WARNING",LoggerHolder);
     }
+
+    {
+        QCOMPARE(bj::framework::LoggerFormat::format("type={}, length={}, name={}",1,1024,std::string("CPU")),QString("type=1, length=1024, name=CPU"));
+        QCOMPARE(bj::framework::LoggerFormat::format("{} {}",true),QString("true {}"));
+    }
+
+    {
+        int evaluated = 0;
+
+        LoggerHolder::getInstance().setSeverity(bj::framework::Logger::SEVERITY_BITSET().set(bj::framework::Logger::ERROR));
+        LOG_TRACE(QString::number(++evaluated),LoggerHolder);
+        QCOMPARE(evaluated,0);
+
+        LoggerHolder::getInstance().setSeverity(bj::framework::Logger::SEVERITY_BITSET().set());
+        LOG_TRACE(QString::number(++evaluated),LoggerHolder);
+        QCOMPARE(evaluated,1);
+    }
+}
+
+void BJLibs::test_LoggerLatency()
+{
+    constexpr int       CALLS = 100000;
+    std::vector<qint64> latency(CALLS);
+    QElapsedTimer       timer;
+
+    for (int i = 0; i < CALLS; ++i)
+    {
+        timer.start();
+        LOG_INFO(QString("TEST->LATENCY"),LoggerHolder);
+        latency[i] = timer.nsecsElapsed();
+    }
+
+    LoggerHolder::getInstance().flush();
+
+    std::sort(latency.begin(),latency.end());
+
+    qInfo() << "Logger::write latency [ns] p50:" << latency[CALLS / 2]
+            << "p99:"     << latency[CALLS * 99 / 100]
+            << "max:"     << latency.back()
+            << "dropped:" << LoggerHolder::getInstance().droppedRecords();
+
+    /*
+     * Caller only pushes into the ring, a generous bound that still catches file I/O on the caller side
+     */
+    QVERIFY2(latency[CALLS / 2] < 50000,"Logger::write p50 latency is above 50 us");
+
+    QBENCHMARK {
+        LOG_INFO(QString("TEST->BENCHMARK"),LoggerHolder);
+    }
+
+    LoggerHolder::getInstance().flush();
+
+    /*
+     * With the BLOCK policy every record reaches the file in the order of the calls,
+     * more records than the ring holds make the callers wait for the writer
+     */
+    {
+        constexpr int ORDERED_CALLS = static_cast<int>(bj::framework::Logger::RING_CAPACITY) * 3;
+        const quint64 dropped       = LoggerHolder::getInstance().droppedRecords();
+        QFile         file("test.log");
+        int           next          = 0;
+
+        LoggerHolder::getInstance().setOverflowPolicy(bj::framework::Logger::BLOCK);
+        LoggerHolder::getInstance().setRotation(0,bj::framework::Logger::MAX_BACKUP_FILES);
+
+        const qint64  offset        = file.size();
+
+        for (int i = 0; i < ORDERED_CALLS; ++i)
+        {
+            LOG_INFO(QString("TEST->ORDER ").append(QString::number(i)).append(';'),LoggerHolder);
+        }
+
+        LoggerHolder::getInstance().flush();
+
+        LoggerHolder::getInstance().setOverflowPolicy(bj::framework::Logger::COUNT);
+        LoggerHolder::getInstance().setRotation(bj::framework::Logger::MAX_FILE_SIZE_DEFAULT,bj::framework::Logger::MAX_BACKUP_FILES);
+
+        QCOMPARE(LoggerHolder::getInstance().droppedRecords(),dropped);
+        QVERIFY(file.open(QIODeviceBase::ReadOnly | QIODeviceBase::Text));
+        QVERIFY(file.seek(offset));
+
+        while (!file.atEnd())
+        {
+            const QString line  = QString::fromUtf8(file.readLine());
+            const qsizetype pos = line.indexOf("TEST->ORDER ");
+
+            if(pos < 0)
+            {
+                continue;
+            }
+
+            const qsizetype begin = pos + qsizetype(sizeof("TEST->ORDER ") - 1);
+
+            QCOMPARE(line.mid(begin,line.indexOf(';',begin) - begin).toInt(),next);
+            ++next;
+        }
+
+        QCOMPARE(next,ORDERED_CALLS);
+    }
 }
 
 void BJLibs::test_StackTrace(){
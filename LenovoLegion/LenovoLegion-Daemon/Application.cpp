@@ -19,6 +19,7 @@
  */
 #include "SysFsDriverCPU.h"
 #include "SysFsDriverCPUXList.h"
+#include "SysFsDriverCPUXEnergyPerformance.h"
 #include "SysFsDriverCPUCore.h"
 #include "SysFsDriverCPUAtom.h"
 #include "SysFsDriverACPIPlatformProfile.h"
@@ -53,10 +54,25 @@
 #include "SysFsDataProviderMachineInformation.h"
 #include "SysFsDataProviderOther.h"
 #include "SysFsDataProviderOtherGpuSwitch.h"
+#include "SysFsDataProviderThrottleDetector.h"
+#include "SysFsDataProviderFanController.h"
+#include "SysFsDataProviderAutoPowerProfile.h"
+#include "SysFsDataProviderCoreParking.h"
+#include "SysFsDataProviderProcessPlacement.h"
+#include "SysFsDataProviderIrqBalancer.h"
+#include "SysFsDataProviderPowerArbiter.h"
+#include "SysFsDataProviderRaplController.h"
+#include "SysFsDataProviderLoadGenerator.h"
+#include "SysFsDataProviderAutoTuner.h"
+#include "SysFsDataProviderCPUEnergyPerformance.h"
 
 #include "DataProviderNvidiaNvml.h"
+#include "DataProviderNvidiaNvmlProcesses.h"
 #include "DataProviderDaemonSettings.h"
+#include "DataProviderDaemonStats.h"
+#include "DataProviderDaemonTrace.h"
 #include "DataProviderRGBController.h"
+#include "DataProviderProcessRules.h"
 
 #include "DaemonSettingsManager.h"
 
@@ -93,6 +109,7 @@ Application::Application(int &argc, char *argv[]) :
     m_sysFsDriverManager->addDriver(new SysFSDriverLegionHWMon(m_sysFsDriverManager));
     m_sysFsDriverManager->addDriver(new SysFsDriverCPU(m_sysFsDriverManager));
     m_sysFsDriverManager->addDriver(new SysFsDriverCPUXList(m_sysFsDriverManager));
+    m_sysFsDriverManager->addDriver(new SysFsDriverCPUXEnergyPerformance(m_sysFsDriverManager));
     m_sysFsDriverManager->addDriver(new SysFsDriverCPUCore(m_sysFsDriverManager));
     m_sysFsDriverManager->addDriver(new SysFsDriverCPUAtom(m_sysFsDriverManager));
     m_sysFsDriverManager->addDriver(new SysFsDriverACPIPlatformProfile(m_sysFsDriverManager));
@@ -127,10 +144,25 @@ Application::Application(int &argc, char *argv[]) :
     m_dataProviderManager->addDataProvider(new SysFsDataProviderMachineInformation(m_sysFsDriverManager,m_dataProviderManager));
     m_dataProviderManager->addDataProvider(new SysFsDataProviderOther(m_sysFsDriverManager,m_dataProviderManager));
     m_dataProviderManager->addDataProvider(new SysFsDataProviderOtherGpuSwitch(m_sysFsDriverManager,m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new SysFsDataProviderThrottleDetector(m_sysFsDriverManager,m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new SysFsDataProviderFanController(m_sysFsDriverManager,m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new SysFsDataProviderAutoPowerProfile(m_sysFsDriverManager,m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new SysFsDataProviderCoreParking(m_sysFsDriverManager,m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new SysFsDataProviderProcessPlacement(m_sysFsDriverManager,m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new SysFsDataProviderIrqBalancer(m_sysFsDriverManager,m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new SysFsDataProviderPowerArbiter(m_sysFsDriverManager,m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new SysFsDataProviderRaplController(m_sysFsDriverManager,m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new SysFsDataProviderLoadGenerator(m_sysFsDriverManager,m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new SysFsDataProviderAutoTuner(m_sysFsDriverManager,m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new SysFsDataProviderCPUEnergyPerformance(m_sysFsDriverManager,m_dataProviderManager));
 
     m_dataProviderManager->addDataProvider(new DataProviderNvidiaNvml(m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new DataProviderNvidiaNvmlProcesses(m_dataProviderManager));
     m_dataProviderManager->addDataProvider(new DataProviderDaemonSettings(m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new DataProviderDaemonStats(m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new DataProviderDaemonTrace(m_dataProviderManager));
     m_dataProviderManager->addDataProvider(new DataProviderRGBController(m_dataProviderManager));
+    m_dataProviderManager->addDataProvider(new DataProviderProcessRules(m_dataProviderManager));
 }
 
 void Application::appRollBackImpl() noexcept
@@ -181,6 +213,14 @@ void Application::appInitImpl(std::unique_ptr<ApplicationModulesHandler_T>)
      */
     DaemonSettingsManager::getInstance().loadAllSettings(m_dataProviderManager);
 
+    /*
+     * Record changes of the settings from now on
+     */
+    DaemonSettingsManager::getInstance().startJournal(m_dataProviderManager);
+    connect(m_sysFsDriverManager,&SysFsDriverManager::kernelEvent,this,[](const SysFsDriver::SubsystemEvent& event) {
+        DaemonSettingsManager::getInstance().kernelEventHandler(event);
+    });
+
     /*
      * Start Server
      */
@@ -358,6 +398,7 @@ void Application::newConnectionNotificationHandler()
         try {
             connect(m_sysFsDriverManager,&SysFsDriverManager::kernelEvent,dynamic_cast<ProtocolProcessorNotifier*>(newProcessor),&ProtocolProcessorNotifier::kernelEventHandler);
             connect(m_sysFsDriverManager,&SysFsDriverManager::moduleSubsystem,dynamic_cast<ProtocolProcessorNotifier*>(newProcessor),&ProtocolProcessorNotifier::moduleSubsystemHandler);
+            connect(m_dataProviderManager,&DataProviderManager::dataProviderEvent,dynamic_cast<ProtocolProcessorNotifier*>(newProcessor),&ProtocolProcessorNotifier::dataProviderEventHandler);
             connect(dynamic_cast<ProtocolProcessorNotifier*>(newProcessor),&ProtocolProcessorNotifier::clientDisconnected,this,&Application::connectionNotificationDisconnectedHandler);
             newProcessor->start();
             
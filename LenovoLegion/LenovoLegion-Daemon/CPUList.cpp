@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "CPUList.h"
+
+#include <QStringList>
+
+namespace LenovoLegionDaemon {
+
+std::set<quint32> CPUList::parse(const QString &list)
+{
+    std::set<quint32> cpus;
+
+    if(list.trimmed().isEmpty())
+    {
+        return cpus;
+    }
+
+    for(const auto& item : list.trimmed().split(','))
+    {
+        const auto range = item.split('-');
+
+        if(range.size() == 1)
+        {
+            cpus.insert(range.at(0).toUInt());
+        }
+        else if(range.size() == 2 && range.at(0).toUInt() <= range.at(1).toUInt())
+        {
+            for(quint32 cpu = range.at(0).toUInt(); cpu <= range.at(1).toUInt(); ++cpu)
+            {
+                cpus.insert(cpu);
+            }
+        }
+        else
+        {
+            THROW_EXCEPTION(exception_T,ERROR_CODES::INVALID_DATA,std::string("Invalid CPU list data !").c_str());
+        }
+    }
+
+    return cpus;
+}
+
+cpu_set_t CPUList::toCpuSet(const std::set<quint32> &cpus)
+{
+    cpu_set_t cpuSet;
+
+    CPU_ZERO(&cpuSet);
+
+    for(const auto cpu : cpus)
+    {
+        if(cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu,&cpuSet);
+        }
+    }
+
+    return cpuSet;
+}
+
+}
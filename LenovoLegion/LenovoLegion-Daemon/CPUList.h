@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <Core/ExceptionBuilder.h>
+
+#include <QString>
+
+#include <sched.h>
+
+#include <set>
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Kernel CPU list format, e.g. "0-3,8,10-11"
+ */
+class CPUList
+{
+public:
+
+    DEFINE_EXCEPTION(CPUList);
+
+    enum ERROR_CODES : int {
+        INVALID_DATA  = 1
+    };
+
+public:
+
+    static std::set<quint32> parse(const QString& list);
+
+    static cpu_set_t toCpuSet(const std::set<quint32>& cpus);
+};
+
+}
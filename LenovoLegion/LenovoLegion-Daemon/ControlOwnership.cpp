@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "ControlOwnership.h"
+
+#include <Core/LoggerHolder.h>
+
+namespace LenovoLegionDaemon {
+
+std::map<QString,quint8> ControlOwnership::s_owners;
+QString                  ControlOwnership::s_caller;
+
+ControlOwnership::Scope::Scope(const QString &owner) :
+    m_previous(s_caller)
+{
+    s_caller = owner;
+}
+
+ControlOwnership::Scope::~Scope()
+{
+    s_caller = m_previous;
+}
+
+std::optional<QString> ControlOwnership::conflict(const QString &owner, quint8 resources)
+{
+    for(const auto& [name,owned] : s_owners)
+    {
+        if(name != owner && (owned & resources) != 0)
+        {
+            return name;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void ControlOwnership::acquire(const QString &owner, quint8 resources)
+{
+    if(resources == 0)
+    {
+        release(owner);
+        return;
+    }
+
+    s_owners[owner] = resources;
+
+    LOGF_D("Control ownership: {} owns {}",owner,resources);
+}
+
+void ControlOwnership::release(const QString &owner)
+{
+    if(s_owners.erase(owner) > 0)
+    {
+        LOGF_D("Control ownership: {} released",owner);
+    }
+}
+
+const QString &ControlOwnership::caller()
+{
+    return s_caller;
+}
+
+}
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <QString>
+
+#include <map>
+#include <optional>
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Controllers writing the same limits in a loop would fight each other. A controller owns the resources
+ * while it is active, the others must not enable or apply over it. Called from the daemon thread only.
+ */
+class ControlOwnership
+{
+public:
+
+    enum Resource : quint8 {
+        CPU_POWER_LIMITS = 0x01,        // PL1/PL2, through the Legion firmware or powercap
+        GPU_POWER_LIMIT  = 0x02,        // configurable TGP
+        CPU_GOVERNOR     = 0x04,
+        FAN_CURVE        = 0x08,        // firmware fan curve, used in the custom power mode only
+        POWER_MODE       = 0x10         // smart fan power mode
+    };
+
+    /*
+     * Owner the provider requests are made for while the scope exists, providers writing a resource
+     * on request check the conflict for the caller
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(const QString& owner);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        QString m_previous;
+    };
+
+public:
+
+    /*
+     * Another owner of any of the resources, empty if none
+     */
+    static std::optional<QString> conflict(const QString& owner,quint8 resources);
+
+    /*
+     * Resources of the owner from now on, the caller checks the conflict first
+     */
+    static void acquire(const QString& owner,quint8 resources);
+
+    static void release(const QString& owner);
+
+    /*
+     * Owner of the current request, empty for a client or the settings
+     */
+    static const QString& caller();
+
+private:
+
+    static std::map<QString,quint8> s_owners;
+    static QString                  s_caller;
+};
+
+}
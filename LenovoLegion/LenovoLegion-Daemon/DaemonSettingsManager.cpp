@@ -20,11 +20,117 @@
 #include "DataProviderNvidiaNvml.h"
 #include "SysFsDataProviderIntelMSR.h"
 #include "SysFsDataProviderOther.h"
+#include "SysFsDataProviderCPUEnergyPerformance.h"
+#include "SysFsDriverACPIPlatformProfile.h"
+#include "SettingsReconciler.h"
+#include "SettingsStore.h"
 
 #include <Core/LoggerHolder.h>
 
+#include <functional>
+#include <map>
+#include <vector>
+
 namespace LenovoLegionDaemon {
 
+namespace {
+
+/*
+ * Offsets are saved rounded to whole mV
+ */
+void roundVoltageOffsets(legion::messages::CpuIntelMSR &intelMSR)
+{
+    intelMSR.mutable_analogio()->set_offset(((intelMSR.analogio().offset() > 0 ? intelMSR.analogio().offset() + 999 : intelMSR.analogio().offset() - 999 ) / 1000) * 1000);
+    intelMSR.mutable_cache()->set_offset(((intelMSR.cache().offset() > 0 ? intelMSR.cache().offset() + 999 : intelMSR.cache().offset() - 999 ) / 1000) * 1000);
+    intelMSR.mutable_cpu()->set_offset(((intelMSR.cpu().offset() > 0 ? intelMSR.cpu().offset() + 999 : intelMSR.cpu().offset() - 999) / 1000) * 1000);
+    intelMSR.mutable_gpu()->set_offset(((intelMSR.gpu().offset() > 0 ? intelMSR.gpu().offset() + 999 : intelMSR.gpu().offset() - 999 ) / 1000) * 1000);
+    intelMSR.mutable_uncore()->set_offset(((intelMSR.uncore().offset() > 0 ? intelMSR.uncore().offset() + 999 : intelMSR.uncore().offset() - 999 ) / 1000) * 1000);
+}
+
+/*
+ * Mode descriptors of the power limits come from the firmware, only the current values are compared.
+ * Limits which are not set stay unset.
+ */
+void clearModeDescriptors(google::protobuf::Message &power)
+{
+    const google::protobuf::Reflection*                 reflection = power.GetReflection();
+    std::vector<const google::protobuf::FieldDescriptor*> fields;
+
+    reflection->ListFields(power,&fields);
+
+    for(const auto* field : fields)
+    {
+        if(field->cpp_type() != google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE || field->is_repeated())
+        {
+            continue;
+        }
+
+        google::protobuf::Message*               limit       = reflection->MutableMessage(&power,field);
+        const google::protobuf::FieldDescriptor* descriptors = limit->GetDescriptor()->FindFieldByName("mode_descriptor_map");
+
+        if(descriptors != nullptr)
+        {
+            limit->GetReflection()->ClearField(limit,descriptors);
+        }
+    }
+}
+
+template<class MessageT,class SaverT>
+std::function<void(const QByteArray&)> groupSaver(SaverT& (SaverT::*saver)(const MessageT&),void (*prepare)(MessageT&) = nullptr)
+{
+    return [saver,prepare](const QByteArray& data) {
+        MessageT message;
+
+        if(!message.ParseFromArray(data.data(),data.size()))
+        {
+            THROW_EXCEPTION(DaemonSettingsManager::exception_T,DaemonSettingsManager::ERROR_CODES::SAVE_ERROR,"Parse of data message error !");
+        }
+
+        if(prepare != nullptr)
+        {
+            prepare(message);
+        }
+
+        SaverT settingsSaver;
+        (settingsSaver.*saver)(message);
+    };
+}
+
+/*
+ * Data types persisted in the settings, same savers as saveAllSettings
+ */
+const std::map<quint8,std::function<void(const QByteArray&)>>& journaledGroups()
+{
+    static const std::map<quint8,std::function<void(const QByteArray&)>> groups = {
+        {SysFsDataProviderPowerProfile::dataType, groupSaver(&SettingsSaverPowerProfiles::saverPowerProfile)},
+        {SysFsDataProviderCPUOptions::dataType,   groupSaver(&SettingsSaverCPUControlData::saverPowerProfile)},
+        {SysFsDataProviderCPUFrequency::dataType, groupSaver(&SettingsSaverCPUFrequency::saveCPUFrequency)},
+        {SysFsDataProviderFanCurve::dataType,     groupSaver(&SettingsSaverFanCurve::saveFanCurve)},
+        {SysFsDataProviderFanOption::dataType,    groupSaver(&SettingsSaverFanOption::saveFanOption)},
+        {SysFsDataProviderCPUSMT::dataType,       groupSaver(&SettingsSaverCPUSMT::saveCPUSMT)},
+        {SysFsDataProviderCPUPower::dataType,     groupSaver(&SettingsSaverCPUPower::saveCPUPower)},
+        {SysFsDataProviderGPUPower::dataType,     groupSaver(&SettingsSaverGPUPower::saveGPUPower)},
+        {DataProviderNvidiaNvml::dataType,        groupSaver(&SettingsSaverNvidiaNvml::saveNvidiaNvml)},
+        {SysFsDataProviderIntelMSR::dataType,     groupSaver(&SettingsSaverIntelMSR::saveIntelMSR,&roundVoltageOffsets)},
+        {SysFsDataProviderOther::dataType,        groupSaver(&SettingsSaverOther::saveOther)},
+        {SysFsDataProviderCPUEnergyPerformance::dataType, groupSaver(&SettingsSaverCPUEnergyPerformance::saveCPUEnergyPerformance)}
+    };
+
+    return groups;
+}
+
+void applyJournaled(quint8 dataType,const QByteArray& data)
+{
+    const auto it = journaledGroups().find(dataType);
+
+    if(it != journaledGroups().end())
+    {
+        it->second(data);
+    }
+}
+
+}
+
 DaemonSettingsManager& DaemonSettingsManager::getInstance()
 {
     static DaemonSettingsManager instance;
@@ -38,6 +144,20 @@ DaemonSettingsManager::DaemonSettingsManager() : m_daemonSettings{}
 void DaemonSettingsManager::loadAllSettings(DataProviderManager* dataProviderManager)
 {
     LOG_T("DaemonSettingsManager::loadAllSettings - start");
+
+    // Settings of the previous versions are taken over once
+    try {
+        SettingsMigrationIni::migrate();
+    } catch(const bj::framework::exception::Exception& ex) {
+        LOG_W(QString("DaemonSettingsManager::loadAllSettings - migration of settings failed: ") + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+
+    // Changes not compacted before the previous run ended
+    try {
+        SettingsJournal::recover(applyJournaled);
+    } catch(const bj::framework::exception::Exception& ex) {
+        LOG_W(QString("DaemonSettingsManager::loadAllSettings - recovery of settings journal failed: ") + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
     
     // Always load daemon settings first
     loadDaemonSettings();
@@ -62,25 +182,158 @@ void DaemonSettingsManager::loadAllSettings(DataProviderManager* dataProviderMan
         LOG_D("DaemonSettingsManager::loadAllSettings - Non-CUSTOM power profile, will skip custom-only settings");
     }
     
-    // Always load power profile
-    loadPowerProfile(dataProviderManager);
-    loadCPUControlData(dataProviderManager);
-    loadCPUFrequency(dataProviderManager);
-    
-    // Only load custom settings if CUSTOM power profile is saved
-    if (isCustomProfile) {
-        loadFanCurve(dataProviderManager);
-        loadCPUPower(dataProviderManager);
-        loadGPUPower(dataProviderManager);
-    } else {
-        LOG_D("DaemonSettingsManager::loadAllSettings - skipping FanCurve, CPUPower, GPUPower (not CUSTOM profile)");
+    SettingsReconciler reconciler(dataProviderManager);
+
+    /*
+     * Stage 0 power profile, the custom limits depend on it
+     * Stage 1 CPU options, they bring CPUs online and refresh the drivers, so nothing runs next to them
+     * Stage 2 independent attributes, in the order added below
+     * Stage 3 SMT, as before after the CPU frequencies
+     */
+    try {
+        legion::messages::CPUOptions    cpuOptions;
+        legion::messages::CPUFrequency  cpuFrequency;
+        legion::messages::FanCurve      fanCurve;
+        legion::messages::CPUPower      cpuPower;
+        legion::messages::GPUPower      gpuPower;
+        legion::messages::FanOption     fanOption;
+        legion::messages::CPUSMT        cpuSMT;
+        legion::messages::NvidiaNvml    nvidiaNvml;
+        legion::messages::CpuIntelMSR   intelMSR;
+        legion::messages::OtherSettings otherSettings;
+        legion::messages::CPUEnergyPerformance cpuEnergyPerformance;
+
+        SettingsLoaderCPUControlData().loadPowerProfile(cpuOptions);
+        SettingsLoaderCPUFrequency().loadCPUFrequency(cpuFrequency);
+        SettingsLoaderFanOption().loadFanOption(fanOption);
+        SettingsLoaderCPUSMT().loadCPUSMT(cpuSMT);
+        SettingsLoaderNvidiaNvml().loadNvidiaNvml(nvidiaNvml);
+        SettingsLoaderIntelMSR().loadIntelMSR(intelMSR);
+        SettingsLoaderOther().loadOther(otherSettings);
+        SettingsLoaderCPUEnergyPerformance().loadCPUEnergyPerformance(cpuEnergyPerformance);
+
+        // Skip the ones without saved data
+        if(savedProfile.ByteSizeLong() != 0)
+        {
+            reconciler.add(0,SysFsDataProviderPowerProfile::dataType,savedProfile);
+        }
+
+        if(cpuOptions.ByteSizeLong() != 0)
+        {
+            reconciler.add(1,SysFsDataProviderCPUOptions::dataType,cpuOptions);
+        }
+
+        // Governors before the frequency limits, intel_pstate changes the EPP with the governor
+        if(cpuEnergyPerformance.ByteSizeLong() != 0)
+        {
+            reconciler.add<legion::messages::CPUEnergyPerformance>(2,SysFsDataProviderCPUEnergyPerformance::dataType,cpuEnergyPerformance,[](legion::messages::CPUEnergyPerformance& message) {
+                message.clear_cpus();
+                message.clear_applied_policy();
+                message.clear_clear_policies();
+            });
+        }
+
+        if(cpuFrequency.ByteSizeLong() != 0)
+        {
+            reconciler.add<legion::messages::CPUFrequency>(2,SysFsDataProviderCPUFrequency::dataType,cpuFrequency,[](legion::messages::CPUFrequency& message) {
+                for(auto& cpu : *message.mutable_cpus())
+                {
+                    cpu.clear_scaling_cur_freq();
+                }
+            });
+        }
+
+        // Only load custom settings if CUSTOM power profile is saved
+        if (isCustomProfile) {
+            SettingsLoaderFanCurve().loadFanCurve(fanCurve);
+            SettingsLoaderCPUPower().loadCPUPower(cpuPower);
+            SettingsLoaderGPUPower().loadGPUPower(gpuPower);
+
+            if(fanCurve.ByteSizeLong() != 0)
+            {
+                reconciler.add<legion::messages::FanCurve>(2,SysFsDataProviderFanCurve::dataType,fanCurve,[](legion::messages::FanCurve& message) {
+                    message.clear_cpu_default();
+                    message.clear_gpu_default();
+                    message.clear_cpusen_default();
+                    message.clear_sys_default();
+                });
+            }
+
+            if(cpuPower.ByteSizeLong() != 0)
+            {
+                reconciler.add<legion::messages::CPUPower>(2,SysFsDataProviderCPUPower::dataType,cpuPower,[](legion::messages::CPUPower& message) {
+                    clearModeDescriptors(message);
+                });
+            }
+
+            if(gpuPower.ByteSizeLong() != 0)
+            {
+                reconciler.add<legion::messages::GPUPower>(2,SysFsDataProviderGPUPower::dataType,gpuPower,[](legion::messages::GPUPower& message) {
+                    clearModeDescriptors(message);
+                });
+            }
+        } else {
+            LOG_D("DaemonSettingsManager::loadAllSettings - skipping FanCurve, CPUPower, GPUPower (not CUSTOM profile)");
+        }
+
+        if(fanOption.ByteSizeLong() != 0)
+        {
+            reconciler.add(2,SysFsDataProviderFanOption::dataType,fanOption);
+        }
+
+        if(nvidiaNvml.ByteSizeLong() != 0)
+        {
+            reconciler.add<legion::messages::NvidiaNvml>(2,DataProviderNvidiaNvml::dataType,nvidiaNvml,[](legion::messages::NvidiaNvml& message) {
+                message.clear_hardware_monitor();
+                message.clear_name();
+                message.clear_power_state();
+                message.clear_events();
+                message.clear_clock_changes();
+                message.clear_throttle_reasons();
+                message.clear_clear_events();
+                message.clear_sample_series();
+            });
+        }
+
+        if(intelMSR.ByteSizeLong() != 0)
+        {
+            reconciler.add<legion::messages::CpuIntelMSR>(2,SysFsDataProviderIntelMSR::dataType,intelMSR,[](legion::messages::CpuIntelMSR& message) {
+                roundVoltageOffsets(message);
+            });
+        }
+
+        if(otherSettings.ByteSizeLong() != 0)
+        {
+            reconciler.add(2,SysFsDataProviderOther::dataType,otherSettings);
+        }
+
+        if(cpuSMT.ByteSizeLong() != 0)
+        {
+            reconciler.add(3,SysFsDataProviderCPUSMT::dataType,cpuSMT);
+        }
+
+        m_lastReconcileReport = reconciler.reconcile();
+
+        quint32 unchanged = 0;
+        quint32 failed    = 0;
+
+        for(const auto& step : m_lastReconcileReport.m_steps)
+        {
+            unchanged += step.m_changedFields == 0 && !step.m_failed ? 1 : 0;
+            failed    += step.m_failed ? 1 : 0;
+        }
+
+        LOGF_I("Saved settings applied in {} us (read {} us, write {} us), {} providers, {} unchanged, {} failed",
+               m_lastReconcileReport.m_totalTime / 1000,
+               m_lastReconcileReport.m_readTime / 1000,
+               m_lastReconcileReport.m_applyTime / 1000,
+               m_lastReconcileReport.m_steps.size(),
+               unchanged,
+               failed);
+    } catch(...) {
+        LOG_W("DaemonSettingsManager::loadAllSettings - failed");
     }
-    
-    loadFanOption(dataProviderManager);
-    loadCPUSMT(dataProviderManager);
-    loadNvidiaNvml(dataProviderManager);
-    loadIntelMSR(dataProviderManager);
-    loadOther(dataProviderManager);
+
     LOG_T("DaemonSettingsManager::loadAllSettings - complete");
 }
 
@@ -88,6 +341,9 @@ void DaemonSettingsManager::saveAllSettings(DataProviderManager* dataProviderMan
 {
     LOG_D("DaemonSettingsManager::saveAllSettings - start");
 
+    // All groups written to the settings file at once
+    SettingsStore::Batch batch;
+
     saveDaemonSettings();
     savePowerProfile(dataProviderManager);
     saveCPUControlData(dataProviderManager);
@@ -100,6 +356,7 @@ void DaemonSettingsManager::saveAllSettings(DataProviderManager* dataProviderMan
     saveNvidiaNvml(dataProviderManager);
     saveIntelMSR(dataProviderManager);
     saveOther(dataProviderManager);
+    saveCPUEnergyPerformance(dataProviderManager);
     LOG_D("DaemonSettingsManager::saveAllSettings - complete");
 }
 
@@ -107,6 +364,21 @@ void DaemonSettingsManager::saveAllSettingsOnExit(DataProviderManager *dataProvi
 {
     LOG_T("DaemonSettingsManager::saveAllSettingsOnExit - start");
 
+    /*
+     * Changes are already in the journal, only the last batch is written and folded into the snapshot
+     */
+    if (m_journal) {
+        try {
+            m_journal->stop();
+        } catch(const bj::framework::exception::Exception& ex) {
+            LOG_W(QString("DaemonSettingsManager::saveAllSettingsOnExit - settings journal failed: ") + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        }
+        m_journal.reset();
+
+        LOG_T("DaemonSettingsManager::saveAllSettingsOnExit - complete");
+        return;
+    }
+
     if (!shouldSaveOnExit()) {
         LOG_D("DaemonSettingsManager::saveAllSettingsOnExit - save disabled by user settings");
         return;
@@ -117,6 +389,41 @@ void DaemonSettingsManager::saveAllSettingsOnExit(DataProviderManager *dataProvi
     LOG_T("DaemonSettingsManager::saveAllSettingsOnExit - complete");
 }
 
+void DaemonSettingsManager::startJournal(DataProviderManager *dataProviderManager)
+{
+    LOG_T("DaemonSettingsManager::startJournal");
+
+    m_journal.reset(new SettingsJournal([dataProviderManager](quint8 dataType) {
+            return dataProviderManager->getDataProvider(dataType).serializeAndGetData();
+        },
+        applyJournaled));
+
+    try {
+        m_journal->start();
+    } catch(const bj::framework::exception::Exception& ex) {
+        LOG_W(QString("DaemonSettingsManager::startJournal - settings journal not available, settings are saved on exit: ") + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        m_journal.reset();
+    }
+}
+
+void DaemonSettingsManager::recordChange(quint8 dataType)
+{
+    // Without save on exit the settings are kept only by an explicit save, as before
+    if (!m_journal || !shouldSaveOnExit() || !journaledGroups().contains(dataType)) {
+        return;
+    }
+
+    m_journal->changed(dataType);
+}
+
+void DaemonSettingsManager::kernelEventHandler(const SysFsDriver::SubsystemEvent &event)
+{
+    // Power profile changed by the Fn+Q key is saved as well
+    if (event.m_driverName == SysFsDriverACPIPlatformProfile::DRIVER_NAME && event.m_action == SysFsDriver::SubsystemEvent::Action::CHANGED) {
+        recordChange(SysFsDataProviderPowerProfile::dataType);
+    }
+}
+
 void DaemonSettingsManager::loadDaemonSettings()
 {
     LOG_T("DaemonSettingsManager::loadDaemonSettings");
@@ -156,28 +463,6 @@ void DaemonSettingsManager::saveDaemonSettings()
     saver.saveDaemonSettings(m_daemonSettings);
 }
 
-void DaemonSettingsManager::loadPowerProfile(DataProviderManager* dataProviderManager)
-{
-    LOG_T("DaemonSettingsManager::loadPowerProfile");
-    try {
-        legion::messages::PowerProfile profile;
-        SettingsLoaderPowerProfiles().loadPowerProfile(profile);
-        // Skip if no fields are set
-        if(profile.ByteSizeLong() == 0) {
-            LOG_D("DaemonSettingsManager::loadPowerProfile - no saved data, skipping");
-            return;
-        }
-        QByteArray data;
-        data.resize(profile.ByteSizeLong());
-        if(profile.SerializeToArray(data.data(),data.size()))
-        {
-            dataProviderManager->getDataProvider(SysFsDataProviderPowerProfile::dataType).deserializeAndSetData(data);
-        }
-    } catch(...) {
-        LOG_W("DaemonSettingsManager::loadPowerProfile - failed");
-    }
-}
-
 void DaemonSettingsManager::savePowerProfile(DataProviderManager* dataProviderManager)
 {
     LOG_T("DaemonSettingsManager::savePowerProfile");
@@ -193,28 +478,6 @@ void DaemonSettingsManager::savePowerProfile(DataProviderManager* dataProviderMa
     }
 }
 
-void DaemonSettingsManager::loadCPUControlData(DataProviderManager* dataProviderManager)
-{
-    LOG_T("DaemonSettingsManager::loadCPUControlData");
-    try {
-        legion::messages::CPUOptions opts;
-        SettingsLoaderCPUControlData().loadPowerProfile(opts);
-        // Skip if no fields are set
-        if(opts.ByteSizeLong() == 0) {
-            LOG_D("DaemonSettingsManager::loadCPUControlData - no saved data, skipping");
-            return;
-        }
-        QByteArray data;
-        data.resize(opts.ByteSizeLong());
-        if(opts.SerializeToArray(data.data(),data.size()))
-        {
-            dataProviderManager->getDataProvider(SysFsDataProviderCPUOptions::dataType).deserializeAndSetData(data);
-        }
-    } catch(...) {
-        LOG_W("DaemonSettingsManager::loadCPUControlData - failed");
-    }
-}
-
 void DaemonSettingsManager::saveCPUControlData(DataProviderManager* dataProviderManager)
 {
     LOG_T("DaemonSettingsManager::saveCPUControlData");
@@ -230,28 +493,6 @@ void DaemonSettingsManager::saveCPUControlData(DataProviderManager* dataProvider
     }
 }
 
-void DaemonSettingsManager::loadCPUFrequency(DataProviderManager* dataProviderManager)
-{
-    LOG_T("DaemonSettingsManager::loadCPUFrequency");
-    try {
-        legion::messages::CPUFrequency freq;
-        SettingsLoaderCPUFrequency().loadCPUFrequency(freq);
-        // Skip if no fields are set
-        if(freq.ByteSizeLong() == 0) {
-            LOG_D("DaemonSettingsManager::loadCPUFrequency - no saved data, skipping");
-            return;
-        }
-        QByteArray data;
-        data.resize(freq.ByteSizeLong());
-        if(freq.SerializeToArray(data.data(),data.size()))
-        {
-            dataProviderManager->getDataProvider(SysFsDataProviderCPUFrequency::dataType).deserializeAndSetData(data);
-        }
-    } catch(...) {
-        LOG_W("DaemonSettingsManager::loadCPUFrequency - failed");
-    }
-}
-
 void DaemonSettingsManager::saveCPUFrequency(DataProviderManager* dataProviderManager)
 {
     LOG_D("DaemonSettingsManager::saveCPUFrequency");
@@ -267,28 +508,6 @@ void DaemonSettingsManager::saveCPUFrequency(DataProviderManager* dataProviderMa
     }
 }
 
-void DaemonSettingsManager::loadFanCurve(DataProviderManager* dataProviderManager)
-{
-    LOG_T("DaemonSettingsManager::loadFanCurve");
-    try {
-        legion::messages::FanCurve curve;
-        SettingsLoaderFanCurve().loadFanCurve(curve);
-        // Skip if no fields are set
-        if(curve.ByteSizeLong() == 0) {
-            LOG_D("DaemonSettingsManager::loadFanCurve - no saved data, skipping");
-            return;
-        }
-        QByteArray data;
-        data.resize(curve.ByteSizeLong());
-        if(curve.SerializeToArray(data.data(),data.size()))
-        {
-            dataProviderManager->getDataProvider(SysFsDataProviderFanCurve::dataType).deserializeAndSetData(data);
-        }
-    } catch(...) {
-        LOG_W("DaemonSettingsManager::loadFanCurve - failed");
-    }
-}
-
 void DaemonSettingsManager::saveFanCurve(DataProviderManager* dataProviderManager)
 {
     LOG_T("DaemonSettingsManager::saveFanCurve");
@@ -304,28 +523,6 @@ void DaemonSettingsManager::saveFanCurve(DataProviderManager* dataProviderManage
     }
 }
 
-void DaemonSettingsManager::loadFanOption(DataProviderManager* dataProviderManager)
-{
-    LOG_T("DaemonSettingsManager::loadFanOption");
-    try {
-        legion::messages::FanOption opt;
-        SettingsLoaderFanOption().loadFanOption(opt);
-        // Skip if no fields are set
-        if(opt.ByteSizeLong() == 0) {
-            LOG_D("DaemonSettingsManager::loadFanOption - no saved data, skipping");
-            return;
-        }
-        QByteArray data;
-        data.resize(opt.ByteSizeLong());
-        if(opt.SerializeToArray(data.data(),data.size()))
-        {
-            dataProviderManager->getDataProvider(SysFsDataProviderFanOption::dataType).deserializeAndSetData(data);
-        }
-    } catch(...) {
-        LOG_W("DaemonSettingsManager::loadFanOption - failed");
-    }
-}
-
 void DaemonSettingsManager::saveFanOption(DataProviderManager* dataProviderManager)
 {
     LOG_T("DaemonSettingsManager::saveFanOption");
@@ -341,28 +538,6 @@ void DaemonSettingsManager::saveFanOption(DataProviderManager* dataProviderManag
     }
 }
 
-void DaemonSettingsManager::loadCPUSMT(DataProviderManager* dataProviderManager)
-{
-    LOG_T("DaemonSettingsManager::loadCPUSMT");
-    try {
-        legion::messages::CPUSMT smt;
-        SettingsLoaderCPUSMT().loadCPUSMT(smt);
-        // Skip if no fields are set
-        if(smt.ByteSizeLong() == 0) {
-            LOG_D("DaemonSettingsManager::loadCPUSMT - no saved data, skipping");
-            return;
-        }
-        QByteArray data;
-        data.resize(smt.ByteSizeLong());
-        if(smt.SerializeToArray(data.data(),data.size()))
-        {
-            dataProviderManager->getDataProvider(SysFsDataProviderCPUSMT::dataType).deserializeAndSetData(data);
-        }
-    } catch(...) {
-        LOG_W("DaemonSettingsManager::loadCPUSMT - failed");
-    }
-}
-
 void DaemonSettingsManager::saveCPUSMT(DataProviderManager* dataProviderManager)
 {
     LOG_T("DaemonSettingsManager::saveCPUSMT");
@@ -378,28 +553,6 @@ void DaemonSettingsManager::saveCPUSMT(DataProviderManager* dataProviderManager)
     }
 }
 
-void DaemonSettingsManager::loadCPUPower(DataProviderManager* dataProviderManager)
-{
-    LOG_T("DaemonSettingsManager::loadCPUPower");
-    try {
-        legion::messages::CPUPower power;
-        SettingsLoaderCPUPower().loadCPUPower(power);
-        // Skip if no fields are set
-        if(power.ByteSizeLong() == 0) {
-            LOG_D("DaemonSettingsManager::loadCPUPower - no saved data, skipping");
-            return;
-        }
-        QByteArray data;
-        data.resize(power.ByteSizeLong());
-        if(power.SerializeToArray(data.data(),data.size()))
-        {
-            dataProviderManager->getDataProvider(SysFsDataProviderCPUPower::dataType).deserializeAndSetData(data);
-        }
-    } catch(...) {
-        LOG_W("DaemonSettingsManager::loadCPUPower - failed");
-    }
-}
-
 void DaemonSettingsManager::saveCPUPower(DataProviderManager* dataProviderManager)
 {
     LOG_T("DaemonSettingsManager::saveCPUPower");
@@ -415,28 +568,6 @@ void DaemonSettingsManager::saveCPUPower(DataProviderManager* dataProviderManage
     }
 }
 
-void DaemonSettingsManager::loadGPUPower(DataProviderManager* dataProviderManager)
-{
-    LOG_T("DaemonSettingsManager::loadGPUPower");
-    try {
-        legion::messages::GPUPower power;
-        SettingsLoaderGPUPower().loadGPUPower(power);
-        // Skip if no fields are set
-        if(power.ByteSizeLong() == 0) {
-            LOG_D("DaemonSettingsManager::loadGPUPower - no saved data, skipping");
-            return;
-        }
-        QByteArray data;
-        data.resize(power.ByteSizeLong());
-        if(power.SerializeToArray(data.data(),data.size()))
-        {
-            dataProviderManager->getDataProvider(SysFsDataProviderGPUPower::dataType).deserializeAndSetData(data);
-        }
-    } catch(...) {
-        LOG_W("DaemonSettingsManager::loadGPUPower - failed");
-    }
-}
-
 void DaemonSettingsManager::saveGPUPower(DataProviderManager* dataProviderManager)
 {
     LOG_D("DaemonSettingsManager::saveGPUPower");
@@ -452,28 +583,6 @@ void DaemonSettingsManager::saveGPUPower(DataProviderManager* dataProviderManage
     }
 }
 
-void DaemonSettingsManager::loadNvidiaNvml(DataProviderManager* dataProviderManager)
-{
-    LOG_T("DaemonSettingsManager::loadNvidiaNvml");
-    try {
-        legion::messages::NvidiaNvml nvml;
-        SettingsLoaderNvidiaNvml().loadNvidiaNvml(nvml);
-        // Skip if no fields are set
-        if(nvml.ByteSizeLong() == 0) {
-            LOG_D("DaemonSettingsManager::loadNvidiaNvml - no saved data, skipping");
-            return;
-        }
-        QByteArray data;
-        data.resize(nvml.ByteSizeLong());
-        if(nvml.SerializeToArray(data.data(),data.size()))
-        {
-            dataProviderManager->getDataProvider(DataProviderNvidiaNvml::dataType).deserializeAndSetData(data);
-        }
-    } catch(...) {
-        LOG_W("DaemonSettingsManager::loadNvidiaNvml - failed");
-    }
-}
-
 void DaemonSettingsManager::saveNvidiaNvml(DataProviderManager* dataProviderManager)
 {
     LOG_T("DaemonSettingsManager::saveNvidiaNvml");
@@ -489,28 +598,6 @@ void DaemonSettingsManager::saveNvidiaNvml(DataProviderManager* dataProviderMana
     }
 }
 
-void DaemonSettingsManager::loadIntelMSR(DataProviderManager* dataProviderManager)
-{
-    LOG_T("DaemonSettingsManager::loadIntelMSR");
-    try {
-        legion::messages::CpuIntelMSR intelMSR;
-        SettingsLoaderIntelMSR().loadIntelMSR(intelMSR);
-        // Skip if no fields are set
-        if(intelMSR.ByteSizeLong() == 0) {
-            LOG_D("DaemonSettingsManager::loadIntelMSR - no saved data, skipping");
-            return;
-        }
-        QByteArray data;
-        data.resize(intelMSR.ByteSizeLong());
-        if(intelMSR.SerializeToArray(data.data(),data.size()))
-        {
-            dataProviderManager->getDataProvider(SysFsDataProviderIntelMSR::dataType).deserializeAndSetData(data);
-        }
-    } catch(...) {
-        LOG_W("DaemonSettingsManager::loadIntelMSR - failed");
-    }
-}
-
 void DaemonSettingsManager::saveIntelMSR(DataProviderManager* dataProviderManager)
 {
     LOG_T("DaemonSettingsManager::saveIntelMSR");
@@ -519,11 +606,7 @@ void DaemonSettingsManager::saveIntelMSR(DataProviderManager* dataProviderManage
         legion::messages::CpuIntelMSR intelMSR;
         if(intelMSR.ParseFromArray(data.data(), data.size()))
         {
-            intelMSR.mutable_analogio()->set_offset(((intelMSR.analogio().offset() > 0 ? intelMSR.analogio().offset() + 999 : intelMSR.analogio().offset() - 999 ) / 1000) * 1000);
-            intelMSR.mutable_cache()->set_offset(((intelMSR.cache().offset() > 0 ? intelMSR.cache().offset() + 999 : intelMSR.cache().offset() - 999 ) / 1000) * 1000);
-            intelMSR.mutable_cpu()->set_offset(((intelMSR.cpu().offset() > 0 ? intelMSR.cpu().offset() + 999 : intelMSR.cpu().offset() - 999) / 1000) * 1000);
-            intelMSR.mutable_gpu()->set_offset(((intelMSR.gpu().offset() > 0 ? intelMSR.gpu().offset() + 999 : intelMSR.gpu().offset() - 999 ) / 1000) * 1000);
-            intelMSR.mutable_uncore()->set_offset(((intelMSR.uncore().offset() > 0 ? intelMSR.uncore().offset() + 999 : intelMSR.uncore().offset() - 999 ) / 1000) * 1000);
+            roundVoltageOffsets(intelMSR);
 
             SettingsSaverIntelMSR().saveIntelMSR(intelMSR);
         }
@@ -532,43 +615,41 @@ void DaemonSettingsManager::saveIntelMSR(DataProviderManager* dataProviderManage
     }
 }
 
-void DaemonSettingsManager::loadOther(DataProviderManager* dataProviderManager)
+void DaemonSettingsManager::saveOther(DataProviderManager* dataProviderManager)
 {
-    LOG_T("DaemonSettingsManager::loadOther");
+    LOG_D("DaemonSettingsManager::saveOther");
     try {
+        auto data = dataProviderManager->getDataProvider(SysFsDataProviderOther::dataType).serializeAndGetData();
         legion::messages::OtherSettings otherSettings;
-        SettingsLoaderOther().loadOther(otherSettings);
-        // Skip if no fields are set
-        if(otherSettings.ByteSizeLong() == 0) {
-            LOG_D("DaemonSettingsManager::loadOther - no saved data, skipping");
-            return;
-        }
-        QByteArray data;
-        data.resize(otherSettings.ByteSizeLong());
-        if(otherSettings.SerializeToArray(data.data(),data.size()))
+        if(otherSettings.ParseFromArray(data.data(), data.size()))
         {
-            dataProviderManager->getDataProvider(SysFsDataProviderOther::dataType).deserializeAndSetData(data);
+            SettingsSaverOther().saveOther(otherSettings);
         }
     } catch(...) {
-        LOG_W("DaemonSettingsManager::loadOther - failed");
+        LOG_W("DaemonSettingsManager::saveOther - failed");
     }
 }
 
-void DaemonSettingsManager::saveOther(DataProviderManager* dataProviderManager)
+void DaemonSettingsManager::saveCPUEnergyPerformance(DataProviderManager* dataProviderManager)
 {
-    LOG_D("DaemonSettingsManager::saveOther");
+    LOG_D("DaemonSettingsManager::saveCPUEnergyPerformance");
     try {
-        auto data = dataProviderManager->getDataProvider(SysFsDataProviderOther::dataType).serializeAndGetData();
-        legion::messages::OtherSettings otherSettings;
-        if(otherSettings.ParseFromArray(data.data(), data.size()))
+        auto data = dataProviderManager->getDataProvider(SysFsDataProviderCPUEnergyPerformance::dataType).serializeAndGetData();
+        legion::messages::CPUEnergyPerformance cpuEnergyPerformance;
+        if(cpuEnergyPerformance.ParseFromArray(data.data(), data.size()))
         {
-            SettingsSaverOther().saveOther(otherSettings);
+            SettingsSaverCPUEnergyPerformance().saveCPUEnergyPerformance(cpuEnergyPerformance);
         }
     } catch(...) {
-        LOG_W("DaemonSettingsManager::saveOther - failed");
+        LOG_W("DaemonSettingsManager::saveCPUEnergyPerformance - failed");
     }
 }
 
+const SettingsReconciler::Report& DaemonSettingsManager::getLastReconcileReport() const
+{
+    return m_lastReconcileReport;
+}
+
 const legion::messages::DaemonSettings& DaemonSettingsManager::getDaemonSettings() const
 {
     return m_daemonSettings;
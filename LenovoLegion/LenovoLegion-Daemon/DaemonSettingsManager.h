@@ -9,8 +9,14 @@
 
 #include <Core/ExceptionBuilder.h>
 
+#include "SettingsJournal.h"
+#include "SettingsReconciler.h"
+#include "SysFsDriver.h"
+
 #include "../LenovoLegion-PrepareBuild/DaemonSettings.pb.h"
 
+#include <memory>
+
 namespace LenovoLegionDaemon {
 
 class DataProviderManager;
@@ -39,19 +45,13 @@ public:
     void saveAllSettings(DataProviderManager* dataProviderManager);
     void saveAllSettingsOnExit(DataProviderManager* dataProviderManager);
 
+    // Changes of the clients recorded in the settings journal
+    void startJournal(DataProviderManager* dataProviderManager);
+    void recordChange(quint8 dataType);
+    void kernelEventHandler(const SysFsDriver::SubsystemEvent& event);
+
     // Load individual setting types
     void loadDaemonSettings();
-    void loadPowerProfile(DataProviderManager* dataProviderManager);
-    void loadCPUControlData(DataProviderManager* dataProviderManager);
-    void loadCPUFrequency(DataProviderManager* dataProviderManager);
-    void loadFanCurve(DataProviderManager* dataProviderManager);
-    void loadFanOption(DataProviderManager* dataProviderManager);
-    void loadCPUSMT(DataProviderManager* dataProviderManager);
-    void loadCPUPower(DataProviderManager* dataProviderManager);
-    void loadGPUPower(DataProviderManager* dataProviderManager);
-    void loadNvidiaNvml(DataProviderManager* dataProviderManager);
-    void loadIntelMSR(DataProviderManager* dataProviderManager);
-    void loadOther(DataProviderManager* dataProviderManager);
 
     // Save individual setting types
     void saveDaemonSettings();
@@ -66,6 +66,7 @@ public:
     void saveNvidiaNvml(DataProviderManager* dataProviderManager);
     void saveIntelMSR(DataProviderManager* dataProviderManager);
     void saveOther(DataProviderManager* dataProviderManager);
+    void saveCPUEnergyPerformance(DataProviderManager* dataProviderManager);
 
     // Access daemon settings
     const legion::messages::DaemonSettings& getDaemonSettings() const;
@@ -74,11 +75,16 @@ public:
     // Check if settings should be saved on exit
     bool shouldSaveOnExit() const;
 
+    // Outcome of the last apply of the saved settings
+    const SettingsReconciler::Report& getLastReconcileReport() const;
+
 private:
     DaemonSettingsManager();
     ~DaemonSettingsManager() = default;
 
     legion::messages::DaemonSettings m_daemonSettings;
+    SettingsReconciler::Report       m_lastReconcileReport;
+    std::unique_ptr<SettingsJournal> m_journal;
 };
 
 }
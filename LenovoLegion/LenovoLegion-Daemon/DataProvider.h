@@ -27,6 +27,13 @@ public:
         SERIALIZE_ERROR                     = -2
     };
 
+    struct DataProviderEvent
+    {
+        quint8  m_dataType;
+        QString m_eventType;
+        QString m_eventValue;
+    };
+
 public:
 
     DataProvider(QObject* parent,quint8  dataType);
@@ -47,6 +54,13 @@ public:
 
     virtual void kernelEventHandler(const LenovoLegionDaemon::SysFsDriver::SubsystemEvent &)   {};
 
+signals:
+
+    /*
+     * Data provider specific event (forwarded to notification clients)
+     */
+    void dataProviderEvent(const LenovoLegionDaemon::DataProvider::DataProviderEvent& event);
+
 private:
 
 public:
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "DataProviderDaemonStats.h"
+#include "DataProviderManager.h"
+#include "LatencyStatistics.h"
+#include "DaemonSettingsManager.h"
+
+#include "../LenovoLegion-PrepareBuild/DaemonStats.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+namespace LenovoLegionDaemon {
+
+namespace {
+
+void fillLatency(legion::messages::DaemonStats::Latency* latency,const LatencyHistogram& histogram)
+{
+    latency->set_count(histogram.count());
+    latency->set_min(histogram.min());
+    latency->set_mean(histogram.mean());
+    latency->set_p50(histogram.valueAtPercentile(50.0));
+    latency->set_p99(histogram.valueAtPercentile(99.0));
+    latency->set_max(histogram.max());
+}
+
+}
+
+DataProviderDaemonStats::DataProviderDaemonStats(DataProviderManager* dataProviderManager) :
+    DataProvider(dataProviderManager, dataType)
+{}
+
+QByteArray DataProviderDaemonStats::serializeAndGetData() const
+{
+    legion::messages::DaemonStats daemonStats;
+    QByteArray byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    daemonStats.set_enabled(LatencyStatistics::isEnabled());
+
+    LatencyStatistics::getInstance().forEachProviderDo([&daemonStats](quint8 dataType,const LatencyStatistics::ProviderStats& stats){
+        legion::messages::DaemonStats::Provider* provider = daemonStats.add_providers();
+
+        provider->set_data_type(dataType);
+        provider->set_errors(stats.m_errors);
+
+        fillLatency(provider->mutable_parse(),stats.m_stages[LatencyStatistics::PARSE]);
+        fillLatency(provider->mutable_get_data(),stats.m_stages[LatencyStatistics::GET_DATA]);
+        fillLatency(provider->mutable_set_data(),stats.m_stages[LatencyStatistics::SET_DATA]);
+        fillLatency(provider->mutable_socket_write(),stats.m_stages[LatencyStatistics::SOCKET_WRITE]);
+        fillLatency(provider->mutable_kernel_event(),stats.m_stages[LatencyStatistics::KERNEL_EVENT]);
+        fillLatency(provider->mutable_init(),stats.m_stages[LatencyStatistics::INIT]);
+    });
+
+    LatencyStatistics::getInstance().forEachAttributeDo([&daemonStats](const std::string& path,const LatencyStatistics::AttributeStats& stats){
+        legion::messages::DaemonStats::Attribute* attribute = daemonStats.add_attributes();
+
+        attribute->set_path(path);
+
+        fillLatency(attribute->mutable_read(),stats.m_reads);
+        fillLatency(attribute->mutable_write(),stats.m_writes);
+    });
+
+    const SettingsReconciler::Report& report = DaemonSettingsManager::getInstance().getLastReconcileReport();
+
+    for(const auto& step : report.m_steps)
+    {
+        legion::messages::DaemonStats::Reconcile::Step* stepMsg = daemonStats.mutable_reconcile()->add_steps();
+
+        stepMsg->set_data_type(step.m_dataType);
+        stepMsg->set_name(step.m_name.toStdString());
+        stepMsg->set_changed_fields(step.m_changedFields);
+        stepMsg->set_time(step.m_time);
+        stepMsg->set_failed(step.m_failed);
+    }
+
+    daemonStats.mutable_reconcile()->set_read_time(report.m_readTime);
+    daemonStats.mutable_reconcile()->set_apply_time(report.m_applyTime);
+    daemonStats.mutable_reconcile()->set_total_time(report.m_totalTime);
+
+    byteArray.resize(daemonStats.ByteSizeLong());
+    if(!daemonStats.SerializeToArray(byteArray.data(), byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T, ERROR_CODES::SERIALIZE_ERROR, "Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray DataProviderDaemonStats::deserializeAndSetData(const QByteArray& data)
+{
+    legion::messages::DaemonStats daemonStats;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!daemonStats.ParseFromArray(data.data(), data.size()))
+    {
+        THROW_EXCEPTION(exception_T, DataProvider::ERROR_CODES::INVALID_DATA, "Parse of data message error !");
+    }
+
+    if(daemonStats.has_reset() && daemonStats.reset())
+    {
+        LOG_D("Daemon statistics reset");
+        LatencyStatistics::getInstance().reset();
+    }
+
+    if(daemonStats.has_enabled())
+    {
+        LOG_D(QString("Daemon statistics ") + (daemonStats.enabled() ? "enabled" : "disabled"));
+        LatencyStatistics::setEnabled(daemonStats.enabled());
+    }
+
+    return {};
+}
+
+}
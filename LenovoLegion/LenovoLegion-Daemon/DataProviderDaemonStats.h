@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include "DataProvider.h"
+
+namespace LenovoLegionDaemon {
+
+class DataProviderManager;
+
+class DataProviderDaemonStats : public DataProvider
+{
+    Q_OBJECT
+
+public:
+    explicit DataProviderDaemonStats(DataProviderManager* dataProviderManager);
+    ~DataProviderDaemonStats() override = default;
+
+    QByteArray serializeAndGetData() const override;
+    QByteArray deserializeAndSetData(const QByteArray& data) override;
+
+public:
+    static constexpr quint8 dataType = 21;
+};
+
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "DataProviderDaemonTrace.h"
+#include "DataProviderManager.h"
+#include "Tracer.h"
+
+#include "../LenovoLegion-PrepareBuild/DaemonTrace.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+namespace LenovoLegionDaemon {
+
+DataProviderDaemonTrace::DataProviderDaemonTrace(DataProviderManager* dataProviderManager) :
+    DataProvider(dataProviderManager, dataType)
+{}
+
+QByteArray DataProviderDaemonTrace::serializeAndGetData() const
+{
+    legion::messages::DaemonTrace daemonTrace;
+    QByteArray byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    daemonTrace.set_enabled(Tracer::isEnabled());
+    daemonTrace.set_recorded_events(Tracer::recordedEvents());
+    daemonTrace.set_dropped_events(Tracer::droppedEvents());
+
+    byteArray.resize(daemonTrace.ByteSizeLong());
+    if(!daemonTrace.SerializeToArray(byteArray.data(), byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T, ERROR_CODES::SERIALIZE_ERROR, "Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray DataProviderDaemonTrace::deserializeAndSetData(const QByteArray& data)
+{
+    legion::messages::DaemonTrace daemonTrace;
+    QByteArray byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!daemonTrace.ParseFromArray(data.data(), data.size()))
+    {
+        THROW_EXCEPTION(exception_T, DataProvider::ERROR_CODES::INVALID_DATA, "Parse of data message error !");
+    }
+
+    if(daemonTrace.has_dump() && daemonTrace.dump())
+    {
+        legion::messages::DaemonTrace dumpResponse;
+
+        LOG_D("Dumping daemon trace to the client");
+
+        dumpResponse.set_enabled(Tracer::isEnabled());
+        dumpResponse.set_recorded_events(Tracer::recordedEvents());
+        dumpResponse.set_dropped_events(Tracer::droppedEvents());
+        dumpResponse.set_chrome_trace_json(Tracer::chromeTraceJson());
+
+        byteArray.resize(dumpResponse.ByteSizeLong());
+        if(!dumpResponse.SerializeToArray(byteArray.data(), byteArray.size()))
+        {
+            THROW_EXCEPTION(exception_T, ERROR_CODES::SERIALIZE_ERROR, "Serialize of data message error !");
+        }
+    }
+
+    if(daemonTrace.has_clear_events() && daemonTrace.clear_events())
+    {
+        Tracer::clear();
+    }
+
+    if(daemonTrace.has_enabled())
+    {
+        LOG_D(QString("Daemon tracing ") + (daemonTrace.enabled() ? "enabled" : "disabled"));
+        Tracer::setEnabled(daemonTrace.enabled());
+    }
+
+    return byteArray;
+}
+
+void DataProviderDaemonTrace::clean()
+{
+    Tracer::setEnabled(false);
+}
+
+}
@@ -7,10 +7,14 @@
  */
 #include "DataProviderManager.h"
 #include "SysFsDriverManager.h"
+#include "LatencyStatistics.h"
+#include "Tracer.h"
 
 
 #include <Core/LoggerHolder.h>
 
+#include <QElapsedTimer>
+
 
 
 namespace  LenovoLegionDaemon {
@@ -32,13 +36,19 @@ void DataProviderManager::addDataProvider(DataProvider *driver)
     {
         THROW_EXCEPTION(exception_T,DATA_PROVIDER_ALREADY_LOADED,"Driver already loaded !");
     };
+
+    connect(driver,&DataProvider::dataProviderEvent,this,&DataProviderManager::dataProviderEvent);
 }
 
 void DataProviderManager::initDataProviders()
 {
+    QElapsedTimer timer;
+
     for(auto& driver : m_dataProviders)
     {
+        timer.start();
         driver.second->init();
+        LatencyStatistics::getInstance().recordProvider(driver.first,LatencyStatistics::INIT,timer.nsecsElapsed());
     }
 }
 
@@ -72,9 +82,14 @@ void DataProviderManager::forEachDataProviderDo(const std::function<void (DataPr
 
 void DataProviderManager::kernelEventHandler(const SysFsDriver::SubsystemEvent &event)
 {
+    QElapsedTimer timer;
+
     for(auto& driver : m_dataProviders)
     {
+        TRACE_SPAN("provider","kernelEventHandler",driver.first);
+        timer.start();
         driver.second->kernelEventHandler(event);
+        LatencyStatistics::getInstance().recordProvider(driver.first,LatencyStatistics::KERNEL_EVENT,timer.nsecsElapsed());
     }
 }
 
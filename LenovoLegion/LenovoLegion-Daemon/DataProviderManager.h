@@ -57,6 +57,10 @@ public slots:
 
     void kernelEventHandler(const LenovoLegionDaemon::SysFsDriver::SubsystemEvent& event);
 
+signals:
+
+    void dataProviderEvent(const LenovoLegionDaemon::DataProvider::DataProviderEvent& event);
+
 private:
 
     SysFsDriverManager*                  m_sysFsDriverManager;
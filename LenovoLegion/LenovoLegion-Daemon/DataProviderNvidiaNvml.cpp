@@ -1,16 +1,69 @@
 #include "DataProviderNvidiaNvml.h"
+#include "NvmlLibrary.h"
+#include "NvmlProcessAccounting.h"
+#include "SysFsDriver.h"
 #include "Core/LoggerHolder.h"
 
+#include <QDateTime>
+#include <QFile>
+
 #include "../LenovoLegion-PrepareBuild/NvidiaNvml.pb.h"
 
 namespace LenovoLegionDaemon {
 
+namespace {
+
+/*
+ * Indexed by DataProviderNvidiaNvml::SampleType
+ */
+constexpr std::array<nvmlSamplingType_t,DataProviderNvidiaNvml::SAMPLE_TYPE_COUNT> SAMPLING_TYPES {
+    NVML_GPU_UTILIZATION_SAMPLES,
+    NVML_MEMORY_UTILIZATION_SAMPLES,
+    NVML_TOTAL_POWER_SAMPLES,
+    NVML_PROCESSOR_CLK_SAMPLES,
+    NVML_MEMORY_CLK_SAMPLES
+};
+
+double sampleValue(nvmlValueType_t type,const nvmlValue_t& value)
+{
+    switch (type) {
+    case NVML_VALUE_TYPE_DOUBLE:
+        return value.dVal;
+    case NVML_VALUE_TYPE_UNSIGNED_INT:
+        return value.uiVal;
+    case NVML_VALUE_TYPE_UNSIGNED_LONG:
+        return value.ulVal;
+    case NVML_VALUE_TYPE_UNSIGNED_LONG_LONG:
+        return static_cast<double>(value.ullVal);
+    case NVML_VALUE_TYPE_SIGNED_LONG_LONG:
+        return static_cast<double>(value.sllVal);
+    default:
+        return 0;
+    }
+}
+
+}
+
 
-DataProviderNvidiaNvml::DataProviderNvidiaNvml(QObject* parent)  : DataProvider(parent,dataType),
+DataProviderNvidiaNvml::DataProviderNvidiaNvml(QObject* parent,const std::filesystem::path& pciDevicesPath)  : DataProvider(parent,dataType),
     m_maxGraphicsClock(0),
     m_maxSmClock(0),
     m_maxMemClock(0),
-    m_device(nullptr)
+    m_device(nullptr),
+    m_nvml(new NvmlLibrary()),
+    m_pciDevicesPath(SysFsDriver::rootedPath(pciDevicesPath)),
+    m_staticData(false),
+    m_nvmlUnavailable(false),
+    m_gpuOffset(0),
+    m_memOffset(0),
+    m_idleSamples(0),
+    m_eventSet(nullptr),
+    m_throttleReasons(0),
+    m_lastSampleTimestamp{},
+    m_processAccounting(new NvmlProcessAccounting(SysFsDriver::rootedPath("/proc"))),
+    m_samplerStop(false),
+    m_generation(0),
+    m_clockChanges(0)
 {
 
 }
@@ -22,191 +75,455 @@ DataProviderNvidiaNvml::~DataProviderNvidiaNvml()
 
 QByteArray DataProviderNvidiaNvml::serializeAndGetData() const
 {
-    legion::messages::NvidiaNvml gpuData;
-    QByteArray                   byteArray;
+    std::shared_ptr<const legion::messages::NvidiaNvml> snapshot;
+    legion::messages::NvidiaNvml                        gpuData;
+    QByteArray                                          byteArray;
 
 
     LOG_T(__PRETTY_FUNCTION__);
 
     /*
-     * Static data
+     * First GET after a pause gets the last snapshot, the sampler is running again for the next one
      */
-    if(m_device != nullptr)
+    requestSamples();
+
     {
-        nvmlReturn_t result;
-        unsigned int graphicsClock, smClock, memClock;
-        int gpuOffset, memOffset;
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        snapshot      = m_snapshot;
+
+        if(snapshot != nullptr)
+        {
+            gpuData = *snapshot;
+        }
+
+        for(const auto& event : m_events)
+        {
+            auto* gpuEvent = gpuData.add_events();
+
+            gpuEvent->set_type(static_cast<legion::messages::NvidiaNvml_Event_Type>(event.m_type));
+            gpuEvent->set_timestamp(event.m_timestamp);
+            gpuEvent->set_throttle_reasons(event.m_throttleReasons);
+            gpuEvent->set_xid(event.m_xid);
+            gpuEvent->set_gpu_clock(event.m_gpuClock);
+        }
+
+        gpuData.set_clock_changes(m_clockChanges);
+
+        for(size_t type = 0; type < SAMPLE_TYPE_COUNT; ++type)
+        {
+            if(m_samples[type].empty())
+            {
+                continue;
+            }
+
+            auto* series = gpuData.add_sample_series();
+
+            series->set_type(static_cast<legion::messages::NvidiaNvml_SampleSeries_Type>(type));
+
+            for(const auto& sample : m_samples[type])
+            {
+                series->add_timestamps(sample.m_timestamp);
+                series->add_values(sample.m_value);
+            }
+        }
+    }
+
+    if(snapshot == nullptr)
+    {
+        LOG_T("No NVIDIA GPU detected, skipping data collection.");
+    }
+
+    byteArray.resize(gpuData.ByteSizeLong());
+    if(!gpuData.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+std::shared_ptr<const legion::messages::NvidiaNvml> DataProviderNvidiaNvml::sample()
+{
+    auto gpuData = std::make_shared<legion::messages::NvidiaNvml>();
+
+    std::lock_guard<std::mutex> lock(m_nvmlMutex);
+
+    /*
+     * Suspended GPU is not touched, any NVML call would wake it up
+     */
+    if(!gpuActive())
+    {
+        closeNvml();
+        m_holdUntil = {};
 
+        gpuData->set_power_state(legion::messages::NvidiaNvml::POWER_STATE_SUSPENDED);
+    }
+    else if(m_device == nullptr && !m_nvmlUnavailable && std::chrono::steady_clock::now() >= m_holdUntil)
+    {
+        try {
+            openNvml();
+        }
+        catch(NvmlLibrary::exception_T& ex)
+        {
+            m_nvmlUnavailable = true;
+            LOG_W(QString("NVML not available: %1").arg(ex.what()));
+        }
+        catch(exception_T& ex)
+        {
+            LOG_D(QString("NVML open failed: %1").arg(ex.what()));
+        }
+    }
 
+    /*
+     * Static data
+     */
+    if(m_staticData)
+    {
         LOG_T("Filling NVML GPU data");
 
         /*
          * Name
          */
-        gpuData.set_name(m_GPUName.toStdString());
+        gpuData->set_name(m_GPUName.toStdString());
 
 
         /*
          * Min Max values
          */
-        gpuData.mutable_hardware_monitor()->mutable_memory_clock()->set_max_value(m_maxMemClock);
-        gpuData.mutable_hardware_monitor()->mutable_memory_clock()->set_min_value(0);
+        gpuData->mutable_hardware_monitor()->mutable_memory_clock()->set_max_value(m_maxMemClock);
+        gpuData->mutable_hardware_monitor()->mutable_memory_clock()->set_min_value(0);
 
-        gpuData.mutable_hardware_monitor()->mutable_sm_clock()->set_max_value(m_maxSmClock);
-        gpuData.mutable_hardware_monitor()->mutable_sm_clock()->set_min_value(0);
+        gpuData->mutable_hardware_monitor()->mutable_sm_clock()->set_max_value(m_maxSmClock);
+        gpuData->mutable_hardware_monitor()->mutable_sm_clock()->set_min_value(0);
 
-        gpuData.mutable_hardware_monitor()->mutable_gpu_clock()->set_max_value(m_maxGraphicsClock);
-        gpuData.mutable_hardware_monitor()->mutable_gpu_clock()->set_min_value(0);
+        gpuData->mutable_hardware_monitor()->mutable_gpu_clock()->set_max_value(m_maxGraphicsClock);
+        gpuData->mutable_hardware_monitor()->mutable_gpu_clock()->set_min_value(0);
 
-        gpuData.mutable_hardware_monitor()->mutable_gpu_utilization()->set_max_value(100);
-        gpuData.mutable_hardware_monitor()->mutable_gpu_utilization()->set_min_value(0);
+        gpuData->mutable_hardware_monitor()->mutable_gpu_utilization()->set_max_value(100);
+        gpuData->mutable_hardware_monitor()->mutable_gpu_utilization()->set_min_value(0);
 
-        gpuData.mutable_hardware_monitor()->mutable_memory_utilization()->set_max_value(100);
-        gpuData.mutable_hardware_monitor()->mutable_memory_utilization()->set_min_value(0);
+        gpuData->mutable_hardware_monitor()->mutable_memory_utilization()->set_max_value(100);
+        gpuData->mutable_hardware_monitor()->mutable_memory_utilization()->set_min_value(0);
 
         /*
          * Specific data
          */
-        gpuData.mutable_hardware_monitor()->mutable_temperature()->set_shutdown(m_shutdownTempThreshold);
-        gpuData.mutable_hardware_monitor()->mutable_temperature()->set_slowdown(m_slowdownTempThreshold);
+        gpuData->mutable_hardware_monitor()->mutable_temperature()->set_shutdown(m_shutdownTempThreshold);
+        gpuData->mutable_hardware_monitor()->mutable_temperature()->set_slowdown(m_slowdownTempThreshold);
 
 
-        gpuData.mutable_hardware_monitor()->mutable_power()->set_min_value(m_powerLimitMin);
-        gpuData.mutable_hardware_monitor()->mutable_power()->set_max_value(m_powerLimitMax);
+        gpuData->mutable_hardware_monitor()->mutable_power()->set_min_value(m_powerLimitMin);
+        gpuData->mutable_hardware_monitor()->mutable_power()->set_max_value(m_powerLimitMax);
 
 
-        gpuData.mutable_hardware_monitor()->mutable_pcie()->set_generation_max(m_pciGenerationMax);
-        gpuData.mutable_hardware_monitor()->mutable_pcie()->set_width_max(m_pciWidthMax);
+        gpuData->mutable_hardware_monitor()->mutable_pcie()->set_generation_max(m_pciGenerationMax);
+        gpuData->mutable_hardware_monitor()->mutable_pcie()->set_width_max(m_pciWidthMax);
 
 
-        gpuData.mutable_gpu_offset()->set_min(m_minGpuOffset);
-        gpuData.mutable_gpu_offset()->set_max(m_maxGpuOffset);
-        gpuData.mutable_memory_offset()->set_min(m_minMemOffset);
-        gpuData.mutable_memory_offset()->set_max(m_maxMemOffset);
+        gpuData->mutable_gpu_offset()->set_min(m_minGpuOffset);
+        gpuData->mutable_gpu_offset()->set_max(m_maxGpuOffset);
+        gpuData->mutable_memory_offset()->set_min(m_minMemOffset);
+        gpuData->mutable_memory_offset()->set_max(m_maxMemOffset);
+    }
+
+    /*
+     * Dynamic data
+     */
+    if(m_device != nullptr)
+    {
+        nvmlReturn_t result;
+        unsigned int graphicsClock, smClock, memClock;
+        int gpuOffset, memOffset;
+
+        // Throttle reasons, also without the events
+        updateThrottleReasons();
+        gpuData->set_throttle_reasons(m_throttleReasons);
 
+        // High rate samples since the last sample
+        drainSamples();
 
+        // Processes
+        m_processAccounting->sample(*m_nvml,m_device);
 
         // Get current clock speeds
-        result = nvmlDeviceGetClockInfo(m_device, NVML_CLOCK_GRAPHICS, &graphicsClock);
+        result = m_nvml->nvmlDeviceGetClockInfo(m_device, NVML_CLOCK_GRAPHICS, &graphicsClock);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_gpu_clock()->set_value(graphicsClock);
+            gpuData->mutable_hardware_monitor()->mutable_gpu_clock()->set_value(graphicsClock);
         }
 
-        result = nvmlDeviceGetClockInfo(m_device, NVML_CLOCK_SM, &smClock);
+        result = m_nvml->nvmlDeviceGetClockInfo(m_device, NVML_CLOCK_SM, &smClock);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_sm_clock()->set_value(smClock);
+            gpuData->mutable_hardware_monitor()->mutable_sm_clock()->set_value(smClock);
         }
 
-        result = nvmlDeviceGetClockInfo(m_device, NVML_CLOCK_MEM, &memClock);
+        result = m_nvml->nvmlDeviceGetClockInfo(m_device, NVML_CLOCK_MEM, &memClock);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_memory_clock()->set_value(memClock);
+            gpuData->mutable_hardware_monitor()->mutable_memory_clock()->set_value(memClock);
         }
 
 
         // Get utilization (GPU and memory)
         nvmlUtilization_t utilization;
-        result = nvmlDeviceGetUtilizationRates(m_device, &utilization);
+        result = m_nvml->nvmlDeviceGetUtilizationRates(m_device, &utilization);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_gpu_utilization()->set_value(utilization.gpu);
-            gpuData.mutable_hardware_monitor()->mutable_memory_utilization()->set_value(utilization.memory);
+            gpuData->mutable_hardware_monitor()->mutable_gpu_utilization()->set_value(utilization.gpu);
+            gpuData->mutable_hardware_monitor()->mutable_memory_utilization()->set_value(utilization.memory);
         }
 
         // Get temperature
         nvmlTemperature_t tempInfo;
         tempInfo.version = nvmlTemperature_v1;
         tempInfo.sensorType = NVML_TEMPERATURE_GPU;
-        result = nvmlDeviceGetTemperatureV(m_device, &tempInfo);
+        result = m_nvml->nvmlDeviceGetTemperatureV(m_device, &tempInfo);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_temperature()->set_value(tempInfo.temperature);
+            gpuData->mutable_hardware_monitor()->mutable_temperature()->set_value(tempInfo.temperature);
         }
 
         // Get memory info
         nvmlMemory_t memory;
-        result = nvmlDeviceGetMemoryInfo(m_device, &memory);
+        result = m_nvml->nvmlDeviceGetMemoryInfo(m_device, &memory);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_memory_use()->set_used(memory.used);
-            gpuData.mutable_hardware_monitor()->mutable_memory_use()->set_free(memory.free);
-            gpuData.mutable_hardware_monitor()->mutable_memory_use()->set_total(memory.total);
+            gpuData->mutable_hardware_monitor()->mutable_memory_use()->set_used(memory.used);
+            gpuData->mutable_hardware_monitor()->mutable_memory_use()->set_free(memory.free);
+            gpuData->mutable_hardware_monitor()->mutable_memory_use()->set_total(memory.total);
         }
 
         // Get current power draw
         unsigned int power_draw;
-        result = nvmlDeviceGetPowerUsage(m_device, &power_draw);
+        result = m_nvml->nvmlDeviceGetPowerUsage(m_device, &power_draw);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_power()->set_value(power_draw);
+            gpuData->mutable_hardware_monitor()->mutable_power()->set_value(power_draw);
         }
 
         // Get total energy consumption
         unsigned long long total_energy;
-        result = nvmlDeviceGetTotalEnergyConsumption(m_device, &total_energy);
+        result = m_nvml->nvmlDeviceGetTotalEnergyConsumption(m_device, &total_energy);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_power()->set_total(total_energy);
+            gpuData->mutable_hardware_monitor()->mutable_power()->set_total(total_energy);
         }
 
         unsigned int default_power_limit;
-        result = nvmlDeviceGetPowerManagementDefaultLimit(m_device, &default_power_limit);
+        result = m_nvml->nvmlDeviceGetPowerManagementDefaultLimit(m_device, &default_power_limit);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_power()->set_default_value(default_power_limit);
+            gpuData->mutable_hardware_monitor()->mutable_power()->set_default_value(default_power_limit);
         }
 
         // Get enforced power limit (actual limit being enforced)
         unsigned int enforced_power_limit;
-        result = nvmlDeviceGetEnforcedPowerLimit(m_device, &enforced_power_limit);
+        result = m_nvml->nvmlDeviceGetEnforcedPowerLimit(m_device, &enforced_power_limit);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_power()->set_enforced_value(enforced_power_limit);
+            gpuData->mutable_hardware_monitor()->mutable_power()->set_enforced_value(enforced_power_limit);
         }
 
         // Get PCIe info
         unsigned int curr_link_gen, curr_link_width;
-        result = nvmlDeviceGetCurrPcieLinkGeneration(m_device, &curr_link_gen);
+        result = m_nvml->nvmlDeviceGetCurrPcieLinkGeneration(m_device, &curr_link_gen);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_pcie()->set_generation(curr_link_gen);
+            gpuData->mutable_hardware_monitor()->mutable_pcie()->set_generation(curr_link_gen);
         }
 
-        result = nvmlDeviceGetCurrPcieLinkWidth(m_device, &curr_link_width);
+        result = m_nvml->nvmlDeviceGetCurrPcieLinkWidth(m_device, &curr_link_width);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_pcie()->set_width(curr_link_width);
+            gpuData->mutable_hardware_monitor()->mutable_pcie()->set_width(curr_link_width);
         }
 
         // Get PCIe throughput
         unsigned int tx_throughput, rx_throughput;
-        result = nvmlDeviceGetPcieThroughput(m_device, NVML_PCIE_UTIL_TX_BYTES, &tx_throughput);
+        result = m_nvml->nvmlDeviceGetPcieThroughput(m_device, NVML_PCIE_UTIL_TX_BYTES, &tx_throughput);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_pcie()->set_tx_bytes(tx_throughput);
+            gpuData->mutable_hardware_monitor()->mutable_pcie()->set_tx_bytes(tx_throughput);
         }
 
-        result = nvmlDeviceGetPcieThroughput(m_device, NVML_PCIE_UTIL_RX_BYTES, &rx_throughput);
+        result = m_nvml->nvmlDeviceGetPcieThroughput(m_device, NVML_PCIE_UTIL_RX_BYTES, &rx_throughput);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_hardware_monitor()->mutable_pcie()->set_rx_bytes(rx_throughput);
+            gpuData->mutable_hardware_monitor()->mutable_pcie()->set_rx_bytes(rx_throughput);
         }
 
         // Get GPU clock offset
-        result = nvmlDeviceGetGpcClkVfOffset(m_device, &gpuOffset);
+        result = m_nvml->nvmlDeviceGetGpcClkVfOffset(m_device, &gpuOffset);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_gpu_offset()->set_value(gpuOffset);
+            m_gpuOffset = gpuOffset;
         }
 
         // Get Memory clock offset
-        result = nvmlDeviceGetMemClkVfOffset(m_device, &memOffset);
+        result = m_nvml->nvmlDeviceGetMemClkVfOffset(m_device, &memOffset);
         if (NVML_SUCCESS == result) {
-            gpuData.mutable_memory_offset()->set_value(memOffset);
+            m_memOffset = memOffset;
         }
     }
-    else
+
+    /*
+     * Last known offsets also for a suspended GPU, the settings are saved from them
+     */
+    if(m_staticData)
     {
-        LOG_T("No NVIDIA GPU detected, skipping data collection.");
+        gpuData->mutable_gpu_offset()->set_value(m_gpuOffset);
+        gpuData->mutable_memory_offset()->set_value(m_memOffset);
+    }
+
+    /*
+     * Open NVML keeps the GPU awake, it is released when the GPU idles and opened again after the GPU
+     * was suspended or after the hold time (another client keeps the GPU awake)
+     */
+    if(m_device != nullptr)
+    {
+        m_idleSamples = gpuData->hardware_monitor().gpu_utilization().value() == 0 ? m_idleSamples + 1 : 0;
+
+        if(m_idleSamples >= RELEASE_IDLE_SAMPLES)
+        {
+            LOG_T("NVIDIA GPU idle, NVML released");
+
+            closeNvml();
+            m_idleSamples = 0;
+            m_holdUntil   = std::chrono::steady_clock::now() + std::chrono::milliseconds(RELEASE_HOLD);
+        }
     }
 
+    return gpuData;
+}
+
+void DataProviderNvidiaNvml::samplerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    LOG_T("NVML sampler started");
+
+    while (!m_samplerStop) {
+        if(idle())
+        {
+            /*
+             * Nobody asks, NVML is released so the GPU can suspend
+             */
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> nvmlLock(m_nvmlMutex);
+
+                closeNvml();
+            }
+            lock.lock();
+
+            m_wakeUp.wait(lock,[this](){ return m_samplerStop || !idle(); });
+            continue;
+        }
+
+        const quint64 generation = m_generation;
+
+        lock.unlock();
+        auto snapshot = sample();
+        lock.lock();
+
+        /*
+         * SET during the sample published newer offsets, the sample is taken again
+         */
+        if(generation != m_generation)
+        {
+            continue;
+        }
+
+        m_snapshot = std::move(snapshot);
+
+        /*
+         * Events are waited for between the samples, without the event set the sampler just sleeps
+         */
+        const auto nextSample = std::chrono::steady_clock::now() + std::chrono::milliseconds(SAMPLE_PERIOD);
+
+        while (!m_samplerStop && std::chrono::steady_clock::now() < nextSample) {
+            lock.unlock();
+            const bool waited = waitForEvent();
+            lock.lock();
+
+            if(!waited)
+            {
+                m_wakeUp.wait_until(lock,nextSample,[this](){ return m_samplerStop; });
+            }
+        }
+    }
+
+    LOG_T("NVML sampler stopped");
+}
+
+void DataProviderNvidiaNvml::startSampler()
+{
+    stopSampler();
 
-    byteArray.resize(gpuData.ByteSizeLong());
-    if(!gpuData.SerializeToArray(byteArray.data(),byteArray.size()))
     {
-        THROW_EXCEPTION(exception_T,ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_samplerStop = false;
+        m_lastRequest = std::chrono::steady_clock::now();
     }
 
-    return byteArray;
+    /*
+     * First snapshot synchronously, the settings are applied right after init
+     */
+    auto snapshot = sample();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_snapshot = std::move(snapshot);
+    }
+
+    m_sampler = std::thread(&DataProviderNvidiaNvml::samplerLoop,this);
+}
+
+void DataProviderNvidiaNvml::stopSampler()
+{
+    if(!m_sampler.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_samplerStop = true;
+    }
+
+    m_wakeUp.notify_one();
+    m_sampler.join();
+
+    m_snapshot.reset();
+}
+
+void DataProviderNvidiaNvml::requestSamples() const
+{
+    bool wakeUp;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        wakeUp        = idle();
+        m_lastRequest = std::chrono::steady_clock::now();
+    }
+
+    if(wakeUp)
+    {
+        m_wakeUp.notify_one();
+    }
+}
+
+std::shared_ptr<const legion::messages::NvidiaNvml> DataProviderNvidiaNvml::snapshot() const
+{
+    requestSamples();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_snapshot;
+}
+
+const NvmlProcessAccounting &DataProviderNvidiaNvml::processAccounting() const
+{
+    return *m_processAccounting;
+}
+
+bool DataProviderNvidiaNvml::idle() const
+{
+    return std::chrono::steady_clock::now() - m_lastRequest > std::chrono::milliseconds(IDLE_TIMEOUT);
 }
 
+
 QByteArray DataProviderNvidiaNvml::deserializeAndSetData(const QByteArray &data)
 {
     legion::messages::NvidiaNvml       nvmlData;
@@ -219,15 +536,31 @@ QByteArray DataProviderNvidiaNvml::deserializeAndSetData(const QByteArray &data)
         THROW_EXCEPTION(exception_T,DataProvider::DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
     }
 
-    /*
-      * Apply GPU offset
-      */
-    if(m_device == nullptr)
+    if(nvmlData.has_clear_events() && nvmlData.clear_events())
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_events.clear();
+    }
+
+    std::lock_guard<std::mutex> nvmlLock(m_nvmlMutex);
+
+    if(m_gpuPath.empty() || m_nvmlUnavailable)
     {
         LOG_W("No NVIDIA GPU device available to set data.");
         return {};
     }
 
+    /*
+     * Explicit SET may wake the GPU up
+     */
+    openNvml();
+    m_idleSamples = 0;
+
+    /*
+      * Apply GPU offset
+      */
+
     if(nvmlData.has_gpu_offset())
     {
         nvmlReturn_t result;
@@ -237,9 +570,9 @@ QByteArray DataProviderNvidiaNvml::deserializeAndSetData(const QByteArray &data)
         gpuClkOffset.pstate = NVML_PSTATE_0;
         gpuClkOffset.clockOffsetMHz = nvmlData.gpu_offset().value();
 
-        result = nvmlDeviceSetClockOffsets(m_device, &gpuClkOffset);
+        result = m_nvml->nvmlDeviceSetClockOffsets(m_device, &gpuClkOffset);
         if (NVML_SUCCESS != result) {
-            LOG_D(QString("Failed to set GPU clock offset: %1").arg(nvmlErrorString(result)));
+            LOG_D(QString("Failed to set GPU clock offset: %1").arg(m_nvml->nvmlErrorString(result)));
         }
     }
 
@@ -255,148 +588,497 @@ QByteArray DataProviderNvidiaNvml::deserializeAndSetData(const QByteArray &data)
         memClkOffset.pstate = NVML_PSTATE_0;
         memClkOffset.clockOffsetMHz = nvmlData.memory_offset().value();
 
-        result = nvmlDeviceSetClockOffsets(m_device, &memClkOffset);
+        result = m_nvml->nvmlDeviceSetClockOffsets(m_device, &memClkOffset);
         if (NVML_SUCCESS != result) {
-            LOG_D(QString("Failed to set Memory clock offset: %1").arg(nvmlErrorString(result)));
+            LOG_D(QString("Failed to set Memory clock offset: %1").arg(m_nvml->nvmlErrorString(result)));
         }
     }
 
+    /*
+     * Applied offsets published at once, the client reads them back right after SET
+     */
+    if(nvmlData.has_gpu_offset() || nvmlData.has_memory_offset())
+    {
+        int gpuOffset, memOffset;
+
+        if(m_nvml->nvmlDeviceGetGpcClkVfOffset(m_device, &gpuOffset) == NVML_SUCCESS)
+        {
+            m_gpuOffset = gpuOffset;
+        }
+
+        if(m_nvml->nvmlDeviceGetMemClkVfOffset(m_device, &memOffset) == NVML_SUCCESS)
+        {
+            m_memOffset = memOffset;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if(m_snapshot != nullptr)
+        {
+            auto snapshot = std::make_shared<legion::messages::NvidiaNvml>(*m_snapshot);
+
+            snapshot->mutable_gpu_offset()->set_value(m_gpuOffset);
+            snapshot->mutable_memory_offset()->set_value(m_memOffset);
+
+            m_snapshot = std::move(snapshot);
+        }
+
+        ++m_generation;
+    }
+
     return {};
 }
 
 void DataProviderNvidiaNvml::init()
 {
-    try {
-        nvmlReturn_t result;
-        unsigned int device_count, i;
+    LOG_T(__PRETTY_FUNCTION__);
+
+    m_gpuPath = findGpu(m_pciDevicesPath);
+
+    if(m_gpuPath.empty())
+    {
+        LOG_D("No NVIDIA GPU found on PCI bus, NVML is not used");
+        return;
+    }
+
+    LOG_D(QString("NVIDIA GPU found: ") + m_gpuPath.c_str());
+
+    startSampler();
+}
+
+void DataProviderNvidiaNvml::openNvml()
+{
+    nvmlReturn_t result;
+    unsigned int device_count, i;
+
+    if(m_device != nullptr)
+    {
+        return;
+    }
+
+    m_nvml->load();
+
+    // Initialize NVML library
+    result = m_nvml->nvmlInit();
+    if (NVML_SUCCESS != result) {
+        THROW_EXCEPTION(exception_T,ERROR_NVML_INIT_FAILED, "NVML initialization failed");
+    }
+
+    // Get number of GPU devices
+    result = m_nvml->nvmlDeviceGetCount(&device_count);
+    if (NVML_SUCCESS != result) {
+        m_nvml->nvmlShutdown();
+        THROW_EXCEPTION(exception_T,ERROR_NVML_DEVICE_COUNT_FAILED, "Failed to get NVML device count");
+    }
+
+
+    if(device_count == 0){
+        m_nvml->nvmlShutdown();
+        THROW_EXCEPTION(exception_T,ERROR_NVML_DEVICE_COUNT_FAILED, "Unusual NVML device count");
+    }
 
+    LOG_D(QString("NVIDIA NVML initialized with %1 device(s)").arg(device_count));
 
-        // Initialize NVML library
-        result = nvmlInit();
+    for (i = 0; i < device_count; i++) {
+        char name[NVML_DEVICE_NAME_BUFFER_SIZE];
+
+        // Get device handle
+        result = m_nvml->nvmlDeviceGetHandleByIndex(i, &m_device);
         if (NVML_SUCCESS != result) {
-            THROW_EXCEPTION(exception_T,ERROR_NVML_INIT_FAILED, "NVML initialization failed");
+            m_device = nullptr;
+            LOG_W(QString("Failed to get handle for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+            continue;
         }
 
-        // Get number of GPU devices
-        result = nvmlDeviceGetCount(&device_count);
+        // Get device name
+        result = m_nvml->nvmlDeviceGetName(m_device, name, NVML_DEVICE_NAME_BUFFER_SIZE);
         if (NVML_SUCCESS != result) {
-            nvmlShutdown();
-            THROW_EXCEPTION(exception_T,ERROR_NVML_DEVICE_COUNT_FAILED, "Failed to get NVML device count");
+            m_device = nullptr;
+            LOG_W(QString("Failed to get name for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+            continue;
+        }
+
+        // Static data are queried once, the GPU may be suspended at the next open
+        if(!m_staticData)
+        {
+                // Get max clocks
+                result = m_nvml->nvmlDeviceGetMaxClockInfo(m_device, NVML_CLOCK_GRAPHICS, &m_maxGraphicsClock);
+                if (NVML_SUCCESS != result) {
+                    LOG_W(QString("Failed to get max graphics clock for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+                }
+
+                result = m_nvml->nvmlDeviceGetMaxClockInfo(m_device, NVML_CLOCK_SM, &m_maxSmClock);
+                if (NVML_SUCCESS != result) {
+                    LOG_W(QString("Failed to get max SM clock for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+                }
+
+                result = m_nvml->nvmlDeviceGetMaxClockInfo(m_device, NVML_CLOCK_MEM, &m_maxMemClock);
+                if (NVML_SUCCESS != result) {
+                    LOG_W(QString("Failed to get max memory clock for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+                }
+
+                // Get temperature thresholds
+                result = m_nvml->nvmlDeviceGetTemperatureThreshold(m_device, NVML_TEMPERATURE_THRESHOLD_SHUTDOWN, &m_shutdownTempThreshold);
+                if (NVML_SUCCESS != result) {
+                    LOG_W(QString("Failed to get shutdown temperature for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+                }
+                result = m_nvml->nvmlDeviceGetTemperatureThreshold(m_device, NVML_TEMPERATURE_THRESHOLD_SLOWDOWN, &m_slowdownTempThreshold);
+                if (NVML_SUCCESS != result) {
+                    LOG_W(QString("Failed to get slowdown temperature for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+                }
+
+                result = m_nvml->nvmlDeviceGetPowerManagementLimitConstraints(m_device, &m_powerLimitMin, &m_powerLimitMax);
+                if (NVML_SUCCESS != result) {
+                    LOG_W(QString("Failed to get power limit constraints for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+                }
+
+                result = m_nvml->nvmlDeviceGetMaxPcieLinkGeneration(m_device, &m_pciGenerationMax);
+                if (NVML_SUCCESS != result){
+                    LOG_W(QString("Failed to get PCIe generation max for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+                }
+
+                result = m_nvml->nvmlDeviceGetMaxPcieLinkWidth(m_device, &m_pciWidthMax);
+                if (NVML_SUCCESS != result) {
+                    LOG_W(QString("Failed to get PCIe width max for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+                }
+
+                // Get GPU clock offset
+                result = m_nvml->nvmlDeviceGetGpcClkMinMaxVfOffset(m_device, &m_minGpuOffset, &m_maxGpuOffset);
+                if (NVML_SUCCESS != result) {
+                    LOG_W(QString("Failed to get GPU clock offset for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+                }
+
+                // Get Memory clock offset
+                result = m_nvml->nvmlDeviceGetMemClkMinMaxVfOffset(m_device, &m_minMemOffset, &m_maxMemOffset);
+                if (NVML_SUCCESS != result) {
+                    LOG_W(QString("Failed to get Memory clock offset for device %1: %2").arg(i).arg(m_nvml->nvmlErrorString(result)));
+                }
+
+            m_staticData = true;
+        }
+
+        m_GPUName = QString(name);
+        break;
+    }
+
+    if(m_device == nullptr)
+    {
+        m_nvml->nvmlShutdown();
+        THROW_EXCEPTION(exception_T,ERROR_NVML_DEVICE_COUNT_FAILED, "No NVIDIA GPU found");
+    }
+
+    registerEvents();
+}
+
+void DataProviderNvidiaNvml::closeNvml()
+{
+    if(m_device != nullptr)
+    {
+        if(m_eventSet != nullptr)
+        {
+            m_nvml->nvmlEventSetFree(m_eventSet);
+            m_eventSet = nullptr;
         }
 
+        m_processAccounting->clear();
 
-        if(device_count == 0){
-            nvmlShutdown();
-            THROW_EXCEPTION(exception_T,ERROR_NVML_DEVICE_COUNT_FAILED, "Unusual NVML device count");
+        if(m_nvml->nvmlShutdown() != NVML_SUCCESS){
+            LOG_W("NVML shutdown failed");
+        }
+        else {
+            LOG_T("NVML shutdown successful");
         }
 
-        LOG_D(QString("NVIDIA NVML initialized with %1 device(s)").arg(device_count));
+        m_device = nullptr;
+    }
+}
 
-        for (i = 0; i < device_count; i++) {
-            char name[NVML_DEVICE_NAME_BUFFER_SIZE];
+bool DataProviderNvidiaNvml::gpuActive() const
+{
+    QFile file(QString::fromStdString((m_gpuPath / "power" / "runtime_status").string()));
 
-            // Get device handle
-            result = nvmlDeviceGetHandleByIndex(i, &m_device);
-            if (NVML_SUCCESS != result) {
-                m_device = nullptr;
-                LOG_W(QString("Failed to get handle for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-                continue;
-            }
+    /*
+     * Without runtime PM the GPU is always on
+     */
+    if(!file.open(QIODeviceBase::ReadOnly))
+    {
+        return true;
+    }
 
-            // Get device name
-            result = nvmlDeviceGetName(m_device, name, NVML_DEVICE_NAME_BUFFER_SIZE);
-            if (NVML_SUCCESS != result) {
-                m_device = nullptr;
-                LOG_W(QString("Failed to get name for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-                continue;
-            }
+    const QByteArray status = file.readAll().trimmed();
 
-            // Get max clocks
-            result = nvmlDeviceGetMaxClockInfo(m_device, NVML_CLOCK_GRAPHICS, &m_maxGraphicsClock);
-            if (NVML_SUCCESS != result) {
-                LOG_W(QString("Failed to get max graphics clock for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-            }
+    return status != "suspended" && status != "suspending";
+}
 
-            result = nvmlDeviceGetMaxClockInfo(m_device, NVML_CLOCK_SM, &m_maxSmClock);
-            if (NVML_SUCCESS != result) {
-                LOG_W(QString("Failed to get max SM clock for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-            }
+void DataProviderNvidiaNvml::registerEvents()
+{
+    nvmlReturn_t       result;
+    unsigned long long supportedTypes = 0;
 
-            result = nvmlDeviceGetMaxClockInfo(m_device, NVML_CLOCK_MEM, &m_maxMemClock);
-            if (NVML_SUCCESS != result) {
-                LOG_W(QString("Failed to get max memory clock for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-            }
+    if(!m_nvml->hasEvents())
+    {
+        LOG_D("NVML events not available in the driver, throttle reasons are only sampled");
+        return;
+    }
 
-            // Get temperature thresholds
-            result = nvmlDeviceGetTemperatureThreshold(m_device, NVML_TEMPERATURE_THRESHOLD_SHUTDOWN, &m_shutdownTempThreshold);
-            if (NVML_SUCCESS != result) {
-                LOG_W(QString("Failed to get shutdown temperature for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-            }
-            result = nvmlDeviceGetTemperatureThreshold(m_device, NVML_TEMPERATURE_THRESHOLD_SLOWDOWN, &m_slowdownTempThreshold);
-            if (NVML_SUCCESS != result) {
-                LOG_W(QString("Failed to get slowdown temperature for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-            }
+    result = m_nvml->nvmlDeviceGetSupportedEventTypes(m_device, &supportedTypes);
+    if (NVML_SUCCESS != result) {
+        LOG_D(QString("Failed to get supported NVML events: %1").arg(m_nvml->nvmlErrorString(result)));
+        return;
+    }
 
-            result = nvmlDeviceGetPowerManagementLimitConstraints(m_device, &m_powerLimitMin, &m_powerLimitMax);
-            if (NVML_SUCCESS != result) {
-                LOG_W(QString("Failed to get power limit constraints for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-            }
+    const unsigned long long eventTypes = supportedTypes & (nvmlEventTypeClock | nvmlEventTypeXidCriticalError);
 
-            result = nvmlDeviceGetMaxPcieLinkGeneration(m_device, &m_pciGenerationMax);
-            if (NVML_SUCCESS != result){
-                LOG_W(QString("Failed to get PCIe generation max for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-            }
+    if(eventTypes == 0)
+    {
+        LOG_D("NVML clock and XID events not supported, throttle reasons are only sampled");
+        return;
+    }
 
-            result = nvmlDeviceGetMaxPcieLinkWidth(m_device, &m_pciWidthMax);
-            if (NVML_SUCCESS != result) {
-                LOG_W(QString("Failed to get PCIe width max for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-            }
+    result = m_nvml->nvmlEventSetCreate(&m_eventSet);
+    if (NVML_SUCCESS != result) {
+        m_eventSet = nullptr;
+        LOG_D(QString("Failed to create NVML event set: %1").arg(m_nvml->nvmlErrorString(result)));
+        return;
+    }
 
-            // Get GPU clock offset
-            result = nvmlDeviceGetGpcClkMinMaxVfOffset(m_device, &m_minGpuOffset, &m_maxGpuOffset);
-            if (NVML_SUCCESS != result) {
-                LOG_W(QString("Failed to get GPU clock offset for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-            }
+    result = m_nvml->nvmlDeviceRegisterEvents(m_device, eventTypes, m_eventSet);
+    if (NVML_SUCCESS != result) {
+        m_nvml->nvmlEventSetFree(m_eventSet);
+        m_eventSet = nullptr;
+        LOG_D(QString("Failed to register NVML events: %1").arg(m_nvml->nvmlErrorString(result)));
+        return;
+    }
 
-            // Get Memory clock offset
-            result = nvmlDeviceGetMemClkMinMaxVfOffset(m_device, &m_minMemOffset, &m_maxMemOffset);
-            if (NVML_SUCCESS != result) {
-                LOG_W(QString("Failed to get Memory clock offset for device %1: %2").arg(i).arg(nvmlErrorString(result)));
-            }
+    LOGF_T("NVML events registered, types={:#x}",eventTypes);
+}
 
-            m_GPUName = QString(name);
-            break;
-        }
+bool DataProviderNvidiaNvml::waitForEvent()
+{
+    nvmlEventData_t                 data {};
+    nvmlEventSet_t                  eventSet;
+    decltype(&::nvmlEventSetWait)   eventSetWait;
+
+    {
+        std::lock_guard<std::mutex> lock(m_nvmlMutex);
+
+        eventSet     = m_eventSet;
+        eventSetWait = m_nvml->nvmlEventSetWait;
+    }
+
+    if(eventSet == nullptr)
+    {
+        return false;
+    }
 
-        if(m_device == nullptr)
+    /*
+     * Waited without the NVML mutex, a SET on the main thread does not wait for the timeout. The event set
+     * is freed only by the sampler thread (closeNvml) and the library unloaded after the sampler stopped,
+     * both outlive the wait
+     */
+    const nvmlReturn_t result = eventSetWait(eventSet, &data, EVENT_WAIT);
+
+    if(result == NVML_ERROR_TIMEOUT)
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_nvmlMutex);
+
+    if(result != NVML_SUCCESS)
+    {
+        LOG_D(QString("NVML event wait failed: %1").arg(m_nvml->nvmlErrorString(result)));
+        return false;
+    }
+
+    if(data.eventType & nvmlEventTypeXidCriticalError)
+    {
+        unsigned int graphicsClock = 0;
+
+        m_nvml->nvmlDeviceGetClockInfo(m_device, NVML_CLOCK_GRAPHICS, &graphicsClock);
+
+        LOG_W(QString("NVIDIA GPU XID error %1").arg(data.eventData));
+
+        addEvent(Event{
+            .m_type             = XID_ERROR,
+            .m_timestamp        = QDateTime::currentMSecsSinceEpoch(),
+            .m_throttleReasons  = m_throttleReasons,
+            .m_xid              = static_cast<quint32>(data.eventData),
+            .m_gpuClock         = graphicsClock
+        });
+    }
+
+    if(data.eventType & nvmlEventTypeClock)
+    {
         {
-            THROW_EXCEPTION(exception_T,ERROR_NVML_DEVICE_COUNT_FAILED, "No NVIDIA GPU found");
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            ++m_clockChanges;
         }
 
-    } catch(exception_T& ex)
+        updateThrottleReasons();
+    }
+
+    return true;
+}
+
+void DataProviderNvidiaNvml::updateThrottleReasons()
+{
+    unsigned long long reasons       = 0;
+    unsigned int       graphicsClock = 0;
+
+    if(m_nvml->nvmlDeviceGetCurrentClocksEventReasons == nullptr || m_nvml->nvmlDeviceGetCurrentClocksEventReasons(m_device, &reasons) != NVML_SUCCESS)
+    {
+        return;
+    }
+
+    reasons &= THROTTLE_REASONS;
+
+    if(reasons == m_throttleReasons)
     {
-        cleanUp();
-        LOG_W(QString("DataProviderNvidiaNvml initialization failed: %1").arg(ex.what()));
+        return;
     }
+
+    m_throttleReasons = reasons;
+
+    m_nvml->nvmlDeviceGetClockInfo(m_device, NVML_CLOCK_GRAPHICS, &graphicsClock);
+
+    LOGF_D("NVIDIA GPU throttle reasons changed, reasons={:#x}, clock={} MHz",reasons,graphicsClock);
+
+    addEvent(Event{
+        .m_type             = THROTTLE_REASONS_CHANGED,
+        .m_timestamp        = QDateTime::currentMSecsSinceEpoch(),
+        .m_throttleReasons  = reasons,
+        .m_xid              = 0,
+        .m_gpuClock         = graphicsClock
+    });
 }
 
-void DataProviderNvidiaNvml::clean()
+void DataProviderNvidiaNvml::drainSamples()
 {
-    cleanUp();
+    for(size_t type = 0; type < SAMPLE_TYPE_COUNT; ++type)
+    {
+        nvmlValueType_t valueType;
+        unsigned int    count = 0;
+        nvmlReturn_t    result;
+
+        /*
+         * Size of the NVML buffer, the samples are returned only into a buffer of this size
+         */
+        result = m_nvml->nvmlDeviceGetSamples(m_device, SAMPLING_TYPES[type], m_lastSampleTimestamp[type], &valueType, &count, nullptr);
+        if (NVML_SUCCESS != result || count == 0) {
+            continue;
+        }
+
+        if(m_sampleBuffer.size() < count)
+        {
+            m_sampleBuffer.resize(count);
+        }
+
+        result = m_nvml->nvmlDeviceGetSamples(m_device, SAMPLING_TYPES[type], m_lastSampleTimestamp[type], &valueType, &count, m_sampleBuffer.data());
+        if (NVML_ERROR_NOT_FOUND == result) {
+            continue;
+        }
+
+        if (NVML_SUCCESS != result) {
+            LOG_T(QString("Failed to get NVML samples of type %1: %2").arg(type).arg(m_nvml->nvmlErrorString(result)));
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto&                    series   = m_samples[type];
+        const unsigned long long lastSeen = m_lastSampleTimestamp[type];
+
+        for(unsigned int i = 0; i < count; ++i)
+        {
+            const nvmlSample_t& sample = m_sampleBuffer[i];
+
+            /*
+             * Buffer is a ring, only the samples newer than the last seen one are taken
+             */
+            if(sample.timeStamp <= lastSeen)
+            {
+                continue;
+            }
+
+            series.push_back(Sample{
+                .m_timestamp    = sample.timeStamp,
+                .m_value        = sampleValue(valueType,sample.sampleValue)
+            });
+
+            m_lastSampleTimestamp[type] = std::max(m_lastSampleTimestamp[type],sample.timeStamp);
+        }
+
+        while (series.size() > SAMPLE_SERIES_CAPACITY) {
+            series.pop_front();
+        }
+    }
 }
 
-void DataProviderNvidiaNvml::cleanUp()
+void DataProviderNvidiaNvml::addEvent(const Event &event)
 {
-    if(m_device != nullptr)
     {
-        if(nvmlShutdown() != NVML_SUCCESS){
-            LOG_W("NVML shutdown failed");
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_events.push_back(event);
+
+        if(m_events.size() > EVENT_LOG_CAPACITY)
+        {
+            m_events.pop_front();
         }
-        else {
-            m_device = nullptr;
-            LOG_T("NVML shutdown successful");
+    }
+
+    /*
+     * Events are emitted from the thread of the provider, the notifier lives there
+     */
+    QMetaObject::invokeMethod(this,[this,event]() {
+        emit dataProviderEvent(DataProviderEvent{
+            .m_dataType     = dataType,
+            .m_eventType    = QString::number(event.m_type),
+            .m_eventValue   = QString::number(event.m_type == XID_ERROR ? event.m_xid : event.m_throttleReasons)
+        });
+    },Qt::QueuedConnection);
+}
+
+std::filesystem::path DataProviderNvidiaNvml::findGpu(const std::filesystem::path &pciDevicesPath)
+{
+    std::error_code ec;
+
+    for (const auto& entry : std::filesystem::directory_iterator(pciDevicesPath,ec)) {
+        QFile vendor(QString::fromStdString((entry.path() / "vendor").string()));
+        QFile pciClass(QString::fromStdString((entry.path() / "class").string()));
+
+        if(!vendor.open(QIODeviceBase::ReadOnly) || !pciClass.open(QIODeviceBase::ReadOnly))
+        {
+            continue;
+        }
+
+        /*
+         * NVIDIA display controller (VGA or 3D)
+         */
+        if(vendor.readAll().trimmed() == NVIDIA_VENDOR_ID && pciClass.readAll().trimmed().startsWith("0x03"))
+        {
+            return entry.path();
         }
     }
+
+    return {};
+}
+
+void DataProviderNvidiaNvml::clean()
+{
+    cleanUp();
+}
+
+void DataProviderNvidiaNvml::cleanUp()
+{
+    stopSampler();
+
+    std::lock_guard<std::mutex> lock(m_nvmlMutex);
+
+    closeNvml();
+    m_nvml->unload();
 }
 
 }
@@ -11,8 +11,43 @@
 #include <Core/ExceptionBuilder.h>
 
 #include <nvml.h>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace legion::messages {
+class NvidiaNvml;
+}
+
 namespace  LenovoLegionDaemon {
 
+class NvmlLibrary;
+class NvmlProcessAccounting;
+
+/*
+ * Dynamic data are sampled by a worker thread into an immutable snapshot, GET returns the last snapshot
+ * so the NVML calls (PCIe throughput alone samples ~20 ms) never block the main thread. The sampler runs
+ * only while clients ask for the data.
+ *
+ * The runtime PM status of the GPU is read from sysfs before every sample, a suspended GPU is reported
+ * without touching NVML. NVML is loaded with dlopen once the GPU is active and released when the GPU
+ * idles, an open NVML would keep the GPU out of D3cold.
+ *
+ * While NVML is open the sampler waits for the clock change and XID events between the samples, the
+ * throttle reasons are read on every clock change, so short throttle episodes between two samples are
+ * not missed. Changes of the reasons and XID errors are kept in the event log and sent as notifications.
+ *
+ * NVML keeps its own high rate sample buffers (utilization, power, clocks), the sampler drains the samples
+ * newer than the last seen timestamp on every sample, so the series have the NVML resolution without
+ * polling faster.
+ */
 class DataProviderNvidiaNvml : public DataProvider
 {
     Q_OBJECT
@@ -26,9 +61,44 @@ public:
         ERROR_NVML_DEVICE_COUNT_FAILED    = 2
     };
 
+    /*
+     * Same values as legion::messages::NvidiaNvml::Event::Type
+     */
+    enum EventType : int {
+        THROTTLE_REASONS_CHANGED    = 0,
+        XID_ERROR                   = 1
+    };
+
+    /*
+     * Same values as legion::messages::NvidiaNvml::SampleSeries::Type
+     */
+    enum SampleType : quint8 {
+        SAMPLES_GPU_UTILIZATION     = 0,
+        SAMPLES_MEMORY_UTILIZATION  = 1,
+        SAMPLES_POWER               = 2,
+        SAMPLES_GPU_CLOCK           = 3,
+        SAMPLES_MEMORY_CLOCK        = 4,
+        SAMPLE_TYPE_COUNT           = 5
+    };
+
+private:
+
+    struct Sample {
+        quint64     m_timestamp;        // us
+        double      m_value;
+    };
+
+    struct Event {
+        EventType   m_type;
+        qint64      m_timestamp;
+        quint64     m_throttleReasons;
+        quint32     m_xid;
+        quint32     m_gpuClock;
+    };
+
 public:
 
-    DataProviderNvidiaNvml(QObject* parent);
+    DataProviderNvidiaNvml(QObject* parent,const std::filesystem::path& pciDevicesPath = "/sys/bus/pci/devices");
     virtual ~DataProviderNvidiaNvml() override;
 
     virtual QByteArray serializeAndGetData()                      const override;
@@ -38,10 +108,63 @@ public:
     virtual void init() override;
     virtual void clean() override;
 
+    /*
+     * Keeps the sampler running, for the providers fed by the sampler
+     */
+    void requestSamples() const;
+
+    /*
+     * Last snapshot without the event log and the sample series, nullptr without the GPU.
+     * For the providers reading a few values on their own period, it does not serialize anything
+     */
+    std::shared_ptr<const legion::messages::NvidiaNvml> snapshot() const;
+
+    const NvmlProcessAccounting& processAccounting() const;
+
 private:
 
     void cleanUp();
 
+    /*
+     * NVML initialized and the device handle found, static data are queried on the first open
+     */
+    void openNvml();
+    void closeNvml();
+
+    bool gpuActive() const;
+
+    /*
+     * Event set registered for the clock change and XID events, if the GPU supports them
+     */
+    void registerEvents();
+
+    /*
+     * Waits for one event at most EVENT_WAIT ms, false without the event set. Sampler thread only,
+     * the NVML mutex is taken just to read the event set and to handle the event
+     */
+    bool waitForEvent();
+
+    void updateThrottleReasons();
+
+    /*
+     * Samples newer than the last seen ones moved from the NVML buffers to the series
+     */
+    void drainSamples();
+    void addEvent(const Event& event);
+
+    static std::filesystem::path findGpu(const std::filesystem::path& pciDevicesPath);
+
+    /*
+     * Dynamic data plus the static ones, NVML is opened or released by the runtime PM status
+     */
+    std::shared_ptr<const legion::messages::NvidiaNvml> sample();
+
+    void samplerLoop();
+    void startSampler();
+    void stopSampler();
+
+    bool idle() const;
+
     /*
      * *************Static data*********************
      */
@@ -64,10 +187,66 @@ private:
      */
 
 
-    nvmlDevice_t m_device;  
+    nvmlDevice_t m_device;
+
+    /*
+     * NVML state, guarded by the NVML mutex
+     */
+    std::mutex                                          m_nvmlMutex;
+    std::unique_ptr<NvmlLibrary>                        m_nvml;
+    const std::filesystem::path                         m_pciDevicesPath;
+    std::filesystem::path                               m_gpuPath;
+    bool                                                m_staticData;
+    bool                                                m_nvmlUnavailable;
+    qint32                                              m_gpuOffset;
+    qint32                                              m_memOffset;
+    quint32                                             m_idleSamples;
+    std::chrono::steady_clock::time_point               m_holdUntil;
+    nvmlEventSet_t                                      m_eventSet;
+    quint64                                             m_throttleReasons;
+    std::array<unsigned long long,SAMPLE_TYPE_COUNT>    m_lastSampleTimestamp;
+    std::vector<nvmlSample_t>                           m_sampleBuffer;
+    std::unique_ptr<NvmlProcessAccounting>              m_processAccounting;
+
+    /*
+     * Sampler, the members below are guarded by the mutex
+     */
+    std::thread                                         m_sampler;
+    mutable std::mutex                                  m_mutex;
+    mutable std::condition_variable                     m_wakeUp;
+    bool                                                m_samplerStop;
+    quint64                                             m_generation;       // incremented by SET
+    std::shared_ptr<const legion::messages::NvidiaNvml> m_snapshot;
+    mutable std::chrono::steady_clock::time_point       m_lastRequest;
+    std::deque<Event>                                   m_events;
+    quint64                                             m_clockChanges;
+    std::array<std::deque<Sample>,SAMPLE_TYPE_COUNT>    m_samples;
+
 public:
 
     static constexpr quint8  dataType = 13;
+
+    static constexpr int     SAMPLE_PERIOD  = 1000;     // ms
+    static constexpr int     IDLE_TIMEOUT   = 10000;    // ms, sampler stops without GET
+
+    static constexpr quint32 RELEASE_IDLE_SAMPLES   = 10;       // samples with 0 % utilization
+    static constexpr int     RELEASE_HOLD           = 30000;    // ms
+
+    static constexpr int     EVENT_WAIT             = 100;      // ms, waited without the NVML mutex
+    static constexpr size_t  EVENT_LOG_CAPACITY     = 256;
+
+    static constexpr size_t  SAMPLE_SERIES_CAPACITY = 512;      // per series
+
+    /*
+     * Reasons which lower the clocks below the requested ones, idle and application clocks are not throttling
+     */
+    static constexpr quint64 THROTTLE_REASONS       = nvmlClocksEventReasonSwPowerCap           |
+                                                      nvmlClocksEventReasonHwSlowdown           |
+                                                      nvmlClocksEventReasonSwThermalSlowdown    |
+                                                      nvmlClocksEventReasonHwThermalSlowdown    |
+                                                      nvmlClocksEventReasonHwPowerBrakeSlowdown;
+
+    static constexpr const char* NVIDIA_VENDOR_ID   = "0x10de";
 };
 
 
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "DataProviderNvidiaNvmlProcesses.h"
+#include "DataProviderNvidiaNvml.h"
+#include "DataProviderManager.h"
+#include "NvmlProcessAccounting.h"
+
+#include "../LenovoLegion-PrepareBuild/GpuProcesses.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+namespace LenovoLegionDaemon {
+
+DataProviderNvidiaNvmlProcesses::DataProviderNvidiaNvmlProcesses(DataProviderManager* dataProviderManager) :
+    DataProvider(dataProviderManager, dataType),
+    m_dataProviderManager(dataProviderManager)
+{}
+
+QByteArray DataProviderNvidiaNvmlProcesses::serializeAndGetData() const
+{
+    legion::messages::GpuProcesses gpuProcesses;
+    QByteArray byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    const auto& nvml = dynamic_cast<const DataProviderNvidiaNvml&>(m_dataProviderManager->getDataProvider(DataProviderNvidiaNvml::dataType));
+
+    nvml.requestSamples();
+
+    gpuProcesses.set_available(nvml.processAccounting().available());
+
+    for(const auto& process : nvml.processAccounting().processes())
+    {
+        legion::messages::GpuProcesses::Process* processMsg = gpuProcesses.add_processes();
+
+        processMsg->set_pid(process.m_pid);
+        processMsg->set_name(process.m_name.toStdString());
+        processMsg->set_compute(process.m_compute);
+        processMsg->set_graphics(process.m_graphics);
+        processMsg->set_used_memory(process.m_usedMemory);
+        processMsg->set_sm_utilization(process.m_smUtilization);
+        processMsg->set_memory_utilization(process.m_memoryUtilization);
+
+        for(size_t window = 0; window < NvmlProcessAccounting::WINDOWS.size(); ++window)
+        {
+            legion::messages::GpuProcesses::Usage* usage = processMsg->add_usage();
+
+            usage->set_window(NvmlProcessAccounting::WINDOWS[window]);
+            usage->set_sm_utilization(process.m_usage[window].m_smUtilization);
+            usage->set_memory_utilization(process.m_usage[window].m_memoryUtilization);
+            usage->set_max_used_memory(process.m_usage[window].m_maxUsedMemory);
+        }
+    }
+
+    byteArray.resize(gpuProcesses.ByteSizeLong());
+    if(!gpuProcesses.SerializeToArray(byteArray.data(), byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T, ERROR_CODES::SERIALIZE_ERROR, "Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+}
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include "DataProvider.h"
+
+namespace LenovoLegionDaemon {
+
+class DataProviderManager;
+
+/*
+ * Per process GPU usage, the processes are sampled by the NVML sampler of DataProviderNvidiaNvml,
+ * GET keeps the sampler running like a GET of the NVML data
+ */
+class DataProviderNvidiaNvmlProcesses : public DataProvider
+{
+    Q_OBJECT
+
+public:
+    explicit DataProviderNvidiaNvmlProcesses(DataProviderManager* dataProviderManager);
+    ~DataProviderNvidiaNvmlProcesses() override = default;
+
+    QByteArray serializeAndGetData() const override;
+
+private:
+
+    DataProviderManager* m_dataProviderManager;
+
+public:
+    static constexpr quint8 dataType = 29;
+};
+
+}
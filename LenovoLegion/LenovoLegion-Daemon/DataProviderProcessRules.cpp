@@ -0,0 +1,598 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "DataProviderProcessRules.h"
+#include "DataProviderManager.h"
+#include "SysFsDataProviderPowerProfile.h"
+#include "SysFsDataProviderCPUPower.h"
+#include "SysFsDataProviderGPUPower.h"
+#include "SysFsDataProviderFanCurve.h"
+#include "SysFsDataProviderFanOption.h"
+#include "SysFsDataProviderCPUOptions.h"
+#include "SysFsDataProviderCPUSMT.h"
+#include "ControlOwnership.h"
+#include "SettingsReconciler.h"
+
+#include "../LenovoLegion-PrepareBuild/ProcessRules.pb.h"
+#include "../LenovoLegion-PrepareBuild/PowerProfile.pb.h"
+#include "../LenovoLegion-PrepareBuild/GPUPower.pb.h"
+#include "../LenovoLegion-PrepareBuild/CPUOptions.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QDateTime>
+
+#include <algorithm>
+
+namespace LenovoLegionDaemon {
+
+DataProviderProcessRules::DataProviderProcessRules(DataProviderManager* dataProviderManager) :
+    DataProvider(dataProviderManager, dataType),
+    m_dataProviderManager(dataProviderManager),
+    m_processMonitor(new ProcessMonitor(this)),
+    m_enabled(false),
+    m_appliedBatches(0),
+    m_failedBatches(0)
+{
+    connect(m_processMonitor,&ProcessMonitor::processStarted,this,&DataProviderProcessRules::onProcessStarted);
+    connect(m_processMonitor,&ProcessMonitor::processExited,this,&DataProviderProcessRules::onProcessExited);
+    connect(m_processMonitor,&ProcessMonitor::overrun,this,&DataProviderProcessRules::onOverrun);
+}
+
+QByteArray DataProviderProcessRules::serializeAndGetData() const
+{
+    legion::messages::ProcessRules processRules;
+    QByteArray                     byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    processRules.set_enabled(m_enabled);
+
+    for(const auto& rule : m_rules)
+    {
+        auto ruleMsg = processRules.mutable_rule_set()->add_rules();
+
+        ruleMsg->set_name(rule.m_name.toStdString());
+        ruleMsg->set_match_type(static_cast<legion::messages::ProcessRules::MatchType>(rule.m_matchType));
+        ruleMsg->set_pattern(rule.m_pattern.pattern().toStdString());
+
+        for(const auto& setting : rule.m_settings)
+        {
+            auto settingMsg = ruleMsg->add_settings();
+
+            settingMsg->set_data_type(setting.m_dataType);
+            settingMsg->set_data(setting.m_data.toStdString());
+        }
+    }
+
+    processRules.set_monitor(static_cast<legion::messages::ProcessRules::Monitor>(m_processMonitor->mode()));
+
+    for(const auto& activeRule : m_activeRules)
+    {
+        auto activeRuleMsg = processRules.add_active_rules();
+
+        activeRuleMsg->set_name(m_rules.at(activeRule.m_rule).m_name.toStdString());
+        activeRuleMsg->set_activated(activeRule.m_activated);
+
+        for(const auto pid : activeRule.m_pids)
+        {
+            activeRuleMsg->add_pids(pid);
+        }
+    }
+
+    processRules.set_applied_batches(m_appliedBatches);
+    processRules.set_failed_batches(m_failedBatches);
+
+    byteArray.resize(processRules.ByteSizeLong());
+    if(!processRules.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray DataProviderProcessRules::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::ProcessRules processRules;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!processRules.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    if(processRules.has_rule_set())
+    {
+        std::vector<Rule> rules;
+
+        for(const auto& ruleMsg : processRules.rule_set().rules())
+        {
+            Rule rule {
+                .m_name      = QString::fromStdString(std::string(ruleMsg.name())),
+                .m_matchType = static_cast<MatchType>(ruleMsg.match_type()),
+                .m_pattern   = QRegularExpression(QString::fromStdString(std::string(ruleMsg.pattern())))
+            };
+
+            if(rule.m_name.isEmpty() || !rule.m_pattern.isValid() || (rule.m_matchType != EXECUTABLE && rule.m_matchType != CMDLINE))
+            {
+                THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid process rule !");
+            }
+
+            for(const auto& settingMsg : ruleMsg.settings())
+            {
+                const Setting setting {
+                    .m_dataType = static_cast<quint8>(settingMsg.data_type()),
+                    .m_data     = QByteArray(settingMsg.data().data(),settingMsg.data().size())
+                };
+
+                if(settingMsg.data_type() > 0xFF || !isSupported(setting.m_dataType))
+                {
+                    THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Unsupported data type in process rule !");
+                }
+
+                SettingsReconciler::splitFields(setting.m_data.toStdString());
+
+                rule.m_settings.push_back(setting);
+            }
+
+            rules.push_back(std::move(rule));
+        }
+
+        /*
+         * Active rules refer to the old rule set, restore first
+         */
+        deactivateAll();
+
+        m_rules = std::move(rules);
+
+        if(m_enabled)
+        {
+            for(const auto& process : m_processMonitor->processes())
+            {
+                onProcessStarted(process);
+            }
+        }
+    }
+
+    if(processRules.has_enabled() && processRules.enabled() != m_enabled)
+    {
+        if(processRules.enabled())
+        {
+            start();
+        }
+        else
+        {
+            stop();
+        }
+    }
+
+    return {};
+}
+
+void DataProviderProcessRules::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+}
+
+void DataProviderProcessRules::clean()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    stop();
+}
+
+void DataProviderProcessRules::start()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    m_processMonitor->start();
+    m_enabled = true;
+
+    /*
+     * Processes started before us
+     */
+    for(const auto& process : m_processMonitor->processes())
+    {
+        onProcessStarted(process);
+    }
+}
+
+void DataProviderProcessRules::stop()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    m_processMonitor->stop();
+    m_enabled = false;
+
+    deactivateAll();
+}
+
+void DataProviderProcessRules::onProcessStarted(const ProcessMonitor::Process &process)
+{
+    /*
+     * exec() in a pid we already track replaces the image, rules of the old one go away
+     */
+    onProcessExited(process.m_pid);
+
+    for(size_t i = 0; i < m_rules.size(); ++i)
+    {
+        if(matches(m_rules.at(i),process))
+        {
+            activate(i,process.m_pid);
+        }
+    }
+}
+
+void DataProviderProcessRules::onProcessExited(qint32 pid)
+{
+    for(auto it = m_activeRules.begin(); it != m_activeRules.end();)
+    {
+        if(it->m_pids.erase(pid) > 0 && it->m_pids.empty())
+        {
+            it = deactivate(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void DataProviderProcessRules::onOverrun()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Exit events may be lost, drop the processes which are gone and pick up the new ones
+     */
+    for(auto it = m_activeRules.begin(); it != m_activeRules.end();)
+    {
+        std::erase_if(it->m_pids,[this](qint32 pid){ return !m_processMonitor->exists(pid); });
+
+        if(it->m_pids.empty())
+        {
+            it = deactivate(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for(const auto& process : m_processMonitor->processes())
+    {
+        for(size_t i = 0; i < m_rules.size(); ++i)
+        {
+            if(matches(m_rules.at(i),process))
+            {
+                activate(i,process.m_pid);
+            }
+        }
+    }
+}
+
+bool DataProviderProcessRules::matches(const Rule &rule, const ProcessMonitor::Process &process) const
+{
+    return rule.m_pattern.match(rule.m_matchType == EXECUTABLE ? process.m_executable : process.m_cmdline).hasMatch();
+}
+
+void DataProviderProcessRules::activate(size_t rule, qint32 pid)
+{
+    auto found = std::find_if(m_activeRules.begin(),m_activeRules.end(),[rule](const ActiveRule& activeRule){ return activeRule.m_rule == rule; });
+
+    if(found != m_activeRules.end())
+    {
+        found->m_pids.insert(pid);
+        return;
+    }
+
+    ActiveRule      activeRule {
+        .m_rule      = rule,
+        .m_pids      = {pid},
+        .m_activated = QDateTime::currentMSecsSinceEpoch()
+    };
+    std::set<Slot>  touched;
+
+    try {
+        for(const auto& setting : m_rules.at(rule).m_settings)
+        {
+            if(std::find(activeRule.m_order.begin(),activeRule.m_order.end(),setting.m_dataType) == activeRule.m_order.end())
+            {
+                activeRule.m_order.push_back(setting.m_dataType);
+            }
+
+            for(const auto& [number,value] : SettingsReconciler::splitFields(setting.m_data.toStdString()))
+            {
+                activeRule.m_values[{setting.m_dataType,number}] = value;
+                touched.insert({setting.m_dataType,number});
+            }
+        }
+
+        /*
+         * A controller regulating the same resource would fight the rule, the field is left to it
+         */
+        for(auto slot = touched.begin(); slot != touched.end();)
+        {
+            const auto owner = ControlOwnership::conflict(OWNER,controlResources(*slot,activeRule.m_values.at(*slot)));
+
+            if(owner.has_value())
+            {
+                LOGF_W("Process rule {} skips field {} of data type {}, it is controlled by {}",m_rules.at(rule).m_name,slot->second,slot->first,owner.value());
+
+                activeRule.m_values.erase(*slot);
+                slot = touched.erase(slot);
+            }
+            else
+            {
+                ++slot;
+            }
+        }
+
+        /*
+         * Remember the current value of the fields nobody holds yet
+         */
+        std::set<Slot> absent;
+
+        for(const auto dataType : activeRule.m_order)
+        {
+            std::map<int,std::string> current;
+            bool                      read = false;
+
+            for(const auto& slot : touched)
+            {
+                if(slot.first != dataType || isHeld(slot))
+                {
+                    continue;
+                }
+
+                if(!read)
+                {
+                    current = SettingsReconciler::splitFields(m_dataProviderManager->getDataProvider(dataType).serializeAndGetData().toStdString());
+                    read    = true;
+                }
+
+                auto value = current.find(slot.second);
+
+                if(value == current.end())
+                {
+                    absent.insert(slot);
+                    continue;
+                }
+
+                m_baseValues[slot] = value->second;
+            }
+        }
+
+        /*
+         * A field the provider does not report can not be written back on release,
+         * unset fields are left alone by the providers, so the rule does not hold it
+         */
+        for(const auto& slot : absent)
+        {
+            LOGF_W("Process rule {} skips field {} of data type {}, it has no current value to restore",m_rules.at(rule).m_name,slot.second,slot.first);
+
+            activeRule.m_values.erase(slot);
+            touched.erase(slot);
+        }
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Snapshot for rule " + m_rules.at(rule).m_name + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+
+        releaseBaseValues(touched);
+        ++m_failedBatches;
+        return;
+    }
+
+    m_activeRules.push_back(std::move(activeRule));
+
+    updateOwnership();
+
+    try {
+        apply(m_activeRules.back().m_order,touched);
+
+        LOGF_I("Process rule {} activated by pid {}",m_rules.at(rule).m_name,pid);
+        ++m_appliedBatches;
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Apply of rule " + m_rules.at(rule).m_name + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+
+        /*
+         * Roll back what made it through
+         */
+        std::vector<quint8> order = m_activeRules.back().m_order;
+        std::reverse(order.begin(),order.end());
+
+        m_activeRules.pop_back();
+
+        updateOwnership();
+
+        try {
+            apply(order,touched);
+        }
+        catch(const bj::framework::exception::Exception& ex)
+        {
+            LOG_W(QString(__PRETTY_FUNCTION__) + "- Roll back of rule " + m_rules.at(rule).m_name + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        }
+
+        releaseBaseValues(touched);
+        ++m_failedBatches;
+    }
+}
+
+std::vector<DataProviderProcessRules::ActiveRule>::iterator DataProviderProcessRules::deactivate(std::vector<ActiveRule>::iterator activeRule)
+{
+    const QString       name  = m_rules.at(activeRule->m_rule).m_name;
+    std::vector<quint8> order(activeRule->m_order.rbegin(),activeRule->m_order.rend());
+    std::set<Slot>      touched;
+
+    /*
+     * Fields overridden by a rule activated later keep their value
+     */
+    for(const auto& [slot,value] : activeRule->m_values)
+    {
+        if(std::none_of(std::next(activeRule),m_activeRules.end(),[&slot](const ActiveRule& later){ return later.m_values.contains(slot); }))
+        {
+            touched.insert(slot);
+        }
+    }
+
+    auto next = m_activeRules.erase(activeRule);
+
+    updateOwnership();
+
+    try {
+        apply(order,touched);
+
+        LOGF_I("Process rule {} deactivated",name);
+        ++m_appliedBatches;
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Restore of rule " + name + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        ++m_failedBatches;
+    }
+
+    releaseBaseValues(touched);
+
+    return next;
+}
+
+void DataProviderProcessRules::deactivateAll()
+{
+    /*
+     * Newest first, so every field ends at its original value
+     */
+    while(!m_activeRules.empty())
+    {
+        deactivate(std::prev(m_activeRules.end()));
+    }
+}
+
+void DataProviderProcessRules::apply(const std::vector<quint8> &order, const std::set<Slot> &touched)
+{
+    for(const auto dataType : order)
+    {
+        std::string message;
+
+        for(const auto& slot : touched)
+        {
+            if(slot.first != dataType)
+            {
+                continue;
+            }
+
+            auto holder = std::find_if(m_activeRules.rbegin(),m_activeRules.rend(),[&slot](const ActiveRule& activeRule){ return activeRule.m_values.contains(slot); });
+
+            if(holder != m_activeRules.rend())
+            {
+                message += holder->m_values.at(slot);
+            }
+            else if(m_baseValues.contains(slot))
+            {
+                message += m_baseValues.at(slot);
+            }
+        }
+
+        /*
+         * Encoded fields concatenate into a valid message
+         */
+        if(!message.empty())
+        {
+            ControlOwnership::Scope scope(OWNER);
+
+            m_dataProviderManager->getDataProvider(dataType).deserializeAndSetData(QByteArray::fromStdString(message));
+        }
+    }
+}
+
+bool DataProviderProcessRules::isHeld(const Slot &slot) const
+{
+    return std::any_of(m_activeRules.begin(),m_activeRules.end(),[&slot](const ActiveRule& activeRule){ return activeRule.m_values.contains(slot); });
+}
+
+void DataProviderProcessRules::releaseBaseValues(const std::set<Slot> &touched)
+{
+    for(const auto& slot : touched)
+    {
+        if(!isHeld(slot))
+        {
+            m_baseValues.erase(slot);
+        }
+    }
+}
+
+bool DataProviderProcessRules::isSupported(quint8 dataType)
+{
+    switch (dataType) {
+    case SysFsDataProviderPowerProfile::dataType:
+    case SysFsDataProviderCPUPower::dataType:
+    case SysFsDataProviderFanCurve::dataType:
+        return ControlOwnership::FAN_CURVE;
+    case SysFsDataProviderGPUPower::dataType:
+    case SysFsDataProviderFanCurve::dataType:
+    case SysFsDataProviderFanOption::dataType:
+    case SysFsDataProviderCPUOptions::dataType:
+    case SysFsDataProviderCPUSMT::dataType:
+        return true;
+    default:
+        return false;
+    }
+}
+
+quint8 DataProviderProcessRules::controlResources(const Slot &slot, const std::string &value)
+{
+    switch (slot.first) {
+    case SysFsDataProviderPowerProfile::dataType:
+        /*
+         * Power mode sets the power limits of the mode
+         */
+        return slot.second == legion::messages::PowerProfile::kCurrentValueFieldNumber ?
+                   ControlOwnership::POWER_MODE | ControlOwnership::CPU_POWER_LIMITS | ControlOwnership::GPU_POWER_LIMIT : 0;
+    case SysFsDataProviderCPUPower::dataType:
+        return ControlOwnership::CPU_POWER_LIMITS;
+    case SysFsDataProviderGPUPower::dataType:
+        return slot.second == legion::messages::GPUPower::kGpuConfigurableTgpFieldNumber ? ControlOwnership::GPU_POWER_LIMIT : 0;
+    case SysFsDataProviderCPUOptions::dataType:
+    {
+        /*
+         * The field alone is a valid message, only the governor of the CPUs is a control resource
+         */
+        legion::messages::CPUOptions cpuOptions;
+
+        if(cpuOptions.ParseFromString(value) && std::any_of(cpuOptions.cpus().begin(),cpuOptions.cpus().end(),[](const auto& cpu){ return cpu.has_governor(); }))
+        {
+            return ControlOwnership::CPU_GOVERNOR;
+        }
+
+        return 0;
+    }
+    default:
+        return 0;
+    }
+}
+
+void DataProviderProcessRules::updateOwnership()
+{
+    quint8 resources = 0;
+
+    for(const auto& activeRule : m_activeRules)
+    {
+        for(const auto& [slot,value] : activeRule.m_values)
+        {
+            resources |= controlResources(slot,value);
+        }
+    }
+
+    ControlOwnership::acquire(OWNER,resources);
+}
+
+}
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include "DataProvider.h"
+#include "ProcessMonitor.h"
+
+#include <QRegularExpression>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace LenovoLegionDaemon {
+
+class DataProviderManager;
+
+/*
+ * Applies settings of other data providers while a matching process runs. A setting is the
+ * request message of the data provider, values are tracked per top level message field, so
+ * overlapping rules stack (the last activated wins) and the original value is restored when
+ * the last rule holding the field goes away. Fields of a resource owned by a controller
+ * (ControlOwnership) are skipped, the resources of the held fields are owned by the rules.
+ */
+class DataProviderProcessRules : public DataProvider
+{
+    Q_OBJECT
+
+public:
+
+    /*
+     * Same values as legion::messages::ProcessRules::MatchType
+     */
+    enum MatchType : quint8 {
+        EXECUTABLE  = 0,
+        CMDLINE     = 1
+    };
+
+    struct Setting {
+        quint8      m_dataType = 0;
+        QByteArray  m_data;
+    };
+
+    struct Rule {
+        QString              m_name;
+        MatchType            m_matchType = EXECUTABLE;
+        QRegularExpression   m_pattern;
+        std::vector<Setting> m_settings;
+    };
+
+private:
+
+    /*
+     * Data type, top level field number
+     */
+    using Slot   = std::pair<quint8,int>;
+
+    /*
+     * Serialized wire format of one top level field, repeated fields included
+     */
+    using Values = std::map<Slot,std::string>;
+
+    struct ActiveRule {
+        size_t               m_rule      = 0;
+        std::set<qint32>     m_pids;
+        qint64               m_activated = 0;
+        Values               m_values;
+        std::vector<quint8>  m_order;       // data types in the rule order
+    };
+
+public:
+
+    explicit DataProviderProcessRules(DataProviderManager* dataProviderManager);
+    ~DataProviderProcessRules() override = default;
+
+    QByteArray serializeAndGetData() const override;
+    QByteArray deserializeAndSetData(const QByteArray& data) override;
+
+    void init()  override;
+    void clean() override;
+
+private:
+
+    void start();
+    void stop();
+
+    void onProcessStarted(const LenovoLegionDaemon::ProcessMonitor::Process& process);
+    void onProcessExited(qint32 pid);
+    void onOverrun();
+
+    bool matches(const Rule& rule,const ProcessMonitor::Process& process) const;
+
+    void activate(size_t rule,qint32 pid);
+    std::vector<ActiveRule>::iterator deactivate(std::vector<ActiveRule>::iterator activeRule);
+    void deactivateAll();
+
+    /*
+     * Write the effective value of the touched fields, data types are processed in the given order
+     */
+    void apply(const std::vector<quint8>& order,const std::set<Slot>& touched);
+
+    bool isHeld(const Slot& slot) const;
+    void releaseBaseValues(const std::set<Slot>& touched);
+
+    static bool isSupported(quint8 dataType);
+
+    /*
+     * Control resources (ControlOwnership) the value of the field writes
+     */
+    static quint8 controlResources(const Slot& slot,const std::string& value);
+
+    /*
+     * Resources of the fields held by the active rules, controllers must not take them over
+     */
+    void updateOwnership();
+
+private:
+
+    DataProviderManager*        m_dataProviderManager;
+
+    ProcessMonitor*             m_processMonitor;
+
+    bool                        m_enabled;
+    std::vector<Rule>           m_rules;
+
+    std::vector<ActiveRule>     m_activeRules;
+    Values                      m_baseValues;
+
+    quint64                     m_appliedBatches;
+    quint64                     m_failedBatches;
+
+public:
+
+    static constexpr quint8 dataType = 25;
+
+    static constexpr const char* OWNER = "process rules";
+};
+
+}
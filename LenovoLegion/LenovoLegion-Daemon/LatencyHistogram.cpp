@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace LenovoLegionDaemon {
+
+void LatencyHistogram::record(quint64 value)
+{
+    value = std::min<quint64>(value,(1ULL << MAX_VALUE_BITS) - 1);
+
+    ++m_buckets[bucketIndex(value)];
+    ++m_count;
+
+    m_sum += value;
+    m_min  = std::min(m_min,value);
+    m_max  = std::max(m_max,value);
+}
+
+void LatencyHistogram::reset()
+{
+    *this = LatencyHistogram();
+}
+
+quint64 LatencyHistogram::valueAtPercentile(double percentile) const
+{
+    if(m_count == 0)
+    {
+        return 0;
+    }
+
+    const quint64 target = std::max<quint64>(1,static_cast<quint64>(std::ceil(std::clamp(percentile,0.0,100.0) / 100.0 * m_count)));
+    quint64       total  = 0;
+
+    for(size_t i = 0; i < BUCKETS; ++i)
+    {
+        total += m_buckets[i];
+
+        if(total >= target)
+        {
+            return std::clamp(bucketHighestValue(i),min(),m_max);
+        }
+    }
+
+    return m_max;
+}
+
+size_t LatencyHistogram::bucketIndex(quint64 value)
+{
+    if(value < SUB_BUCKETS)
+    {
+        return value;
+    }
+
+    const int msb   = std::bit_width(value) - 1;
+    const int shift = msb - SUB_BUCKET_BITS;
+
+    return SUB_BUCKETS + (msb - SUB_BUCKET_BITS) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+}
+
+quint64 LatencyHistogram::bucketHighestValue(size_t index)
+{
+    if(index < SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    const quint64 range = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    const quint64 sub   = (index - SUB_BUCKETS) % SUB_BUCKETS;
+
+    return ((SUB_BUCKETS + sub + 1) << range) - 1;
+}
+
+}
@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <QtGlobal>
+
+#include <array>
+#include <limits>
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Log-linear (HDR style) histogram of nanosecond latencies.
+ * Every power of two range is split into SUB_BUCKETS linear buckets,
+ * so the relative error of a reported value is below 1/SUB_BUCKETS.
+ */
+class LatencyHistogram
+{
+public:
+
+    static constexpr int     SUB_BUCKET_BITS  = 4;
+    static constexpr quint64 SUB_BUCKETS      = 1ULL << SUB_BUCKET_BITS;
+    static constexpr int     MAX_VALUE_BITS   = 40;                          // ~18 minutes in ns, larger values are clamped
+    static constexpr size_t  BUCKETS          = SUB_BUCKETS + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+public:
+
+    void    record(quint64 value);
+    void    reset();
+
+    quint64 count() const { return m_count; }
+    quint64 min()   const { return m_count == 0 ? 0 : m_min; }
+    quint64 max()   const { return m_max; }
+    quint64 mean()  const { return m_count == 0 ? 0 : m_sum / m_count; }
+
+    /*
+     * Highest value equivalent to the value at percentile (0 - 100)
+     */
+    quint64 valueAtPercentile(double percentile) const;
+
+private:
+
+    static size_t  bucketIndex(quint64 value);
+    static quint64 bucketHighestValue(size_t index);
+
+private:
+
+    std::array<quint32,BUCKETS> m_buckets = {};
+    quint64                     m_count   = 0;
+    quint64                     m_sum     = 0;
+    quint64                     m_min     = std::numeric_limits<quint64>::max();
+    quint64                     m_max     = 0;
+};
+
+}
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "LatencyStatistics.h"
+
+namespace LenovoLegionDaemon {
+
+std::atomic<bool> LatencyStatistics::s_enabled {false};
+
+LatencyStatistics &LatencyStatistics::getInstance()
+{
+    static LatencyStatistics instance;
+    return instance;
+}
+
+void LatencyStatistics::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled,std::memory_order_relaxed);
+}
+
+void LatencyStatistics::recordProvider(quint8 dataType, Stage stage, quint64 nsecs)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_providers[dataType].m_stages[stage].record(nsecs);
+}
+
+void LatencyStatistics::recordProviderError(quint8 dataType)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ++m_providers[dataType].m_errors;
+}
+
+void LatencyStatistics::recordAttribute(std::string_view path, bool write, quint64 nsecs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    /*
+     * The path is copied only the first time the attribute is seen
+     */
+    auto attribute = m_attributes.find(path);
+
+    if(attribute == m_attributes.end())
+    {
+        attribute = m_attributes.emplace(std::string(path),AttributeStats()).first;
+    }
+
+    (write ? attribute->second.m_writes : attribute->second.m_reads).record(nsecs);
+}
+
+void LatencyStatistics::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_providers.clear();
+    m_attributes.clear();
+}
+
+void LatencyStatistics::forEachProviderDo(const std::function<void (quint8, const ProviderStats &)> &func) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for(const auto& provider : m_providers)
+    {
+        func(provider.first,provider.second);
+    }
+}
+
+void LatencyStatistics::forEachAttributeDo(const std::function<void (const std::string &, const AttributeStats &)> &func) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for(const auto& attribute : m_attributes)
+    {
+        func(attribute.first,attribute.second);
+    }
+}
+
+}
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include "LatencyHistogram.h"
+
+#include <QElapsedTimer>
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Latencies of the provider requests and of the sysfs attributes. Disabled by default, a disabled
+ * recording costs one relaxed load, so the sysfs reads and writes are not slowed down.
+ */
+class LatencyStatistics
+{
+public:
+
+    enum Stage : quint8 {
+        PARSE           = 0,
+        GET_DATA        = 1,
+        SET_DATA        = 2,
+        SOCKET_WRITE    = 3,
+        KERNEL_EVENT    = 4,
+        INIT            = 5,
+        STAGES_COUNT    = 6
+    };
+
+    struct ProviderStats {
+        std::array<LatencyHistogram,STAGES_COUNT> m_stages;
+        quint64                                   m_errors = 0;
+    };
+
+    struct AttributeStats {
+        LatencyHistogram m_reads;
+        LatencyHistogram m_writes;
+    };
+
+    /*
+     * Records elapsed time of the enclosing scope as a read or write of the attribute,
+     * the path must outlive the timer
+     */
+    class AttributeTimer
+    {
+    public:
+        AttributeTimer(const std::filesystem::path& path,bool write) noexcept : m_path(LatencyStatistics::isEnabled() ? &path : nullptr),m_write(write)
+        {
+            if(m_path != nullptr) [[unlikely]]
+            {
+                m_timer.start();
+            }
+        }
+
+        ~AttributeTimer()
+        {
+            if(m_path != nullptr) [[unlikely]]
+            {
+                LatencyStatistics::getInstance().recordAttribute(m_path->native(),m_write,m_timer.nsecsElapsed());
+            }
+        }
+
+        AttributeTimer(const AttributeTimer&) = delete;
+        AttributeTimer& operator=(const AttributeTimer&) = delete;
+
+    private:
+        const std::filesystem::path* m_path;
+        const bool                   m_write;
+        QElapsedTimer                m_timer;
+    };
+
+public:
+
+    // Singleton instance access
+    static LatencyStatistics& getInstance();
+
+    LatencyStatistics(const LatencyStatistics&) = delete;
+    LatencyStatistics& operator=(const LatencyStatistics&) = delete;
+
+    static bool isEnabled() noexcept { return s_enabled.load(std::memory_order_relaxed); }
+
+    /*
+     * Recorded values are kept, reset() drops them
+     */
+    static void setEnabled(bool enabled);
+
+    void recordProvider(quint8 dataType,Stage stage,quint64 nsecs);
+    void recordProviderError(quint8 dataType);
+
+    void recordAttribute(std::string_view path,bool write,quint64 nsecs);
+
+    static AttributeTimer attributeReadTimer(const std::filesystem::path& path) noexcept  { return AttributeTimer(path,false); }
+    static AttributeTimer attributeWriteTimer(const std::filesystem::path& path) noexcept { return AttributeTimer(path,true); }
+
+    void reset();
+
+    void forEachProviderDo(const std::function<void(quint8,const ProviderStats&)>& func) const;
+    void forEachAttributeDo(const std::function<void(const std::string&,const AttributeStats&)>& func) const;
+
+private:
+
+    LatencyStatistics() = default;
+    ~LatencyStatistics() = default;
+
+private:
+
+    static std::atomic<bool>                            s_enabled;
+
+    mutable std::mutex                                  m_mutex;
+
+    std::map<quint8,ProviderStats>                      m_providers;
+    std::map<std::string,AttributeStats,std::less<>>    m_attributes;   // looked up by the path without a copy
+};
+
+}
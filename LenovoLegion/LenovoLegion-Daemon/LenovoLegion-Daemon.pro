@@ -7,20 +7,38 @@ CONFIG += c++20 cmdline link_pkgconfig
 
 PKGCONFIG += protobuf hidapi-hidraw
 
+# LOG_T statements are compiled out of release builds, LOG_D stays switchable at runtime
+CONFIG(release, debug|release): DEFINES += BL_LOG_MIN_LEVEL=1
+
 DESTDIR = $${DESTINATION_BIN_PATH}
 
 SOURCES +=  \
         Application.cpp \
+        CPUList.cpp \
+        ControlOwnership.cpp \
         DaemonSettingsManager.cpp \
         DataProvider.cpp \
         DataProviderDaemonSettings.cpp \
+        DataProviderDaemonStats.cpp \
+        DataProviderDaemonTrace.cpp \
         DataProviderManager.cpp \
         DataProviderNvidiaNvml.cpp \
+        DataProviderNvidiaNvmlProcesses.cpp \
+        DataProviderProcessRules.cpp \
         DataProviderRGBController.cpp \
+        LatencyHistogram.cpp \
+        LatencyStatistics.cpp \
+        LoadGenerator.cpp \
+        NvmlLibrary.cpp \
+        NvmlProcessAccounting.cpp \
+        PeerCredentials.cpp \
         ProtocolParser.cpp \
         ProtocolProcessor.cpp \
         ProtocolProcessorBase.cpp \
         ProtocolProcessorNotifier.cpp \
+        ProcInterrupts.cpp \
+        ProcStat.cpp \
+        ProcessMonitor.cpp \
         RGBControlers/LenovoRGBControllerC197.cpp \
         RGBControlers/LenovoRGBControllerC9xx.cpp \
         RGBControlers/LenovoUSBControllerC9xx.cpp \
@@ -30,28 +48,40 @@ SOURCES +=  \
         SysFSDriverLegionHWMon.cpp \
         SysFSDriverLegionIntelMSR.cpp \
         SysFsDataProvider.cpp \
+        SysFsDataProviderAutoPowerProfile.cpp \
+        SysFsDataProviderAutoTuner.cpp \
         SysFsDataProviderBattery.cpp \
+        SysFsDataProviderCPUEnergyPerformance.cpp \
         SysFsDataProviderCPUFrequency.cpp \
         SysFsDataProviderCPUInfo.cpp \
         SysFsDataProviderCPUOptions.cpp \
         SysFsDataProviderCPUPower.cpp \
         SysFsDataProviderCPUSMT.cpp \
         SysFsDataProviderCPUTopology.cpp \
+        SysFsDataProviderCoreParking.cpp \
+        SysFsDataProviderFanController.cpp \
         SysFsDataProviderFanCurve.cpp \
         SysFsDataProviderFanOption.cpp \
         SysFsDataProviderGPUPower.cpp \
         SysFsDataProviderHWMon.cpp \
         SysFsDataProviderIntelMSR.cpp \
+        SysFsDataProviderIrqBalancer.cpp \
+        SysFsDataProviderLoadGenerator.cpp \
         SysFsDataProviderMachineInformation.cpp \
         SysFsDataProviderOther.cpp \
         SysFsDataProviderOtherGpuSwitch.cpp \
+        SysFsDataProviderPowerArbiter.cpp \
         SysFsDataProviderPowerProfile.cpp \
+        SysFsDataProviderProcessPlacement.cpp \
+        SysFsDataProviderRaplController.cpp \
+        SysFsDataProviderThrottleDetector.cpp \
         SysFsDriver.cpp \
         SysFsDriverACPIPlatformProfile.cpp \
         SysFsDriverCPU.cpp \
         SysFsDriverCPUAtom.cpp \
         SysFsDriverCPUCore.cpp \
         SysFsDriverCPUInfo.cpp \
+        SysFsDriverCPUXEnergyPerformance.cpp \
         SysFsDriverCPUXList.cpp \
         SysFsDriverIntelPowercapRapl.cpp \
         SysFsDriverLegionEvents.cpp \
@@ -60,53 +90,87 @@ SOURCES +=  \
         SysFsDriverManager.cpp \
         SysFsDriverPowerSuplyBattery0.cpp \
         Settings.cpp \
+        SettingsJournal.cpp \
+        SettingsReconciler.cpp \
+        SettingsStore.cpp \
         StringUtils.cpp \
+        Tracer.cpp \
         main.cpp
 
 HEADERS += \
     Application.h \
+    CPUList.h \
+    ControlOwnership.h \
     DaemonSettingsManager.h \
     DataProvider.h \
     DataProviderDaemonSettings.h \
+    DataProviderDaemonStats.h \
+    DataProviderDaemonTrace.h \
     DataProviderManager.h \
     DataProviderNvidiaNvml.h \
+    DataProviderNvidiaNvmlProcesses.h \
+    DataProviderProcessRules.h \
     DataProviderRGBController.h \
     Message.h \
+    LatencyHistogram.h \
+    LatencyStatistics.h \
+    LoadGenerator.h \
+    NvmlLibrary.h \
+    NvmlProcessAccounting.h \
+    PeerCredentials.h \
     ProtocolParser.h \
     ProtocolProcessor.h \
     ProtocolProcessorBase.h \
     ProtocolProcessorNotifier.h \
+    ProcInterrupts.h \
+    ProcStat.h \
+    ProcessMonitor.h \
     RGBControlers/LenovoRGBControllerC197.h \
     RGBControlers/LenovoRGBControllerC9xx.h \
     RGBControlers/LenovoUSBControllerC9xx.h \
     SysFSDriverLegionFanMode.h \
     SysFSDriverLegionGameZone.h \
     Settings.h \
+    SettingsJournal.h \
+    SettingsReconciler.h \
+    SettingsStore.h \
     SysFSDriverLegionHWMon.h \
     SysFSDriverLegionIntelMSR.h \
     SysFsDataProvider.h \
+    SysFsDataProviderAutoPowerProfile.h \
+    SysFsDataProviderAutoTuner.h \
     SysFsDataProviderBattery.h \
+    SysFsDataProviderCPUEnergyPerformance.h \
     SysFsDataProviderCPUFrequency.h \
     SysFsDataProviderCPUInfo.h \
     SysFsDataProviderCPUOptions.h \
     SysFsDataProviderCPUPower.h \
     SysFsDataProviderCPUSMT.h \
     SysFsDataProviderCPUTopology.h \
+    SysFsDataProviderCoreParking.h \
+    SysFsDataProviderFanController.h \
     SysFsDataProviderFanCurve.h \
     SysFsDataProviderFanOption.h \
     SysFsDataProviderGPUPower.h \
     SysFsDataProviderHWMon.h \
     SysFsDataProviderIntelMSR.h \
+    SysFsDataProviderIrqBalancer.h \
+    SysFsDataProviderLoadGenerator.h \
     SysFsDataProviderMachineInformation.h \
     SysFsDataProviderOther.h \
     SysFsDataProviderOtherGpuSwitch.h \
+    SysFsDataProviderPowerArbiter.h \
     SysFsDataProviderPowerProfile.h \
+    SysFsDataProviderProcessPlacement.h \
+    SysFsDataProviderRaplController.h \
+    SysFsDataProviderThrottleDetector.h \
     SysFsDriver.h \
     SysFsDriverACPIPlatformProfile.h \
     SysFsDriverCPU.h \
     SysFsDriverCPUAtom.h \
     SysFsDriverCPUCore.h \
     SysFsDriverCPUInfo.h \
+    SysFsDriverCPUXEnergyPerformance.h \
     SysFsDriverCPUXList.h \
     SysFsDriverIntelPowercapRapl.h \
     SysFsDriverLegion.h \
@@ -119,6 +183,7 @@ HEADERS += \
     RGBController.h \
     RGBControllerKeyNames.h \
     StringUtils.h \
+    Tracer.h \
     RGBControllerDetector.h
 
 
@@ -148,7 +213,23 @@ HEADERS += \
         ../LenovoLegion-PrepareBuild/ComputerInfo.pb.h \
         ../LenovoLegion-PrepareBuild/DaemonSettings.pb.h \
         ../LenovoLegion-PrepareBuild/Other.pb.h \
-        ../LenovoLegion-PrepareBuild/RGBController.pb.h
+        ../LenovoLegion-PrepareBuild/RGBController.pb.h \
+        ../LenovoLegion-PrepareBuild/ThrottleDetector.pb.h \
+        ../LenovoLegion-PrepareBuild/DaemonStats.pb.h \
+        ../LenovoLegion-PrepareBuild/DaemonTrace.pb.h \
+        ../LenovoLegion-PrepareBuild/FanController.pb.h \
+        ../LenovoLegion-PrepareBuild/AutoPowerProfile.pb.h \
+        ../LenovoLegion-PrepareBuild/ProcessRules.pb.h \
+        ../LenovoLegion-PrepareBuild/CoreParking.pb.h \
+        ../LenovoLegion-PrepareBuild/ProcessPlacement.pb.h \
+        ../LenovoLegion-PrepareBuild/IrqBalancer.pb.h \
+        ../LenovoLegion-PrepareBuild/SettingsSnapshot.pb.h \
+        ../LenovoLegion-PrepareBuild/GpuProcesses.pb.h \
+        ../LenovoLegion-PrepareBuild/PowerArbiter.pb.h \
+        ../LenovoLegion-PrepareBuild/RaplController.pb.h \
+        ../LenovoLegion-PrepareBuild/LoadGenerator.pb.h \
+        ../LenovoLegion-PrepareBuild/AutoTuner.pb.h \
+        ../LenovoLegion-PrepareBuild/CPUEnergyPerformance.pb.h
 
 SOURCES += \
         ../LenovoLegion-PrepareBuild/HWMonitoring.pb.cc \
@@ -166,11 +247,27 @@ SOURCES += \
         ../LenovoLegion-PrepareBuild/ComputerInfo.pb.cc \
         ../LenovoLegion-PrepareBuild/DaemonSettings.pb.cc \
         ../LenovoLegion-PrepareBuild/Other.pb.cc \
-        ../LenovoLegion-PrepareBuild/RGBController.pb.cc
+        ../LenovoLegion-PrepareBuild/RGBController.pb.cc \
+        ../LenovoLegion-PrepareBuild/ThrottleDetector.pb.cc \
+        ../LenovoLegion-PrepareBuild/DaemonStats.pb.cc \
+        ../LenovoLegion-PrepareBuild/DaemonTrace.pb.cc \
+        ../LenovoLegion-PrepareBuild/FanController.pb.cc \
+        ../LenovoLegion-PrepareBuild/AutoPowerProfile.pb.cc \
+        ../LenovoLegion-PrepareBuild/ProcessRules.pb.cc \
+        ../LenovoLegion-PrepareBuild/CoreParking.pb.cc \
+        ../LenovoLegion-PrepareBuild/ProcessPlacement.pb.cc \
+        ../LenovoLegion-PrepareBuild/IrqBalancer.pb.cc \
+        ../LenovoLegion-PrepareBuild/SettingsSnapshot.pb.cc \
+        ../LenovoLegion-PrepareBuild/GpuProcesses.pb.cc \
+        ../LenovoLegion-PrepareBuild/PowerArbiter.pb.cc \
+        ../LenovoLegion-PrepareBuild/RaplController.pb.cc \
+        ../LenovoLegion-PrepareBuild/LoadGenerator.pb.cc \
+        ../LenovoLegion-PrepareBuild/AutoTuner.pb.cc \
+        ../LenovoLegion-PrepareBuild/CPUEnergyPerformance.pb.cc
 
 
 INCLUDEPATH += $${CUDA_PATH}/include
-LIBS += -L$${CUDA_PATH}/lib64 -l$${PROJECT_LIBS_NAME} -ludev -lnvidia-ml
+LIBS += -L$${CUDA_PATH}/lib64 -l$${PROJECT_LIBS_NAME} -ludev -ldl
 
 DISTFILES +=  \
     lenovo-legion-daemon.service
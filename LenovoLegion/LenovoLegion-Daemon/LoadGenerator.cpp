@@ -0,0 +1,297 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "LoadGenerator.h"
+#include "CPUList.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <immintrin.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace LenovoLegionDaemon {
+
+namespace {
+
+/*
+ * Chunk sizes, a chunk takes tens of microseconds, the duty cycle is checked between chunks
+ */
+constexpr size_t INTEGER_ITERATIONS = 1 << 16;
+constexpr size_t FMA_ITERATIONS     = 1 << 14;
+constexpr size_t MEMORY_CHUNK       = (1 << 20) / sizeof(double);
+
+/*
+ * Multiply-add converging to 1, no overflow and no denormals however long it runs
+ */
+constexpr float  FMA_MULTIPLIER     = 0.999999f;
+constexpr float  FMA_ADDEND         = 0.000001f;
+
+quint64 scalarInteger(quint64& state)
+{
+    quint64 a = state, b = state + 1, c = state + 2, d = state + 3;
+
+    for(size_t i = 0; i < INTEGER_ITERATIONS; ++i)
+    {
+        a = a * 6364136223846793005ULL + 1442695040888963407ULL;
+        b = b * 6364136223846793005ULL + 1442695040888963407ULL;
+        c = c * 6364136223846793005ULL + 1442695040888963407ULL;
+        d = d * 6364136223846793005ULL + 1442695040888963407ULL;
+
+        /*
+         * Keeps the chains scalar, the compiler would vectorize them otherwise
+         */
+        asm volatile("" : "+r"(a), "+r"(b), "+r"(c), "+r"(d));
+    }
+
+    state = a ^ b ^ c ^ d;
+
+    return INTEGER_ITERATIONS * 4 * 2;
+}
+
+__attribute__((target("avx2,fma")))
+quint64 avx2Fma(float& state)
+{
+    const __m256 multiplier = _mm256_set1_ps(FMA_MULTIPLIER);
+    const __m256 addend     = _mm256_set1_ps(FMA_ADDEND);
+    __m256       accumulators[8];
+
+    /*
+     * Eight independent chains hide the FMA latency on both ports
+     */
+    for(int i = 0; i < 8; ++i)
+    {
+        accumulators[i] = _mm256_set1_ps(state + static_cast<float>(i));
+    }
+
+    for(size_t i = 0; i < FMA_ITERATIONS; ++i)
+    {
+        for(int j = 0; j < 8; ++j)
+        {
+            accumulators[j] = _mm256_fmadd_ps(accumulators[j],multiplier,addend);
+        }
+    }
+
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes,_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(accumulators[0],accumulators[1]),_mm256_add_ps(accumulators[2],accumulators[3])),
+                                        _mm256_add_ps(_mm256_add_ps(accumulators[4],accumulators[5]),_mm256_add_ps(accumulators[6],accumulators[7]))));
+
+    state = lanes[0] / 8;
+
+    return FMA_ITERATIONS * 8 * 8 * 2;
+}
+
+__attribute__((target("avx512f")))
+quint64 avx512Fma(float& state)
+{
+    const __m512 multiplier = _mm512_set1_ps(FMA_MULTIPLIER);
+    const __m512 addend     = _mm512_set1_ps(FMA_ADDEND);
+    __m512       accumulators[8];
+
+    for(int i = 0; i < 8; ++i)
+    {
+        accumulators[i] = _mm512_set1_ps(state + static_cast<float>(i));
+    }
+
+    for(size_t i = 0; i < FMA_ITERATIONS; ++i)
+    {
+        for(int j = 0; j < 8; ++j)
+        {
+            accumulators[j] = _mm512_fmadd_ps(accumulators[j],multiplier,addend);
+        }
+    }
+
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes,_mm512_add_ps(_mm512_add_ps(_mm512_add_ps(accumulators[0],accumulators[1]),_mm512_add_ps(accumulators[2],accumulators[3])),
+                                        _mm512_add_ps(_mm512_add_ps(accumulators[4],accumulators[5]),_mm512_add_ps(accumulators[6],accumulators[7]))));
+
+    state = lanes[0] / 8;
+
+    return FMA_ITERATIONS * 8 * 16 * 2;
+}
+
+/*
+ * Bytes read plus bytes written, the write allocate traffic is not counted (same as STREAM)
+ */
+quint64 memoryBandwidth(const std::vector<double>& source,std::vector<double>& destination,size_t& offset)
+{
+    const size_t count = std::min(MEMORY_CHUNK,source.size() - offset);
+
+    for(size_t i = offset; i < offset + count; ++i)
+    {
+        destination[i] = source[i] * 1.000001;
+    }
+
+    offset = (offset + count) % source.size();
+
+    return count * 2 * sizeof(double);
+}
+
+}
+
+LoadGenerator::LoadGenerator() :
+    m_kernel(SCALAR_INTEGER),
+    m_dutyCycle(100),
+    m_period(0),
+    m_stop(false),
+    m_work(0)
+{}
+
+LoadGenerator::~LoadGenerator()
+{
+    stop();
+}
+
+bool LoadGenerator::supported(Kernel kernel)
+{
+    switch (kernel) {
+    case SCALAR_INTEGER:
+    case MEMORY_BANDWIDTH:
+        return true;
+    case AVX2_FMA:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case AVX512_FMA:
+        return __builtin_cpu_supports("avx512f");
+    }
+
+    return false;
+}
+
+void LoadGenerator::start(Kernel kernel, const std::set<quint32> &cpus, quint32 dutyCycle, std::chrono::milliseconds period)
+{
+    stop();
+
+    m_kernel    = kernel;
+    m_dutyCycle = std::clamp<quint32>(dutyCycle,1,100);
+    m_period    = period;
+    m_stop      = false;
+    m_work      = 0;
+
+    for(const auto cpu : cpus)
+    {
+        m_workers.emplace_back(&LoadGenerator::worker,this,cpu);
+    }
+}
+
+void LoadGenerator::stop()
+{
+    if(m_workers.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_stop = true;
+    }
+
+    m_wakeUp.notify_all();
+
+    for(auto& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    m_workers.clear();
+}
+
+bool LoadGenerator::running() const
+{
+    return !m_workers.empty();
+}
+
+quint64 LoadGenerator::work() const
+{
+    return m_work.load(std::memory_order_relaxed);
+}
+
+void LoadGenerator::worker(quint32 cpu)
+{
+    const cpu_set_t cpuSet = CPUList::toCpuSet({cpu});
+
+    std::vector<double> source;
+    std::vector<double> destination;
+    size_t              offset       = 0;
+    quint64             integerState = cpu;
+    float               floatState   = static_cast<float>(cpu);
+
+    if(::sched_setaffinity(0,sizeof(cpuSet),&cpuSet) != 0)
+    {
+        LOG_D(QString("Pin of load worker to CPU %1 failed: %2").arg(cpu).arg(std::strerror(errno)));
+    }
+
+    if(m_kernel == MEMORY_BANDWIDTH)
+    {
+        /*
+         * Touched by this worker, so the pages are local to its CPU
+         */
+        try {
+            source.assign(MEMORY_BUFFER_SIZE / sizeof(double),1.0);
+            destination.assign(MEMORY_BUFFER_SIZE / sizeof(double),0.0);
+        }
+        catch(const std::bad_alloc&)
+        {
+            LOG_W(QString("Allocation of load buffers for CPU %1 failed").arg(cpu));
+            return;
+        }
+    }
+
+    const auto busy        = m_period * m_dutyCycle / 100;
+    auto       periodStart = std::chrono::steady_clock::now();
+
+    while (!m_stop.load(std::memory_order_relaxed)) {
+        quint64 work = 0;
+
+        while (std::chrono::steady_clock::now() - periodStart < busy && !m_stop.load(std::memory_order_relaxed)) {
+            switch (m_kernel) {
+            case SCALAR_INTEGER:
+                work += scalarInteger(integerState);
+                break;
+            case AVX2_FMA:
+                work += avx2Fma(floatState);
+                break;
+            case AVX512_FMA:
+                work += avx512Fma(floatState);
+                break;
+            case MEMORY_BANDWIDTH:
+                work += memoryBandwidth(source,destination,offset);
+                break;
+            }
+        }
+
+        m_work.fetch_add(work,std::memory_order_relaxed);
+
+        periodStart += m_period;
+
+        if(m_dutyCycle < 100)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_wakeUp.wait_until(lock,periodStart,[this]{ return m_stop.load(); });
+        }
+
+        /*
+         * Late by more than a period (suspend, stall), the next one starts now and nothing is made up for
+         */
+        if(std::chrono::steady_clock::now() - periodStart > m_period)
+        {
+            periodStart = std::chrono::steady_clock::now();
+        }
+    }
+
+    /*
+     * Results are observable, the kernels can not be optimized out
+     */
+    volatile quint64 sink = integerState ^ static_cast<quint64>(floatState) ^ (destination.empty() ? 0 : static_cast<quint64>(destination.front()));
+    static_cast<void>(sink);
+}
+
+}
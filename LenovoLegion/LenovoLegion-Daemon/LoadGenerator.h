@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Synthetic load, one worker thread pinned to every given CPU. A worker runs the kernel for the
+ * duty cycle of every period and sleeps the rest of it. The vector kernels are compiled for their
+ * instruction set only and selected at runtime, the daemon itself is built for the baseline x86-64.
+ */
+class LoadGenerator
+{
+public:
+
+    /*
+     * Same values as legion::messages::LoadGenerator::Kernel
+     */
+    enum Kernel : quint8 {
+        SCALAR_INTEGER      = 0,    // independent 64 bit multiply-add chains, work in integer operations
+        AVX2_FMA            = 1,    // 256 bit FMA chains, work in floating point operations
+        AVX512_FMA          = 2,    // 512 bit FMA chains, work in floating point operations
+        MEMORY_BANDWIDTH    = 3     // scaled copy of a buffer larger than the caches, work in bytes read and written
+    };
+
+public:
+
+    LoadGenerator();
+    ~LoadGenerator();
+
+    static bool supported(Kernel kernel);
+
+    void start(Kernel kernel,const std::set<quint32>& cpus,quint32 dutyCycle,std::chrono::milliseconds period);
+    void stop();
+
+    bool running() const;
+
+    /*
+     * Work done by all workers since start, the unit depends on the kernel
+     */
+    quint64 work() const;
+
+private:
+
+    void worker(quint32 cpu);
+
+private:
+
+    Kernel                      m_kernel;
+    quint32                     m_dutyCycle;        // %
+    std::chrono::microseconds   m_period;
+
+    std::vector<std::thread>    m_workers;
+
+    std::mutex                  m_mutex;
+    std::condition_variable     m_wakeUp;
+    std::atomic<bool>           m_stop;
+    std::atomic<quint64>        m_work;
+
+public:
+
+    /*
+     * Per worker and array, two arrays, well above the last level cache of a single core
+     */
+    static constexpr size_t MEMORY_BUFFER_SIZE = 32 * 1024 * 1024;
+};
+
+}
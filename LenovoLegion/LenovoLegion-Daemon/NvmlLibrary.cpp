@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "NvmlLibrary.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QtGlobal>
+
+#include <dlfcn.h>
+
+#define LENOVO_LEGION_NVML_STRINGIFY(name)   #name
+#define LENOVO_LEGION_NVML_SYMBOL(name)      LENOVO_LEGION_NVML_STRINGIFY(name)
+
+namespace LenovoLegionDaemon {
+
+NvmlLibrary::NvmlLibrary() :
+    m_handle(nullptr)
+{}
+
+NvmlLibrary::~NvmlLibrary()
+{
+    unload();
+}
+
+void NvmlLibrary::load()
+{
+    if(isLoaded())
+    {
+        return;
+    }
+
+    m_handle = dlopen(path().toStdString().c_str(),RTLD_NOW | RTLD_LOCAL);
+
+    if(m_handle == nullptr)
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::LOAD_ERROR,std::string("I can not load library (").append(path().toStdString()).append("): ").append(dlerror()).append(" !").c_str());
+    }
+
+#define LENOVO_LEGION_NVML_RESOLVE(name)                                                                                                    \
+    name = reinterpret_cast<decltype(name)>(dlsym(m_handle,LENOVO_LEGION_NVML_SYMBOL(name)));                                              \
+    if(name == nullptr)                                                                                                                     \
+    {                                                                                                                                       \
+        unload();                                                                                                                           \
+        THROW_EXCEPTION(exception_T,ERROR_CODES::SYMBOL_ERROR,std::string("Symbol ").append(LENOVO_LEGION_NVML_SYMBOL(name)).append(" not found !").c_str()); \
+    }
+
+    LENOVO_LEGION_NVML_FUNCTIONS(LENOVO_LEGION_NVML_RESOLVE)
+
+#undef LENOVO_LEGION_NVML_RESOLVE
+
+#define LENOVO_LEGION_NVML_RESOLVE_OPTIONAL(name)                                                                                           \
+    name = reinterpret_cast<decltype(name)>(dlsym(m_handle,LENOVO_LEGION_NVML_SYMBOL(name)));                                              \
+    if(name == nullptr)                                                                                                                     \
+    {                                                                                                                                       \
+        LOG_D(QString("Optional NVML symbol ") + LENOVO_LEGION_NVML_SYMBOL(name) + " not found");                                          \
+    }
+
+    LENOVO_LEGION_NVML_EVENT_FUNCTIONS(LENOVO_LEGION_NVML_RESOLVE_OPTIONAL)
+    LENOVO_LEGION_NVML_ACCOUNTING_FUNCTIONS(LENOVO_LEGION_NVML_RESOLVE_OPTIONAL)
+
+#undef LENOVO_LEGION_NVML_RESOLVE_OPTIONAL
+
+    LOG_D(QString("NVML library loaded from ") + path());
+}
+
+void NvmlLibrary::unload()
+{
+    if(m_handle == nullptr)
+    {
+        return;
+    }
+
+#define LENOVO_LEGION_NVML_RESET(name) name = nullptr;
+    LENOVO_LEGION_NVML_FUNCTIONS(LENOVO_LEGION_NVML_RESET)
+    LENOVO_LEGION_NVML_EVENT_FUNCTIONS(LENOVO_LEGION_NVML_RESET)
+    LENOVO_LEGION_NVML_ACCOUNTING_FUNCTIONS(LENOVO_LEGION_NVML_RESET)
+#undef LENOVO_LEGION_NVML_RESET
+
+    dlclose(m_handle);
+    m_handle = nullptr;
+}
+
+bool NvmlLibrary::isLoaded() const
+{
+    return m_handle != nullptr;
+}
+
+bool NvmlLibrary::hasEvents() const
+{
+#define LENOVO_LEGION_NVML_FOUND(name) name != nullptr &&
+    return LENOVO_LEGION_NVML_EVENT_FUNCTIONS(LENOVO_LEGION_NVML_FOUND) true;
+#undef LENOVO_LEGION_NVML_FOUND
+}
+
+bool NvmlLibrary::hasProcessAccounting() const
+{
+#define LENOVO_LEGION_NVML_FOUND(name) name != nullptr &&
+    return LENOVO_LEGION_NVML_ACCOUNTING_FUNCTIONS(LENOVO_LEGION_NVML_FOUND) true;
+#undef LENOVO_LEGION_NVML_FOUND
+}
+
+QString NvmlLibrary::path()
+{
+    static const QByteArray library = qgetenv(LIBRARY_ENV);
+
+    return library.isEmpty() ? QString(DEFAULT_PATH) : QString(library);
+}
+
+}
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <Core/ExceptionBuilder.h>
+
+#include <QString>
+
+#include <nvml.h>
+
+namespace LenovoLegionDaemon {
+
+/*
+ * NVML functions used by the daemon. The names go through the nvml.h macros, so e.g. nvmlInit resolves
+ * to the versioned nvmlInit_v2 symbol like it does for a linked library. The library is not used without
+ * any of them.
+ */
+#define LENOVO_LEGION_NVML_FUNCTIONS(F)                 \
+    F(nvmlInit)                                         \
+    F(nvmlShutdown)                                     \
+    F(nvmlErrorString)                                  \
+    F(nvmlDeviceGetCount)                               \
+    F(nvmlDeviceGetHandleByIndex)                       \
+    F(nvmlDeviceGetName)                                \
+    F(nvmlDeviceGetMaxClockInfo)                        \
+    F(nvmlDeviceGetTemperatureThreshold)                \
+    F(nvmlDeviceGetPowerManagementLimitConstraints)     \
+    F(nvmlDeviceGetMaxPcieLinkGeneration)               \
+    F(nvmlDeviceGetMaxPcieLinkWidth)                    \
+    F(nvmlDeviceGetGpcClkMinMaxVfOffset)                \
+    F(nvmlDeviceGetMemClkMinMaxVfOffset)                \
+    F(nvmlDeviceGetClockInfo)                           \
+    F(nvmlDeviceGetUtilizationRates)                    \
+    F(nvmlDeviceGetTemperatureV)                        \
+    F(nvmlDeviceGetMemoryInfo)                          \
+    F(nvmlDeviceGetPowerUsage)                          \
+    F(nvmlDeviceGetTotalEnergyConsumption)              \
+    F(nvmlDeviceGetPowerManagementDefaultLimit)         \
+    F(nvmlDeviceGetEnforcedPowerLimit)                  \
+    F(nvmlDeviceGetCurrPcieLinkGeneration)              \
+    F(nvmlDeviceGetCurrPcieLinkWidth)                   \
+    F(nvmlDeviceGetPcieThroughput)                      \
+    F(nvmlDeviceGetSamples)                             \
+    F(nvmlDeviceGetGpcClkVfOffset)                      \
+    F(nvmlDeviceGetMemClkVfOffset)                      \
+    F(nvmlDeviceSetClockOffsets)
+
+/*
+ * Events and process accounting, missing in older drivers (e.g. nvmlDeviceGetCurrentClocksEventReasons,
+ * the versioned process queries). Left nullptr if not found, the basic telemetry works without them.
+ */
+#define LENOVO_LEGION_NVML_EVENT_FUNCTIONS(F)           \
+    F(nvmlDeviceGetCurrentClocksEventReasons)           \
+    F(nvmlDeviceGetSupportedEventTypes)                 \
+    F(nvmlDeviceRegisterEvents)                         \
+    F(nvmlEventSetCreate)                               \
+    F(nvmlEventSetWait)                                 \
+    F(nvmlEventSetFree)
+
+#define LENOVO_LEGION_NVML_ACCOUNTING_FUNCTIONS(F)      \
+    F(nvmlDeviceGetComputeRunningProcesses)             \
+    F(nvmlDeviceGetGraphicsRunningProcesses)            \
+    F(nvmlDeviceGetProcessUtilization)
+
+/*
+ * libnvidia-ml loaded with dlopen on first use, so the daemon starts and runs on machines without the
+ * NVIDIA driver and does not touch the GPU until it is needed. LENOVO_LEGION_NVML_LIBRARY selects another
+ * library, e.g. a stub for tests.
+ */
+class NvmlLibrary
+{
+public:
+
+    DEFINE_EXCEPTION(NvmlLibrary);
+
+    enum ERROR_CODES : int {
+        LOAD_ERROR      = -1,
+        SYMBOL_ERROR    = -2
+    };
+
+public:
+
+    NvmlLibrary();
+    ~NvmlLibrary();
+
+    NvmlLibrary(const NvmlLibrary&) = delete;
+    NvmlLibrary& operator=(const NvmlLibrary&) = delete;
+
+    void load();
+    void unload();
+
+    bool isLoaded() const;
+
+    /*
+     * All the event, resp. accounting functions were found
+     */
+    bool hasEvents() const;
+    bool hasProcessAccounting() const;
+
+    static QString path();
+
+public:
+
+#define LENOVO_LEGION_NVML_DECLARE(name) decltype(&::name) name = nullptr;
+    LENOVO_LEGION_NVML_FUNCTIONS(LENOVO_LEGION_NVML_DECLARE)
+    LENOVO_LEGION_NVML_EVENT_FUNCTIONS(LENOVO_LEGION_NVML_DECLARE)
+    LENOVO_LEGION_NVML_ACCOUNTING_FUNCTIONS(LENOVO_LEGION_NVML_DECLARE)
+#undef LENOVO_LEGION_NVML_DECLARE
+
+private:
+
+    void* m_handle;
+
+public:
+
+    static constexpr const char* DEFAULT_PATH = "libnvidia-ml.so.1";
+    static constexpr const char* LIBRARY_ENV  = "LENOVO_LEGION_NVML_LIBRARY";
+};
+
+}
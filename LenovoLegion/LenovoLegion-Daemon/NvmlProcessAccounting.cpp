@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "NvmlProcessAccounting.h"
+#include "NvmlLibrary.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QFile>
+
+#include <algorithm>
+
+namespace LenovoLegionDaemon {
+
+NvmlProcessAccounting::NvmlProcessAccounting(const std::filesystem::path &procRoot) :
+    m_procRoot(procRoot),
+    m_processBuffer(PROCESS_BUFFER_SIZE),
+    m_lastUtilizationTimestamp(0),
+    m_available(false)
+{}
+
+void NvmlProcessAccounting::sample(NvmlLibrary &nvml, nvmlDevice_t device)
+{
+    std::vector<nvmlProcessInfo_t>                                  compute;
+    std::vector<nvmlProcessInfo_t>                                  graphics;
+    std::map<quint32,const nvmlProcessUtilizationSample_t*>         utilization;
+    nvmlReturn_t                                                    result;
+    unsigned int                                                    count = 0;
+
+    const auto now = std::chrono::steady_clock::now();
+
+    /*
+     * Older driver without the process queries
+     */
+    if(!nvml.hasProcessAccounting())
+    {
+        clear();
+        return;
+    }
+
+    const bool computeValid  = runningProcesses(nvml.nvmlDeviceGetComputeRunningProcesses,device,compute);
+    const bool graphicsValid = runningProcesses(nvml.nvmlDeviceGetGraphicsRunningProcesses,device,graphics);
+
+    /*
+     * Utilization samples since the last seen one, a process without a sample was idle
+     */
+    result = nvml.nvmlDeviceGetProcessUtilization(device, nullptr, &count, m_lastUtilizationTimestamp);
+    if ((NVML_SUCCESS == result || NVML_ERROR_INSUFFICIENT_SIZE == result) && count > 0) {
+        m_utilizationBuffer.resize(count);
+
+        result = nvml.nvmlDeviceGetProcessUtilization(device, m_utilizationBuffer.data(), &count, m_lastUtilizationTimestamp);
+        if (NVML_SUCCESS == result) {
+            for(unsigned int i = 0; i < count; ++i)
+            {
+                const auto& sample = m_utilizationBuffer[i];
+                auto&       newest = utilization[sample.pid];
+
+                if(newest == nullptr || newest->timeStamp < sample.timeStamp)
+                {
+                    newest = &sample;
+                }
+
+                m_lastUtilizationTimestamp = std::max(m_lastUtilizationTimestamp,sample.timeStamp);
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_available = computeValid || graphicsValid;
+
+    std::map<quint32,State> states;
+
+    auto add = [&](const nvmlProcessInfo_t& info,bool isCompute) {
+        auto& state = states[info.pid];
+
+        if(state.m_process.m_pid == 0)
+        {
+            auto previous = m_states.find(info.pid);
+
+            if(previous != m_states.end())
+            {
+                state = std::move(previous->second);
+            }
+            else
+            {
+                state.m_process.m_pid  = info.pid;
+                state.m_process.m_name = processName(info.pid);
+            }
+
+            state.m_process.m_compute    = false;
+            state.m_process.m_graphics   = false;
+            state.m_process.m_usedMemory = 0;
+        }
+
+        /*
+         * NVML_VALUE_NOT_AVAILABLE without the permissions (e.g. WDDM or a foreign container)
+         */
+        if(info.usedGpuMemory != NVML_VALUE_NOT_AVAILABLE)
+        {
+            state.m_process.m_usedMemory = std::max<quint64>(state.m_process.m_usedMemory,info.usedGpuMemory);
+        }
+
+        (isCompute ? state.m_process.m_compute : state.m_process.m_graphics) = true;
+    };
+
+    for(const auto& info : compute)
+    {
+        add(info,true);
+    }
+
+    for(const auto& info : graphics)
+    {
+        add(info,false);
+    }
+
+    for(auto& [pid,state] : states)
+    {
+        const auto sample = utilization.find(pid);
+
+        state.m_process.m_smUtilization     = sample != utilization.end() ? sample->second->smUtil  : 0;
+        state.m_process.m_memoryUtilization = sample != utilization.end() ? sample->second->memUtil : 0;
+
+        state.m_points.push_back(Point{
+            .m_time                 = now,
+            .m_smUtilization        = state.m_process.m_smUtilization,
+            .m_memoryUtilization    = state.m_process.m_memoryUtilization,
+            .m_usedMemory           = state.m_process.m_usedMemory
+        });
+
+        while (!state.m_points.empty() && now - state.m_points.front().m_time > std::chrono::seconds(WINDOWS.back())) {
+            state.m_points.pop_front();
+        }
+    }
+
+    m_states = std::move(states);
+}
+
+void NvmlProcessAccounting::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_states.clear();
+    m_available                = false;
+    m_lastUtilizationTimestamp = 0;
+}
+
+std::vector<NvmlProcessAccounting::Process> NvmlProcessAccounting::processes() const
+{
+    std::vector<Process> result;
+
+    const auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for(const auto& [pid,state] : m_states)
+    {
+        Process process = state.m_process;
+
+        for(size_t window = 0; window < WINDOWS.size(); ++window)
+        {
+            Usage& usage = process.m_usage[window];
+            size_t count = 0;
+
+            for(const auto& point : state.m_points)
+            {
+                if(now - point.m_time > std::chrono::seconds(WINDOWS[window]))
+                {
+                    continue;
+                }
+
+                usage.m_smUtilization     += point.m_smUtilization;
+                usage.m_memoryUtilization += point.m_memoryUtilization;
+                usage.m_maxUsedMemory      = std::max(usage.m_maxUsedMemory,point.m_usedMemory);
+                ++count;
+            }
+
+            if(count != 0)
+            {
+                usage.m_smUtilization     /= count;
+                usage.m_memoryUtilization /= count;
+            }
+        }
+
+        result.push_back(std::move(process));
+    }
+
+    std::sort(result.begin(),result.end(),[](const Process& left,const Process& right) {
+        return left.m_usage.front().m_smUtilization > right.m_usage.front().m_smUtilization;
+    });
+
+    return result;
+}
+
+bool NvmlProcessAccounting::available() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_available;
+}
+
+bool NvmlProcessAccounting::runningProcesses(RunningProcesses function, nvmlDevice_t device, std::vector<nvmlProcessInfo_t> &processes)
+{
+    unsigned int count  = static_cast<unsigned int>(m_processBuffer.size());
+    nvmlReturn_t result = function(device, &count, m_processBuffer.data());
+
+    /*
+     * More processes than the buffer, count is the needed size, processes may start in between
+     */
+    if (NVML_ERROR_INSUFFICIENT_SIZE == result) {
+        m_processBuffer.resize(count + PROCESS_BUFFER_SIZE);
+
+        count  = static_cast<unsigned int>(m_processBuffer.size());
+        result = function(device, &count, m_processBuffer.data());
+    }
+
+    if (NVML_SUCCESS != result) {
+        LOG_T(QString("Failed to get GPU processes: %1").arg(result));
+        return false;
+    }
+
+    processes.assign(m_processBuffer.begin(),m_processBuffer.begin() + count);
+
+    return true;
+}
+
+QString NvmlProcessAccounting::processName(quint32 pid) const
+{
+    QFile file(m_procRoot / std::to_string(pid) / "comm");
+
+    if(!file.open(QIODeviceBase::ReadOnly))
+    {
+        return {};
+    }
+
+    return QString::fromLocal8Bit(file.readAll()).trimmed();
+}
+
+}
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <QString>
+
+#include <nvml.h>
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace LenovoLegionDaemon {
+
+class NvmlLibrary;
+
+/*
+ * Processes running on the GPU with their SM and memory utilization and VRAM use, sampled by the NVML
+ * sampler and aggregated over the windows. A process is dropped once NVML does not list it anymore.
+ */
+class NvmlProcessAccounting
+{
+public:
+
+    static constexpr std::array<int,3> WINDOWS { 10, 60, 300 };    // s
+
+    struct Usage {
+        double      m_smUtilization       = 0;
+        double      m_memoryUtilization   = 0;
+        quint64     m_maxUsedMemory       = 0;
+    };
+
+    struct Process {
+        quint32     m_pid                   = 0;
+        QString     m_name;
+        bool        m_compute               = false;
+        bool        m_graphics              = false;
+        quint64     m_usedMemory            = 0;        // bytes
+        quint32     m_smUtilization         = 0;        // %
+        quint32     m_memoryUtilization     = 0;        // %
+
+        std::array<Usage,WINDOWS.size()> m_usage;
+    };
+
+private:
+
+    struct Point {
+        std::chrono::steady_clock::time_point   m_time;
+        quint32                                 m_smUtilization;
+        quint32                                 m_memoryUtilization;
+        quint64                                 m_usedMemory;
+    };
+
+    struct State {
+        Process             m_process;
+        std::deque<Point>   m_points;
+    };
+
+    using RunningProcesses = decltype(&::nvmlDeviceGetComputeRunningProcesses);
+
+public:
+
+    explicit NvmlProcessAccounting(const std::filesystem::path& procRoot = "/proc");
+
+    /*
+     * Called by the sampler with the NVML opened
+     */
+    void sample(NvmlLibrary& nvml,nvmlDevice_t device);
+
+    /*
+     * NVML closed, the processes are unknown
+     */
+    void clear();
+
+    std::vector<Process> processes() const;
+
+    bool available() const;
+
+private:
+
+    bool runningProcesses(RunningProcesses function,nvmlDevice_t device,std::vector<nvmlProcessInfo_t>& processes);
+
+    QString processName(quint32 pid) const;
+
+private:
+
+    const std::filesystem::path                 m_procRoot;
+
+    /*
+     * NVML buffers, used only by the sampler
+     */
+    std::vector<nvmlProcessInfo_t>              m_processBuffer;
+    std::vector<nvmlProcessUtilizationSample_t> m_utilizationBuffer;
+    unsigned long long                          m_lastUtilizationTimestamp;
+
+    /*
+     * Guarded by the mutex
+     */
+    mutable std::mutex                          m_mutex;
+    std::map<quint32,State>                     m_states;
+    bool                                        m_available;
+
+public:
+
+    static constexpr size_t PROCESS_BUFFER_SIZE = 32;
+};
+
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "PeerCredentials.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+namespace LenovoLegionDaemon {
+
+thread_local std::optional<PeerCredentials::Credentials> PeerCredentials::s_current;
+
+PeerCredentials::Scope::Scope(const Credentials &credentials) :
+    m_previous(s_current)
+{
+    s_current = credentials;
+}
+
+PeerCredentials::Scope::~Scope()
+{
+    s_current = m_previous;
+}
+
+PeerCredentials::Credentials PeerCredentials::read(qintptr socketDescriptor)
+{
+    ucred     credentials {};
+    socklen_t length = sizeof(credentials);
+
+    if(socketDescriptor < 0 || ::getsockopt(static_cast<int>(socketDescriptor),SOL_SOCKET,SO_PEERCRED,&credentials,&length) != 0 || length != sizeof(credentials))
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Peer credentials are not available, the client is not privileged");
+        return {};
+    }
+
+    return {
+        .m_pid = static_cast<qint32>(credentials.pid),
+        .m_uid = static_cast<quint32>(credentials.uid)
+    };
+}
+
+const std::optional<PeerCredentials::Credentials> &PeerCredentials::current()
+{
+    return s_current;
+}
+
+bool PeerCredentials::isPrivileged()
+{
+    return !s_current.has_value() || s_current->m_uid == ROOT_UID;
+}
+
+bool PeerCredentials::mayControl(qint32 pid, const std::filesystem::path &procRoot)
+{
+    struct stat status {};
+
+    if(isPrivileged())
+    {
+        return true;
+    }
+
+    return ::stat((procRoot / std::to_string(pid)).c_str(),&status) == 0 && status.st_uid == s_current->m_uid;
+}
+
+}
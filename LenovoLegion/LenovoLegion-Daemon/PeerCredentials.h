@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <QtGlobal>
+
+#include <filesystem>
+#include <limits>
+#include <optional>
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Credentials of the client whose request is being processed. The protocol processor sets them
+ * for the duration of the request, outside of a request the caller is the daemon itself
+ */
+class PeerCredentials
+{
+public:
+
+    static constexpr quint32 ROOT_UID   = 0;
+    static constexpr quint32 NOBODY_UID = std::numeric_limits<quint32>::max();
+
+    struct Credentials {
+        qint32  m_pid = -1;
+        quint32 m_uid = NOBODY_UID;         // kept when the credentials can not be read
+    };
+
+    class Scope
+    {
+    public:
+        explicit Scope(const Credentials& credentials);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        std::optional<Credentials> m_previous;
+    };
+
+public:
+
+    /*
+     * SO_PEERCRED of the connected unix socket, fixed at connect time
+     */
+    static Credentials read(qintptr socketDescriptor);
+
+    /*
+     * Empty outside of a client request
+     */
+    static const std::optional<Credentials>& current();
+
+    /*
+     * The daemon itself (settings, rules) or a root client
+     */
+    static bool isPrivileged();
+
+    /*
+     * Privileged caller or the owner of /proc/<pid>
+     */
+    static bool mayControl(qint32 pid,const std::filesystem::path& procRoot = "/proc");
+
+private:
+
+    static thread_local std::optional<Credentials> s_current;
+};
+
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "ProcInterrupts.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+
+namespace LenovoLegionDaemon {
+
+std::map<quint32,ProcInterrupts::Interrupt> ProcInterrupts::read(const std::filesystem::path &procRoot)
+{
+    const std::filesystem::path  path = procRoot / "interrupts";
+    std::map<quint32,Interrupt>  interrupts;
+    QFile                        file(path);
+
+    if(!file.open(QIODeviceBase::ReadOnly))
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::OPEN_FOR_READING_ERROR,std::string("I can not open file (").append(path.string()).append(") with permision=ReadOnly !").c_str());
+    }
+
+    QTextStream stream(&file);
+
+    /*
+     * Header has one column per online CPU
+     */
+    const qsizetype cpus = stream.readLine().split(' ',Qt::SkipEmptyParts).size();
+
+    for(QString line = stream.readLine(); !line.isNull(); line = stream.readLine())
+    {
+        const QStringList fields = line.split(' ',Qt::SkipEmptyParts);
+        bool              isNumber = false;
+
+        if(fields.isEmpty() || !fields.at(0).endsWith(':'))
+        {
+            continue;
+        }
+
+        const quint32 irq = fields.at(0).chopped(1).toUInt(&isNumber);
+
+        if(!isNumber)
+        {
+            continue;
+        }
+
+        /*
+         * <irq>: <count per CPU> <chip> <hwirq-type> <actions>
+         */
+        Interrupt interrupt;
+
+        for(qsizetype i = 1; i < fields.size() && i <= cpus; ++i)
+        {
+            interrupt.m_count += fields.at(i).toULongLong();
+        }
+
+        if(fields.size() > cpus + 1)
+        {
+            interrupt.m_chip = fields.at(cpus + 1);
+        }
+
+        if(fields.size() > cpus + 3)
+        {
+            interrupt.m_actions = fields.mid(cpus + 3).join(' ');
+        }
+        else if(fields.size() == cpus + 3)
+        {
+            interrupt.m_actions = fields.last();
+        }
+
+        interrupts[irq] = interrupt;
+    }
+
+    return interrupts;
+}
+
+}
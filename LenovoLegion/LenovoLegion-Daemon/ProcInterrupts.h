@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <Core/ExceptionBuilder.h>
+
+#include <QString>
+
+#include <filesystem>
+#include <map>
+
+namespace LenovoLegionDaemon {
+
+class ProcInterrupts
+{
+public:
+
+    DEFINE_EXCEPTION(ProcInterrupts);
+
+    enum ERROR_CODES : int {
+        OPEN_FOR_READING_ERROR  = 1
+    };
+
+    struct Interrupt {
+        quint64 m_count = 0;        // sum over all CPUs
+        QString m_chip;             // e.g. "IR-PCI-MSIX-0000:00:14.3"
+        QString m_actions;          // e.g. "iwlwifi:default_queue"
+    };
+
+public:
+
+    /*
+     * Read <procRoot>/interrupts, only the numbered interrupts are returned,
+     * the architecture counters (NMI, LOC, ...) can not be steered
+     */
+    static std::map<quint32,Interrupt> read(const std::filesystem::path& procRoot = "/proc");
+};
+
+}
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "ProcStat.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+
+#include <algorithm>
+
+namespace LenovoLegionDaemon {
+
+ProcStat::Snapshot ProcStat::read(const std::filesystem::path &procRoot)
+{
+    const std::filesystem::path path = procRoot / "stat";
+    Snapshot                    snapshot;
+    QFile                       file(path);
+
+    if(!file.open(QIODeviceBase::ReadOnly))
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::OPEN_FOR_READING_ERROR,std::string("I can not open file (").append(path.string()).append(") with permision=ReadOnly !").c_str());
+    }
+
+    QTextStream stream(&file);
+
+    for(QString line = stream.readLine(); !line.isNull(); line = stream.readLine())
+    {
+        if(!line.startsWith("cpu"))
+        {
+            continue;
+        }
+
+        const QStringList fields = line.split(' ',Qt::SkipEmptyParts);
+
+        if(fields.size() < 5)
+        {
+            continue;
+        }
+
+        /*
+         * user nice system idle iowait irq softirq steal, guest is already accounted in user
+         */
+        CPUTimes times;
+
+        for(qsizetype i = 1; i < fields.size() && i <= 8; ++i)
+        {
+            times.m_total += fields.at(i).toULongLong();
+        }
+
+        times.m_busy = times.m_total - fields.at(4).toULongLong() - (fields.size() > 5 ? fields.at(5).toULongLong() : 0);
+
+        if(fields.at(0) == "cpu")
+        {
+            snapshot.m_all = times;
+        }
+        else
+        {
+            const size_t cpu = fields.at(0).mid(3).toUInt();
+
+            snapshot.m_cpus.resize(std::max(snapshot.m_cpus.size(),cpu + 1));
+            snapshot.m_cpus[cpu] = times;
+        }
+    }
+
+    return snapshot;
+}
+
+quint32 ProcStat::utilization(const CPUTimes &previous, const CPUTimes &current)
+{
+    if(current.m_total <= previous.m_total || current.m_busy < previous.m_busy)
+    {
+        return 0;
+    }
+
+    return static_cast<quint32>(std::min<quint64>(100,(current.m_busy - previous.m_busy) * 100 / (current.m_total - previous.m_total)));
+}
+
+}
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <Core/ExceptionBuilder.h>
+
+#include <QtGlobal>
+
+#include <filesystem>
+#include <vector>
+
+namespace LenovoLegionDaemon {
+
+class ProcStat
+{
+public:
+
+    DEFINE_EXCEPTION(ProcStat);
+
+    enum ERROR_CODES : int {
+        OPEN_FOR_READING_ERROR  = 1
+    };
+
+    struct CPUTimes {
+        quint64 m_busy  = 0;
+        quint64 m_total = 0;
+    };
+
+    struct Snapshot {
+        CPUTimes                m_all;      // aggregated "cpu" line
+        std::vector<CPUTimes>   m_cpus;     // "cpuN" lines, indexed by N
+    };
+
+public:
+
+    /*
+     * Read <procRoot>/stat
+     */
+    static Snapshot read(const std::filesystem::path& procRoot = "/proc");
+
+    /*
+     * Utilization in percent between two samples
+     */
+    static quint32 utilization(const CPUTimes& previous,const CPUTimes& current);
+};
+
+}
@@ -0,0 +1,347 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "ProcessMonitor.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QFile>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace LenovoLegionDaemon {
+
+ProcessMonitor::ProcessMonitor(QObject* parent,const std::filesystem::path& procRoot) : QObject(parent),
+    m_procRoot(procRoot),
+    m_mode(NONE),
+    m_socket(-1),
+    m_socketNotifier(nullptr),
+    m_pollTimer(new QTimer(this))
+{
+    m_pollTimer->setInterval(POLL_PERIOD_MS);
+
+    connect(m_pollTimer,&QTimer::timeout,this,&ProcessMonitor::poll);
+}
+
+ProcessMonitor::~ProcessMonitor()
+{
+    stop();
+}
+
+void ProcessMonitor::start()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(m_mode != NONE)
+    {
+        return;
+    }
+
+    if(openNetlink())
+    {
+        m_mode = NETLINK;
+    }
+    else
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Proc connector not available, falling back to polling of " + m_procRoot.c_str());
+
+        m_pollPids = pids();
+        m_pollTimer->start();
+        m_mode     = POLLING;
+    }
+}
+
+void ProcessMonitor::stop()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    closeNetlink();
+
+    m_pollTimer->stop();
+    m_pollPids.clear();
+
+    m_mode = NONE;
+}
+
+ProcessMonitor::Mode ProcessMonitor::mode() const
+{
+    return m_mode;
+}
+
+const std::filesystem::path &ProcessMonitor::procRoot() const
+{
+    return m_procRoot;
+}
+
+std::vector<ProcessMonitor::Process> ProcessMonitor::processes() const
+{
+    std::vector<Process> result;
+
+    for(const auto pid : pids())
+    {
+        auto item = process(pid);
+
+        if(item.has_value())
+        {
+            result.push_back(std::move(item.value()));
+        }
+    }
+
+    return result;
+}
+
+std::optional<ProcessMonitor::Process> ProcessMonitor::process(qint32 pid) const
+{
+    const std::filesystem::path directory = m_procRoot / std::to_string(pid);
+    std::error_code             error;
+    Process                     result { .m_pid = pid };
+
+    /*
+     * Kernel threads have no executable, the process may also be gone already
+     */
+    const std::filesystem::path executable = std::filesystem::read_symlink(directory / "exe",error);
+
+    if(error || executable.empty())
+    {
+        return std::nullopt;
+    }
+
+    result.m_executable = QString::fromStdString(executable.string());
+
+    QFile file(directory / "cmdline");
+
+    if(file.open(QIODeviceBase::ReadOnly))
+    {
+        QByteArray cmdline = file.readAll();
+
+        cmdline.replace('\0',' ');
+
+        result.m_cmdline = QString::fromLocal8Bit(cmdline).trimmed();
+    }
+
+    return result;
+}
+
+bool ProcessMonitor::exists(qint32 pid) const
+{
+    std::error_code error;
+
+    return std::filesystem::exists(m_procRoot / std::to_string(pid),error);
+}
+
+bool ProcessMonitor::openNetlink()
+{
+    /*
+     * Only the real /proc belongs to the proc connector
+     */
+    if(m_procRoot != "/proc")
+    {
+        return false;
+    }
+
+    m_socket = ::socket(PF_NETLINK,SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,NETLINK_CONNECTOR);
+
+    if(m_socket < 0)
+    {
+        LOG_D(QString(__PRETTY_FUNCTION__) + "- Netlink socket error: " + std::strerror(errno));
+        return false;
+    }
+
+    sockaddr_nl address {};
+
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = CN_IDX_PROC;
+    address.nl_pid    = 0;
+
+    if(::bind(m_socket,reinterpret_cast<sockaddr*>(&address),sizeof(address)) < 0)
+    {
+        LOG_D(QString(__PRETTY_FUNCTION__) + "- Netlink bind error: " + std::strerror(errno));
+        closeNetlink();
+        return false;
+    }
+
+    /*
+     * cn_msg ends with a flexible array, the multicast operation follows it
+     */
+    alignas(nlmsghdr) char request[NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))] {};
+
+    nlmsghdr*              header    = reinterpret_cast<nlmsghdr*>(request);
+    cn_msg*                message   = static_cast<cn_msg*>(NLMSG_DATA(header));
+    const proc_cn_mcast_op operation = PROC_CN_MCAST_LISTEN;
+
+    header->nlmsg_len   = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+    header->nlmsg_type  = NLMSG_DONE;
+    header->nlmsg_pid   = static_cast<__u32>(::getpid());
+    message->id.idx     = CN_IDX_PROC;
+    message->id.val     = CN_VAL_PROC;
+    message->len        = sizeof(proc_cn_mcast_op);
+
+    std::memcpy(message->data,&operation,sizeof(operation));
+
+    if(::send(m_socket,request,header->nlmsg_len,0) < 0)
+    {
+        LOG_D(QString(__PRETTY_FUNCTION__) + "- Netlink subscribe error: " + std::strerror(errno));
+        closeNetlink();
+        return false;
+    }
+
+    m_socketNotifier = new QSocketNotifier(m_socket,QSocketNotifier::Read,this);
+
+    connect(m_socketNotifier,&QSocketNotifier::activated,this,&ProcessMonitor::onNetlinkData);
+
+    LOG_D(QString(__PRETTY_FUNCTION__) + "- Listening for proc connector events");
+
+    return true;
+}
+
+void ProcessMonitor::closeNetlink()
+{
+    if(m_socketNotifier != nullptr)
+    {
+        m_socketNotifier->setEnabled(false);
+        delete m_socketNotifier;
+        m_socketNotifier = nullptr;
+    }
+
+    if(m_socket >= 0)
+    {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+}
+
+void ProcessMonitor::onNetlinkData()
+{
+    alignas(nlmsghdr) char buffer[RECEIVE_BUFFER_SIZE];
+
+    for(;;)
+    {
+        sockaddr_nl address {};
+        socklen_t   addressLength = sizeof(address);
+
+        const ssize_t received = ::recvfrom(m_socket,buffer,sizeof(buffer),0,reinterpret_cast<sockaddr*>(&address),&addressLength);
+
+        if(received < 0)
+        {
+            if(errno == ENOBUFS)
+            {
+                LOG_W(QString(__PRETTY_FUNCTION__) + "- Proc connector events lost");
+                emit overrun();
+                continue;
+            }
+
+            if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                LOG_W(QString(__PRETTY_FUNCTION__) + "- Netlink receive error: " + std::strerror(errno));
+            }
+
+            return;
+        }
+
+        /*
+         * Only the kernel is trusted
+         */
+        if(address.nl_pid != 0)
+        {
+            continue;
+        }
+
+        int length = static_cast<int>(received);
+
+        for(nlmsghdr* header = reinterpret_cast<nlmsghdr*>(buffer); NLMSG_OK(header,length); header = NLMSG_NEXT(header,length))
+        {
+            if(header->nlmsg_type == NLMSG_NOOP || header->nlmsg_type == NLMSG_ERROR)
+            {
+                continue;
+            }
+
+            const cn_msg* message = static_cast<const cn_msg*>(NLMSG_DATA(header));
+
+            if(message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC || message->len < sizeof(proc_event))
+            {
+                continue;
+            }
+
+            const proc_event* event = reinterpret_cast<const proc_event*>(message->data);
+
+            /*
+             * Threads are not interesting, only the thread group leader
+             */
+            if(event->what == proc_event::PROC_EVENT_EXEC && event->event_data.exec.process_pid == event->event_data.exec.process_tgid)
+            {
+                const auto item = process(event->event_data.exec.process_tgid);
+
+                if(item.has_value())
+                {
+                    emit processStarted(item.value());
+                }
+            }
+            else if(event->what == proc_event::PROC_EVENT_EXIT && event->event_data.exit.process_pid == event->event_data.exit.process_tgid)
+            {
+                emit processExited(event->event_data.exit.process_tgid);
+            }
+        }
+    }
+}
+
+void ProcessMonitor::poll()
+{
+    const std::set<qint32> current = pids();
+
+    for(const auto pid : m_pollPids)
+    {
+        if(!current.contains(pid))
+        {
+            emit processExited(pid);
+        }
+    }
+
+    for(const auto pid : current)
+    {
+        if(!m_pollPids.contains(pid))
+        {
+            const auto item = process(pid);
+
+            if(item.has_value())
+            {
+                emit processStarted(item.value());
+            }
+        }
+    }
+
+    m_pollPids = current;
+}
+
+std::set<qint32> ProcessMonitor::pids() const
+{
+    std::set<qint32> result;
+    std::error_code  error;
+
+    for(const auto& entry : std::filesystem::directory_iterator(m_procRoot,error))
+    {
+        const std::string name = entry.path().filename().string();
+
+        if(!name.empty() && std::all_of(name.begin(),name.end(),[](char c){ return c >= '0' && c <= '9'; }))
+        {
+            result.insert(std::stoi(name));
+        }
+    }
+
+    return result;
+}
+
+}
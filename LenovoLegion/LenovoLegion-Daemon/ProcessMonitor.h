@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+#include <filesystem>
+#include <optional>
+#include <set>
+#include <vector>
+
+class QSocketNotifier;
+class QTimer;
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Process exec/exit notifications, the netlink proc connector is used when the kernel
+ * and our capabilities allow it, otherwise /proc is scanned periodically
+ */
+class ProcessMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    enum Mode : quint8 {
+        NONE        = 0,
+        NETLINK     = 1,
+        POLLING     = 2
+    };
+
+    struct Process {
+        qint32  m_pid = 0;
+        QString m_executable;
+        QString m_cmdline;
+    };
+
+public:
+
+    ProcessMonitor(QObject* parent,const std::filesystem::path& procRoot = "/proc");
+    ~ProcessMonitor() override;
+
+    void start();
+    void stop();
+
+    Mode mode() const;
+
+    const std::filesystem::path& procRoot() const;
+
+    /*
+     * Currently running processes, kernel threads are skipped
+     */
+    std::vector<Process> processes() const;
+
+    std::optional<Process> process(qint32 pid) const;
+
+    bool exists(qint32 pid) const;
+
+signals:
+
+    void processStarted(const LenovoLegionDaemon::ProcessMonitor::Process& process);
+    void processExited(qint32 pid);
+
+    /*
+     * Events were lost, listeners should check the processes they track
+     */
+    void overrun();
+
+private:
+
+    bool openNetlink();
+    void closeNetlink();
+
+    void onNetlinkData();
+    void poll();
+
+    std::set<qint32> pids() const;
+
+private:
+
+    const std::filesystem::path m_procRoot;
+
+    Mode                        m_mode;
+
+    int                         m_socket;
+    QSocketNotifier*            m_socketNotifier;
+
+    QTimer*                     m_pollTimer;
+    std::set<qint32>            m_pollPids;
+
+public:
+
+    static constexpr int        POLL_PERIOD_MS      = 1000;
+    static constexpr size_t     RECEIVE_BUFFER_SIZE = 8192;
+};
+
+}
@@ -9,18 +9,26 @@
 #include "ProtocolParser.h"
 #include "Message.h"
 #include "DataProviderManager.h"
+#include "DaemonSettingsManager.h"
+#include "LatencyStatistics.h"
+#include "Tracer.h"
 
 #include <Core/LoggerHolder.h>
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QScopeGuard>
 
 
 namespace LenovoLegionDaemon {
 
 ProtocolProcessor::ProtocolProcessor(DataProviderManager* dataProviderManager,QLocalSocket* clientSocket,QObject* parent) :
     ProtocolProcessorBase(clientSocket,parent),
-    m_dataProviderManager(dataProviderManager)
-{}
+    m_dataProviderManager(dataProviderManager),
+    m_peer(PeerCredentials::read(clientSocket->socketDescriptor()))
+{
+    LOGF_D("Client connected: pid={}, uid={}",m_peer.m_pid,m_peer.m_uid);
+}
 
 ProtocolProcessor::~ProtocolProcessor()
 {
@@ -64,15 +72,41 @@ void ProtocolProcessor::readyReadHandler()
         return;
     }
 
-    ProtocolParser::parseMessage(*m_clientSocket,[this](const MessageHeader& header,const QByteArray& data ){
+    TRACE_SPAN("ipc","request");
+
+    QElapsedTimer           timer;
+    PeerCredentials::Scope  peerScope(m_peer);
+
+    timer.start();
+
+    ProtocolParser::parseMessage(*m_clientSocket,[this,&timer](const MessageHeader& header,const QByteArray& data ){
+
+        LatencyStatistics& statistics = LatencyStatistics::getInstance();
+
+        auto lap = [&timer]() -> quint64 {
+            const quint64 nsecs = timer.nsecsElapsed();
+            timer.restart();
+            return nsecs;
+        };
 
-        LOG_T(QString("Message header was readed: header.m_type= ").append(QString::number(header.m_type)).append(", header.m_dataType=").append(QString::number(header.m_dataType)).append(", header.m_dataLength=").append(QString::number(header.m_dataLength)));
+        statistics.recordProvider(header.m_dataType,LatencyStatistics::PARSE,lap());
+
+        LOGF_T("Message header was readed: header.m_type= {}, header.m_dataType={}, header.m_dataLength={}",header.m_type,header.m_dataType,header.m_dataLength);
+
+        auto errorGuard = qScopeGuard([&statistics,&header](){
+            statistics.recordProviderError(header.m_dataType);
+        });
 
         switch (header.m_type) {
         case MessageHeader::GET_DATA_REQUEST: {
             if(data.size() > 0)
             {
-                QByteArray reponse = m_dataProviderManager->getDataProvider(header.m_dataType).serializeAndGetData(data);
+                QByteArray reponse;
+                {
+                    TRACE_SPAN("provider","serializeAndGetData",header.m_dataType);
+                    reponse = m_dataProviderManager->getDataProvider(header.m_dataType).serializeAndGetData(data);
+                }
+                statistics.recordProvider(header.m_dataType,LatencyStatistics::GET_DATA,lap());
                 m_clientSocket->write(
                     ProtocolParser::parseMessage(
                         MessageHeader {
@@ -86,7 +120,12 @@ void ProtocolProcessor::readyReadHandler()
             }
             else
             {
-                QByteArray reponse = m_dataProviderManager->getDataProvider(header.m_dataType).serializeAndGetData();
+                QByteArray reponse;
+                {
+                    TRACE_SPAN("provider","serializeAndGetData",header.m_dataType);
+                    reponse = m_dataProviderManager->getDataProvider(header.m_dataType).serializeAndGetData();
+                }
+                statistics.recordProvider(header.m_dataType,LatencyStatistics::GET_DATA,lap());
                 m_clientSocket->write(
                     ProtocolParser::parseMessage(
                         MessageHeader {
@@ -101,7 +140,13 @@ void ProtocolProcessor::readyReadHandler()
         }
             break;
         case MessageHeader::SET_DATA_REQUEST: {
-            QByteArray reponse = m_dataProviderManager->getDataProvider(header.m_dataType).deserializeAndSetData(data);
+            QByteArray reponse;
+            {
+                TRACE_SPAN("provider","deserializeAndSetData",header.m_dataType);
+                reponse = m_dataProviderManager->getDataProvider(header.m_dataType).deserializeAndSetData(data);
+            }
+            statistics.recordProvider(header.m_dataType,LatencyStatistics::SET_DATA,lap());
+            DaemonSettingsManager::getInstance().recordChange(header.m_dataType);
             m_clientSocket->write(
                 ProtocolParser::parseMessage(
                     MessageHeader {
@@ -129,6 +174,13 @@ void ProtocolProcessor::readyReadHandler()
             break;
         }
 
+        if(header.m_type == MessageHeader::GET_DATA_REQUEST || header.m_type == MessageHeader::SET_DATA_REQUEST)
+        {
+            statistics.recordProvider(header.m_dataType,LatencyStatistics::SOCKET_WRITE,lap());
+        }
+
+        errorGuard.dismiss();
+
         LOG_T(QString("Message received: done !"));
     });
 }
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "ProtocolProcessorBase.h"
+#include "PeerCredentials.h"
 
 #include <Core/ExceptionBuilder.h>
 
@@ -43,7 +44,8 @@ private:
 
 private:
 
-    DataProviderManager*     m_dataProviderManager;
+    DataProviderManager*            m_dataProviderManager;
+    PeerCredentials::Credentials    m_peer;
 };
 
 }
@@ -15,6 +15,8 @@
 #include "SysFsDriverCPUXList.h"
 #include "SysFsDriverLegion.h"
 #include "SysFsDriverLegionEvents.h"
+#include "SysFsDataProviderThrottleDetector.h"
+#include "DataProviderNvidiaNvml.h"
 
 #include "../LenovoLegion-PrepareBuild/Notification.pb.h"
 
@@ -67,7 +69,7 @@ void ProtocolProcessorNotifier::disconnectedHandler()
 
 void ProtocolProcessorNotifier::kernelEventHandler(const LenovoLegionDaemon::SysFsDriver::SubsystemEvent &event)
 {
-    LOG_T("ProtocolProcessorNotifier: kernelEventHandler m_driverName=" + event.m_driverName + ", event.m_action=" + QString::number(static_cast<int>(event.m_action)) + ", m_DriverSpecificAction=" + QString(event.m_DriverSpecificEventType.data()) + ", m_DriverSpecificValue=" + event.m_DriverSpecificEventValue.data());
+    LOGF_T("ProtocolProcessorNotifier: kernelEventHandler m_driverName={}, event.m_action={}, m_DriverSpecificAction={}, m_DriverSpecificValue={}",event.m_driverName,event.m_action,event.m_DriverSpecificEventType,event.m_DriverSpecificEventValue);
 
     if(!isRunning())
     {
@@ -140,7 +142,7 @@ void ProtocolProcessorNotifier::kernelEventHandler(const LenovoLegionDaemon::Sys
 
 void ProtocolProcessorNotifier::moduleSubsystemHandler(const LenovoLegionDaemon::SysFsDriverManager::ModuleSubsystemEvent &event)
 {
-    LOG_T("ProtocolProcessorNotifier: moduleSubsystemHandler " + event.m_moduleName + " " + QString::number(static_cast<int>(event.m_action)));
+    LOGF_T("ProtocolProcessorNotifier: moduleSubsystemHandler {} {}",event.m_moduleName,event.m_action);
 
     legion::messages::Notification msg;
 
@@ -177,6 +179,64 @@ void ProtocolProcessorNotifier::moduleSubsystemHandler(const LenovoLegionDaemon:
         }
 
 
+        m_clientSocket->write(ProtocolParser::parseMessage(MessageHeader{
+                                                               .m_type         = MessageHeader::NOTIFICATION,
+                                                               .m_dataType     = m_dataType,
+                                                               .m_dataLength   = data.length()
+                                                           },data));
+    }
+}
+
+void ProtocolProcessorNotifier::dataProviderEventHandler(const LenovoLegionDaemon::DataProvider::DataProviderEvent &event)
+{
+    LOGF_T("ProtocolProcessorNotifier: dataProviderEventHandler m_dataType={}, m_eventType={}, m_eventValue={}",event.m_dataType,event.m_eventType,event.m_eventValue);
+
+    legion::messages::Notification msg;
+
+
+    if(!isRunning())
+    {
+        LOG_T("ProtocolProcessorNotifier is not running, ignoring data provider event !");
+        return;
+    }
+
+
+    if(event.m_dataType == SysFsDataProviderThrottleDetector::dataType)
+    {
+        if(event.m_eventType.toInt() == SysFsDataProviderThrottleDetector::EPISODE_STARTED)
+        {
+            msg.set_action(legion::messages::Notification::THROTTLE_EPISODE_STARTED);
+            msg.set_throttle_reason(static_cast<legion::messages::Notification_ThrottleReason>(event.m_eventValue.toUInt()));
+        }
+    }
+
+    if(event.m_dataType == DataProviderNvidiaNvml::dataType)
+    {
+        if(event.m_eventType.toInt() == DataProviderNvidiaNvml::THROTTLE_REASONS_CHANGED)
+        {
+            msg.set_action(legion::messages::Notification::GPU_THROTTLE_REASONS_CHANGE);
+            msg.set_gpu_throttle_reasons(event.m_eventValue.toULongLong());
+        }
+
+        if(event.m_eventType.toInt() == DataProviderNvidiaNvml::XID_ERROR)
+        {
+            msg.set_action(legion::messages::Notification::GPU_XID_ERROR);
+            msg.set_gpu_xid(event.m_eventValue.toUInt());
+        }
+    }
+
+    if(msg.has_action())
+    {
+        QByteArray data;
+
+        data.resize(msg.ByteSizeLong());
+
+        if(!msg.SerializeToArray(data.data(),data.size()))
+        {
+            THROW_EXCEPTION(exception_T,ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+        }
+
+
         m_clientSocket->write(ProtocolParser::parseMessage(MessageHeader{
                                                                .m_type         = MessageHeader::NOTIFICATION,
                                                                .m_dataType     = m_dataType,
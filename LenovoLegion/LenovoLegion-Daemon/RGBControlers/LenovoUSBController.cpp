@@ -11,6 +11,7 @@
 #include <Core/LoggerHolder.h>
 
 #include "StringUtils.h"
+#include "Tracer.h"
 
 #include <iomanip>
 #include <sstream>
@@ -530,6 +531,8 @@ void LenovoUSBController::sendFeatureReport(const ByteArray& packet) const
 {
     LOG_T(QString::asprintf("LenovoUSBController::sendFeatureReport: Sending packet: %s", convertBytesArrayToHex(packet).c_str()));
 
+    TRACE_SPAN("hid","sendFeatureReport",packet.size());
+
     int ret = hid_send_feature_report(m_dev, packet.data(), packet.size());
     if(ret < 0)
     {
@@ -554,6 +557,8 @@ LenovoUSBController::ByteArray LenovoUSBController::getFeatureReport() const
 {
     ByteArray response(PACKET_SIZE, REPORT_ID);
 
+    TRACE_SPAN("hid","getFeatureReport",response.size());
+
     int ret = hid_get_feature_report(m_dev, response.data(), response.size());
     if(ret < 0)
     {
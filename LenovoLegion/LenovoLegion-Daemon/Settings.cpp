@@ -6,42 +6,322 @@
  *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
  */
 #include <Settings.h>
+#include <SettingsStore.h>
 #include <Core/Application.h>
+#include <Core/LoggerHolder.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QSettings>
+
+#include <memory>
 
 namespace LenovoLegionDaemon {
 
+namespace {
+
+/*
+ * Readers of the INI groups, the layout of the previous versions
+ */
+void readIniPowerProfile(QSettings& ini,legion::messages::PowerProfile &profile)
+{
+    if (ini.contains("PowerProfile")) {
+        profile.set_current_value(static_cast<legion::messages::PowerProfile::Profiles>(
+            ini.value("PowerProfile").toUInt()));
+    }
+
+    if(ini.contains("custom_fnq_enabled")) {
+        profile.mutable_custom_fnq_enabled()->set_current_value(ini.value("custom_fnq_enabled").toBool());
+    }
+}
+
+void readIniCPUControlData(QSettings& ini,legion::messages::CPUOptions &profile)
+{
+    size_t size = ini.beginReadArray("CPUControl");
+    for (size_t i = 0; i < size; ++i) {
+        legion::messages::CPUOptions::CPUX* cpux = profile.add_cpus();
+        ini.setArrayIndex(i);
+        if (ini.contains("online")) {
+            cpux->set_cpu_online(ini.value("online").toBool());
+        }
+        if (ini.contains("governor")) {
+            cpux->set_governor(ini.value("governor").toString().toStdString());
+        }
+    }
+    ini.endArray();
+}
+
+void readIniCPUFrequency(QSettings& ini,legion::messages::CPUFrequency &frequency)
+{
+    size_t size = ini.beginReadArray("CPUFrequency");
+    for (size_t i = 0; i < size; ++i) {
+        legion::messages::CPUFrequency::CPUX* cpux = frequency.add_cpus();
+        ini.setArrayIndex(i);
+        if (ini.contains("scaling_min_freq")) {
+            cpux->set_scaling_min_freq(ini.value("scaling_min_freq").toUInt());
+        }
+        if (ini.contains("scaling_max_freq")) {
+            cpux->set_scaling_max_freq(ini.value("scaling_max_freq").toUInt());
+        }
+    }
+    ini.endArray();
+}
+
+void readIniFanCurve(QSettings& ini,legion::messages::FanCurve &fanCurve)
+{
+    if (ini.contains("point1")) {
+        fanCurve.mutable_current_value()->set_point1(ini.value("point1").toInt());
+    }
+    if (ini.contains("point2")) {
+        fanCurve.mutable_current_value()->set_point2(ini.value("point2").toInt());
+    }
+    if (ini.contains("point3")) {
+        fanCurve.mutable_current_value()->set_point3(ini.value("point3").toInt());
+    }
+    if (ini.contains("point4")) {
+        fanCurve.mutable_current_value()->set_point4(ini.value("point4").toInt());
+    }
+    if (ini.contains("point5")) {
+        fanCurve.mutable_current_value()->set_point5(ini.value("point5").toInt());
+    }
+    if (ini.contains("point6")) {
+        fanCurve.mutable_current_value()->set_point6(ini.value("point6").toInt());
+    }
+    if (ini.contains("point7")) {
+        fanCurve.mutable_current_value()->set_point7(ini.value("point7").toInt());
+    }
+    if (ini.contains("point8")) {
+        fanCurve.mutable_current_value()->set_point8(ini.value("point8").toInt());
+    }
+    if (ini.contains("point9")) {
+        fanCurve.mutable_current_value()->set_point9(ini.value("point9").toInt());
+    }
+    if (ini.contains("point10")) {
+        fanCurve.mutable_current_value()->set_point10(ini.value("point10").toInt());
+    }
+}
+
+void readIniFanOption(QSettings& ini,legion::messages::FanOption &fanOption)
+{
+    if (ini.contains("full_speed")) {
+        fanOption.mutable_full_speed()->set_current_value(ini.value("full_speed").toBool());
+    }
+}
+
+void readIniCPUSMT(QSettings& ini,legion::messages::CPUSMT &cpuSmt)
+{
+    if (ini.contains("control")) {
+        cpuSmt.set_control(ini.value("control").toString().toStdString());
+    }
+}
+
+void readIniCPUPower(QSettings& ini,legion::messages::CPUPower &cpuPower)
+{
+    if (ini.contains("cpu_stp_limit")) {
+        cpuPower.mutable_cpu_stp_limit()->set_current_value(ini.value("cpu_stp_limit").toUInt());
+    }
+    if (ini.contains("cpu_ltp_limit")) {
+        cpuPower.mutable_cpu_ltp_limit()->set_current_value(ini.value("cpu_ltp_limit").toUInt());
+    }
+    if (ini.contains("cpu_clp_limit")) {
+        cpuPower.mutable_cpu_clp_limit()->set_current_value(ini.value("cpu_clp_limit").toUInt());
+    }
+    if (ini.contains("cpu_tmp_limit")) {
+        cpuPower.mutable_cpu_tmp_limit()->set_current_value(ini.value("cpu_tmp_limit").toUInt());
+    }
+    if (ini.contains("cpu_pl1_tau")) {
+        cpuPower.mutable_cpu_pl1_tau()->set_current_value(ini.value("cpu_pl1_tau").toUInt());
+    }
+    if (ini.contains("gpu_total_onac")) {
+        cpuPower.mutable_gpu_total_onac()->set_current_value(ini.value("gpu_total_onac").toUInt());
+    }
+    if (ini.contains("gpu_to_cpu_dynamic_boost")) {
+        cpuPower.mutable_gpu_to_cpu_dynamic_boost()->set_current_value(ini.value("gpu_to_cpu_dynamic_boost").toUInt());
+    }
+}
+
+void readIniGPUPower(QSettings& ini,legion::messages::GPUPower &gpuPower)
+{
+    if (ini.contains("gpu_power_boost")) {
+        gpuPower.mutable_gpu_power_boost()->set_current_value(ini.value("gpu_power_boost").toUInt());
+    }
+    if (ini.contains("gpu_configurable_tgp")) {
+        gpuPower.mutable_gpu_configurable_tgp()->set_current_value(ini.value("gpu_configurable_tgp").toUInt());
+    }
+    if (ini.contains("gpu_temperature_limit")) {
+        gpuPower.mutable_gpu_temperature_limit()->set_current_value(ini.value("gpu_temperature_limit").toUInt());
+    }
+}
+
+void readIniNvidiaNvml(QSettings& ini,legion::messages::NvidiaNvml &nvidiaNvml)
+{
+    if (ini.contains("gpu_offset")) {
+        nvidiaNvml.mutable_gpu_offset()->set_value(ini.value("gpu_offset").toInt());
+    }
+    if (ini.contains("memory_offset")) {
+        nvidiaNvml.mutable_memory_offset()->set_value(ini.value("memory_offset").toInt());
+    }
+}
+
+void readIniDaemonSettings(QSettings& ini,legion::messages::DaemonSettings &daemonSettings)
+{
+    daemonSettings.set_apply_settings_on_start(ini.value("apply_settings_on_start", true).toBool());
+    daemonSettings.set_save_settings_on_exit(ini.value("save_settings_on_exit", true).toBool());
+    daemonSettings.set_debug_logging(ini.value("debug_logging", false).toBool());
+    daemonSettings.set_trace_logging(ini.value("trace_logging", false).toBool());
+}
+
+void readIniIntelMSR(QSettings& ini,legion::messages::CpuIntelMSR &intelMSR)
+{
+    if (ini.contains("analogio_offset")) {
+        intelMSR.mutable_analogio()->set_offset(ini.value("analogio_offset").toInt());
+    }
+    if (ini.contains("cache_offset")) {
+        intelMSR.mutable_cache()->set_offset(ini.value("cache_offset").toInt());
+    }
+    if (ini.contains("cpu_offset")) {
+        intelMSR.mutable_cpu()->set_offset(ini.value("cpu_offset").toInt());
+    }
+    if (ini.contains("gpu_offset")) {
+        intelMSR.mutable_gpu()->set_offset(ini.value("gpu_offset").toInt());
+    }
+    if (ini.contains("uncore_offset")) {
+        intelMSR.mutable_uncore()->set_offset(ini.value("uncore_offset").toInt());
+    }
+}
+
+void readIniOther(QSettings& ini,legion::messages::OtherSettings &otherSettings)
+{
+    if (ini.contains("disable_touchpad")) {
+        otherSettings.mutable_touch_pad()->set_current(ini.value("disable_touchpad").toBool());
+    }
+    if (ini.contains("disable_win_key")) {
+        otherSettings.mutable_win_key()->set_current(ini.value("disable_win_key").toBool());
+    }
+}
+
+/*
+ * Group present in the INI read with reader and stored with saver
+ */
+template<class MessageT,class SaverT>
+void migrateGroup(QSettings& ini,const QString& group,void (*reader)(QSettings&,MessageT&),SaverT& (SaverT::*saver)(const MessageT&))
+{
+    if(!ini.childGroups().contains(group))
+    {
+        return;
+    }
+
+    MessageT message;
+    SaverT   settingsSaver;
+
+    ini.beginGroup(group);
+    reader(ini,message);
+    ini.endGroup();
+
+    (settingsSaver.*saver)(message);
+}
+
+}
+
 Settings::Settings(const QString &group) :
-    m_settings(QCoreApplication::applicationDirPath()
-               .append(QDir::separator())
-               .append(bj::framework::Application::data_dir)
-               .append(QDir::separator())
-               .append("/LenovoLegion-Daemon.ini"), QSettings::IniFormat)
+    m_group(group)
 {
-    m_settings.setValue("LenovoLegion", "LenovoLegion-Daemon");
-    m_settings.beginGroup(group);
 }
 
 Settings::~Settings()
 {
-    m_settings.endGroup();
 }
 
-SettingsLoaderPowerProfiles::SettingsLoaderPowerProfiles() :
-    Settings("PowerProfileData")
+bool Settings::load(google::protobuf::Message &message) const
 {
+    std::string data;
+
+    if(!SettingsStore::getInstance().get(m_group,data))
+    {
+        return false;
+    }
+
+    return message.MergeFromString(data);
 }
 
-SettingsLoaderPowerProfiles& SettingsLoaderPowerProfiles::loadPowerProfile(legion::messages::PowerProfile &profile)
+void Settings::save(const google::protobuf::Message &message)
 {
-    if (m_settings.contains("PowerProfile")) {
-        profile.set_current_value(static_cast<legion::messages::PowerProfile::Profiles>(
-            m_settings.value("PowerProfile").toUInt()));
+    std::string data;
+
+    if(!message.SerializeToString(&data))
+    {
+        THROW_EXCEPTION(SettingsStore::exception_T,SettingsStore::ERROR_CODES::INVALID_DATA,"Serialize of settings group error !");
     }
 
-    if(m_settings.contains("custom_fnq_enabled")) {
-        profile.mutable_custom_fnq_enabled()->set_current_value(m_settings.value("custom_fnq_enabled").toBool());
+    SettingsStore::getInstance().set(m_group,data);
+}
+
+void Settings::update(const google::protobuf::Message &message)
+{
+    std::unique_ptr<google::protobuf::Message> merged(message.New());
+
+    load(*merged);
+    merged->MergeFrom(message);
+
+    save(*merged);
+}
+
+bool SettingsMigrationIni::migrate()
+{
+    if(SettingsStore::getInstance().exists() || !QFile::exists(path()))
+    {
+        return false;
     }
 
+    QSettings           ini(path(), QSettings::IniFormat);
+    SettingsStore::Batch batch;
+
+    LOG_I(QString("Migration of settings from ") + path() + " to " + SettingsStore::path());
+
+    migrateGroup<legion::messages::PowerProfile,SettingsSaverPowerProfiles>(ini,"PowerProfileData",readIniPowerProfile,&SettingsSaverPowerProfiles::saverPowerProfile);
+    migrateGroup<legion::messages::CPUOptions,SettingsSaverCPUControlData>(ini,"CPUsControlData",readIniCPUControlData,&SettingsSaverCPUControlData::saverPowerProfile);
+    migrateGroup<legion::messages::CPUFrequency,SettingsSaverCPUFrequency>(ini,"CPUFrequencyData",readIniCPUFrequency,&SettingsSaverCPUFrequency::saveCPUFrequency);
+    migrateGroup<legion::messages::FanCurve,SettingsSaverFanCurve>(ini,"FanCurveData",readIniFanCurve,&SettingsSaverFanCurve::saveFanCurve);
+    migrateGroup<legion::messages::FanOption,SettingsSaverFanOption>(ini,"FanOptionData",readIniFanOption,&SettingsSaverFanOption::saveFanOption);
+    migrateGroup<legion::messages::CPUSMT,SettingsSaverCPUSMT>(ini,"CPUSMTData",readIniCPUSMT,&SettingsSaverCPUSMT::saveCPUSMT);
+    migrateGroup<legion::messages::CPUPower,SettingsSaverCPUPower>(ini,"CPUPowerData",readIniCPUPower,&SettingsSaverCPUPower::saveCPUPower);
+    migrateGroup<legion::messages::GPUPower,SettingsSaverGPUPower>(ini,"GPUPowerData",readIniGPUPower,&SettingsSaverGPUPower::saveGPUPower);
+    migrateGroup<legion::messages::NvidiaNvml,SettingsSaverNvidiaNvml>(ini,"NvidiaNvmlData",readIniNvidiaNvml,&SettingsSaverNvidiaNvml::saveNvidiaNvml);
+    migrateGroup<legion::messages::CpuIntelMSR,SettingsSaverIntelMSR>(ini,"IntelMSRData",readIniIntelMSR,&SettingsSaverIntelMSR::saveIntelMSR);
+    migrateGroup<legion::messages::OtherSettings,SettingsSaverOther>(ini,"OtherData",readIniOther,&SettingsSaverOther::saveOther);
+
+    /*
+     * Always written, so the snapshot exists after the migration even for an empty INI
+     */
+    legion::messages::DaemonSettings daemonSettings;
+
+    ini.beginGroup("DaemonSettings");
+    readIniDaemonSettings(ini,daemonSettings);
+    ini.endGroup();
+
+    SettingsSaverDaemonSettings().saveDaemonSettings(daemonSettings);
+
+    return true;
+}
+
+QString SettingsMigrationIni::path()
+{
+    return QCoreApplication::applicationDirPath()
+               .append(QDir::separator())
+               .append(bj::framework::Application::data_dir)
+               .append(QDir::separator())
+               .append("/LenovoLegion-Daemon.ini");
+}
+
+SettingsLoaderPowerProfiles::SettingsLoaderPowerProfiles() :
+    Settings("PowerProfileData")
+{
+}
+
+SettingsLoaderPowerProfiles& SettingsLoaderPowerProfiles::loadPowerProfile(legion::messages::PowerProfile &profile)
+{
+    load(profile);
     return *this;
 }
 
@@ -52,8 +332,10 @@ SettingsSaverPowerProfiles::SettingsSaverPowerProfiles() :
 
 SettingsSaverPowerProfiles& SettingsSaverPowerProfiles::saverPowerProfile(const legion::messages::PowerProfile &profile)
 {
-    m_settings.setValue("PowerProfile", static_cast<quint32>(profile.current_value()));
-    m_settings.setValue("custom_fnq_enabled", profile.custom_fnq_enabled().current_value());
+    legion::messages::PowerProfile saved;
+    saved.set_current_value(profile.current_value());
+    saved.mutable_custom_fnq_enabled()->set_current_value(profile.custom_fnq_enabled().current_value());
+    save(saved);
     return *this;
 }
 
@@ -64,18 +346,7 @@ SettingsLoaderCPUControlData::SettingsLoaderCPUControlData() :
 
 SettingsLoaderCPUControlData& SettingsLoaderCPUControlData::loadPowerProfile(legion::messages::CPUOptions &profile)
 {
-    size_t size = m_settings.beginReadArray("CPUControl");
-    for (size_t i = 0; i < size; ++i) {
-        legion::messages::CPUOptions::CPUX* cpux = profile.add_cpus();
-        m_settings.setArrayIndex(i);
-        if (m_settings.contains("online")) {
-            cpux->set_cpu_online(m_settings.value("online").toBool());
-        }
-        if (m_settings.contains("governor")) {
-            cpux->set_governor(m_settings.value("governor").toString().toStdString());
-        }
-    }
-    m_settings.endArray();
+    load(profile);
     return *this;
 }
 
@@ -86,13 +357,13 @@ SettingsSaverCPUControlData::SettingsSaverCPUControlData() :
 
 SettingsSaverCPUControlData& SettingsSaverCPUControlData::saverPowerProfile(const legion::messages::CPUOptions &profile)
 {
-    m_settings.beginWriteArray("CPUControl");
+    legion::messages::CPUOptions saved;
     for (int i = 0; i < profile.cpus().size(); ++i) {
-        m_settings.setArrayIndex(i);
-        m_settings.setValue("online", profile.cpus().at(i).cpu_online());
-        m_settings.setValue("governor", QString(profile.cpus().at(i).governor().data()).trimmed());
+        legion::messages::CPUOptions::CPUX* cpux = saved.add_cpus();
+        cpux->set_cpu_online(profile.cpus().at(i).cpu_online());
+        cpux->set_governor(QString::fromStdString(std::string(profile.cpus().at(i).governor())).trimmed().toStdString());
     }
-    m_settings.endArray();
+    save(saved);
     return *this;
 }
 
@@ -104,18 +375,7 @@ SettingsLoaderCPUFrequency::SettingsLoaderCPUFrequency() :
 
 SettingsLoaderCPUFrequency& SettingsLoaderCPUFrequency::loadCPUFrequency(legion::messages::CPUFrequency &frequency)
 {
-    size_t size = m_settings.beginReadArray("CPUFrequency");
-    for (size_t i = 0; i < size; ++i) {
-        legion::messages::CPUFrequency::CPUX* cpux = frequency.add_cpus();
-        m_settings.setArrayIndex(i);
-        if (m_settings.contains("scaling_min_freq")) {
-            cpux->set_scaling_min_freq(m_settings.value("scaling_min_freq").toUInt());
-        }
-        if (m_settings.contains("scaling_max_freq")) {
-            cpux->set_scaling_max_freq(m_settings.value("scaling_max_freq").toUInt());
-        }
-    }
-    m_settings.endArray();
+    load(frequency);
     return *this;
 }
 
@@ -126,13 +386,13 @@ SettingsSaverCPUFrequency::SettingsSaverCPUFrequency() :
 
 SettingsSaverCPUFrequency& SettingsSaverCPUFrequency::saveCPUFrequency(const legion::messages::CPUFrequency &frequency)
 {
-    m_settings.beginWriteArray("CPUFrequency");
+    legion::messages::CPUFrequency saved;
     for (int i = 0; i < frequency.cpus().size(); ++i) {
-        m_settings.setArrayIndex(i);
-        m_settings.setValue("scaling_min_freq", frequency.cpus().at(i).scaling_min_freq());
-        m_settings.setValue("scaling_max_freq", frequency.cpus().at(i).scaling_max_freq());
+        legion::messages::CPUFrequency::CPUX* cpux = saved.add_cpus();
+        cpux->set_scaling_min_freq(frequency.cpus().at(i).scaling_min_freq());
+        cpux->set_scaling_max_freq(frequency.cpus().at(i).scaling_max_freq());
     }
-    m_settings.endArray();
+    save(saved);
     return *this;
 }
 
@@ -144,36 +404,7 @@ SettingsLoaderFanCurve::SettingsLoaderFanCurve() :
 
 SettingsLoaderFanCurve& SettingsLoaderFanCurve::loadFanCurve(legion::messages::FanCurve &fanCurve)
 {
-    if (m_settings.contains("point1")) {
-        fanCurve.mutable_current_value()->set_point1(m_settings.value("point1").toInt());
-    }
-    if (m_settings.contains("point2")) {
-        fanCurve.mutable_current_value()->set_point2(m_settings.value("point2").toInt());
-    }
-    if (m_settings.contains("point3")) {
-        fanCurve.mutable_current_value()->set_point3(m_settings.value("point3").toInt());
-    }
-    if (m_settings.contains("point4")) {
-        fanCurve.mutable_current_value()->set_point4(m_settings.value("point4").toInt());
-    }
-    if (m_settings.contains("point5")) {
-        fanCurve.mutable_current_value()->set_point5(m_settings.value("point5").toInt());
-    }
-    if (m_settings.contains("point6")) {
-        fanCurve.mutable_current_value()->set_point6(m_settings.value("point6").toInt());
-    }
-    if (m_settings.contains("point7")) {
-        fanCurve.mutable_current_value()->set_point7(m_settings.value("point7").toInt());
-    }
-    if (m_settings.contains("point8")) {
-        fanCurve.mutable_current_value()->set_point8(m_settings.value("point8").toInt());
-    }
-    if (m_settings.contains("point9")) {
-        fanCurve.mutable_current_value()->set_point9(m_settings.value("point9").toInt());
-    }
-    if (m_settings.contains("point10")) {
-        fanCurve.mutable_current_value()->set_point10(m_settings.value("point10").toInt());
-    }
+    load(fanCurve);
     return *this;
 }
 
@@ -184,16 +415,18 @@ SettingsSaverFanCurve::SettingsSaverFanCurve() :
 
 SettingsSaverFanCurve& SettingsSaverFanCurve::saveFanCurve(const legion::messages::FanCurve &fanCurve)
 {
-    m_settings.setValue("point1", fanCurve.current_value().point1());
-    m_settings.setValue("point2", fanCurve.current_value().point2());
-    m_settings.setValue("point3", fanCurve.current_value().point3());
-    m_settings.setValue("point4", fanCurve.current_value().point4());
-    m_settings.setValue("point5", fanCurve.current_value().point5());
-    m_settings.setValue("point6", fanCurve.current_value().point6());
-    m_settings.setValue("point7", fanCurve.current_value().point7());
-    m_settings.setValue("point8", fanCurve.current_value().point8());
-    m_settings.setValue("point9", fanCurve.current_value().point9());
-    m_settings.setValue("point10", fanCurve.current_value().point10());
+    legion::messages::FanCurve saved;
+    saved.mutable_current_value()->set_point1(fanCurve.current_value().point1());
+    saved.mutable_current_value()->set_point2(fanCurve.current_value().point2());
+    saved.mutable_current_value()->set_point3(fanCurve.current_value().point3());
+    saved.mutable_current_value()->set_point4(fanCurve.current_value().point4());
+    saved.mutable_current_value()->set_point5(fanCurve.current_value().point5());
+    saved.mutable_current_value()->set_point6(fanCurve.current_value().point6());
+    saved.mutable_current_value()->set_point7(fanCurve.current_value().point7());
+    saved.mutable_current_value()->set_point8(fanCurve.current_value().point8());
+    saved.mutable_current_value()->set_point9(fanCurve.current_value().point9());
+    saved.mutable_current_value()->set_point10(fanCurve.current_value().point10());
+    save(saved);
     return *this;
 }
 
@@ -205,9 +438,7 @@ SettingsLoaderFanOption::SettingsLoaderFanOption() :
 
 SettingsLoaderFanOption& SettingsLoaderFanOption::loadFanOption(legion::messages::FanOption &fanOption)
 {
-    if (m_settings.contains("full_speed")) {
-        fanOption.mutable_full_speed()->set_current_value(m_settings.value("full_speed").toBool());
-    }
+    load(fanOption);
     return *this;
 }
 
@@ -218,7 +449,9 @@ SettingsSaverFanOption::SettingsSaverFanOption() :
 
 SettingsSaverFanOption& SettingsSaverFanOption::saveFanOption(const legion::messages::FanOption &fanOption)
 {
-    m_settings.setValue("full_speed", fanOption.full_speed().current_value());
+    legion::messages::FanOption saved;
+    saved.mutable_full_speed()->set_current_value(fanOption.full_speed().current_value());
+    save(saved);
     return *this;
 }
 
@@ -230,9 +463,7 @@ SettingsLoaderCPUSMT::SettingsLoaderCPUSMT() :
 
 SettingsLoaderCPUSMT& SettingsLoaderCPUSMT::loadCPUSMT(legion::messages::CPUSMT &cpuSmt)
 {
-    if (m_settings.contains("control")) {
-        cpuSmt.set_control(m_settings.value("control").toString().toStdString());
-    }
+    load(cpuSmt);
     return *this;
 }
 
@@ -243,7 +474,9 @@ SettingsSaverCPUSMT::SettingsSaverCPUSMT() :
 
 SettingsSaverCPUSMT& SettingsSaverCPUSMT::saveCPUSMT(const legion::messages::CPUSMT &cpuSmt)
 {
-    m_settings.setValue("control", QString::fromStdString(cpuSmt.control().data()));
+    legion::messages::CPUSMT saved;
+    saved.set_control(std::string(cpuSmt.control()));
+    save(saved);
     return *this;
 }
 
@@ -255,27 +488,7 @@ SettingsLoaderCPUPower::SettingsLoaderCPUPower() :
 
 SettingsLoaderCPUPower& SettingsLoaderCPUPower::loadCPUPower(legion::messages::CPUPower &cpuPower)
 {
-    if (m_settings.contains("cpu_stp_limit")) {
-        cpuPower.mutable_cpu_stp_limit()->set_current_value(m_settings.value("cpu_stp_limit").toUInt());
-    }
-    if (m_settings.contains("cpu_ltp_limit")) {
-        cpuPower.mutable_cpu_ltp_limit()->set_current_value(m_settings.value("cpu_ltp_limit").toUInt());
-    }
-    if (m_settings.contains("cpu_clp_limit")) {
-        cpuPower.mutable_cpu_clp_limit()->set_current_value(m_settings.value("cpu_clp_limit").toUInt());
-    }
-    if (m_settings.contains("cpu_tmp_limit")) {
-        cpuPower.mutable_cpu_tmp_limit()->set_current_value(m_settings.value("cpu_tmp_limit").toUInt());
-    }
-    if (m_settings.contains("cpu_pl1_tau")) {
-        cpuPower.mutable_cpu_pl1_tau()->set_current_value(m_settings.value("cpu_pl1_tau").toUInt());
-    }
-    if (m_settings.contains("gpu_total_onac")) {
-        cpuPower.mutable_gpu_total_onac()->set_current_value(m_settings.value("gpu_total_onac").toUInt());
-    }
-    if (m_settings.contains("gpu_to_cpu_dynamic_boost")) {
-        cpuPower.mutable_gpu_to_cpu_dynamic_boost()->set_current_value(m_settings.value("gpu_to_cpu_dynamic_boost").toUInt());
-    }
+    load(cpuPower);
     return *this;
 }
 
@@ -286,27 +499,29 @@ SettingsSaverCPUPower::SettingsSaverCPUPower() :
 
 SettingsSaverCPUPower& SettingsSaverCPUPower::saveCPUPower(const legion::messages::CPUPower &cpuPower)
 {
+    legion::messages::CPUPower saved;
     if (cpuPower.has_cpu_stp_limit()) {
-        m_settings.setValue("cpu_stp_limit", cpuPower.cpu_stp_limit().current_value());
+        saved.mutable_cpu_stp_limit()->set_current_value(cpuPower.cpu_stp_limit().current_value());
     }
     if (cpuPower.has_cpu_ltp_limit()) {
-        m_settings.setValue("cpu_ltp_limit", cpuPower.cpu_ltp_limit().current_value());
+        saved.mutable_cpu_ltp_limit()->set_current_value(cpuPower.cpu_ltp_limit().current_value());
     }
     if (cpuPower.has_cpu_clp_limit()) {
-        m_settings.setValue("cpu_clp_limit", cpuPower.cpu_clp_limit().current_value());
+        saved.mutable_cpu_clp_limit()->set_current_value(cpuPower.cpu_clp_limit().current_value());
     }
     if (cpuPower.has_cpu_tmp_limit()) {
-        m_settings.setValue("cpu_tmp_limit", cpuPower.cpu_tmp_limit().current_value());
+        saved.mutable_cpu_tmp_limit()->set_current_value(cpuPower.cpu_tmp_limit().current_value());
     }
     if (cpuPower.has_cpu_pl1_tau()) {
-        m_settings.setValue("cpu_pl1_tau", cpuPower.cpu_pl1_tau().current_value());
+        saved.mutable_cpu_pl1_tau()->set_current_value(cpuPower.cpu_pl1_tau().current_value());
     }
     if (cpuPower.has_gpu_total_onac()) {
-        m_settings.setValue("gpu_total_onac", cpuPower.gpu_total_onac().current_value());
+        saved.mutable_gpu_total_onac()->set_current_value(cpuPower.gpu_total_onac().current_value());
     }
     if (cpuPower.has_gpu_to_cpu_dynamic_boost()) {
-        m_settings.setValue("gpu_to_cpu_dynamic_boost", cpuPower.gpu_to_cpu_dynamic_boost().current_value());
+        saved.mutable_gpu_to_cpu_dynamic_boost()->set_current_value(cpuPower.gpu_to_cpu_dynamic_boost().current_value());
     }
+    update(saved);
     return *this;
 }
 
@@ -318,15 +533,7 @@ SettingsLoaderGPUPower::SettingsLoaderGPUPower() :
 
 SettingsLoaderGPUPower& SettingsLoaderGPUPower::loadGPUPower(legion::messages::GPUPower &gpuPower)
 {
-    if (m_settings.contains("gpu_power_boost")) {
-        gpuPower.mutable_gpu_power_boost()->set_current_value(m_settings.value("gpu_power_boost").toUInt());
-    }
-    if (m_settings.contains("gpu_configurable_tgp")) {
-        gpuPower.mutable_gpu_configurable_tgp()->set_current_value(m_settings.value("gpu_configurable_tgp").toUInt());
-    }
-    if (m_settings.contains("gpu_temperature_limit")) {
-        gpuPower.mutable_gpu_temperature_limit()->set_current_value(m_settings.value("gpu_temperature_limit").toUInt());
-    }
+    load(gpuPower);
     return *this;
 }
 
@@ -337,15 +544,17 @@ SettingsSaverGPUPower::SettingsSaverGPUPower() :
 
 SettingsSaverGPUPower& SettingsSaverGPUPower::saveGPUPower(const legion::messages::GPUPower &gpuPower)
 {
+    legion::messages::GPUPower saved;
     if (gpuPower.has_gpu_power_boost()) {
-        m_settings.setValue("gpu_power_boost", gpuPower.gpu_power_boost().current_value());
+        saved.mutable_gpu_power_boost()->set_current_value(gpuPower.gpu_power_boost().current_value());
     }
     if (gpuPower.has_gpu_configurable_tgp()) {
-        m_settings.setValue("gpu_configurable_tgp", gpuPower.gpu_configurable_tgp().current_value());
+        saved.mutable_gpu_configurable_tgp()->set_current_value(gpuPower.gpu_configurable_tgp().current_value());
     }
     if (gpuPower.has_gpu_temperature_limit()) {
-        m_settings.setValue("gpu_temperature_limit", gpuPower.gpu_temperature_limit().current_value());
+        saved.mutable_gpu_temperature_limit()->set_current_value(gpuPower.gpu_temperature_limit().current_value());
     }
+    update(saved);
     return *this;
 }
 // Nvidia NVML Settings
@@ -356,12 +565,7 @@ SettingsLoaderNvidiaNvml::SettingsLoaderNvidiaNvml() :
 
 SettingsLoaderNvidiaNvml& SettingsLoaderNvidiaNvml::loadNvidiaNvml(legion::messages::NvidiaNvml &nvidiaNvml)
 {
-    if (m_settings.contains("gpu_offset")) {
-        nvidiaNvml.mutable_gpu_offset()->set_value(m_settings.value("gpu_offset").toInt());
-    }
-    if (m_settings.contains("memory_offset")) {
-        nvidiaNvml.mutable_memory_offset()->set_value(m_settings.value("memory_offset").toInt());
-    }
+    load(nvidiaNvml);
     return *this;
 }
 
@@ -372,12 +576,14 @@ SettingsSaverNvidiaNvml::SettingsSaverNvidiaNvml() :
 
 SettingsSaverNvidiaNvml& SettingsSaverNvidiaNvml::saveNvidiaNvml(const legion::messages::NvidiaNvml &nvidiaNvml)
 {
+    legion::messages::NvidiaNvml saved;
     if (nvidiaNvml.has_gpu_offset()) {
-        m_settings.setValue("gpu_offset", nvidiaNvml.gpu_offset().value());
+        saved.mutable_gpu_offset()->set_value(nvidiaNvml.gpu_offset().value());
     }
     if (nvidiaNvml.has_memory_offset()) {
-        m_settings.setValue("memory_offset", nvidiaNvml.memory_offset().value());
+        saved.mutable_memory_offset()->set_value(nvidiaNvml.memory_offset().value());
     }
+    update(saved);
     return *this;
 }
 
@@ -389,10 +595,11 @@ SettingsLoaderDaemonSettings::SettingsLoaderDaemonSettings() :
 
 SettingsLoaderDaemonSettings& SettingsLoaderDaemonSettings::loadDaemonSettings(legion::messages::DaemonSettings &daemonSettings)
 {
-    daemonSettings.set_apply_settings_on_start(m_settings.value("apply_settings_on_start", true).toBool());
-    daemonSettings.set_save_settings_on_exit(m_settings.value("save_settings_on_exit", true).toBool());
-    daemonSettings.set_debug_logging(m_settings.value("debug_logging", false).toBool());
-    daemonSettings.set_trace_logging(m_settings.value("trace_logging", false).toBool());
+    daemonSettings.set_apply_settings_on_start(true);
+    daemonSettings.set_save_settings_on_exit(true);
+    daemonSettings.set_debug_logging(false);
+    daemonSettings.set_trace_logging(false);
+    load(daemonSettings);
     // Note: save_now is not loaded - it's a command flag, not a persistent setting
     return *this;
 }
@@ -404,10 +611,12 @@ SettingsSaverDaemonSettings::SettingsSaverDaemonSettings() :
 
 SettingsSaverDaemonSettings& SettingsSaverDaemonSettings::saveDaemonSettings(const legion::messages::DaemonSettings &daemonSettings)
 {
-    m_settings.setValue("apply_settings_on_start", daemonSettings.apply_settings_on_start());
-    m_settings.setValue("save_settings_on_exit", daemonSettings.save_settings_on_exit());
-    m_settings.setValue("debug_logging", daemonSettings.debug_logging());
-    m_settings.setValue("trace_logging", daemonSettings.trace_logging());
+    legion::messages::DaemonSettings saved;
+    saved.set_apply_settings_on_start(daemonSettings.apply_settings_on_start());
+    saved.set_save_settings_on_exit(daemonSettings.save_settings_on_exit());
+    saved.set_debug_logging(daemonSettings.debug_logging());
+    saved.set_trace_logging(daemonSettings.trace_logging());
+    save(saved);
     // Note: save_now is not saved - it's a command flag, not a persistent setting
     return *this;
 }
@@ -420,31 +629,7 @@ SettingsLoaderIntelMSR::SettingsLoaderIntelMSR() :
 
 SettingsLoaderIntelMSR& SettingsLoaderIntelMSR::loadIntelMSR(legion::messages::CpuIntelMSR &intelMSR)
 {
-    // Analogio voltage settings
-    if (m_settings.contains("analogio_offset")) {
-        intelMSR.mutable_analogio()->set_offset(m_settings.value("analogio_offset").toInt());
-    }
-    
-    // Cache voltage settings
-    if (m_settings.contains("cache_offset")) {
-        intelMSR.mutable_cache()->set_offset(m_settings.value("cache_offset").toInt());
-    }
-    
-    // CPU voltage settings
-    if (m_settings.contains("cpu_offset")) {
-        intelMSR.mutable_cpu()->set_offset(m_settings.value("cpu_offset").toInt());
-    }
-    
-    // GPU voltage settings
-    if (m_settings.contains("gpu_offset")) {
-        intelMSR.mutable_gpu()->set_offset(m_settings.value("gpu_offset").toInt());
-    }
-    
-    // Uncore voltage settings
-    if (m_settings.contains("uncore_offset")) {
-        intelMSR.mutable_uncore()->set_offset(m_settings.value("uncore_offset").toInt());
-    }
-    
+    load(intelMSR);
     return *this;
 }
 
@@ -455,31 +640,34 @@ SettingsSaverIntelMSR::SettingsSaverIntelMSR() :
 
 SettingsSaverIntelMSR& SettingsSaverIntelMSR::saveIntelMSR(const legion::messages::CpuIntelMSR &intelMSR)
 {
+    legion::messages::CpuIntelMSR saved;
+
     // Save analogio offset if present
     if (intelMSR.has_analogio() && intelMSR.analogio().has_offset()) {
-        m_settings.setValue("analogio_offset", intelMSR.analogio().offset());
+        saved.mutable_analogio()->set_offset(intelMSR.analogio().offset());
     }
-    
+
     // Save cache offset if present
     if (intelMSR.has_cache() && intelMSR.cache().has_offset()) {
-        m_settings.setValue("cache_offset", intelMSR.cache().offset());
+        saved.mutable_cache()->set_offset(intelMSR.cache().offset());
     }
-    
+
     // Save CPU offset if present
     if (intelMSR.has_cpu() && intelMSR.cpu().has_offset()) {
-        m_settings.setValue("cpu_offset", intelMSR.cpu().offset());
+        saved.mutable_cpu()->set_offset(intelMSR.cpu().offset());
     }
-    
+
     // Save GPU offset if present
     if (intelMSR.has_gpu() && intelMSR.gpu().has_offset()) {
-        m_settings.setValue("gpu_offset", intelMSR.gpu().offset());
+        saved.mutable_gpu()->set_offset(intelMSR.gpu().offset());
     }
-    
+
     // Save uncore offset if present
     if (intelMSR.has_uncore() && intelMSR.uncore().has_offset()) {
-        m_settings.setValue("uncore_offset", intelMSR.uncore().offset());
+        saved.mutable_uncore()->set_offset(intelMSR.uncore().offset());
     }
-    
+
+    update(saved);
     return *this;
 }
 
@@ -491,16 +679,7 @@ SettingsLoaderOther::SettingsLoaderOther() :
 
 SettingsLoaderOther& SettingsLoaderOther::loadOther(legion::messages::OtherSettings &otherSettings)
 {
-    // Load touchpad setting
-    if (m_settings.contains("disable_touchpad")) {
-        otherSettings.mutable_touch_pad()->set_current(m_settings.value("disable_touchpad").toBool());
-    }
-    
-    // Load win key setting
-    if (m_settings.contains("disable_win_key")) {
-        otherSettings.mutable_win_key()->set_current(m_settings.value("disable_win_key").toBool());
-    }
-    
+    load(otherSettings);
     return *this;
 }
 
@@ -511,16 +690,83 @@ SettingsSaverOther::SettingsSaverOther() :
 
 SettingsSaverOther& SettingsSaverOther::saveOther(const legion::messages::OtherSettings &otherSettings)
 {
+    legion::messages::OtherSettings saved;
+
     // Save touchpad setting if present
     if (otherSettings.has_touch_pad() && otherSettings.touch_pad().has_current()) {
-        m_settings.setValue("disable_touchpad", otherSettings.touch_pad().current());
+        saved.mutable_touch_pad()->set_current(otherSettings.touch_pad().current());
     }
-    
+
     // Save win key setting if present
     if (otherSettings.has_win_key() && otherSettings.win_key().has_current()) {
-        m_settings.setValue("disable_win_key", otherSettings.win_key().current());
+        saved.mutable_win_key()->set_current(otherSettings.win_key().current());
     }
-    
+
+    update(saved);
+    return *this;
+}
+
+// Auto Tuner Profiles
+SettingsLoaderAutoTuner::SettingsLoaderAutoTuner() :
+    Settings("AutoTunerProfiles")
+{
+}
+
+SettingsLoaderAutoTuner& SettingsLoaderAutoTuner::loadAutoTuner(legion::messages::AutoTuner &autoTuner)
+{
+    load(autoTuner);
+    return *this;
+}
+
+SettingsSaverAutoTuner::SettingsSaverAutoTuner() :
+    Settings("AutoTunerProfiles")
+{
+}
+
+SettingsSaverAutoTuner& SettingsSaverAutoTuner::saveAutoTuner(const legion::messages::AutoTuner &autoTuner)
+{
+    legion::messages::AutoTuner saved;
+
+    // Only the profiles are persisted, all of them replace the saved ones
+    saved.mutable_profiles()->CopyFrom(autoTuner.profiles());
+
+    save(saved);
+    return *this;
+}
+
+// CPU Energy Performance
+SettingsLoaderCPUEnergyPerformance::SettingsLoaderCPUEnergyPerformance() :
+    Settings("CPUEnergyPerformanceData")
+{
+}
+
+SettingsLoaderCPUEnergyPerformance& SettingsLoaderCPUEnergyPerformance::loadCPUEnergyPerformance(legion::messages::CPUEnergyPerformance &cpuEnergyPerformance)
+{
+    load(cpuEnergyPerformance);
+    return *this;
+}
+
+SettingsSaverCPUEnergyPerformance::SettingsSaverCPUEnergyPerformance() :
+    Settings("CPUEnergyPerformanceData")
+{
+}
+
+SettingsSaverCPUEnergyPerformance& SettingsSaverCPUEnergyPerformance::saveCPUEnergyPerformance(const legion::messages::CPUEnergyPerformance &cpuEnergyPerformance)
+{
+    legion::messages::CPUEnergyPerformance saved;
+
+    // Groups and policies only, the state of the CPUs is not persisted
+    if (cpuEnergyPerformance.has_performance_cores()) {
+        *saved.mutable_performance_cores() = cpuEnergyPerformance.performance_cores();
+    }
+
+    if (cpuEnergyPerformance.has_efficient_cores()) {
+        *saved.mutable_efficient_cores() = cpuEnergyPerformance.efficient_cores();
+    }
+
+    saved.mutable_policies()->CopyFrom(cpuEnergyPerformance.policies());
+
+    save(saved);
     return *this;
 }
 
@@ -7,7 +7,9 @@
  */
 #pragma once
 
-#include <QSettings>
+#include <QString>
+
+#include <google/protobuf/message.h>
 
 
 #include "../LenovoLegion-PrepareBuild/PowerProfile.pb.h"
@@ -20,6 +22,8 @@
 #include "../LenovoLegion-PrepareBuild/CpuIntelMSR.pb.h"
 #include "../LenovoLegion-PrepareBuild/DaemonSettings.pb.h"
 #include "../LenovoLegion-PrepareBuild/Other.pb.h"
+#include "../LenovoLegion-PrepareBuild/AutoTuner.pb.h"
+#include "../LenovoLegion-PrepareBuild/CPUEnergyPerformance.pb.h"
 
 
 namespace LenovoLegionDaemon {
@@ -44,7 +48,37 @@ public:
 
 protected:
 
-    QSettings m_settings;
+    /*
+     * Persisted fields of the group merged into the message, false if the group was never saved
+     */
+    bool load(google::protobuf::Message& message) const;
+
+    /*
+     * Persisted fields of the group replaced by the message
+     */
+    void save(const google::protobuf::Message& message);
+
+    /*
+     * Fields set in the message replace the persisted ones, the others are kept
+     */
+    void update(const google::protobuf::Message& message);
+
+protected:
+
+    const QString m_group;
+};
+
+
+/*
+ * One time import of the LenovoLegion-Daemon.ini written by the previous versions,
+ * runs only while there is no settings snapshot yet
+ */
+class SettingsMigrationIni
+{
+public:
+    static bool migrate();
+
+    static QString path();
 };
 
 
@@ -230,4 +264,34 @@ public:
     SettingsSaverOther& saveOther(const legion::messages::OtherSettings &otherSettings);
 };
 
+// Auto Tuner Profiles
+class SettingsLoaderAutoTuner: protected Settings
+{
+public:
+    explicit SettingsLoaderAutoTuner();
+    SettingsLoaderAutoTuner& loadAutoTuner(legion::messages::AutoTuner &autoTuner);
+};
+
+class SettingsSaverAutoTuner: protected Settings
+{
+public:
+    explicit SettingsSaverAutoTuner();
+    SettingsSaverAutoTuner& saveAutoTuner(const legion::messages::AutoTuner &autoTuner);
+};
+
+// CPU Energy Performance
+class SettingsLoaderCPUEnergyPerformance: protected Settings
+{
+public:
+    explicit SettingsLoaderCPUEnergyPerformance();
+    SettingsLoaderCPUEnergyPerformance& loadCPUEnergyPerformance(legion::messages::CPUEnergyPerformance &cpuEnergyPerformance);
+};
+
+class SettingsSaverCPUEnergyPerformance: protected Settings
+{
+public:
+    explicit SettingsSaverCPUEnergyPerformance();
+    SettingsSaverCPUEnergyPerformance& saveCPUEnergyPerformance(const legion::messages::CPUEnergyPerformance &cpuEnergyPerformance);
+};
+
 }
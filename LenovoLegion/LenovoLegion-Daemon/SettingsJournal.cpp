@@ -0,0 +1,347 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "SettingsJournal.h"
+#include "SettingsStore.h"
+
+#include <Core/Application.h>
+#include <Core/LoggerHolder.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTimer>
+
+#include <chrono>
+#include <cstring>
+
+#include <unistd.h>
+
+namespace LenovoLegionDaemon {
+
+SettingsJournal::SettingsJournal(const Reader &reader, const Applier &applier, QObject *parent) :
+    QObject(parent),
+    m_batchTimer(new QTimer(this)),
+    m_reader(reader),
+    m_applier(applier),
+    m_file(path()),
+    m_running(false)
+{
+    m_batchTimer->setSingleShot(true);
+    m_batchTimer->setInterval(BATCH_PERIOD);
+
+    connect(m_batchTimer,&QTimer::timeout,this,&SettingsJournal::batchTimeout);
+}
+
+SettingsJournal::~SettingsJournal()
+{
+    try {
+        stop();
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Stop of settings journal failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+void SettingsJournal::start()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(m_running)
+    {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(path()).absolutePath());
+
+    if(!m_file.open(QIODeviceBase::WriteOnly | QIODeviceBase::Append))
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::OPEN_ERROR,std::string("I can not open file (").append(path().toStdString()).append(") with permision=Append !").c_str());
+    }
+
+    m_running = true;
+}
+
+void SettingsJournal::stop()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!m_running)
+    {
+        return;
+    }
+
+    m_running = false;
+
+    m_batchTimer->stop();
+
+    writePending();
+    finishCompaction(true);
+
+    m_file.close();
+
+    /*
+     * Rest of the journal folded now, nothing is left for the next start
+     */
+    const size_t count = fold(m_applier,{compactionPath(),path()});
+
+    LOGF_D("Settings journal stopped, {} data types folded into the snapshot",count);
+}
+
+void SettingsJournal::changed(quint8 dataType)
+{
+    if(!m_running)
+    {
+        return;
+    }
+
+    m_changed.insert(dataType);
+
+    if(!m_batchTimer->isActive())
+    {
+        m_batchTimer->start();
+    }
+}
+
+void SettingsJournal::recover(const Applier &applier)
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!QFile::exists(compactionPath()) && !QFile::exists(path()))
+    {
+        return;
+    }
+
+    const size_t count = fold(applier,{compactionPath(),path()});
+
+    LOGF_I("Settings journal of the previous run recovered, {} data types",count);
+}
+
+QString SettingsJournal::path()
+{
+    return QCoreApplication::applicationDirPath()
+            .append(QDir::separator())
+            .append(bj::framework::Application::data_dir)
+            .append(QDir::separator())
+            .append("LenovoLegion-Daemon.journal");
+}
+
+QString SettingsJournal::compactionPath()
+{
+    return path().append(".compacting");
+}
+
+void SettingsJournal::batchTimeout()
+{
+    try {
+        writePending();
+        finishCompaction(false);
+
+        if(m_file.size() >= COMPACTION_SIZE && !m_compaction.valid())
+        {
+            startCompaction();
+        }
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Settings journal error: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+void SettingsJournal::writePending()
+{
+    QByteArray batch;
+    size_t     count = 0;
+
+    for (const auto dataType : m_changed) {
+        QByteArray state;
+
+        try {
+            state = m_reader(dataType);
+        }
+        catch(const bj::framework::exception::Exception& ex)
+        {
+            LOG_W(QString(__PRETTY_FUNCTION__) + "- Read of data type " + QString::number(dataType) + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+            continue;
+        }
+
+        Record record {};
+
+        record.m_size     = static_cast<quint32>(state.size());
+        record.m_checksum = qChecksum(QByteArrayView(state));
+        record.m_dataType = dataType;
+
+        batch.append(reinterpret_cast<const char*>(&record),sizeof(Record));
+        batch.append(state);
+
+        ++count;
+    }
+
+    m_changed.clear();
+
+    if(batch.isEmpty())
+    {
+        return;
+    }
+
+    /*
+     * One sync for the whole batch
+     */
+    if(m_file.write(batch) != batch.size() || !m_file.flush() || ::fdatasync(m_file.handle()) != 0)
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::WRITE_ERROR,std::string("I can not write file (").append(path().toStdString()).append(") !").c_str());
+    }
+
+    LOGF_T("Settings journal batch written, {} records, {} bytes",count,batch.size());
+}
+
+void SettingsJournal::startCompaction()
+{
+    /*
+     * Previous compaction failed, its file is folded at the stop or at the next start
+     */
+    if(QFile::exists(compactionPath()))
+    {
+        return;
+    }
+
+    m_file.close();
+
+    const bool renamed = QFile::rename(path(),compactionPath());
+
+    if(!m_file.open(QIODeviceBase::WriteOnly | QIODeviceBase::Append))
+    {
+        m_running = false;
+        THROW_EXCEPTION(exception_T,ERROR_CODES::OPEN_ERROR,std::string("I can not open file (").append(path().toStdString()).append(") with permision=Append !").c_str());
+    }
+
+    if(!renamed)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Rotation of settings journal " + path() + " failed");
+        return;
+    }
+
+    m_compaction = std::async(std::launch::async,[applier = m_applier](){
+        return fold(applier,{compactionPath()});
+    });
+}
+
+void SettingsJournal::finishCompaction(bool wait)
+{
+    if(!m_compaction.valid())
+    {
+        return;
+    }
+
+    if(!wait && m_compaction.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return;
+    }
+
+    try {
+        const size_t count = m_compaction.get();
+
+        LOGF_D("Settings journal compacted, {} data types",count);
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Compaction of settings journal failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+size_t SettingsJournal::fold(const Applier &applier, const std::vector<QString> &paths)
+{
+    std::map<quint8,QByteArray> states;
+    size_t                      count = 0;
+
+    /*
+     * Later files hold later changes
+     */
+    for (const auto& file : paths) {
+        for (auto& [dataType,state] : readRecords(file,count)) {
+            states[dataType] = std::move(state);
+        }
+    }
+
+    if(!states.empty())
+    {
+        SettingsStore::Batch batch;
+
+        for (const auto& [dataType,state] : states) {
+            try {
+                applier(dataType,state);
+            }
+            catch(const bj::framework::exception::Exception& ex)
+            {
+                LOG_W(QString(__PRETTY_FUNCTION__) + "- Apply of data type " + QString::number(dataType) + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+            }
+        }
+
+        /*
+         * Journal is removed only after the snapshot is written
+         */
+        SettingsStore::getInstance().sync();
+    }
+
+    for (const auto& file : paths) {
+        QFile::remove(file);
+    }
+
+    LOGF_T("Settings journal folded, {} records",count);
+
+    return states.size();
+}
+
+std::map<quint8, QByteArray> SettingsJournal::readRecords(const QString &path, size_t &count)
+{
+    std::map<quint8,QByteArray> states;
+    QFile                       file(path);
+
+    if(!file.exists())
+    {
+        return states;
+    }
+
+    if(!file.open(QIODeviceBase::ReadOnly))
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::OPEN_ERROR,std::string("I can not open file (").append(path.toStdString()).append(") with permision=ReadOnly !").c_str());
+    }
+
+    const QByteArray data   = file.readAll();
+    qsizetype        offset = 0;
+
+    while (data.size() - offset >= static_cast<qsizetype>(sizeof(Record))) {
+        Record record;
+
+        std::memcpy(&record,data.constData() + offset,sizeof(Record));
+
+        const QByteArrayView state(data.constData() + offset + sizeof(Record),
+                                   qMin<qsizetype>(record.m_size,data.size() - offset - sizeof(Record)));
+
+        /*
+         * Torn record at the end, the batch was not synced
+         */
+        if(state.size() != record.m_size || qChecksum(state) != record.m_checksum)
+        {
+            break;
+        }
+
+        states[record.m_dataType] = state.toByteArray();
+        offset += sizeof(Record) + record.m_size;
+        ++count;
+    }
+
+    if(offset != data.size())
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Settings journal " + path + " has " + QString::number(data.size() - offset) + " damaged bytes at the end, they are skipped");
+    }
+
+    return states;
+}
+
+}
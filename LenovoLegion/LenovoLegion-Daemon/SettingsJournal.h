@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <Core/ExceptionBuilder.h>
+
+#include <QByteArray>
+#include <QFile>
+#include <QObject>
+#include <QString>
+
+#include <functional>
+#include <future>
+#include <map>
+#include <set>
+#include <vector>
+
+class QTimer;
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Append only log of the settings changed by the clients. A change only marks its data type, the state is
+ * read and appended once per batch and the batch is made durable with one fdatasync. When the journal grows
+ * the file is rotated and folded into the settings snapshot by a worker thread, so a crash loses at most the
+ * last batch and the exit has nothing to save.
+ *
+ * File layout: Record followed by the serialized message of the data type, repeated
+ */
+class SettingsJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    DEFINE_EXCEPTION(SettingsJournal);
+
+    enum ERROR_CODES : int {
+        OPEN_ERROR      = -1,
+        WRITE_ERROR     = -2
+    };
+
+    /*
+     * Reader returns the current state of the data type, applier stores the state into the settings
+     * snapshot, the applier is called from the worker thread
+     */
+    using Reader  = std::function<QByteArray(quint8)>;
+    using Applier = std::function<void(quint8,const QByteArray&)>;
+
+private:
+
+    struct Record {
+        quint32 m_size;                 // message
+        quint32 m_checksum;             // message
+        quint8  m_dataType;
+        quint8  m_reserved[3];
+    };
+
+public:
+
+    SettingsJournal(const Reader& reader,const Applier& applier,QObject* parent = nullptr);
+    ~SettingsJournal();
+
+    void start();
+    void stop();
+
+    void changed(quint8 dataType);
+
+    /*
+     * Journal left by the previous run folded into the settings snapshot, before the snapshot is loaded
+     */
+    static void recover(const Applier& applier);
+
+    static QString path();
+    static QString compactionPath();
+
+private:
+
+    void batchTimeout();
+
+    void writePending();
+
+    void startCompaction();
+    void finishCompaction(bool wait);
+
+    /*
+     * Last state of every data type in the files applied and written to the snapshot, the files are
+     * removed afterwards
+     */
+    static size_t fold(const Applier& applier,const std::vector<QString>& paths);
+
+    static std::map<quint8,QByteArray> readRecords(const QString& path,size_t& count);
+
+private:
+
+    QTimer*             m_batchTimer;
+
+    const Reader        m_reader;
+    const Applier       m_applier;
+
+    QFile               m_file;
+    bool                m_running;
+
+    std::set<quint8>    m_changed;
+
+    std::future<size_t> m_compaction;
+
+public:
+
+    static constexpr int     BATCH_PERIOD       = 250;          // ms
+    static constexpr qint64  COMPACTION_SIZE    = 64 * 1024;    // bytes
+};
+
+}
@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "SettingsReconciler.h"
+#include "DataProviderManager.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/unknown_field_set.h>
+
+#include <QElapsedTimer>
+
+#include <optional>
+
+namespace LenovoLegionDaemon {
+
+SettingsReconciler::SettingsReconciler(DataProviderManager *dataProviderManager) :
+    m_dataProviderManager(dataProviderManager)
+{}
+
+SettingsReconciler::Report SettingsReconciler::reconcile()
+{
+    Report                                 report;
+    QElapsedTimer                          totalTimer;
+    std::map<quint8,std::vector<size_t>>   stages;
+    std::vector<std::optional<QByteArray>> current(m_entries.size());
+    bool                                   stale = true;
+
+    totalTimer.start();
+
+    report.m_steps.resize(m_entries.size());
+
+    for(size_t i = 0; i < m_entries.size(); ++i)
+    {
+        stages[m_entries.at(i).m_stage].push_back(i);
+
+        report.m_steps[i].m_dataType = m_entries.at(i).m_dataType;
+        report.m_steps[i].m_name     = m_entries.at(i).m_name;
+    }
+
+    for(auto stage = stages.begin(); stage != stages.end(); ++stage)
+    {
+        /*
+         * One batch for this and all the later stages, again only when something was written
+         */
+        if(stale)
+        {
+            QElapsedTimer       readTimer;
+            std::vector<size_t> indexes;
+
+            readTimer.start();
+
+            for(auto it = stage; it != stages.end(); ++it)
+            {
+                indexes.insert(indexes.end(),it->second.begin(),it->second.end());
+            }
+
+            const auto values = readCurrent(indexes);
+
+            for(size_t i = 0; i < indexes.size(); ++i)
+            {
+                current[indexes.at(i)] = values.at(i);
+            }
+
+            report.m_readTime += readTimer.nsecsElapsed();
+            stale              = false;
+        }
+
+        std::vector<std::pair<size_t,QByteArray>> requests;
+
+        for(const auto index : stage->second)
+        {
+            const Entry& entry = m_entries.at(index);
+            Step&        step  = report.m_steps[index];
+
+            try {
+                /*
+                 * Unknown current state, whole desired state is written as before
+                 */
+                const QByteArray request = current.at(index).has_value() ? diff(entry,current.at(index).value(),step.m_changedFields) : entry.m_desired;
+
+                if(!current.at(index).has_value())
+                {
+                    step.m_changedFields = static_cast<quint32>(splitFields(entry.m_desired.toStdString()).size());
+                }
+
+                if(!request.isEmpty())
+                {
+                    requests.emplace_back(index,request);
+                }
+            }
+            catch(const bj::framework::exception::Exception& ex)
+            {
+                LOG_W(QString(__PRETTY_FUNCTION__) + "- Diff of " + entry.m_name + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+                step.m_failed = true;
+            }
+        }
+
+        if(requests.empty())
+        {
+            continue;
+        }
+
+        QElapsedTimer applyTimer;
+
+        applyTimer.start();
+
+        for(const auto& [index,request] : requests)
+        {
+            QElapsedTimer timer;
+            Step&         step = report.m_steps[index];
+
+            timer.start();
+
+            try {
+                m_dataProviderManager->getDataProvider(m_entries.at(index).m_dataType).deserializeAndSetData(request);
+            }
+            catch(const bj::framework::exception::Exception& ex)
+            {
+                LOG_W(QString(__PRETTY_FUNCTION__) + "- Apply of " + m_entries.at(index).m_name + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+                step.m_failed = true;
+            }
+
+            step.m_time = timer.nsecsElapsed();
+        }
+
+        report.m_applyTime += applyTimer.nsecsElapsed();
+        stale               = true;
+    }
+
+    report.m_totalTime = totalTimer.nsecsElapsed();
+
+    return report;
+}
+
+std::vector<std::optional<QByteArray>> SettingsReconciler::readCurrent(const std::vector<size_t> &indexes) const
+{
+    std::vector<std::optional<QByteArray>> result;
+
+    for(const auto index : indexes)
+    {
+        try {
+            result.push_back(m_dataProviderManager->getDataProvider(m_entries.at(index).m_dataType).serializeAndGetData());
+        }
+        catch(const bj::framework::exception::Exception& ex)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Read of " + m_entries.at(index).m_name + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+            result.push_back(std::nullopt);
+        }
+    }
+
+    return result;
+}
+
+QByteArray SettingsReconciler::diff(const Entry &entry, const QByteArray &current, quint32 &changedFields)
+{
+    const auto desiredFields    = splitFields(entry.m_normalize(entry.m_desired));
+    const auto currentFields    = splitFields(entry.m_normalize(current));
+    auto       requestFields    = splitFields(entry.m_desired.toStdString());
+    QByteArray request;
+
+    changedFields = 0;
+
+    for(const auto& [number,value] : desiredFields)
+    {
+        const auto field = currentFields.find(number);
+
+        if(field != currentFields.end() && field->second == value)
+        {
+            continue;
+        }
+
+        request.append(QByteArray::fromStdString(requestFields[number]));
+        ++changedFields;
+    }
+
+    return request;
+}
+
+std::map<int,std::string> SettingsReconciler::splitFields(const std::string &data)
+{
+    google::protobuf::UnknownFieldSet                fieldSet;
+    std::map<int,google::protobuf::UnknownFieldSet>  fieldsByNumber;
+    std::map<int,std::string>                        result;
+
+    if(!fieldSet.ParseFromString(data))
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    for(int i = 0; i < fieldSet.field_count(); ++i)
+    {
+        fieldsByNumber[fieldSet.field(i).number()].AddField(fieldSet.field(i));
+    }
+
+    for(const auto& [number,fields] : fieldsByNumber)
+    {
+        if(!fields.SerializeToString(&result[number]))
+        {
+            THROW_EXCEPTION(exception_T,ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+        }
+    }
+
+    return result;
+}
+
+std::string SettingsReconciler::serializeDeterministic(const google::protobuf::Message &message)
+{
+    std::string result;
+
+    /*
+     * Map fields have no stable order otherwise
+     */
+    {
+        google::protobuf::io::StringOutputStream stringStream(&result);
+        google::protobuf::io::CodedOutputStream  codedStream(&stringStream);
+
+        codedStream.SetSerializationDeterministic(true);
+
+        if(!message.SerializeToCodedStream(&codedStream))
+        {
+            THROW_EXCEPTION(exception_T,ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+        }
+    }
+
+    return result;
+}
+
+}
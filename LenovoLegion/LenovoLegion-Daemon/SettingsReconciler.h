@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <Core/ExceptionBuilder.h>
+
+#include <QByteArray>
+#include <QString>
+
+#include <google/protobuf/message.h>
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace LenovoLegionDaemon {
+
+class DataProviderManager;
+
+/*
+ * Brings the providers to a desired state. The current state is read in one batch, only the top level
+ * fields which differ are written. Stages are applied in ascending order, the entries of one stage in
+ * the order they were added. A stage which wrote something makes the later stages read their state
+ * again, e.g. a power profile change resets the power limits.
+ *
+ * Everything runs on the calling (daemon) thread, the providers are not thread safe.
+ */
+class SettingsReconciler
+{
+public:
+
+    DEFINE_EXCEPTION(SettingsReconciler);
+
+    enum ERROR_CODES : int {
+        INVALID_DATA    = 1,
+        SERIALIZE_ERROR = 2
+    };
+
+    struct Step {
+        quint8  m_dataType      = 0;
+        QString m_name;
+        quint32 m_changedFields = 0;
+        qint64  m_time          = 0;    // ns, write only
+        bool    m_failed        = false;
+    };
+
+    struct Report {
+        std::vector<Step> m_steps;
+        qint64            m_readTime    = 0;    // ns
+        qint64            m_applyTime   = 0;    // ns
+        qint64            m_totalTime   = 0;    // ns
+    };
+
+private:
+
+    struct Entry {
+        quint8                                   m_stage     = 0;
+        quint8                                   m_dataType  = 0;
+        QString                                  m_name;
+        QByteArray                               m_desired;
+        std::function<std::string(const QByteArray&)> m_normalize;
+    };
+
+public:
+
+    explicit SettingsReconciler(DataProviderManager* dataProviderManager);
+
+    /*
+     * Normalize clears the read only and volatile parts of the message before it is compared,
+     * it is applied to both the desired and the current state
+     */
+    template<class MessageT>
+    void add(quint8 stage,quint8 dataType,const MessageT& desired,const std::function<void(MessageT&)>& normalize = {})
+    {
+        Entry entry {
+            .m_stage    = stage,
+            .m_dataType = dataType,
+            .m_name     = QString::fromStdString(std::string(desired.GetDescriptor()->name()))
+        };
+
+        entry.m_desired.resize(desired.ByteSizeLong());
+        if(!desired.SerializeToArray(entry.m_desired.data(),entry.m_desired.size()))
+        {
+            THROW_EXCEPTION(exception_T,ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+        }
+
+        entry.m_normalize = [normalize](const QByteArray& data) {
+            MessageT message;
+
+            if(!message.ParseFromArray(data.data(),data.size()))
+            {
+                THROW_EXCEPTION(exception_T,ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+            }
+
+            if(normalize)
+            {
+                normalize(message);
+            }
+
+            return serializeDeterministic(message);
+        };
+
+        m_entries.push_back(std::move(entry));
+    }
+
+    Report reconcile();
+
+    /*
+     * Encoded top level fields of the message by field number, repeated fields together
+     */
+    static std::map<int,std::string> splitFields(const std::string& data);
+
+private:
+
+    /*
+     * Current state of the entries, std::nullopt if it can not be read
+     */
+    std::vector<std::optional<QByteArray>> readCurrent(const std::vector<size_t>& indexes) const;
+
+    /*
+     * Fields of the desired state which differ from the current one, empty if there is nothing to write
+     */
+    static QByteArray diff(const Entry& entry,const QByteArray& current,quint32& changedFields);
+
+    static std::string serializeDeterministic(const google::protobuf::Message& message);
+
+private:
+
+    DataProviderManager*    m_dataProviderManager;
+
+    std::vector<Entry>      m_entries;
+};
+
+}
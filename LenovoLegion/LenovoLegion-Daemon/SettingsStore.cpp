@@ -0,0 +1,228 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "SettingsStore.h"
+
+#include "../LenovoLegion-PrepareBuild/SettingsSnapshot.pb.h"
+
+#include <Core/Application.h>
+#include <Core/LoggerHolder.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <cstring>
+
+namespace LenovoLegionDaemon {
+
+SettingsStore::Batch::Batch()
+{
+    SettingsStore& store = SettingsStore::getInstance();
+
+    std::lock_guard<std::recursive_mutex> lock(store.m_mutex);
+
+    ++store.m_batchDepth;
+}
+
+SettingsStore::Batch::~Batch()
+{
+    SettingsStore& store = SettingsStore::getInstance();
+
+    std::lock_guard<std::recursive_mutex> lock(store.m_mutex);
+
+    if(--store.m_batchDepth == 0 && store.m_dirty)
+    {
+        try {
+            store.flush();
+        }
+        catch(const bj::framework::exception::Exception& ex)
+        {
+            LOG_W(QString(__PRETTY_FUNCTION__) + "- Write of settings failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        }
+    }
+}
+
+SettingsStore &SettingsStore::getInstance()
+{
+    static SettingsStore instance;
+    return instance;
+}
+
+SettingsStore::SettingsStore() :
+    m_loaded(false),
+    m_dirty(false),
+    m_batchDepth(0)
+{}
+
+bool SettingsStore::get(const QString &group, std::string &data)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    load();
+
+    const auto it = m_groups.find(group);
+
+    if(it == m_groups.end())
+    {
+        return false;
+    }
+
+    data = it->second;
+
+    return true;
+}
+
+void SettingsStore::set(const QString &group, const std::string &data)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    load();
+
+    auto& value = m_groups[group];
+
+    if(value == data && !m_dirty)
+    {
+        return;
+    }
+
+    value   = data;
+    m_dirty = true;
+
+    if(m_batchDepth == 0)
+    {
+        flush();
+    }
+}
+
+bool SettingsStore::exists() const
+{
+    return QFile::exists(path());
+}
+
+void SettingsStore::sync()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if(m_dirty)
+    {
+        flush();
+    }
+}
+
+QString SettingsStore::path()
+{
+    return QCoreApplication::applicationDirPath()
+            .append(QDir::separator())
+            .append(bj::framework::Application::data_dir)
+            .append(QDir::separator())
+            .append("LenovoLegion-Daemon.settings");
+}
+
+void SettingsStore::load()
+{
+    if(m_loaded)
+    {
+        return;
+    }
+
+    m_loaded = true;
+
+    QFile file(path());
+
+    if(!file.exists())
+    {
+        return;
+    }
+
+    if(!file.open(QIODeviceBase::ReadOnly))
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::OPEN_ERROR,std::string("I can not open file (").append(path().toStdString()).append(") with permision=ReadOnly !").c_str());
+    }
+
+    legion::messages::SettingsSnapshot snapshot;
+    Header                             header {};
+    uchar*                             data = file.size() >= static_cast<qint64>(sizeof(Header)) ? file.map(0,file.size()) : nullptr;
+
+    if(data != nullptr)
+    {
+        std::memcpy(&header,data,sizeof(Header));
+    }
+
+    /*
+     * Damaged snapshot must not stop the daemon, the settings start from defaults and the file
+     * is replaced on the next save
+     */
+    if(data == nullptr                                              ||
+       std::memcmp(header.m_magic,MAGIC,sizeof(MAGIC)) != 0         ||
+       header.m_version != FORMAT_VERSION                           ||
+       header.m_size != file.size() - sizeof(Header)                ||
+       header.m_checksum != qChecksum(QByteArrayView(reinterpret_cast<const char*>(data + sizeof(Header)),header.m_size)) ||
+       !snapshot.ParseFromArray(data + sizeof(Header),header.m_size))
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Settings file " + path() + " is damaged, defaults are used");
+    }
+    else
+    {
+        for(const auto& [group,value] : snapshot.groups())
+        {
+            m_groups[QString::fromStdString(std::string(group))] = std::string(value);
+        }
+
+        LOGF_D("Settings snapshot version {} loaded, {} groups",snapshot.version(),m_groups.size());
+    }
+
+    if(data != nullptr)
+    {
+        file.unmap(data);
+    }
+}
+
+void SettingsStore::flush()
+{
+    legion::messages::SettingsSnapshot snapshot;
+    std::string                        payload;
+    Header                             header {};
+
+    snapshot.set_version(SCHEMA_VERSION);
+
+    for(const auto& [group,value] : m_groups)
+    {
+        (*snapshot.mutable_groups())[group.toStdString()] = value;
+    }
+
+    if(!snapshot.SerializeToString(&payload))
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::INVALID_DATA,"Serialize of settings snapshot error !");
+    }
+
+    std::memcpy(header.m_magic,MAGIC,sizeof(MAGIC));
+    header.m_version  = FORMAT_VERSION;
+    header.m_size     = static_cast<quint32>(payload.size());
+    header.m_checksum = qChecksum(QByteArrayView(payload.data(),payload.size()));
+
+    QDir().mkpath(QFileInfo(path()).absolutePath());
+
+    /*
+     * Temporary file in the same directory renamed over the old one on commit
+     */
+    QSaveFile file(path());
+
+    if(!file.open(QIODeviceBase::WriteOnly)                                                                   ||
+       file.write(reinterpret_cast<const char*>(&header),sizeof(Header)) != static_cast<qint64>(sizeof(Header)) ||
+       file.write(payload.data(),payload.size()) != static_cast<qint64>(payload.size())                        ||
+       !file.commit())
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::WRITE_ERROR,std::string("I can not write file (").append(path().toStdString()).append(") !").c_str());
+    }
+
+    m_dirty = false;
+}
+
+}
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <Core/ExceptionBuilder.h>
+
+#include <QString>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Binary settings snapshot, one file with the messages of all groups. It is read once with mmap
+ * on first access and written with write-to-temp plus rename, so a crash leaves either the old
+ * or the new snapshot behind.
+ *
+ * File layout: Header followed by legion::messages::SettingsSnapshot
+ *
+ * Thread safe, the settings journal is compacted into the store from a worker thread
+ */
+class SettingsStore
+{
+public:
+
+    DEFINE_EXCEPTION(SettingsStore);
+
+    enum ERROR_CODES : int {
+        OPEN_ERROR      = -1,
+        WRITE_ERROR     = -2,
+        INVALID_DATA    = -3
+    };
+
+    /*
+     * Saves inside of a batch are written at once when the outermost batch ends
+     */
+    class Batch
+    {
+    public:
+        Batch();
+        ~Batch();
+
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+    };
+
+private:
+
+    struct Header {
+        char    m_magic[4];
+        quint32 m_version;
+        quint32 m_size;                 // payload
+        quint32 m_checksum;             // payload
+    };
+
+public:
+
+    static SettingsStore& getInstance();
+
+    SettingsStore(const SettingsStore&) = delete;
+    SettingsStore& operator=(const SettingsStore&) = delete;
+
+    /*
+     * Serialized message of the group, false if the group was never saved
+     */
+    bool get(const QString& group,std::string& data);
+    void set(const QString& group,const std::string& data);
+
+    /*
+     * False until the first snapshot is written, the INI migration relies on it
+     */
+    bool exists() const;
+
+    /*
+     * Unwritten changes written now, also inside of a batch
+     */
+    void sync();
+
+    static QString path();
+
+private:
+
+    SettingsStore();
+    ~SettingsStore() = default;
+
+    void load();
+    void flush();
+
+private:
+
+    mutable std::recursive_mutex    m_mutex;
+
+    bool                            m_loaded;
+    bool                            m_dirty;
+    quint32                         m_batchDepth;
+
+    std::map<QString,std::string>   m_groups;
+
+public:
+
+    static constexpr char    MAGIC[4]        = {'L','L','D','S'};
+    static constexpr quint32 FORMAT_VERSION  = 1;
+    static constexpr quint32 SCHEMA_VERSION  = 1;
+};
+
+}
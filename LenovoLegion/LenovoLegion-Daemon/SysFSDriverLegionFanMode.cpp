@@ -67,7 +67,7 @@ void SysFSDriverLegionFanMode::init()
 
 void SysFSDriverLegionFanMode::handleKernelEvent(const KernelEvent::Event &event)
 {
-    LOG_D(__PRETTY_FUNCTION__ + QString(": Kernel event received ACTION=") + event.m_action + ", DRIVER=" + event.m_driver + ", SYSNAME=" + event.m_sysName + ", SUBSYSTEM=" + event.m_subSystem + ", DEVPATH=" + event.m_devPath);
+    LOGF_D("{}: Kernel event received ACTION={}, DRIVER={}, SYSNAME={}, SUBSYSTEM={}, DEVPATH={}",__PRETTY_FUNCTION__,event.m_action,event.m_driver,event.m_sysName,event.m_subSystem,event.m_devPath);
 
     if(m_blockKernelEvent)
     {
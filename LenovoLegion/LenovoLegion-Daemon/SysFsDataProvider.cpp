@@ -1,4 +1,6 @@
 #include "SysFsDataProvider.h"
+#include "LatencyStatistics.h"
+#include "Tracer.h"
 
 
 #include <QFile>
@@ -13,6 +15,8 @@ SysFsDataProvider::SysFsDataProvider(SysFsDriverManager* sysFsDriverManager, QOb
 
 QString SysFsDataProvider::getData(const std::filesystem::path &path)
 {
+    TRACE_SPAN("sysfs","read",path.native());
+    auto  timer = LatencyStatistics::attributeReadTimer(path);
     QFile file(path);
 
     if(!file.open(QIODeviceBase::ReadOnly))
@@ -24,6 +28,8 @@ QString SysFsDataProvider::getData(const std::filesystem::path &path)
 }
 void SysFsDataProvider::setData(const std::filesystem::path &path, quint8 value)
 {
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
 
     if(!file.open(QIODeviceBase::WriteOnly))
@@ -36,6 +42,8 @@ void SysFsDataProvider::setData(const std::filesystem::path &path, quint8 value)
 
 void SysFsDataProvider::setData(const std::filesystem::path &path, quint16 value)
 {
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
 
     if(!file.open(QIODeviceBase::WriteOnly))
@@ -48,6 +56,8 @@ void SysFsDataProvider::setData(const std::filesystem::path &path, quint16 value
 
 void SysFsDataProvider::setData(const std::filesystem::path &path, quint32 value)
 {
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
 
     if(!file.open(QIODeviceBase::WriteOnly))
@@ -60,6 +70,8 @@ void SysFsDataProvider::setData(const std::filesystem::path &path, quint32 value
 
 void SysFsDataProvider::setData(const std::filesystem::path &path, quint64 value)
 {
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
 
     if(!file.open(QIODeviceBase::WriteOnly))
@@ -72,6 +84,8 @@ void SysFsDataProvider::setData(const std::filesystem::path &path, quint64 value
 
 void SysFsDataProvider::setData(const std::filesystem::path &path, bool value)
 {
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
 
     if(!file.open(QIODeviceBase::WriteOnly))
@@ -84,6 +98,8 @@ void SysFsDataProvider::setData(const std::filesystem::path &path, bool value)
 
 void SysFsDataProvider::setData(const std::filesystem::path &path, const std::vector<quint8>& values)
 {
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
     QTextStream   out(&file);
 
@@ -107,6 +123,8 @@ void SysFsDataProvider::setData(const std::filesystem::path &path, const std::ve
 
 void SysFsDataProvider::setData(const std::filesystem::path &path, const std::vector<quint32> &values)
 {
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
     QTextStream   out(&file);
 
@@ -130,6 +148,8 @@ void SysFsDataProvider::setData(const std::filesystem::path &path, const std::ve
 
 void SysFsDataProvider::setData(const std::filesystem::path &path, const std::string_view &value)
 {
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
 
     if(!file.open(QIODeviceBase::WriteOnly))
@@ -142,6 +162,8 @@ void SysFsDataProvider::setData(const std::filesystem::path &path, const std::st
 
 
 void SysFsDataProvider::setData(const std::filesystem::path &path, qint8 value) {
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
 
     if(!file.open(QIODeviceBase::WriteOnly))
@@ -154,6 +176,8 @@ void SysFsDataProvider::setData(const std::filesystem::path &path, qint8 value)
 
 
 void SysFsDataProvider::setData(const std::filesystem::path &path, qint16 value){
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
 
     if(!file.open(QIODeviceBase::WriteOnly))
@@ -166,6 +190,8 @@ void SysFsDataProvider::setData(const std::filesystem::path &path, qint16 value)
 
 
 void SysFsDataProvider::setData(const std::filesystem::path &path, qint32 value){
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
 
     if(!file.open(QIODeviceBase::WriteOnly))
@@ -178,6 +204,8 @@ void SysFsDataProvider::setData(const std::filesystem::path &path, qint32 value)
 
 
 void SysFsDataProvider::setData(const std::filesystem::path &path, qint64 value){
+    TRACE_SPAN("sysfs","write",path.native());
+    auto  timer = LatencyStatistics::attributeWriteTimer(path);
     QFile file(path);
 
     if(!file.open(QIODeviceBase::WriteOnly))
@@ -0,0 +1,413 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "SysFsDataProviderAutoPowerProfile.h"
+#include "SysFSDriverLegionGameZone.h"
+#include "SysFsDriverPowerSuplyBattery0.h"
+#include "DataProviderManager.h"
+#include "DataProviderNvidiaNvml.h"
+#include "ControlOwnership.h"
+
+#include "../LenovoLegion-PrepareBuild/AutoPowerProfile.pb.h"
+#include "../LenovoLegion-PrepareBuild/NvidiaNvml.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QDateTime>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace LenovoLegionDaemon {
+
+SysFsDataProviderAutoPowerProfile::SysFsDataProviderAutoPowerProfile(SysFsDriverManager* sysFsDriverManager,DataProviderManager* dataProviderManager) :
+    SysFsDataProvider(sysFsDriverManager,dataProviderManager,dataType),
+    m_dataProviderManager(dataProviderManager),
+    m_timer(new QTimer(this)),
+    m_enabled(false),
+    m_cpuLoad(0),
+    m_gpuLoad(0),
+    m_onBattery(false),
+    m_currentProfile(UNKNOWN),
+    m_targetProfile(UNKNOWN),
+    m_switches(0)
+{
+    m_timer->setInterval(SAMPLE_PERIOD_MS);
+
+    connect(m_timer,&QTimer::timeout,this,&SysFsDataProviderAutoPowerProfile::sample);
+}
+
+QByteArray SysFsDataProviderAutoPowerProfile::serializeAndGetData() const
+{
+    legion::messages::AutoPowerProfile autoPowerProfile;
+    QByteArray                         byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    autoPowerProfile.set_enabled(m_enabled);
+    autoPowerProfile.set_quiet_threshold(m_config.m_quietThreshold);
+    autoPowerProfile.set_performance_threshold(m_config.m_performanceThreshold);
+    autoPowerProfile.set_hysteresis(m_config.m_hysteresis);
+    autoPowerProfile.set_dwell_time(m_config.m_dwellTime);
+    autoPowerProfile.set_high_load_profile(static_cast<legion::messages::AutoPowerProfile::Profile>(m_config.m_highLoadProfile));
+    autoPowerProfile.set_battery_profile(static_cast<legion::messages::AutoPowerProfile::Profile>(m_config.m_batteryProfile));
+
+    autoPowerProfile.set_cpu_utilization(static_cast<quint32>(m_cpuLoad + 0.5));
+    autoPowerProfile.set_gpu_utilization(static_cast<quint32>(m_gpuLoad + 0.5));
+    autoPowerProfile.set_on_battery(m_onBattery);
+    autoPowerProfile.set_current_profile(static_cast<legion::messages::AutoPowerProfile::Profile>(m_currentProfile));
+    autoPowerProfile.set_target_profile(static_cast<legion::messages::AutoPowerProfile::Profile>(m_targetProfile));
+    autoPowerProfile.set_switches(m_switches);
+
+    for(const auto& item : m_history)
+    {
+        auto switchMsg = autoPowerProfile.add_history();
+
+        switchMsg->set_timestamp(item.m_timestamp);
+        switchMsg->set_from(static_cast<legion::messages::AutoPowerProfile::Profile>(item.m_from));
+        switchMsg->set_to(static_cast<legion::messages::AutoPowerProfile::Profile>(item.m_to));
+        switchMsg->set_cpu_utilization(item.m_cpuUtilization);
+        switchMsg->set_gpu_utilization(item.m_gpuUtilization);
+        switchMsg->set_on_battery(item.m_onBattery);
+        switchMsg->set_reason(static_cast<legion::messages::AutoPowerProfile::Reason>(item.m_reason));
+    }
+
+    byteArray.resize(autoPowerProfile.ByteSizeLong());
+    if(!autoPowerProfile.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray SysFsDataProviderAutoPowerProfile::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::AutoPowerProfile autoPowerProfile;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!autoPowerProfile.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    Config config = m_config;
+
+    if(autoPowerProfile.has_quiet_threshold())
+    {
+        config.m_quietThreshold = autoPowerProfile.quiet_threshold();
+    }
+
+    if(autoPowerProfile.has_performance_threshold())
+    {
+        config.m_performanceThreshold = autoPowerProfile.performance_threshold();
+    }
+
+    if(autoPowerProfile.has_hysteresis())
+    {
+        config.m_hysteresis = autoPowerProfile.hysteresis();
+    }
+
+    if(autoPowerProfile.has_dwell_time())
+    {
+        config.m_dwellTime = autoPowerProfile.dwell_time();
+    }
+
+    if(autoPowerProfile.has_high_load_profile())
+    {
+        config.m_highLoadProfile = static_cast<Profile>(autoPowerProfile.high_load_profile());
+    }
+
+    if(autoPowerProfile.has_battery_profile())
+    {
+        config.m_batteryProfile = static_cast<Profile>(autoPowerProfile.battery_profile());
+    }
+
+    if(config.m_quietThreshold >= config.m_performanceThreshold || config.m_performanceThreshold > 100 ||
+       (config.m_highLoadProfile != PERFORMANCE && config.m_highLoadProfile != CUSTOM) ||
+       (config.m_batteryProfile != QUIET && config.m_batteryProfile != BALANCED && config.m_batteryProfile != PERFORMANCE && config.m_batteryProfile != CUSTOM))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid auto power profile configuration !");
+    }
+
+    m_config = config;
+
+    if(autoPowerProfile.has_enabled() && autoPowerProfile.enabled() != m_enabled)
+    {
+        if(autoPowerProfile.enabled())
+        {
+            start();
+        }
+        else
+        {
+            stop();
+        }
+    }
+
+    return {};
+}
+
+void SysFsDataProviderAutoPowerProfile::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+}
+
+void SysFsDataProviderAutoPowerProfile::clean()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    stop();
+}
+
+void SysFsDataProviderAutoPowerProfile::start()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    const auto owner = ControlOwnership::conflict(OWNER,ControlOwnership::POWER_MODE);
+
+    if(owner.has_value())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Power mode is controlled by " + owner->toStdString() + " !");
+    }
+
+    m_currentProfile = readProfile();
+    m_targetProfile  = m_currentProfile;
+    m_writtenProfile = m_currentProfile;
+
+    /*
+     * Seed the averages, the first switch waits for the dwell time anyway
+     */
+    m_lastCPUTimes   = ProcStat::read(SysFsDriver::rootedPath("/proc")).m_all;
+    m_cpuLoad        = 0;
+    m_gpuLoad        = readGPUUtilization();
+    m_onBattery      = readOnBattery();
+
+    m_history.clear();
+    m_dwellTimer.start();
+    m_enabled        = true;
+
+    ControlOwnership::acquire(OWNER,ControlOwnership::POWER_MODE);
+
+    m_timer->start();
+}
+
+void SysFsDataProviderAutoPowerProfile::stop()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    m_timer->stop();
+    m_enabled = false;
+    m_writtenProfile.reset();
+
+    ControlOwnership::release(OWNER);
+}
+
+void SysFsDataProviderAutoPowerProfile::sample()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Called from timer, nobody above us would handle the exception
+     */
+    try {
+        m_cpuLoad += SMOOTHING * (readCPUUtilization() - m_cpuLoad);
+        m_gpuLoad += SMOOTHING * (readGPUUtilization() - m_gpuLoad);
+
+        const bool onBattery = readOnBattery();
+        const bool unplugged = onBattery && !m_onBattery;
+
+        m_onBattery      = onBattery;
+        m_currentProfile = readProfile();
+
+        if(m_writtenProfile.has_value() && m_writtenProfile.value() != m_currentProfile)
+        {
+            /*
+             * Somebody else changed the profile, keep it at least for the dwell time
+             */
+            addSwitch(m_writtenProfile.value(),m_currentProfile,USER);
+
+            m_writtenProfile = m_currentProfile;
+            m_dwellTimer.restart();
+        }
+
+        const double load    = std::max(m_cpuLoad,m_gpuLoad);
+        const quint8 current = levelForProfile(m_currentProfile);
+        quint8       target  = levelForLoad(load);
+
+        if(target < current)
+        {
+            /*
+             * Step down only when the load left the band of the current level by the hysteresis
+             */
+            target = std::min(current,levelForLoad(load + m_config.m_hysteresis));
+        }
+
+        if(m_onBattery)
+        {
+            target = std::min(target,levelForProfile(m_config.m_batteryProfile));
+        }
+
+        if(target == current)
+        {
+            m_targetProfile = m_currentProfile;
+            return;
+        }
+
+        m_targetProfile = profileForLevel(target);
+
+        if(unplugged && target < current)
+        {
+            writeProfile(m_targetProfile);
+            addSwitch(m_currentProfile,m_targetProfile,POWER_SOURCE);
+
+            m_currentProfile = m_targetProfile;
+        }
+        else if(m_dwellTimer.elapsed() >= static_cast<qint64>(m_config.m_dwellTime) * 1000)
+        {
+            writeProfile(m_targetProfile);
+            addSwitch(m_currentProfile,m_targetProfile,LOAD);
+
+            m_currentProfile = m_targetProfile;
+        }
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Sample failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+quint32 SysFsDataProviderAutoPowerProfile::readCPUUtilization()
+{
+    const ProcStat::CPUTimes times = ProcStat::read(SysFsDriver::rootedPath("/proc")).m_all;
+    const quint32 utilization      = ProcStat::utilization(m_lastCPUTimes,times);
+
+    m_lastCPUTimes = times;
+
+    return utilization;
+}
+
+quint32 SysFsDataProviderAutoPowerProfile::readGPUUtilization() const
+{
+    const auto& nvml     = dynamic_cast<const DataProviderNvidiaNvml&>(m_dataProviderManager->getDataProvider(DataProviderNvidiaNvml::dataType));
+    const auto  snapshot = nvml.snapshot();
+
+    /*
+     * No NVIDIA GPU or it is switched off, it does not add any load
+     */
+    if(snapshot == nullptr || !snapshot->has_hardware_monitor())
+    {
+        return 0;
+    }
+
+    return snapshot->hardware_monitor().gpu_utilization().value();
+}
+
+bool SysFsDataProviderAutoPowerProfile::readOnBattery() const
+{
+    try {
+        SysFsDriverPowerSuplyBattery0::PowerSuplyBattery0 batery0(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverPowerSuplyBattery0::DRIVER_NAME));
+
+        return getData(batery0.m_powerSuplyBattery0).trimmed() == "Discharging";
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Power supply Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    return false;
+}
+
+SysFsDataProviderAutoPowerProfile::Profile SysFsDataProviderAutoPowerProfile::readProfile() const
+{
+    SysFSDriverLegionGameZone::GameZone::SmartFan smartFan(m_sysFsDriverManager->getDriverDesriptor(SysFSDriverLegionGameZone::DRIVER_NAME));
+
+    return static_cast<Profile>(getData(smartFan.m_current_value).toUShort());
+}
+
+void SysFsDataProviderAutoPowerProfile::writeProfile(Profile profile)
+{
+    SysFSDriverLegionGameZone::GameZone::SmartFan smartFan(m_sysFsDriverManager->getDriverDesriptor(SysFSDriverLegionGameZone::DRIVER_NAME));
+
+    setData(smartFan.m_current_value,static_cast<quint8>(profile));
+
+    m_writtenProfile = profile;
+    m_dwellTimer.restart();
+    ++m_switches;
+}
+
+quint8 SysFsDataProviderAutoPowerProfile::levelForLoad(double load) const
+{
+    if(load >= m_config.m_performanceThreshold)
+    {
+        return 2;
+    }
+
+    if(load >= m_config.m_quietThreshold)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+quint8 SysFsDataProviderAutoPowerProfile::levelForProfile(Profile profile) const
+{
+    switch (profile) {
+    case QUIET:
+        return 0;
+    case PERFORMANCE:
+    case EXTREME:
+    case CUSTOM:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+SysFsDataProviderAutoPowerProfile::Profile SysFsDataProviderAutoPowerProfile::profileForLevel(quint8 level) const
+{
+    switch (level) {
+    case 0:
+        return QUIET;
+    case 1:
+        return BALANCED;
+    default:
+        return m_config.m_highLoadProfile;
+    }
+}
+
+void SysFsDataProviderAutoPowerProfile::addSwitch(Profile from, Profile to, Reason reason)
+{
+    const Switch item {
+        .m_timestamp      = QDateTime::currentMSecsSinceEpoch(),
+        .m_from           = from,
+        .m_to             = to,
+        .m_cpuUtilization = static_cast<quint32>(m_cpuLoad + 0.5),
+        .m_gpuUtilization = static_cast<quint32>(m_gpuLoad + 0.5),
+        .m_onBattery      = m_onBattery,
+        .m_reason         = reason
+    };
+
+    LOGF_I("Auto power profile: {} -> {}, cpu={}%, gpu={}%, battery={}, reason={}",item.m_from,item.m_to,item.m_cpuUtilization,item.m_gpuUtilization,item.m_onBattery,item.m_reason);
+
+    m_history.push_back(item);
+
+    if(m_history.size() > HISTORY_CAPACITY)
+    {
+        m_history.pop_front();
+    }
+}
+
+}
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <SysFsDataProvider.h>
+
+#include "ProcStat.h"
+
+#include <QElapsedTimer>
+
+#include <deque>
+#include <optional>
+
+class QTimer;
+
+namespace LenovoLegionDaemon {
+
+class DataProviderManager;
+
+/*
+ * Switches the power profile by the system load, the CPU and GPU utilization are
+ * smoothed and the higher one is compared against the thresholds
+ */
+class SysFsDataProviderAutoPowerProfile : public SysFsDataProvider
+{
+public:
+
+    /*
+     * Same values as legion::messages::PowerProfile::Profiles
+     */
+    enum Profile : quint8 {
+        UNKNOWN         = 0,
+        QUIET           = 1,
+        BALANCED        = 2,
+        PERFORMANCE     = 3,
+        EXTREME         = 224,
+        CUSTOM          = 255
+    };
+
+    /*
+     * Same values as legion::messages::AutoPowerProfile::Reason
+     */
+    enum Reason : quint8 {
+        LOAD            = 0,
+        POWER_SOURCE    = 1,
+        USER            = 2
+    };
+
+    struct Config {
+        quint32 m_quietThreshold        = 15;
+        quint32 m_performanceThreshold  = 60;
+        quint32 m_hysteresis            = 5;
+        quint32 m_dwellTime             = 30;           // s
+        Profile m_highLoadProfile       = PERFORMANCE;
+        Profile m_batteryProfile        = BALANCED;
+    };
+
+    struct Switch {
+        qint64  m_timestamp             = 0;
+        Profile m_from                  = UNKNOWN;
+        Profile m_to                    = UNKNOWN;
+        quint32 m_cpuUtilization        = 0;
+        quint32 m_gpuUtilization        = 0;
+        bool    m_onBattery             = false;
+        Reason  m_reason                = LOAD;
+    };
+
+public:
+
+    SysFsDataProviderAutoPowerProfile(SysFsDriverManager* sysFsDriverManager,DataProviderManager* dataProviderManager);
+
+    virtual QByteArray serializeAndGetData()                    const override;
+    virtual QByteArray deserializeAndSetData(const QByteArray&)       override;
+
+    virtual void init()  override;
+    virtual void clean() override;
+
+private:
+
+    void sample();
+
+    void start();
+    void stop();
+
+    quint32 readCPUUtilization();
+    quint32 readGPUUtilization() const;
+    bool    readOnBattery() const;
+
+    Profile readProfile() const;
+    void    writeProfile(Profile profile);
+
+    /*
+     * Load level 0 - quiet, 1 - balanced, 2 - high load
+     */
+    quint8  levelForLoad(double load) const;
+    quint8  levelForProfile(Profile profile) const;
+    Profile profileForLevel(quint8 level) const;
+
+    void    addSwitch(Profile from,Profile to,Reason reason);
+
+private:
+
+    DataProviderManager*        m_dataProviderManager;
+
+    QTimer*                     m_timer;
+
+    bool                        m_enabled;
+    Config                      m_config;
+
+    ProcStat::CPUTimes          m_lastCPUTimes;
+    double                      m_cpuLoad;
+    double                      m_gpuLoad;
+    bool                        m_onBattery;
+
+    Profile                     m_currentProfile;
+    Profile                     m_targetProfile;
+
+    /*
+     * Profile written by the engine, a different value read back means the user took over
+     */
+    std::optional<Profile>      m_writtenProfile;
+    QElapsedTimer               m_dwellTimer;
+    quint64                     m_switches;
+
+    std::deque<Switch>          m_history;
+
+public:
+
+    static constexpr quint8  dataType = 24;
+
+    static constexpr const char* OWNER = "auto power profile";
+
+    static constexpr int     SAMPLE_PERIOD_MS    = 2000;
+    static constexpr size_t  HISTORY_CAPACITY    = 64;
+
+    /*
+     * Weight of the new sample in the exponential moving average
+     */
+    static constexpr double  SMOOTHING           = 0.3;
+};
+
+}
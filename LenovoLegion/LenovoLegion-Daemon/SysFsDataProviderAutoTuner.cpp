@@ -0,0 +1,974 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "SysFsDataProviderAutoTuner.h"
+#include "SysFsDriverIntelPowercapRapl.h"
+#include "SysFSDriverLegionGameZone.h"
+#include "SysFSDriverLegionHWMon.h"
+#include "SysFsDriverLegionOther.h"
+#include "SysFsDriverCPUXList.h"
+#include "SysFsDriverCPU.h"
+#include "CPUList.h"
+#include "ControlOwnership.h"
+#include "PeerCredentials.h"
+#include "Settings.h"
+
+#include "../LenovoLegion-PrepareBuild/AutoTuner.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QDateTime>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace LenovoLegionDaemon {
+
+namespace {
+
+void fillSetting(legion::messages::AutoTuner::Setting* settingMsg,const SysFsDataProviderAutoTuner::Setting& setting)
+{
+    settingMsg->set_cpu_ltp_limit(setting.m_cpuLtpLimit);
+    settingMsg->set_cpu_stp_limit(setting.m_cpuStpLimit);
+    settingMsg->set_cpu_pl1_tau(setting.m_cpuPl1Tau);
+    settingMsg->set_governor(setting.m_governor.toStdString());
+}
+
+void fillCandidate(legion::messages::AutoTuner::Candidate* candidateMsg,const SysFsDataProviderAutoTuner::Candidate& candidate)
+{
+    fillSetting(candidateMsg->mutable_setting(),candidate.m_setting);
+
+    candidateMsg->set_throughput(candidate.m_throughput);
+    candidateMsg->set_power(candidate.m_power);
+    candidateMsg->set_efficiency(candidate.efficiency());
+    candidateMsg->set_max_temperature(candidate.m_maxTemperature);
+    candidateMsg->set_max_fan_speed(candidate.m_maxFanSpeed);
+    candidateMsg->set_verdict(static_cast<legion::messages::AutoTuner::Verdict>(candidate.m_verdict));
+}
+
+SysFsDataProviderAutoTuner::Candidate parseCandidate(const legion::messages::AutoTuner::Candidate& candidateMsg)
+{
+    return SysFsDataProviderAutoTuner::Candidate {
+        .m_setting = {
+            .m_cpuLtpLimit  = candidateMsg.setting().cpu_ltp_limit(),
+            .m_cpuStpLimit  = candidateMsg.setting().cpu_stp_limit(),
+            .m_cpuPl1Tau    = candidateMsg.setting().cpu_pl1_tau(),
+            .m_governor     = QString::fromStdString(candidateMsg.setting().governor())
+        },
+        .m_throughput       = candidateMsg.throughput(),
+        .m_power            = candidateMsg.power(),
+        .m_maxTemperature   = candidateMsg.max_temperature(),
+        .m_maxFanSpeed      = candidateMsg.max_fan_speed(),
+        .m_verdict          = static_cast<SysFsDataProviderAutoTuner::Verdict>(candidateMsg.verdict())
+    };
+}
+
+}
+
+SysFsDataProviderAutoTuner::SysFsDataProviderAutoTuner(SysFsDriverManager* sysFsDriverManager,QObject* parent) :
+    SysFsDataProvider(sysFsDriverManager,parent,dataType),
+    m_timer(new QTimer(this)),
+    m_state(IDLE),
+    m_dimension(0),
+    m_startWork(0)
+{
+    m_timer->setInterval(STEP_PERIOD_MS);
+
+    connect(m_timer,&QTimer::timeout,this,&SysFsDataProviderAutoTuner::step);
+}
+
+QByteArray SysFsDataProviderAutoTuner::serializeAndGetData() const
+{
+    legion::messages::AutoTuner autoTuner;
+    QByteArray                  byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    autoTuner.set_enabled(running());
+    autoTuner.set_objective(static_cast<legion::messages::AutoTuner::Objective>(m_config.m_objective));
+    autoTuner.set_kernel(m_config.m_kernel);
+    autoTuner.set_budget(m_config.m_budget);
+    autoTuner.set_steps(m_config.m_steps);
+    autoTuner.set_warmup(m_config.m_warmup);
+    autoTuner.set_measurement(m_config.m_measurement);
+    autoTuner.set_max_temperature(m_config.m_maxTemperature);
+    autoTuner.set_quiet_performance(m_config.m_quietPerformance);
+    autoTuner.set_state(static_cast<legion::messages::AutoTuner::State>(m_state));
+
+    if(m_state != IDLE)
+    {
+        fillSetting(autoTuner.mutable_original(),m_original);
+        fillSetting(autoTuner.mutable_incumbent(),m_incumbent);
+    }
+
+    for(const auto& candidate : m_candidates)
+    {
+        fillCandidate(autoTuner.add_candidates(),candidate);
+    }
+
+    for(const auto& [objective,profile] : m_profiles)
+    {
+        auto profileMsg = autoTuner.add_profiles();
+
+        profileMsg->set_name(profileName(objective).toStdString());
+        profileMsg->set_objective(static_cast<legion::messages::AutoTuner::Objective>(objective));
+        profileMsg->set_timestamp(profile.m_timestamp);
+        fillCandidate(profileMsg->mutable_candidate(),profile.m_candidate);
+    }
+
+    byteArray.resize(autoTuner.ByteSizeLong());
+    if(!autoTuner.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray SysFsDataProviderAutoTuner::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::AutoTuner autoTuner;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!autoTuner.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    /*
+     * A search runs the load generator on all CPUs and both paths write the CPU power limits
+     */
+    if((autoTuner.has_apply_profile() || (autoTuner.has_enabled() && autoTuner.enabled())) && !PeerCredentials::isPrivileged())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Auto tuner requested by an unprivileged client !");
+    }
+
+    Config config = m_config;
+
+    if(autoTuner.has_objective())
+    {
+        config.m_objective = static_cast<Objective>(autoTuner.objective());
+    }
+
+    if(autoTuner.has_kernel())
+    {
+        config.m_kernel = static_cast<LoadGenerator::Kernel>(autoTuner.kernel());
+    }
+
+    if(autoTuner.has_budget())
+    {
+        config.m_budget = autoTuner.budget();
+    }
+
+    if(autoTuner.has_steps())
+    {
+        config.m_steps = autoTuner.steps();
+    }
+
+    if(autoTuner.has_warmup())
+    {
+        config.m_warmup = autoTuner.warmup();
+    }
+
+    if(autoTuner.has_measurement())
+    {
+        config.m_measurement = autoTuner.measurement();
+    }
+
+    if(autoTuner.has_max_temperature())
+    {
+        config.m_maxTemperature = autoTuner.max_temperature();
+    }
+
+    if(autoTuner.has_quiet_performance())
+    {
+        config.m_quietPerformance = autoTuner.quiet_performance();
+    }
+
+    if(config.m_objective > QUIET || config.m_kernel > LoadGenerator::MEMORY_BANDWIDTH ||
+       config.m_budget == 0 || config.m_budget > MAX_BUDGET ||
+       config.m_steps < 2 || config.m_steps > MAX_STEPS ||
+       config.m_warmup == 0 || config.m_warmup > 600 ||
+       config.m_measurement == 0 || config.m_measurement > 600 ||
+       config.m_maxTemperature < 60 || config.m_maxTemperature > 105 ||
+       config.m_quietPerformance == 0 || config.m_quietPerformance > 100)
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid auto tuner configuration !");
+    }
+
+    /*
+     * Applies to the next search
+     */
+    m_config = config;
+
+    if(autoTuner.has_apply_profile())
+    {
+        if(running())
+        {
+            THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Auto tuner is running !");
+        }
+
+        const auto profile = m_profiles.find(static_cast<Objective>(autoTuner.apply_profile()));
+
+        if(profile == m_profiles.end())
+        {
+            THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"No auto tuner profile of the objective !");
+        }
+
+        applySetting(profile->second.m_candidate.m_setting);
+
+        LOGF_I("Auto tuner: profile {} applied",profileName(profile->first));
+    }
+
+    if(autoTuner.has_enabled() && autoTuner.enabled() != running())
+    {
+        if(autoTuner.enabled())
+        {
+            start();
+        }
+        else
+        {
+            stop(IDLE);
+        }
+    }
+
+    return {};
+}
+
+void SysFsDataProviderAutoTuner::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    try {
+        loadProfiles();
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Load of auto tuner profiles failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+void SysFsDataProviderAutoTuner::clean()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    stop(IDLE);
+}
+
+QString SysFsDataProviderAutoTuner::profileName(Objective objective)
+{
+    switch (objective) {
+    case MAX_PERFORMANCE:
+        return "max-performance";
+    case BEST_EFFICIENCY:
+        return "best-efficiency";
+    case QUIET:
+        return "quiet";
+    }
+
+    return {};
+}
+
+void SysFsDataProviderAutoTuner::start()
+{
+    quint32 temperature = 0, fanSpeed = 0;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!LoadGenerator::supported(m_config.m_kernel))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Load kernel not supported by the CPU !");
+    }
+
+    const auto owner = ControlOwnership::conflict(OWNER,ControlOwnership::CPU_POWER_LIMITS | ControlOwnership::CPU_GOVERNOR);
+
+    if(owner.has_value())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"CPU power limits or governor are controlled by " + owner->toStdString() + " !");
+    }
+
+    /*
+     * Temperature is the stability guard, no search without it
+     */
+    readSensors(temperature,fanSpeed);
+
+    if(temperature == 0)
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"CPU temperature not available !");
+    }
+
+    SysFSDriverLegionGameZone::GameZone::SmartFan smartFan(m_sysFsDriverManager->getDriverDesriptor(SysFSDriverLegionGameZone::DRIVER_NAME));
+    SysFsDriverLegionOther::Other::CPU            cpuControl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverLegionOther::DRIVER_NAME));
+
+    const quint32 mode = getData(smartFan.m_current_value).toUInt();
+
+    m_original  = readSetting();
+    m_incumbent = m_original;
+    m_cpus      = onlineCPUs();
+
+    /*
+     * Evenly spread over the range of the current power mode, unknown range leaves the limit alone
+     */
+    auto values = [this](const std::optional<Range>& range,quint32 current) {
+        std::vector<quint32> result;
+
+        if(!range.has_value())
+        {
+            return std::vector<quint32>{current};
+        }
+
+        for(quint32 i = 0; i < m_config.m_steps; ++i)
+        {
+            const quint32 value = range->m_min + (range->m_max - range->m_min) * i / (m_config.m_steps - 1);
+
+            if(result.empty() || result.back() != value)
+            {
+                result.push_back(value);
+            }
+        }
+
+        return result;
+    };
+
+    m_ltpValues = values(readRange(cpuControl.m_cpu_ltp_limit.m_min_value,cpuControl.m_cpu_ltp_limit.m_max_value,mode),m_original.m_cpuLtpLimit);
+    m_stpValues = values(readRange(cpuControl.m_cpu_stp_limit.m_min_value,cpuControl.m_cpu_stp_limit.m_max_value,mode),m_original.m_cpuStpLimit);
+    m_tauValues = values(readRange(cpuControl.m_cpu_pl1_tau.m_min_value,cpuControl.m_cpu_pl1_tau.m_max_value,mode),m_original.m_cpuPl1Tau);
+    m_governors.clear();
+
+    try {
+        SysFsDriverCPUXList::CPUXList cpus(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXList::DRIVER_NAME));
+
+        if(!cpus.cpuList().empty())
+        {
+            for(const auto& governor : getData(cpus.cpuList().front().m_freq.m_cpuScalingAvailableGovernors).split(' ',Qt::SkipEmptyParts))
+            {
+                m_governors.push_back(governor.trimmed());
+            }
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- CPUX Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    /*
+     * Original setting is measured first, it is the reference of the search
+     */
+    m_candidates.clear();
+    m_queue     = {m_original};
+    m_dimension = 0;
+
+    ControlOwnership::acquire(OWNER,ControlOwnership::CPU_POWER_LIMITS | ControlOwnership::CPU_GOVERNOR);
+
+    m_state     = WARMUP;
+
+    m_generator.start(m_config.m_kernel,m_cpus,100,std::chrono::milliseconds(100));
+    m_timer->start();
+
+    LOGF_I("Auto tuner: search started, objective={}, budget={}, cpu_ltp={}W, cpu_stp={}W, cpu_pl1_tau={}s, governor={}",
+           profileName(m_config.m_objective),m_config.m_budget,m_original.m_cpuLtpLimit,m_original.m_cpuStpLimit,m_original.m_cpuPl1Tau,m_original.m_governor);
+
+    try {
+        next();
+    }
+    catch(...)
+    {
+        stop(FAILED);
+        throw;
+    }
+}
+
+void SysFsDataProviderAutoTuner::stop(State state)
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    const bool wasRunning = running();
+
+    m_timer->stop();
+    m_generator.stop();
+    m_queue.clear();
+
+    if(wasRunning)
+    {
+        try {
+            applySetting(m_original);
+        }
+        catch(const bj::framework::exception::Exception& ex)
+        {
+            LOG_W(QString(__PRETTY_FUNCTION__) + "- Restore of the original setting failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        }
+    }
+
+    ControlOwnership::release(OWNER);
+
+    if(wasRunning && state == FINISHED)
+    {
+        for(const auto objective : {MAX_PERFORMANCE,BEST_EFFICIENCY,QUIET})
+        {
+            const auto candidate = best(objective);
+
+            if(candidate.has_value())
+            {
+                m_profiles[objective] = Profile {
+                    .m_candidate = candidate.value(),
+                    .m_timestamp = QDateTime::currentMSecsSinceEpoch()
+                };
+            }
+        }
+
+        try {
+            saveProfiles();
+        }
+        catch(const bj::framework::exception::Exception& ex)
+        {
+            LOG_W(QString(__PRETTY_FUNCTION__) + "- Save of auto tuner profiles failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        }
+    }
+
+    if(wasRunning || state == IDLE)
+    {
+        m_state = state;
+    }
+
+    if(wasRunning)
+    {
+        LOGF_I("Auto tuner: search ended, state={}, candidates={}",m_state,m_candidates.size());
+    }
+}
+
+bool SysFsDataProviderAutoTuner::running() const
+{
+    return m_state == WARMUP || m_state == MEASUREMENT || m_state == COOLDOWN;
+}
+
+void SysFsDataProviderAutoTuner::step()
+{
+    quint32 temperature = 0, fanSpeed = 0;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Called from timer, nobody above us would handle the exception
+     */
+    try {
+        readSensors(temperature,fanSpeed);
+
+        if(temperature == 0)
+        {
+            LOG_W(QString(__PRETTY_FUNCTION__) + "- CPU temperature lost, auto tuning aborted");
+            stop(FAILED);
+            return;
+        }
+
+        if(m_state == COOLDOWN)
+        {
+            if(temperature + COOLDOWN_HYSTERESIS <= m_config.m_maxTemperature)
+            {
+                m_generator.start(m_config.m_kernel,m_cpus,100,std::chrono::milliseconds(100));
+                next();
+            }
+            else if(m_phaseTimer.elapsed() >= COOLDOWN_TIMEOUT * 1000)
+            {
+                LOG_W(QString(__PRETTY_FUNCTION__) + "- CPU did not cool down in " + QString::number(COOLDOWN_TIMEOUT) + "s, auto tuning aborted");
+                stop(FAILED);
+            }
+
+            return;
+        }
+
+        m_current.m_maxTemperature = std::max(m_current.m_maxTemperature,temperature);
+        m_current.m_maxFanSpeed    = std::max(m_current.m_maxFanSpeed,fanSpeed);
+
+        if(temperature >= m_config.m_maxTemperature)
+        {
+            finishCandidate(OVERHEAT);
+            return;
+        }
+
+        if(m_state == WARMUP)
+        {
+            if(m_phaseTimer.elapsed() >= static_cast<qint64>(m_config.m_warmup) * 1000)
+            {
+                m_state                    = MEASUREMENT;
+                m_startWork                = m_generator.work();
+                m_lastEnergy               = readEnergy();
+                m_energy                   = m_lastEnergy.has_value() ? std::optional<quint64>(0) : std::nullopt;
+                m_current.m_maxTemperature = temperature;
+                m_current.m_maxFanSpeed    = fanSpeed;
+
+                m_phaseTimer.restart();
+            }
+
+            return;
+        }
+
+        const std::optional<quint64> energy = readEnergy();
+
+        if(energy.has_value() && m_lastEnergy.has_value() && m_energy.has_value())
+        {
+            /*
+             * energy_uj wraps around at max_energy_range_uj
+             */
+            m_energy = m_energy.value() + (energy.value() >= m_lastEnergy.value() ? energy.value() - m_lastEnergy.value()
+                                                                                  : maxEnergy() - m_lastEnergy.value() + energy.value());
+        }
+        else
+        {
+            m_energy.reset();
+        }
+
+        m_lastEnergy = energy;
+
+        if(m_phaseTimer.elapsed() >= static_cast<qint64>(m_config.m_measurement) * 1000)
+        {
+            finishCandidate(OK);
+        }
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Auto tuning failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        stop(FAILED);
+    }
+}
+
+void SysFsDataProviderAutoTuner::next()
+{
+    while (m_queue.empty()) {
+        if(m_dimension >= DIMENSION_COUNT)
+        {
+            stop(FINISHED);
+            return;
+        }
+
+        /*
+         * Next setting is searched around the best one found so far
+         */
+        const auto incumbent = best(m_config.m_objective);
+
+        if(incumbent.has_value())
+        {
+            m_incumbent = incumbent->m_setting;
+        }
+
+        m_queue = candidatesFor(static_cast<Dimension>(m_dimension++));
+    }
+
+    if(m_candidates.size() >= m_config.m_budget)
+    {
+        stop(FINISHED);
+        return;
+    }
+
+    m_current = Candidate {
+        .m_setting = m_queue.front()
+    };
+
+    m_queue.pop_front();
+
+    applySetting(m_current.m_setting);
+
+    m_state = WARMUP;
+    m_phaseTimer.restart();
+
+    LOGF_D("Auto tuner: candidate {}, cpu_ltp={}W, cpu_stp={}W, cpu_pl1_tau={}s, governor={}",
+           m_candidates.size() + 1,m_current.m_setting.m_cpuLtpLimit,m_current.m_setting.m_cpuStpLimit,m_current.m_setting.m_cpuPl1Tau,m_current.m_setting.m_governor);
+}
+
+void SysFsDataProviderAutoTuner::finishCandidate(Verdict verdict)
+{
+    const double seconds = m_phaseTimer.elapsed() / 1000.0;
+
+    m_current.m_verdict = verdict;
+
+    if(verdict == OK && seconds > 0)
+    {
+        m_current.m_throughput = (m_generator.work() - m_startWork) / seconds / 1e9;
+        m_current.m_power      = m_energy.has_value() ? m_energy.value() / 1e6 / seconds : 0;
+    }
+
+    m_candidates.push_back(m_current);
+
+    LOGF_I("Auto tuner: cpu_ltp={}W, cpu_stp={}W, cpu_pl1_tau={}s, governor={}, throughput={}, power={}W, temperature={}, fan={}, verdict={}",
+           m_current.m_setting.m_cpuLtpLimit,m_current.m_setting.m_cpuStpLimit,m_current.m_setting.m_cpuPl1Tau,m_current.m_setting.m_governor,
+           m_current.m_throughput,m_current.m_power,m_current.m_maxTemperature,m_current.m_maxFanSpeed,verdict);
+
+    if(verdict == OVERHEAT)
+    {
+        /*
+         * Back to the last good setting without load until the CPU cools down
+         */
+        m_generator.stop();
+        applySetting(m_incumbent);
+
+        m_state = COOLDOWN;
+        m_phaseTimer.restart();
+        return;
+    }
+
+    next();
+}
+
+std::deque<SysFsDataProviderAutoTuner::Setting> SysFsDataProviderAutoTuner::candidatesFor(Dimension dimension) const
+{
+    std::deque<Setting> result;
+
+    auto add = [&](const Setting& setting) {
+        /*
+         * Firmware does not accept a short term limit below the long term one
+         */
+        if(setting.m_cpuStpLimit >= setting.m_cpuLtpLimit && !measured(setting) && std::find(result.begin(),result.end(),setting) == result.end())
+        {
+            result.push_back(setting);
+        }
+    };
+
+    switch (dimension) {
+    case CPU_LTP_LIMIT:
+        for(const auto value : m_ltpValues)
+        {
+            Setting setting = m_incumbent;
+            setting.m_cpuLtpLimit = value;
+            add(setting);
+        }
+        break;
+    case CPU_STP_LIMIT:
+        for(const auto value : m_stpValues)
+        {
+            Setting setting = m_incumbent;
+            setting.m_cpuStpLimit = value;
+            add(setting);
+        }
+        break;
+    case CPU_PL1_TAU:
+        for(const auto value : m_tauValues)
+        {
+            Setting setting = m_incumbent;
+            setting.m_cpuPl1Tau = value;
+            add(setting);
+        }
+        break;
+    case GOVERNOR:
+        for(const auto& value : m_governors)
+        {
+            Setting setting = m_incumbent;
+            setting.m_governor = value;
+            add(setting);
+        }
+        break;
+    case DIMENSION_COUNT:
+        break;
+    }
+
+    return result;
+}
+
+bool SysFsDataProviderAutoTuner::measured(const Setting &setting) const
+{
+    return std::any_of(m_candidates.begin(),m_candidates.end(),[&setting](const Candidate& candidate){ return candidate.m_setting == setting; });
+}
+
+std::optional<double> SysFsDataProviderAutoTuner::score(const Candidate &candidate, Objective objective) const
+{
+    if(candidate.m_verdict != OK)
+    {
+        return std::nullopt;
+    }
+
+    switch (objective) {
+    case MAX_PERFORMANCE:
+        return candidate.m_throughput;
+    case BEST_EFFICIENCY:
+        if(candidate.m_power <= 0)
+        {
+            return std::nullopt;
+        }
+        return candidate.efficiency();
+    case QUIET:
+    {
+        double maxThroughput = 0;
+
+        for(const auto& other : m_candidates)
+        {
+            if(other.m_verdict == OK)
+            {
+                maxThroughput = std::max(maxThroughput,other.m_throughput);
+            }
+        }
+
+        if(maxThroughput <= 0 || candidate.m_throughput < maxThroughput * m_config.m_quietPerformance / 100)
+        {
+            return std::nullopt;
+        }
+
+        /*
+         * Slowest fans, the throughput decides between the same speeds
+         */
+        return -static_cast<double>(candidate.m_maxFanSpeed) + candidate.m_throughput / maxThroughput;
+    }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<SysFsDataProviderAutoTuner::Candidate> SysFsDataProviderAutoTuner::best(Objective objective) const
+{
+    std::optional<Candidate> result;
+    std::optional<double>    bestScore;
+
+    for(const auto& candidate : m_candidates)
+    {
+        const auto candidateScore = score(candidate,objective);
+
+        if(candidateScore.has_value() && (!bestScore.has_value() || candidateScore.value() > bestScore.value()))
+        {
+            bestScore = candidateScore;
+            result    = candidate;
+        }
+    }
+
+    return result;
+}
+
+SysFsDataProviderAutoTuner::Setting SysFsDataProviderAutoTuner::readSetting() const
+{
+    SysFsDriverLegionOther::Other::CPU cpuControl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverLegionOther::DRIVER_NAME));
+
+    Setting setting {
+        .m_cpuLtpLimit = getData(cpuControl.m_cpu_ltp_limit.m_current_value).toUInt(),
+        .m_cpuStpLimit = getData(cpuControl.m_cpu_stp_limit.m_current_value).toUInt(),
+        .m_cpuPl1Tau   = getData(cpuControl.m_cpu_pl1_tau.m_current_value).toUInt()
+    };
+
+    try {
+        SysFsDriverCPUXList::CPUXList cpus(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXList::DRIVER_NAME));
+
+        if(!cpus.cpuList().empty())
+        {
+            setting.m_governor = getData(cpus.cpuList().front().m_freq.m_cpuScalingGovernor).trimmed();
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- CPUX Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    return setting;
+}
+
+void SysFsDataProviderAutoTuner::applySetting(const Setting &setting)
+{
+    const auto owner = ControlOwnership::conflict(OWNER,ControlOwnership::CPU_POWER_LIMITS | (setting.m_governor.isEmpty() ? 0 : ControlOwnership::CPU_GOVERNOR));
+
+    if(owner.has_value())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"CPU power limits or governor are controlled by " + owner->toStdString() + " !");
+    }
+
+    SysFsDriverLegionOther::Other::CPU cpuControl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverLegionOther::DRIVER_NAME));
+
+    const Setting current = readSetting();
+
+    /*
+     * Short term limit never below the long term one in between
+     */
+    if(setting.m_cpuLtpLimit > current.m_cpuStpLimit)
+    {
+        setData(cpuControl.m_cpu_stp_limit.m_current_value,setting.m_cpuStpLimit);
+        setData(cpuControl.m_cpu_ltp_limit.m_current_value,setting.m_cpuLtpLimit);
+    }
+    else
+    {
+        if(setting.m_cpuLtpLimit != current.m_cpuLtpLimit)
+        {
+            setData(cpuControl.m_cpu_ltp_limit.m_current_value,setting.m_cpuLtpLimit);
+        }
+
+        if(setting.m_cpuStpLimit != current.m_cpuStpLimit)
+        {
+            setData(cpuControl.m_cpu_stp_limit.m_current_value,setting.m_cpuStpLimit);
+        }
+    }
+
+    if(setting.m_cpuPl1Tau != current.m_cpuPl1Tau)
+    {
+        setData(cpuControl.m_cpu_pl1_tau.m_current_value,setting.m_cpuPl1Tau);
+    }
+
+    if(!setting.m_governor.isEmpty() && setting.m_governor != current.m_governor)
+    {
+        SysFsDriverCPUXList::CPUXList cpus(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXList::DRIVER_NAME));
+
+        const std::set<quint32> online = onlineCPUs();
+
+        for(size_t i = 0; i < cpus.cpuList().size(); ++i)
+        {
+            if(online.contains(static_cast<quint32>(i)))
+            {
+                setData(cpus.cpuList().at(i).m_freq.m_cpuScalingGovernor,setting.m_governor.toStdString());
+            }
+        }
+    }
+}
+
+std::optional<SysFsDataProviderAutoTuner::Range> SysFsDataProviderAutoTuner::readRange(const std::filesystem::path &minPath, const std::filesystem::path &maxPath, quint32 mode) const
+{
+    /*
+     * Values per power mode, e.g. "1=15,2=35,3=55,255=55"
+     */
+    auto valueForMode = [&](const std::filesystem::path& path) -> std::optional<quint32> {
+        for (const auto& item : getData(path).trimmed().split(',')) {
+            const auto pair = item.split('=');
+
+            if(pair.size() == 2 && pair.at(0).toUInt() == mode)
+            {
+                return pair.at(1).toUInt();
+            }
+        }
+
+        return std::nullopt;
+    };
+
+    const auto min = valueForMode(minPath);
+    const auto max = valueForMode(maxPath);
+
+    if(!min.has_value() || !max.has_value() || min.value() > max.value())
+    {
+        LOG_D(QString(__PRETTY_FUNCTION__) + "- No range of " + QString::fromStdString(minPath.parent_path().string()) + " for mode " + QString::number(mode));
+        return std::nullopt;
+    }
+
+    return Range {
+        .m_min = min.value(),
+        .m_max = max.value()
+    };
+}
+
+void SysFsDataProviderAutoTuner::readSensors(quint32 &temperature, quint32 &fanSpeed) const
+{
+    temperature = 0;
+    fanSpeed    = 0;
+
+    try {
+        SysFSDriverLegionHWMon::HWMon hwMon(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFSDriverLegionHWMon::DRIVER_NAME));
+
+        for(const auto& temp : hwMon.m_legion.m_temps)
+        {
+            if(getData(temp.m_label).startsWith("CPU"))
+            {
+                temperature = getData(temp.m_input).toUInt() / 1000;
+            }
+        }
+
+        for(const auto& fan : hwMon.m_legion.m_fans)
+        {
+            fanSpeed = std::max(fanSpeed,getData(fan.m_input).toUInt());
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Legion HWMon Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+}
+
+std::optional<quint64> SysFsDataProviderAutoTuner::readEnergy() const
+{
+    try {
+        SysFsDriverIntelPowercapRapl::IntelPowercapRapl intelPowercapRapl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+
+        return getData(intelPowercapRapl.m_powercapCPUEnergy).toULongLong();
+
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Intel Rapl Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    return std::nullopt;
+}
+
+quint64 SysFsDataProviderAutoTuner::maxEnergy() const
+{
+    SysFsDriverIntelPowercapRapl::IntelPowercapRapl intelPowercapRapl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+
+    return getData(intelPowercapRapl.m_max_energy_range).toULongLong();
+}
+
+std::set<quint32> SysFsDataProviderAutoTuner::onlineCPUs() const
+{
+    SysFsDriverCPU::CPU cpu(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPU::DRIVER_NAME));
+
+    return CPUList::parse(getData(cpu.m_topology.m_online));
+}
+
+void SysFsDataProviderAutoTuner::loadProfiles()
+{
+    legion::messages::AutoTuner autoTuner;
+
+    SettingsLoaderAutoTuner().loadAutoTuner(autoTuner);
+
+    m_profiles.clear();
+
+    for(const auto& profileMsg : autoTuner.profiles())
+    {
+        if(profileMsg.objective() > legion::messages::AutoTuner::OBJECTIVE_QUIET)
+        {
+            continue;
+        }
+
+        m_profiles[static_cast<Objective>(profileMsg.objective())] = Profile {
+            .m_candidate = parseCandidate(profileMsg.candidate()),
+            .m_timestamp = static_cast<qint64>(profileMsg.timestamp())
+        };
+    }
+
+    LOGF_D("Auto tuner: {} profiles loaded",m_profiles.size());
+}
+
+void SysFsDataProviderAutoTuner::saveProfiles()
+{
+    legion::messages::AutoTuner autoTuner;
+
+    for(const auto& [objective,profile] : m_profiles)
+    {
+        auto profileMsg = autoTuner.add_profiles();
+
+        profileMsg->set_name(profileName(objective).toStdString());
+        profileMsg->set_objective(static_cast<legion::messages::AutoTuner::Objective>(objective));
+        profileMsg->set_timestamp(profile.m_timestamp);
+        fillCandidate(profileMsg->mutable_candidate(),profile.m_candidate);
+    }
+
+    SettingsSaverAutoTuner().saveAutoTuner(autoTuner);
+}
+
+}
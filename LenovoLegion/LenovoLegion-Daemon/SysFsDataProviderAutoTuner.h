@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <SysFsDataProvider.h>
+
+#include "LoadGenerator.h"
+
+#include <QElapsedTimer>
+
+#include <deque>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+class QTimer;
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Searches the CPU power settings (cpu_ltp_limit, cpu_stp_limit, cpu_pl1_tau, governor) under a
+ * LoadGenerator load on all online CPUs. Coordinate descent: the values of one setting are measured
+ * with the others at the best ones found so far, then the next setting follows, until the budget is
+ * used. Every candidate is measured after a warmup for throughput, RAPL package power, CPU temperature
+ * and fan speed. A candidate reaching max_temperature is rejected, the last good setting is applied
+ * and the load pauses until the CPU cools down. Errors end the search.
+ *
+ * The original setting is restored at the end of the search. The best candidate of every objective
+ * is kept as a named profile in the settings store and applied on request.
+ */
+class SysFsDataProviderAutoTuner : public SysFsDataProvider
+{
+public:
+
+    /*
+     * Same values as legion::messages::AutoTuner::Objective
+     */
+    enum Objective : quint8 {
+        MAX_PERFORMANCE     = 0,
+        BEST_EFFICIENCY     = 1,
+        QUIET               = 2
+    };
+
+    /*
+     * Same values as legion::messages::AutoTuner::State
+     */
+    enum State : quint8 {
+        IDLE                = 0,
+        WARMUP              = 1,
+        MEASUREMENT         = 2,
+        COOLDOWN            = 3,
+        FINISHED            = 4,
+        FAILED              = 5
+    };
+
+    /*
+     * Same values as legion::messages::AutoTuner::Verdict
+     */
+    enum Verdict : quint8 {
+        OK                  = 0,
+        OVERHEAT            = 1
+    };
+
+    struct Config {
+        Objective               m_objective         = BEST_EFFICIENCY;
+        LoadGenerator::Kernel   m_kernel            = LoadGenerator::AVX2_FMA;
+        quint32                 m_budget            = 24;
+        quint32                 m_steps             = 4;
+        quint32                 m_warmup            = 20;       // s
+        quint32                 m_measurement       = 20;       // s
+        quint32                 m_maxTemperature    = 95;       // °C
+        quint32                 m_quietPerformance  = 90;       // %
+    };
+
+    struct Setting {
+        quint32                 m_cpuLtpLimit       = 0;        // W
+        quint32                 m_cpuStpLimit       = 0;        // W
+        quint32                 m_cpuPl1Tau         = 0;        // s
+        QString                 m_governor;
+
+        bool operator==(const Setting&) const = default;
+    };
+
+    struct Candidate {
+        Setting                 m_setting;
+        double                  m_throughput        = 0;
+        double                  m_power             = 0;        // W
+        quint32                 m_maxTemperature    = 0;        // °C
+        quint32                 m_maxFanSpeed       = 0;        // RPM
+        Verdict                 m_verdict           = OK;
+
+        double efficiency() const { return m_power > 0 ? m_throughput / m_power : 0; }
+    };
+
+    struct Profile {
+        Candidate               m_candidate;
+        qint64                  m_timestamp         = 0;
+    };
+
+private:
+
+    /*
+     * Order of the coordinate descent
+     */
+    enum Dimension : quint8 {
+        CPU_LTP_LIMIT       = 0,
+        CPU_STP_LIMIT       = 1,
+        CPU_PL1_TAU         = 2,
+        GOVERNOR            = 3,
+        DIMENSION_COUNT     = 4
+    };
+
+    struct Range {
+        quint32 m_min                               = 0;
+        quint32 m_max                               = 0;
+    };
+
+public:
+
+    SysFsDataProviderAutoTuner(SysFsDriverManager* sysFsDriverManager,QObject* parent);
+
+    virtual QByteArray serializeAndGetData()                    const override;
+    virtual QByteArray deserializeAndSetData(const QByteArray&)       override;
+
+    virtual void init()  override;
+    virtual void clean() override;
+
+    static QString profileName(Objective objective);
+
+private:
+
+    void step();
+
+    void start();
+    void stop(State state);
+    bool running() const;
+
+    /*
+     * Next candidate applied, the search ends when there is none or the budget is used
+     */
+    void next();
+    void finishCandidate(Verdict verdict);
+
+    std::deque<Setting> candidatesFor(Dimension dimension) const;
+    bool                measured(const Setting& setting) const;
+
+    /*
+     * Higher is better, nullopt for candidates not eligible for the objective
+     */
+    std::optional<double>    score(const Candidate& candidate,Objective objective) const;
+    std::optional<Candidate> best(Objective objective) const;
+
+    Setting readSetting() const;
+    void    applySetting(const Setting& setting);
+
+    std::optional<Range> readRange(const std::filesystem::path& minPath,const std::filesystem::path& maxPath,quint32 mode) const;
+
+    void readSensors(quint32& temperature,quint32& fanSpeed) const;
+
+    std::optional<quint64> readEnergy() const;
+    quint64                maxEnergy()  const;
+
+    std::set<quint32> onlineCPUs() const;
+
+    void loadProfiles();
+    void saveProfiles();
+
+private:
+
+    LoadGenerator                       m_generator;
+
+    QTimer*                             m_timer;
+
+    State                               m_state;
+    Config                              m_config;
+
+    Setting                             m_original;
+    Setting                             m_incumbent;
+
+    std::vector<quint32>                m_ltpValues;
+    std::vector<quint32>                m_stpValues;
+    std::vector<quint32>                m_tauValues;
+    std::vector<QString>                m_governors;
+
+    quint8                              m_dimension;
+    std::deque<Setting>                 m_queue;
+    Candidate                           m_current;
+    std::set<quint32>                   m_cpus;
+
+    QElapsedTimer                       m_phaseTimer;
+    quint64                             m_startWork;
+    std::optional<quint64>              m_lastEnergy;
+    std::optional<quint64>              m_energy;           // µJ, measurement so far
+
+    std::vector<Candidate>              m_candidates;
+    std::map<Objective,Profile>         m_profiles;
+
+public:
+
+    static constexpr quint8  dataType = 33;
+
+    static constexpr const char* OWNER = "auto tuner";
+
+    static constexpr int     STEP_PERIOD_MS          = 1000;
+
+    /*
+     * Load resumes after an overheat this much below max_temperature
+     */
+    static constexpr quint32 COOLDOWN_HYSTERESIS     = 15;      // °C
+
+    /*
+     * Search fails when the CPU does not cool down in time, e.g. the fans are stuck
+     */
+    static constexpr qint64  COOLDOWN_TIMEOUT        = 300;     // s
+
+    static constexpr quint32 MAX_BUDGET              = 200;
+    static constexpr quint32 MAX_STEPS               = 16;
+};
+
+}
@@ -0,0 +1,518 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "SysFsDataProviderCPUEnergyPerformance.h"
+#include "SysFsDriverCPUXEnergyPerformance.h"
+#include "SysFsDriverACPIPlatformProfile.h"
+#include "SysFSDriverLegionGameZone.h"
+#include "SysFsDriverCPUXList.h"
+#include "SysFsDriverCPUCore.h"
+#include "SysFsDriverCPUAtom.h"
+#include "SysFsDriverCPU.h"
+#include "CPUList.h"
+#include "ControlOwnership.h"
+
+#include "../LenovoLegion-PrepareBuild/CPUEnergyPerformance.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <algorithm>
+
+namespace LenovoLegionDaemon {
+
+namespace {
+
+void fillGroup(legion::messages::CPUEnergyPerformance::Group* groupMsg,const SysFsDataProviderCPUEnergyPerformance::Group& group)
+{
+    if(group.m_governor.has_value())
+    {
+        groupMsg->set_governor(group.m_governor.value().toStdString());
+    }
+
+    if(group.m_preference.has_value())
+    {
+        groupMsg->set_preference(group.m_preference.value().toStdString());
+    }
+
+    if(group.m_bias.has_value())
+    {
+        groupMsg->set_bias(group.m_bias.value());
+    }
+}
+
+SysFsDataProviderCPUEnergyPerformance::Group parseGroup(const legion::messages::CPUEnergyPerformance::Group& groupMsg)
+{
+    SysFsDataProviderCPUEnergyPerformance::Group group;
+
+    if(groupMsg.has_governor())
+    {
+        group.m_governor = QString::fromStdString(groupMsg.governor()).trimmed();
+    }
+
+    if(groupMsg.has_preference())
+    {
+        group.m_preference = QString::fromStdString(groupMsg.preference()).trimmed();
+    }
+
+    if(groupMsg.has_bias())
+    {
+        group.m_bias = groupMsg.bias();
+    }
+
+    return group;
+}
+
+/*
+ * Set values of the override replace the ones of the group
+ */
+SysFsDataProviderCPUEnergyPerformance::Group mergeGroup(const SysFsDataProviderCPUEnergyPerformance::Group& group,const SysFsDataProviderCPUEnergyPerformance::Group& override)
+{
+    return SysFsDataProviderCPUEnergyPerformance::Group {
+        .m_governor     = override.m_governor.has_value()   ? override.m_governor   : group.m_governor,
+        .m_preference   = override.m_preference.has_value() ? override.m_preference : group.m_preference,
+        .m_bias         = override.m_bias.has_value()       ? override.m_bias       : group.m_bias
+    };
+}
+
+}
+
+SysFsDataProviderCPUEnergyPerformance::SysFsDataProviderCPUEnergyPerformance(SysFsDriverManager* sysFsDriverManager,QObject* parent) :
+    SysFsDataProvider(sysFsDriverManager,parent,dataType),
+    m_appliedPolicy(PROFILE_UNKNOWN)
+{}
+
+QByteArray SysFsDataProviderCPUEnergyPerformance::serializeAndGetData() const
+{
+    legion::messages::CPUEnergyPerformance cpuEnergyPerformance;
+    QByteArray                             byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    fillGroup(cpuEnergyPerformance.mutable_performance_cores(),m_performanceCores);
+    fillGroup(cpuEnergyPerformance.mutable_efficient_cores(),m_efficientCores);
+
+    for(const auto& [profile,policy] : m_policies)
+    {
+        auto policyMsg = cpuEnergyPerformance.add_policies();
+
+        policyMsg->set_profile(static_cast<legion::messages::CPUEnergyPerformance::Profile>(profile));
+        fillGroup(policyMsg->mutable_performance_cores(),policy.m_performanceCores);
+        fillGroup(policyMsg->mutable_efficient_cores(),policy.m_efficientCores);
+    }
+
+    cpuEnergyPerformance.set_applied_policy(static_cast<legion::messages::CPUEnergyPerformance::Profile>(m_appliedPolicy));
+
+    try {
+        SysFsDriverCPUXEnergyPerformance::CPUXEnergyPerformanceList energyPerformance(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXEnergyPerformance::DRIVER_NAME));
+        SysFsDriverCPUXList::CPUXList                               cpuXlist(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXList::DRIVER_NAME));
+
+        for(const auto& [cpu,coreType] : onlineCPUs())
+        {
+            if(cpu >= energyPerformance.cpuList().size() || cpu >= cpuXlist.cpuList().size())
+            {
+                continue;
+            }
+
+            const auto& cpuX = energyPerformance.cpuList().at(cpu);
+            auto        cpuMsg = cpuEnergyPerformance.add_cpus();
+
+            cpuMsg->set_cpu(cpu);
+            cpuMsg->set_core_type(static_cast<legion::messages::CPUEnergyPerformance::CoreType>(coreType));
+            cpuMsg->set_governor(getData(cpuXlist.cpuList().at(cpu).m_freq.m_cpuScalingGovernor).trimmed().toStdString());
+
+            if(cpuX.isPreferenceAvailable())
+            {
+                cpuMsg->set_preference(getData(cpuX.m_energyPerformancePreference.value()).trimmed().toStdString());
+                cpuMsg->set_available_preferences(getData(cpuX.m_energyPerformanceAvailablePreferences.value()).trimmed().toStdString());
+            }
+
+            if(cpuX.isBiasAvailable())
+            {
+                cpuMsg->set_bias(getData(cpuX.m_energyPerfBias.value()).toUInt());
+            }
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- CPUX energy performance Driver not available");
+            cpuEnergyPerformance.clear_cpus();
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    byteArray.resize(cpuEnergyPerformance.ByteSizeLong());
+    if(!cpuEnergyPerformance.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray SysFsDataProviderCPUEnergyPerformance::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::CPUEnergyPerformance cpuEnergyPerformance;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!cpuEnergyPerformance.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    Group                    performanceCores = m_performanceCores;
+    Group                    efficientCores   = m_efficientCores;
+    std::map<Profile,Policy> policies         = m_policies;
+
+    if(cpuEnergyPerformance.has_performance_cores())
+    {
+        performanceCores = mergeGroup(performanceCores,parseGroup(cpuEnergyPerformance.performance_cores()));
+    }
+
+    if(cpuEnergyPerformance.has_efficient_cores())
+    {
+        efficientCores = mergeGroup(efficientCores,parseGroup(cpuEnergyPerformance.efficient_cores()));
+    }
+
+    if(cpuEnergyPerformance.clear_policies())
+    {
+        policies.clear();
+    }
+
+    if(cpuEnergyPerformance.policies_size() > 0)
+    {
+        policies.clear();
+
+        for(const auto& policyMsg : cpuEnergyPerformance.policies())
+        {
+            const Profile profile = static_cast<Profile>(policyMsg.profile());
+
+            if(profile != PROFILE_QUIET && profile != PROFILE_BALANCED && profile != PROFILE_PERFORMANCE && profile != PROFILE_EXTREME && profile != PROFILE_CUSTOM)
+            {
+                THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid power profile of the policy !");
+            }
+
+            if(policies.contains(profile))
+            {
+                THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"More policies of the same power profile !");
+            }
+
+            policies[profile] = Policy {
+                .m_performanceCores = parseGroup(policyMsg.performance_cores()),
+                .m_efficientCores   = parseGroup(policyMsg.efficient_cores())
+            };
+        }
+    }
+
+    validateGroup(performanceCores);
+    validateGroup(efficientCores);
+
+    for(const auto& [profile,policy] : policies)
+    {
+        validateGroup(policy.m_performanceCores);
+        validateGroup(policy.m_efficientCores);
+    }
+
+    const bool governor = hasGovernor(performanceCores,efficientCores,policies);
+
+    if(governor)
+    {
+        const auto owner = ControlOwnership::conflict(OWNER,ControlOwnership::CPU_GOVERNOR);
+
+        if(owner.has_value())
+        {
+            THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"CPU governor is controlled by " + owner->toStdString() + " !");
+        }
+    }
+
+    m_performanceCores = performanceCores;
+    m_efficientCores   = efficientCores;
+    m_policies         = policies;
+
+    ControlOwnership::acquire(OWNER,governor ? ControlOwnership::CPU_GOVERNOR : 0);
+
+    /*
+     * Policy of the current profile takes effect at once
+     */
+    const Profile profile = readProfile();
+
+    m_appliedPolicy = m_policies.contains(profile) ? profile : PROFILE_UNKNOWN;
+
+    applyGroups();
+
+    return {};
+}
+
+void SysFsDataProviderCPUEnergyPerformance::kernelEventHandler(const SysFsDriver::SubsystemEvent &event)
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    try {
+        if(event.m_driverName == SysFsDriverACPIPlatformProfile::DRIVER_NAME && event.m_action == SysFsDriver::SubsystemEvent::Action::CHANGED)
+        {
+            const Profile profile       = readProfile();
+            const Profile appliedPolicy = m_policies.contains(profile) ? profile : PROFILE_UNKNOWN;
+
+            /*
+             * Nothing to switch between two profiles without a policy
+             */
+            if(appliedPolicy == m_appliedPolicy)
+            {
+                return;
+            }
+
+            m_appliedPolicy = appliedPolicy;
+
+            LOGF_I("CPU energy performance: power profile changed to {}, applied policy {}",profile,m_appliedPolicy);
+
+            applyGroups();
+        }
+
+        if(event.m_driverName == SysFsDriverCPUXEnergyPerformance::DRIVER_NAME && event.m_action == SysFsDriver::SubsystemEvent::Action::RELOADED)
+        {
+            applyGroups();
+        }
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Apply of CPU energy performance failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+SysFsDataProviderCPUEnergyPerformance::Group SysFsDataProviderCPUEnergyPerformance::effectiveGroup(CoreType coreType) const
+{
+    const Group& group  = coreType == EFFICIENT ? m_efficientCores : m_performanceCores;
+    const auto   policy = m_policies.find(m_appliedPolicy);
+
+    if(policy == m_policies.end())
+    {
+        return group;
+    }
+
+    return mergeGroup(group,coreType == EFFICIENT ? policy->second.m_efficientCores : policy->second.m_performanceCores);
+}
+
+void SysFsDataProviderCPUEnergyPerformance::applyGroups()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    const std::map<quint32,CoreType> cpus = onlineCPUs();
+
+    /*
+     * Non hybrid part, every CPU is in the P-core group
+     */
+    applyGroup(effectiveGroup(PERFORMANCE),PERFORMANCE,cpus);
+    applyGroup(effectiveGroup(EFFICIENT),EFFICIENT,cpus);
+}
+
+void SysFsDataProviderCPUEnergyPerformance::applyGroup(const Group &group, CoreType coreType, const std::map<quint32,CoreType> &cpus)
+{
+    if(!group.m_governor.has_value() && !group.m_preference.has_value() && !group.m_bias.has_value())
+    {
+        return;
+    }
+
+    std::optional<SysFsDriverCPUXEnergyPerformance::CPUXEnergyPerformanceList> energyPerformance;
+    SysFsDriverCPUXList::CPUXList                                              cpuXlist(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXList::DRIVER_NAME));
+
+    /*
+     * Governor is applied without EPP and EPB as well
+     */
+    try {
+        energyPerformance.emplace(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXEnergyPerformance::DRIVER_NAME));
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- CPUX energy performance Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    const SysFsDriverCPUXEnergyPerformance::CPUXEnergyPerformanceList::CPUX emptyCPUX = SysFsDriver::DescriptorType();
+
+    /*
+     * EPP and EPB are applied while another controller owns the governor
+     */
+    const auto governorOwner = group.m_governor.has_value() ? ControlOwnership::conflict(OWNER,ControlOwnership::CPU_GOVERNOR) : std::nullopt;
+
+    if(governorOwner.has_value())
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- CPU governor is controlled by " + governorOwner.value() + ", governor left alone");
+    }
+
+    for(const auto& [cpu,cpuCoreType] : cpus)
+    {
+        if((coreType == EFFICIENT) != (cpuCoreType == EFFICIENT))
+        {
+            continue;
+        }
+
+        if(cpu >= cpuXlist.cpuList().size())
+        {
+            LOG_W(QString(__PRETTY_FUNCTION__) + "- cpu=" + QString::number(cpu) + QString( " out of range !"));
+            continue;
+        }
+
+        const auto& cpuX = energyPerformance.has_value() && cpu < energyPerformance->cpuList().size() ? energyPerformance->cpuList().at(cpu) : emptyCPUX;
+
+        /*
+         * Governor first, intel_pstate changes the EPP on a governor change
+         */
+        if(group.m_governor.has_value() && !governorOwner.has_value() && getData(cpuXlist.cpuList().at(cpu).m_freq.m_cpuScalingGovernor).trimmed() != group.m_governor.value())
+        {
+            setData(cpuXlist.cpuList().at(cpu).m_freq.m_cpuScalingGovernor,group.m_governor.value().toStdString());
+        }
+
+        if(group.m_preference.has_value() && cpuX.isPreferenceAvailable())
+        {
+            /*
+             * The performance governor of intel_pstate accepts no other EPP than performance
+             */
+            if(getData(cpuXlist.cpuList().at(cpu).m_freq.m_cpuScalingGovernor).trimmed() == "performance" && group.m_preference.value() != "performance")
+            {
+                LOG_D(QString(__PRETTY_FUNCTION__) + "- cpu=" + QString::number(cpu) + " has the performance governor, EPP left alone");
+            }
+            else if(getData(cpuX.m_energyPerformancePreference.value()).trimmed() != group.m_preference.value())
+            {
+                setData(cpuX.m_energyPerformancePreference.value(),group.m_preference.value().toStdString());
+            }
+        }
+
+        if(group.m_bias.has_value() && cpuX.isBiasAvailable() && getData(cpuX.m_energyPerfBias.value()).toUInt() != group.m_bias.value())
+        {
+            setData(cpuX.m_energyPerfBias.value(),group.m_bias.value());
+        }
+    }
+}
+
+void SysFsDataProviderCPUEnergyPerformance::validateGroup(const Group &group) const
+{
+    if(group.m_bias.has_value() && group.m_bias.value() > MAX_BIAS)
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid energy perf bias !");
+    }
+
+    if(group.m_governor.has_value())
+    {
+        SysFsDriverCPUXList::CPUXList cpuXlist(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXList::DRIVER_NAME));
+
+        if(cpuXlist.cpuList().empty() || !getData(cpuXlist.cpuList().front().m_freq.m_cpuScalingAvailableGovernors).split(' ',Qt::SkipEmptyParts).contains(group.m_governor.value()))
+        {
+            THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Governor not available !");
+        }
+    }
+
+    if(group.m_preference.has_value())
+    {
+        SysFsDriverCPUXEnergyPerformance::CPUXEnergyPerformanceList energyPerformance(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXEnergyPerformance::DRIVER_NAME));
+
+        const auto cpuX = std::find_if(energyPerformance.cpuList().begin(),energyPerformance.cpuList().end(),[](const SysFsDriverCPUXEnergyPerformance::CPUXEnergyPerformanceList::CPUX& cpuX) {
+            return cpuX.isPreferenceAvailable();
+        });
+
+        if(cpuX == energyPerformance.cpuList().end())
+        {
+            THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Energy performance preference not available !");
+        }
+
+        /*
+         * Name of the available ones or the raw EPP value
+         */
+        bool          isNumber = false;
+        const quint32 value    = group.m_preference.value().toUInt(&isNumber);
+
+        if(isNumber ? value > MAX_PREFERENCE : !getData(cpuX->m_energyPerformanceAvailablePreferences.value()).split(' ',Qt::SkipEmptyParts).contains(group.m_preference.value()))
+        {
+            THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid energy performance preference !");
+        }
+    }
+}
+
+bool SysFsDataProviderCPUEnergyPerformance::hasGovernor(const Group &performanceCores, const Group &efficientCores, const std::map<Profile,Policy> &policies)
+{
+    return performanceCores.m_governor.has_value() || efficientCores.m_governor.has_value() ||
+           std::any_of(policies.begin(),policies.end(),[](const auto& item) {
+               return item.second.m_performanceCores.m_governor.has_value() || item.second.m_efficientCores.m_governor.has_value();
+           });
+}
+
+std::map<quint32,SysFsDataProviderCPUEnergyPerformance::CoreType> SysFsDataProviderCPUEnergyPerformance::onlineCPUs() const
+{
+    SysFsDriverCPU::CPU        cpu(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPU::DRIVER_NAME));
+    std::map<quint32,CoreType> cpus;
+
+    for(const auto cpuId : CPUList::parse(getData(cpu.m_topology.m_online)))
+    {
+        cpus[cpuId] = ALL;
+    }
+
+    try {
+        SysFsDriverCPUCore::CPUCore core(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPUCore::DRIVER_NAME));
+        SysFsDriverCPUAtom::CPUAtom atom(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPUAtom::DRIVER_NAME));
+
+        for(const auto cpuId : CPUList::parse(getData(core.m_cpus)))
+        {
+            if(cpus.contains(cpuId))
+            {
+                cpus[cpuId] = PERFORMANCE;
+            }
+        }
+
+        for(const auto cpuId : CPUList::parse(getData(atom.m_cpus)))
+        {
+            if(cpus.contains(cpuId))
+            {
+                cpus[cpuId] = EFFICIENT;
+            }
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Hybrid topology Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    return cpus;
+}
+
+SysFsDataProviderCPUEnergyPerformance::Profile SysFsDataProviderCPUEnergyPerformance::readProfile() const
+{
+    try {
+        SysFSDriverLegionGameZone::GameZone::SmartFan smartFan(m_sysFsDriverManager->getDriverDesriptor(SysFSDriverLegionGameZone::DRIVER_NAME));
+
+        return static_cast<Profile>(getData(smartFan.m_current_value).toUShort());
+
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Legion GameZone Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    return PROFILE_UNKNOWN;
+}
+
+}
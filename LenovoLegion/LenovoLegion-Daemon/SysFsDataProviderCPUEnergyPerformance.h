@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <SysFsDataProvider.h>
+
+#include <map>
+#include <optional>
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Governor, energy performance preference (EPP) and energy perf bias (EPB) of the P-cores and E-cores
+ * as two groups, every CPU of a non hybrid part belongs to the P-core group. A policy overrides the
+ * groups while the power profile it belongs to is active. The groups are applied again when the CPUs
+ * come online, the kernel resets the EPP of them.
+ */
+class SysFsDataProviderCPUEnergyPerformance : public SysFsDataProvider
+{
+public:
+
+    /*
+     * Same values as legion::messages::CPUEnergyPerformance::CoreType
+     */
+    enum CoreType : quint8 {
+        ALL             = 0,
+        PERFORMANCE     = 1,
+        EFFICIENT       = 2
+    };
+
+    /*
+     * Same values as legion::messages::PowerProfile::Profiles
+     */
+    enum Profile : quint8 {
+        PROFILE_UNKNOWN     = 0,
+        PROFILE_QUIET       = 1,
+        PROFILE_BALANCED    = 2,
+        PROFILE_PERFORMANCE = 3,
+        PROFILE_EXTREME     = 224,
+        PROFILE_CUSTOM      = 255
+    };
+
+    /*
+     * Unset values are left alone
+     */
+    struct Group {
+        std::optional<QString>  m_governor;
+        std::optional<QString>  m_preference;
+        std::optional<quint32>  m_bias;
+    };
+
+    struct Policy {
+        Group                   m_performanceCores;
+        Group                   m_efficientCores;
+    };
+
+public:
+
+    SysFsDataProviderCPUEnergyPerformance(SysFsDriverManager* sysFsDriverManager,QObject* parent);
+
+    virtual QByteArray serializeAndGetData()                    const override;
+    virtual QByteArray deserializeAndSetData(const QByteArray&)       override;
+
+    virtual void kernelEventHandler(const LenovoLegionDaemon::SysFsDriver::SubsystemEvent &event) override;
+
+private:
+
+    /*
+     * Configured group with the values of the applied policy over it
+     */
+    Group effectiveGroup(CoreType coreType) const;
+
+    void  applyGroups();
+    void  applyGroup(const Group& group,CoreType coreType,const std::map<quint32,CoreType>& cpus);
+
+    void  validateGroup(const Group& group) const;
+
+    /*
+     * Governor in any of the groups or policies, the governor is owned then
+     */
+    static bool hasGovernor(const Group& performanceCores,const Group& efficientCores,const std::map<Profile,Policy>& policies);
+
+    /*
+     * Online CPUs with their core type
+     */
+    std::map<quint32,CoreType> onlineCPUs() const;
+
+    Profile readProfile() const;
+
+private:
+
+    Group                       m_performanceCores;
+    Group                       m_efficientCores;
+
+    std::map<Profile,Policy>    m_policies;
+    Profile                     m_appliedPolicy;
+
+public:
+
+    static constexpr quint8  dataType = 34;
+
+    static constexpr const char* OWNER = "CPU energy performance";
+
+    static constexpr quint32 MAX_BIAS            = 15;
+    static constexpr quint32 MAX_PREFERENCE      = 255;
+};
+
+}
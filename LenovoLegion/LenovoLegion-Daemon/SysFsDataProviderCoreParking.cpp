@@ -0,0 +1,530 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "SysFsDataProviderCoreParking.h"
+#include "CPUList.h"
+#include "SysFsDriverCPUXList.h"
+#include "SysFsDriverCPUCore.h"
+#include "SysFsDriverCPUAtom.h"
+#include "SysFsDriverIntelPowercapRapl.h"
+
+#include "../LenovoLegion-PrepareBuild/CoreParking.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QDateTime>
+#include <QScopeGuard>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace LenovoLegionDaemon {
+
+SysFsDataProviderCoreParking::SysFsDataProviderCoreParking(SysFsDriverManager* sysFsDriverManager,QObject* parent) :
+    SysFsDataProvider(sysFsDriverManager,parent,dataType),
+    m_timer(new QTimer(this)),
+    m_enabled(false),
+    m_level(NONE),
+    m_utilization(0),
+    m_transitions(0)
+{
+    m_timer->setInterval(SAMPLE_PERIOD_MS);
+
+    connect(m_timer,&QTimer::timeout,this,&SysFsDataProviderCoreParking::sample);
+}
+
+QByteArray SysFsDataProviderCoreParking::serializeAndGetData() const
+{
+    legion::messages::CoreParking coreParking;
+    QByteArray                    byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    coreParking.set_enabled(m_enabled);
+    coreParking.set_max_level(static_cast<legion::messages::CoreParking::Level>(m_config.m_maxLevel));
+    coreParking.set_park_threshold(m_config.m_parkThreshold);
+    coreParking.set_unpark_threshold(m_config.m_unparkThreshold);
+    coreParking.set_park_delay(m_config.m_parkDelay);
+    coreParking.set_unpark_delay(m_config.m_unparkDelay);
+    coreParking.set_dwell_time(m_config.m_dwellTime);
+    coreParking.set_max_transitions(m_config.m_maxTransitions);
+    coreParking.set_measurement(m_config.m_measurement);
+
+    coreParking.set_utilization(static_cast<quint32>(m_utilization + 0.5));
+    coreParking.set_level(static_cast<legion::messages::CoreParking::Level>(m_level));
+    coreParking.set_transitions(m_transitions);
+    coreParking.set_storm_protected(isStormProtected(QDateTime::currentMSecsSinceEpoch()));
+    coreParking.set_hybrid(m_topology.m_hybrid);
+
+    for(const auto cpu : m_parked)
+    {
+        coreParking.add_parked_cpus(cpu);
+    }
+
+    /*
+     * Savings against the unparked average power at the same (light) load
+     */
+    const double baseline = m_statistics.at(NONE).m_time > 0 ? static_cast<double>(m_statistics.at(NONE).m_energy) / m_statistics.at(NONE).m_time : 0;
+    double       saved    = 0;
+
+    for(size_t level = 0; level < m_statistics.size(); ++level)
+    {
+        const LevelStatistics& statistics = m_statistics.at(level);
+        auto                   levelMsg   = coreParking.add_statistics();
+
+        levelMsg->set_level(static_cast<legion::messages::CoreParking::Level>(level));
+        levelMsg->set_time(statistics.m_time);
+        levelMsg->set_energy(statistics.m_energy);
+        levelMsg->set_average_power(statistics.m_time > 0 ? static_cast<quint32>(statistics.m_energy / statistics.m_time) : 0);
+
+        if(level != NONE && baseline > 0)
+        {
+            saved += std::max(0.0,baseline * statistics.m_time - statistics.m_energy);
+        }
+    }
+
+    coreParking.set_energy_saved(static_cast<quint64>(saved));
+
+    byteArray.resize(coreParking.ByteSizeLong());
+    if(!coreParking.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray SysFsDataProviderCoreParking::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::CoreParking coreParking;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!coreParking.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    Config config = m_config;
+
+    if(coreParking.has_max_level())
+    {
+        config.m_maxLevel = static_cast<Level>(coreParking.max_level());
+    }
+
+    if(coreParking.has_park_threshold())
+    {
+        config.m_parkThreshold = coreParking.park_threshold();
+    }
+
+    if(coreParking.has_unpark_threshold())
+    {
+        config.m_unparkThreshold = coreParking.unpark_threshold();
+    }
+
+    if(coreParking.has_park_delay())
+    {
+        config.m_parkDelay = coreParking.park_delay();
+    }
+
+    if(coreParking.has_unpark_delay())
+    {
+        config.m_unparkDelay = coreParking.unpark_delay();
+    }
+
+    if(coreParking.has_dwell_time())
+    {
+        config.m_dwellTime = coreParking.dwell_time();
+    }
+
+    if(coreParking.has_max_transitions())
+    {
+        config.m_maxTransitions = coreParking.max_transitions();
+    }
+
+    if(coreParking.has_measurement())
+    {
+        config.m_measurement = coreParking.measurement();
+    }
+
+    if(config.m_maxLevel > P_CORES || config.m_parkThreshold >= config.m_unparkThreshold || config.m_unparkThreshold > 100 || config.m_maxTransitions == 0)
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid core parking configuration !");
+    }
+
+    if(config.m_measurement != m_config.m_measurement)
+    {
+        m_measurementTimer.invalidate();
+    }
+
+    m_config = config;
+
+    if(coreParking.has_enabled() && coreParking.enabled() != m_enabled)
+    {
+        if(coreParking.enabled())
+        {
+            start();
+        }
+        else
+        {
+            stop();
+        }
+    }
+
+    return {};
+}
+
+void SysFsDataProviderCoreParking::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+}
+
+void SysFsDataProviderCoreParking::clean()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Never leave CPUs offline behind us
+     */
+    try {
+        stop();
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Unpark of CPUs failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+void SysFsDataProviderCoreParking::start()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    m_topology     = readTopology();
+    m_level        = NONE;
+
+    /*
+     * m_parked is kept, CPUs which failed to come back on the last stop are retried by the next level change
+     */
+
+    m_lastCPUTimes = ProcStat::read(SysFsDriver::rootedPath("/proc")).m_all;
+    m_utilization  = 0;
+
+    m_lowLoadTimer.invalidate();
+    m_highLoadTimer.invalidate();
+    m_dwellTimer.invalidate();
+    m_measurementTimer.invalidate();
+
+    m_transitionTimestamps.clear();
+    m_lastEnergy.reset();
+    m_lastEnergyTimer.invalidate();
+    m_statistics.fill({});
+
+    LOGF_D("Core parking: hybrid={}, SMT parks {} CPUs, P-cores parks {} CPUs",m_topology.m_hybrid,m_topology.m_parkSets.at(SMT).size(),m_topology.m_parkSets.at(P_CORES).size());
+
+    m_enabled      = true;
+
+    m_timer->start();
+}
+
+void SysFsDataProviderCoreParking::stop()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!m_enabled)
+    {
+        return;
+    }
+
+    m_timer->stop();
+    m_enabled = false;
+
+    setLevel(NONE);
+}
+
+void SysFsDataProviderCoreParking::sample()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Called from timer, nobody above us would handle the exception
+     */
+    try {
+        const ProcStat::CPUTimes times = ProcStat::read(SysFsDriver::rootedPath("/proc")).m_all;
+
+        /*
+         * /proc/stat aggregates the online CPUs only, so this is the load of what is left
+         */
+        m_utilization += SMOOTHING * (ProcStat::utilization(m_lastCPUTimes,times) - m_utilization);
+        m_lastCPUTimes = times;
+
+        const qint64 now   = QDateTime::currentMSecsSinceEpoch();
+        const bool   light = m_utilization < m_config.m_parkThreshold;
+        const bool   heavy = m_utilization >= m_config.m_unparkThreshold;
+
+        readEnergy(light);
+
+        while(!m_transitionTimestamps.empty() && now - m_transitionTimestamps.front() > STORM_WINDOW_MS)
+        {
+            m_transitionTimestamps.pop_front();
+        }
+
+        if(!light)
+        {
+            m_lowLoadTimer.invalidate();
+            m_measurementTimer.invalidate();
+        }
+        else if(!m_lowLoadTimer.isValid())
+        {
+            m_lowLoadTimer.start();
+        }
+
+        if(!heavy)
+        {
+            m_highLoadTimer.invalidate();
+        }
+        else if(!m_highLoadTimer.isValid())
+        {
+            m_highLoadTimer.start();
+        }
+
+        if(m_level != NONE && isStormProtected(now))
+        {
+            /*
+             * Too many transitions in the window, what is parked comes back and stays online until the window passes
+             */
+            LOGF_W("Core parking: {} transitions in {} ms, unparking all CPUs",m_transitionTimestamps.size(),STORM_WINDOW_MS);
+
+            setLevel(NONE);
+        }
+        else if(heavy)
+        {
+            /*
+             * Coming back is not subject to the dwell time, the load needs the CPUs now
+             */
+            if(m_level != NONE && m_highLoadTimer.elapsed() >= static_cast<qint64>(m_config.m_unparkDelay) * 1000)
+            {
+                setLevel(NONE);
+            }
+        }
+        else if(light && m_lowLoadTimer.elapsed() >= static_cast<qint64>(m_config.m_parkDelay) * 1000)
+        {
+            if(m_config.m_measurement)
+            {
+                if(!m_measurementTimer.isValid())
+                {
+                    m_measurementTimer.start();
+                }
+                else if(m_measurementTimer.elapsed() >= MEASUREMENT_WINDOW_MS)
+                {
+                    setLevel(m_level == NONE ? m_config.m_maxLevel : NONE);
+                    m_measurementTimer.restart();
+                }
+            }
+            else if(m_level != m_config.m_maxLevel &&
+                    (!m_dwellTimer.isValid() || m_dwellTimer.elapsed() >= static_cast<qint64>(m_config.m_dwellTime) * 1000) &&
+                    !isStormProtected(now))
+            {
+                setLevel(m_config.m_maxLevel);
+            }
+        }
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Sample failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+SysFsDataProviderCoreParking::Topology SysFsDataProviderCoreParking::readTopology() const
+{
+    SysFsDriverCPUXList::CPUXList cpuXList(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXList::DRIVER_NAME));
+    Topology                      topology;
+    std::set<quint32>             pCores;
+    std::set<quint32>             eCores;
+
+    try {
+        SysFsDriverCPUCore::CPUCore core(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPUCore::DRIVER_NAME));
+        SysFsDriverCPUAtom::CPUAtom atom(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPUAtom::DRIVER_NAME));
+
+        pCores = CPUList::parse(getData(core.m_cpus));
+        eCores = CPUList::parse(getData(atom.m_cpus));
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Hybrid topology Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    topology.m_hybrid = !pCores.empty() && !eCores.empty();
+
+    /*
+     * Only CPUs online now (the topology is known) and hot-pluggable are ever touched
+     */
+    auto isParkable = [&cpuXList](quint32 cpu){
+        return cpu < cpuXList.cpuList().size() && cpuXList.cpuList().at(cpu).m_topology.has_value() && cpuXList.cpuList().at(cpu).isOnlineAvailable();
+    };
+
+    auto siblingsOf = [this,&cpuXList](quint32 cpu){
+        return CPUList::parse(getData(cpuXList.cpuList().at(cpu).m_topology->m_threadSiblingsList));
+    };
+
+    for(quint32 cpu = 0; cpu < cpuXList.cpuList().size(); ++cpu)
+    {
+        if(!isParkable(cpu) || (topology.m_hybrid && !pCores.contains(cpu)))
+        {
+            continue;
+        }
+
+        const std::set<quint32> siblings = siblingsOf(cpu);
+
+        if(siblings.size() > 1 && cpu != *siblings.begin())
+        {
+            topology.m_parkSets.at(SMT).insert(cpu);
+        }
+    }
+
+    if(topology.m_hybrid)
+    {
+        /*
+         * The first P-core stays, its first thread is usually CPU0 which can not go offline anyway
+         */
+        const quint32           first = *pCores.begin();
+        const std::set<quint32> keep  = first < cpuXList.cpuList().size() && cpuXList.cpuList().at(first).m_topology.has_value() ? siblingsOf(first) : std::set<quint32>{first};
+
+        topology.m_parkSets.at(P_CORES) = topology.m_parkSets.at(SMT);
+
+        for(const auto cpu : pCores)
+        {
+            if(isParkable(cpu) && !keep.contains(cpu))
+            {
+                topology.m_parkSets.at(P_CORES).insert(cpu);
+            }
+        }
+    }
+    else
+    {
+        topology.m_parkSets.at(P_CORES) = topology.m_parkSets.at(SMT);
+    }
+
+    return topology;
+}
+
+void SysFsDataProviderCoreParking::setLevel(Level level)
+{
+    SysFsDriverCPUXList::CPUXList cpuXList(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXList::DRIVER_NAME));
+
+    const std::set<quint32>& target = m_topology.m_parkSets.at(level);
+
+    m_sysFsDriverManager->blockKernelEvent(SysFsDriverCPUXList::DRIVER_NAME,true);
+    auto cleanup =  qScopeGuard([this] {
+        m_sysFsDriverManager->processAllUdevEvents(100);
+        m_sysFsDriverManager->refreshDriver(SysFsDriverCPUXList::DRIVER_NAME);
+        m_sysFsDriverManager->blockKernelEvent(SysFsDriverCPUXList::DRIVER_NAME,false);
+    });
+
+    /*
+     * Online first, the load always has somewhere to go. A CPU which fails does not keep
+     * the others offline, it stays parked and the next level change tries it again
+     */
+    for(auto it = m_parked.begin(); it != m_parked.end();)
+    {
+        if(target.contains(*it))
+        {
+            ++it;
+            continue;
+        }
+
+        try {
+            setData(cpuXList.cpuList().at(*it).m_cpuOnline.value(),true);
+            it = m_parked.erase(it);
+        }
+        catch(const bj::framework::exception::Exception& ex)
+        {
+            LOG_W(QString(__PRETTY_FUNCTION__) + "- Unpark of CPU " + QString::number(*it) + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+            ++it;
+        }
+    }
+
+    for(const auto cpu : target)
+    {
+        if(!m_parked.contains(cpu))
+        {
+            setData(cpuXList.cpuList().at(cpu).m_cpuOnline.value(),false);
+            m_parked.insert(cpu);
+        }
+    }
+
+    if(level != m_level)
+    {
+        LOGF_I("Core parking: level {} -> {}, utilization={}%, parked={}",m_level,level,static_cast<quint32>(m_utilization + 0.5),m_parked.size());
+
+        ++m_transitions;
+
+        /*
+         * Measurement windows are deliberate, they do not count as a storm
+         */
+        if(!m_config.m_measurement)
+        {
+            m_transitionTimestamps.push_back(QDateTime::currentMSecsSinceEpoch());
+        }
+    }
+
+    m_level = level;
+    m_dwellTimer.restart();
+}
+
+void SysFsDataProviderCoreParking::readEnergy(bool lightLoad)
+{
+    try {
+        SysFsDriverIntelPowercapRapl::IntelPowercapRapl intelPowercapRapl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+
+        const quint64 energy  = getData(intelPowercapRapl.m_powercapCPUEnergy).toULongLong();
+        const qint64  elapsed = m_lastEnergyTimer.isValid() ? m_lastEnergyTimer.restart() : 0;
+
+        if(!m_lastEnergyTimer.isValid())
+        {
+            m_lastEnergyTimer.start();
+        }
+
+        if(m_lastEnergy.has_value() && elapsed > 0 && lightLoad)
+        {
+            /*
+             * energy_uj wraps around at max_energy_range_uj
+             */
+            const quint64 delta = energy >= m_lastEnergy.value() ? energy - m_lastEnergy.value()
+                                                                 : getData(intelPowercapRapl.m_max_energy_range).toULongLong() - m_lastEnergy.value() + energy;
+
+            m_statistics.at(m_level).m_time   += static_cast<quint64>(elapsed);
+            m_statistics.at(m_level).m_energy += delta;
+        }
+
+        m_lastEnergy = energy;
+
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Intel Rapl Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+}
+
+bool SysFsDataProviderCoreParking::isStormProtected(qint64 now) const
+{
+    return static_cast<quint32>(std::count_if(m_transitionTimestamps.begin(),m_transitionTimestamps.end(),[now](qint64 timestamp){ return now - timestamp <= STORM_WINDOW_MS; })) >= m_config.m_maxTransitions;
+}
+
+}
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <SysFsDataProvider.h>
+
+#include "ProcStat.h"
+
+#include <QElapsedTimer>
+
+#include <array>
+#include <deque>
+#include <optional>
+#include <set>
+
+class QTimer;
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Takes CPUs offline at light load, SMT siblings first and on hybrid CPUs also the P-cores,
+ * so the work consolidates on the E-cores. Everything comes back at sustained high load.
+ */
+class SysFsDataProviderCoreParking : public SysFsDataProvider
+{
+public:
+
+    /*
+     * Same values as legion::messages::CoreParking::Level
+     */
+    enum Level : quint8 {
+        NONE        = 0,
+        SMT         = 1,
+        P_CORES     = 2
+    };
+
+    struct Config {
+        Level   m_maxLevel          = SMT;
+        quint32 m_parkThreshold     = 15;
+        quint32 m_unparkThreshold   = 60;
+        quint32 m_parkDelay         = 30;   // s
+        quint32 m_unparkDelay       = 2;    // s
+        quint32 m_dwellTime         = 60;   // s
+        quint32 m_maxTransitions    = 6;
+        bool    m_measurement       = false;
+    };
+
+    struct LevelStatistics {
+        quint64 m_time      = 0;            // ms
+        quint64 m_energy    = 0;            // uJ
+    };
+
+private:
+
+    /*
+     * CPUs taken offline on each level, computed from the topology with all CPUs online
+     */
+    struct Topology {
+        bool                            m_hybrid = false;
+        std::array<std::set<quint32>,3> m_parkSets;
+    };
+
+public:
+
+    SysFsDataProviderCoreParking(SysFsDriverManager* sysFsDriverManager,QObject* parent);
+
+    virtual QByteArray serializeAndGetData()                    const override;
+    virtual QByteArray deserializeAndSetData(const QByteArray&)       override;
+
+    virtual void init()  override;
+    virtual void clean() override;
+
+private:
+
+    void sample();
+
+    void start();
+    void stop();
+
+    Topology readTopology() const;
+    void     setLevel(Level level);
+
+    void     readEnergy(bool lightLoad);
+
+    bool     isStormProtected(qint64 now) const;
+
+private:
+
+    QTimer*                     m_timer;
+
+    bool                        m_enabled;
+    Config                      m_config;
+
+    Topology                    m_topology;
+    Level                       m_level;
+    std::set<quint32>           m_parked;
+
+    ProcStat::CPUTimes          m_lastCPUTimes;
+    double                      m_utilization;
+
+    QElapsedTimer               m_lowLoadTimer;
+    QElapsedTimer               m_highLoadTimer;
+    QElapsedTimer               m_dwellTimer;
+    QElapsedTimer               m_measurementTimer;
+
+    quint64                     m_transitions;
+    std::deque<qint64>          m_transitionTimestamps;
+
+    std::optional<quint64>      m_lastEnergy;
+    QElapsedTimer               m_lastEnergyTimer;
+    std::array<LevelStatistics,3> m_statistics;
+
+public:
+
+    static constexpr quint8  dataType = 26;
+
+    static constexpr int     SAMPLE_PERIOD_MS        = 1000;
+
+    /*
+     * Hotplug storm protection window
+     */
+    static constexpr qint64  STORM_WINDOW_MS         = 10 * 60 * 1000;
+
+    /*
+     * Length of the parked and unparked windows in measurement mode
+     */
+    static constexpr qint64  MEASUREMENT_WINDOW_MS   = 60 * 1000;
+
+    /*
+     * Weight of the new sample in the exponential moving average
+     */
+    static constexpr double  SMOOTHING               = 0.3;
+};
+
+}
@@ -0,0 +1,479 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "SysFsDataProviderFanController.h"
+#include "SysFSDriverLegionHWMon.h"
+#include "SysFSDriverLegionFanMode.h"
+#include "SysFSDriverLegionGameZone.h"
+#include "ControlOwnership.h"
+
+#include "../LenovoLegion-PrepareBuild/FanController.pb.h"
+#include "../LenovoLegion-PrepareBuild/PowerProfile.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QDateTime>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace LenovoLegionDaemon {
+
+SysFsDataProviderFanController::SysFsDataProviderFanController(SysFsDriverManager* sysFsDriverManager,QObject* parent) :
+    SysFsDataProvider(sysFsDriverManager,parent,dataType),
+    m_timer(new QTimer(this)),
+    m_enabled(false),
+    m_controlTemperature(0),
+    m_targetLevel(0),
+    m_curveWrites(0)
+{
+    m_timer->setInterval(CONTROL_PERIOD_MS);
+
+    connect(m_timer,&QTimer::timeout,this,&SysFsDataProviderFanController::control);
+}
+
+QByteArray SysFsDataProviderFanController::serializeAndGetData() const
+{
+    legion::messages::FanController fanController;
+    QByteArray                      byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    fanController.set_enabled(m_enabled);
+    fanController.set_min_temperature(m_config.m_minTemperature);
+    fanController.set_max_temperature(m_config.m_maxTemperature);
+    fanController.set_hysteresis(m_config.m_hysteresis);
+    fanController.set_max_step_up(m_config.m_maxStepUp);
+    fanController.set_max_step_down(m_config.m_maxStepDown);
+
+    if(m_temperatures.m_cpu.has_value())
+    {
+        fanController.set_cpu_temperature(m_temperatures.m_cpu.value());
+    }
+
+    if(m_temperatures.m_gpu.has_value())
+    {
+        fanController.set_gpu_temperature(m_temperatures.m_gpu.value());
+    }
+
+    if(m_temperatures.m_sys.has_value())
+    {
+        fanController.set_sys_temperature(m_temperatures.m_sys.value());
+    }
+
+    fanController.set_control_temperature(m_controlTemperature);
+    fanController.set_target_level(m_targetLevel);
+    fanController.set_output_level(m_outputLevel.value_or(0));
+    fanController.set_curve_writes(m_curveWrites);
+
+    if(m_lastCurve.has_value())
+    {
+        for(const auto point : m_lastCurve.value())
+        {
+            fanController.add_curve(point);
+        }
+    }
+
+    for(const auto& step : m_history)
+    {
+        auto stepMsg = fanController.add_history();
+
+        stepMsg->set_timestamp(step.m_timestamp);
+        stepMsg->set_control_temperature(step.m_controlTemperature);
+        stepMsg->set_target_level(step.m_targetLevel);
+        stepMsg->set_output_level(step.m_outputLevel);
+        stepMsg->set_decision(static_cast<legion::messages::FanController::Decision>(step.m_decision));
+        stepMsg->set_curve_written(step.m_curveWritten);
+    }
+
+    byteArray.resize(fanController.ByteSizeLong());
+    if(!fanController.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray SysFsDataProviderFanController::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::FanController fanController;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!fanController.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    Config config = m_config;
+
+    if(fanController.has_min_temperature())
+    {
+        config.m_minTemperature = fanController.min_temperature();
+    }
+
+    if(fanController.has_max_temperature())
+    {
+        config.m_maxTemperature = fanController.max_temperature();
+    }
+
+    if(fanController.has_hysteresis())
+    {
+        config.m_hysteresis = fanController.hysteresis();
+    }
+
+    if(fanController.has_max_step_up())
+    {
+        config.m_maxStepUp = fanController.max_step_up();
+    }
+
+    if(fanController.has_max_step_down())
+    {
+        config.m_maxStepDown = fanController.max_step_down();
+    }
+
+    if(config.m_minTemperature >= config.m_maxTemperature || config.m_maxTemperature > 110 || config.m_maxStepUp == 0 || config.m_maxStepDown == 0)
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid fan controller configuration !");
+    }
+
+    m_config = config;
+
+    if(fanController.has_enabled() && fanController.enabled() != m_enabled)
+    {
+        if(fanController.enabled())
+        {
+            start();
+        }
+        else
+        {
+            stop();
+        }
+    }
+
+    return {};
+}
+
+void SysFsDataProviderFanController::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+}
+
+void SysFsDataProviderFanController::clean()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Hand the fan back to the firmware curve the user had
+     */
+    try {
+        stop();
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Restore of fan curve failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+void SysFsDataProviderFanController::start()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    const auto owner = ControlOwnership::conflict(OWNER,ControlOwnership::FAN_CURVE | ControlOwnership::POWER_MODE);
+
+    if(owner.has_value())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Fan curve or power mode are controlled by " + owner->toStdString() + " !");
+    }
+
+    const quint8 mode = readPowerMode();
+
+    m_savedPowerMode.reset();
+
+    if(mode != legion::messages::PowerProfile::POWER_PROFILE_CUSTOM)
+    {
+        writePowerMode(legion::messages::PowerProfile::POWER_PROFILE_CUSTOM);
+        m_savedPowerMode = mode;
+
+        LOGF_I("Fan controller: custom power mode set, power mode {} restored at the end",mode);
+    }
+
+    /*
+     * The curve of the custom mode, read after the switch
+     */
+    try {
+        m_savedCurve = readCurve();
+    }
+    catch(const bj::framework::exception::Exception&)
+    {
+        if(m_savedPowerMode.has_value())
+        {
+            writePowerMode(m_savedPowerMode.value());
+            m_savedPowerMode.reset();
+        }
+
+        throw;
+    }
+
+    m_lastCurve  = m_savedCurve;
+    m_outputLevel.reset();
+    m_history.clear();
+    m_enabled    = true;
+
+    ControlOwnership::acquire(OWNER,ControlOwnership::FAN_CURVE | ControlOwnership::POWER_MODE);
+
+    m_timer->start();
+
+    control();
+}
+
+void SysFsDataProviderFanController::stop()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!m_enabled)
+    {
+        return;
+    }
+
+    m_timer->stop();
+    m_enabled = false;
+
+    ControlOwnership::release(OWNER);
+
+    if(m_savedCurve.has_value())
+    {
+        writeCurve(m_savedCurve.value());
+        m_savedCurve.reset();
+    }
+
+    /*
+     * Unless the user left the custom mode meanwhile (Fn+Q)
+     */
+    if(m_savedPowerMode.has_value())
+    {
+        const quint8 mode = m_savedPowerMode.value();
+
+        m_savedPowerMode.reset();
+
+        if(readPowerMode() == legion::messages::PowerProfile::POWER_PROFILE_CUSTOM)
+        {
+            writePowerMode(mode);
+
+            LOGF_I("Fan controller: power mode {} restored",mode);
+        }
+    }
+}
+
+void SysFsDataProviderFanController::control()
+{
+    Step step {
+        .m_timestamp = QDateTime::currentMSecsSinceEpoch()
+    };
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Called from timer, nobody above us would handle the exception
+     */
+    try {
+        if(readPowerMode() != legion::messages::PowerProfile::POWER_PROFILE_CUSTOM)
+        {
+            /*
+             * The curve does nothing outside of the custom mode, the mode the user chose wins
+             */
+            LOG_W("Fan controller: custom power mode left, fan controller disabled");
+
+            stop();
+            return;
+        }
+
+        m_temperatures = readTemperatures();
+
+        if(!m_temperatures.m_cpu.has_value() && !m_temperatures.m_gpu.has_value() && !m_temperatures.m_sys.has_value())
+        {
+            step.m_decision = SENSOR_ERROR;
+        }
+        else
+        {
+            m_controlTemperature = std::max({m_temperatures.m_cpu.value_or(0),m_temperatures.m_gpu.value_or(0),m_temperatures.m_sys.value_or(0)});
+            m_targetLevel        = levelForTemperature(m_controlTemperature);
+
+            const quint8 output  = m_outputLevel.value_or(m_targetLevel);
+            quint8       next    = output;
+
+            if(m_targetLevel > output)
+            {
+                next            = static_cast<quint8>(std::min<quint32>(m_targetLevel,output + m_config.m_maxStepUp));
+                step.m_decision = next == m_targetLevel ? RAISE : RATE_LIMITED;
+            }
+            else if(m_targetLevel < output)
+            {
+                /*
+                 * Go down only when the temperature left the band of the current level by the hysteresis
+                 */
+                const quint8 lowered = levelForTemperature(m_controlTemperature + m_config.m_hysteresis);
+
+                if(lowered < output)
+                {
+                    next            = static_cast<quint8>(std::max<qint32>(lowered,static_cast<qint32>(output) - static_cast<qint32>(m_config.m_maxStepDown)));
+                    step.m_decision = next == lowered ? LOWER : RATE_LIMITED;
+                }
+                else
+                {
+                    step.m_decision = HYSTERESIS;
+                }
+            }
+
+            m_outputLevel = next;
+
+            /*
+             * Flat curve on the output level, the last point stays at maximum so the
+             * firmware still protects the machine if the daemon dies
+             */
+            Curve curve;
+            curve.fill(next);
+            curve.back() = MAX_LEVEL;
+
+            if(readCurve() != curve)
+            {
+                writeCurve(curve);
+                step.m_curveWritten = true;
+            }
+        }
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Control step failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        step.m_decision = SENSOR_ERROR;
+    }
+
+    step.m_controlTemperature = m_controlTemperature;
+    step.m_targetLevel        = m_targetLevel;
+    step.m_outputLevel        = m_outputLevel.value_or(0);
+
+    if(step.m_decision != HOLD || step.m_curveWritten)
+    {
+        LOGF_D("Fan controller: temperature={}, target={}, output={}, decision={}, written={}",step.m_controlTemperature,step.m_targetLevel,step.m_outputLevel,step.m_decision,step.m_curveWritten);
+    }
+
+    m_history.push_back(step);
+
+    if(m_history.size() > HISTORY_CAPACITY)
+    {
+        m_history.pop_front();
+    }
+}
+
+SysFsDataProviderFanController::Temperatures SysFsDataProviderFanController::readTemperatures() const
+{
+    Temperatures temperatures;
+
+    try {
+        SysFSDriverLegionHWMon::HWMon hwMon(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFSDriverLegionHWMon::DRIVER_NAME));
+
+        for(const auto& temp : hwMon.m_legion.m_temps)
+        {
+            const QString label = getData(temp.m_label);
+            const quint32 value = getData(temp.m_input).toUInt() / 1000;
+
+            if(label.startsWith("CPU"))
+            {
+                temperatures.m_cpu = value;
+            }
+            else if(label.startsWith("GPU"))
+            {
+                temperatures.m_gpu = value;
+            }
+            else if(label.startsWith("SYS"))
+            {
+                temperatures.m_sys = value;
+            }
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Legion HWMon Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    return temperatures;
+}
+
+quint8 SysFsDataProviderFanController::readPowerMode() const
+{
+    SysFSDriverLegionGameZone::GameZone::SmartFan smartFan(m_sysFsDriverManager->getDriverDesriptor(SysFSDriverLegionGameZone::DRIVER_NAME));
+
+    return static_cast<quint8>(getData(smartFan.m_current_value).toUShort());
+}
+
+void SysFsDataProviderFanController::writePowerMode(quint8 mode)
+{
+    SysFSDriverLegionGameZone::GameZone::SmartFan smartFan(m_sysFsDriverManager->getDriverDesriptor(SysFSDriverLegionGameZone::DRIVER_NAME));
+
+    setData(smartFan.m_current_value,mode);
+}
+
+SysFsDataProviderFanController::Curve SysFsDataProviderFanController::readCurve() const
+{
+    SysFSDriverLegionFanMode::FanMode::FanCurve fanCurve(m_sysFsDriverManager->getDriverDesriptor(SysFSDriverLegionFanMode::DRIVER_NAME));
+    Curve                                       curve;
+
+    const auto points = getData(fanCurve.m_current_value).split(',');
+
+    if(static_cast<size_t>(points.size()) != curve.size())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid fan curve data !");
+    }
+
+    for (size_t i = 0; i < curve.size(); ++i)
+    {
+        curve[i] = static_cast<quint8>(points.at(i).toUInt());
+    }
+
+    return curve;
+}
+
+void SysFsDataProviderFanController::writeCurve(const Curve &curve)
+{
+    SysFSDriverLegionFanMode::FanMode::FanCurve fanCurve(m_sysFsDriverManager->getDriverDesriptor(SysFSDriverLegionFanMode::DRIVER_NAME));
+
+    setData(fanCurve.m_current_value,std::vector<quint8>(curve.begin(),curve.end()));
+
+    m_lastCurve = curve;
+    ++m_curveWrites;
+}
+
+quint8 SysFsDataProviderFanController::levelForTemperature(quint32 temperature) const
+{
+    if(temperature <= m_config.m_minTemperature)
+    {
+        return MIN_LEVEL;
+    }
+
+    if(temperature >= m_config.m_maxTemperature)
+    {
+        return MAX_LEVEL;
+    }
+
+    /*
+     * Linear between the limits, rounded up so a level is reached at its lower edge
+     */
+    const quint32 range = m_config.m_maxTemperature - m_config.m_minTemperature;
+    const quint32 steps = MAX_LEVEL - MIN_LEVEL;
+
+    return static_cast<quint8>(MIN_LEVEL + ((temperature - m_config.m_minTemperature) * steps + range - 1) / range);
+}
+
+}
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <SysFsDataProvider.h>
+
+#include <array>
+#include <deque>
+#include <optional>
+
+class QTimer;
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Closed loop fan control, the firmware curve is used as the actuator. Every control
+ * period the fan level is computed from the hottest sensor and written as a flat curve.
+ * The firmware uses the curve in the custom power mode only, the controller switches to it
+ * and owns the curve and the power mode while it is enabled.
+ */
+class SysFsDataProviderFanController : public SysFsDataProvider
+{
+public:
+
+    /*
+     * Same values as legion::messages::FanController::Decision
+     */
+    enum Decision : quint8 {
+        HOLD            = 0,
+        RAISE           = 1,
+        LOWER           = 2,
+        HYSTERESIS      = 3,
+        RATE_LIMITED    = 4,
+        SENSOR_ERROR    = 5
+    };
+
+    using Curve = std::array<quint8,10>;
+
+    struct Config {
+        quint32 m_minTemperature    = 50;
+        quint32 m_maxTemperature    = 90;
+        quint32 m_hysteresis        = 4;
+        quint32 m_maxStepUp         = 2;
+        quint32 m_maxStepDown       = 1;
+    };
+
+    struct Step {
+        qint64   m_timestamp            = 0;
+        quint32  m_controlTemperature   = 0;
+        quint8   m_targetLevel          = 0;
+        quint8   m_outputLevel          = 0;
+        Decision m_decision             = HOLD;
+        bool     m_curveWritten         = false;
+    };
+
+private:
+
+    struct Temperatures {
+        std::optional<quint32> m_cpu;   // °C
+        std::optional<quint32> m_gpu;   // °C
+        std::optional<quint32> m_sys;   // °C
+    };
+
+public:
+
+    SysFsDataProviderFanController(SysFsDriverManager* sysFsDriverManager,QObject* parent);
+
+    virtual QByteArray serializeAndGetData()                    const override;
+    virtual QByteArray deserializeAndSetData(const QByteArray&)       override;
+
+    virtual void init()  override;
+    virtual void clean() override;
+
+private:
+
+    void control();
+
+    void start();
+    void stop();
+
+    quint8 readPowerMode() const;
+    void   writePowerMode(quint8 mode);
+
+    Temperatures readTemperatures() const;
+    Curve readCurve() const;
+    void writeCurve(const Curve& curve);
+
+    quint8 levelForTemperature(quint32 temperature) const;
+
+private:
+
+    QTimer*                     m_timer;
+
+    bool                        m_enabled;
+    Config                      m_config;
+
+    Temperatures                m_temperatures;
+    quint32                     m_controlTemperature;
+    quint8                      m_targetLevel;
+    std::optional<quint8>       m_outputLevel;
+
+    /*
+     * Curve set before the controller took over, restored when it is disabled
+     */
+    std::optional<Curve>        m_savedCurve;
+
+    /*
+     * Power mode before the switch to the custom one, empty if it was custom already
+     */
+    std::optional<quint8>       m_savedPowerMode;
+    std::optional<Curve>        m_lastCurve;
+    quint64                     m_curveWrites;
+
+    std::deque<Step>            m_history;
+
+public:
+
+    static constexpr quint8  dataType = 23;
+
+    static constexpr const char* OWNER = "fan controller";
+
+    static constexpr int     CONTROL_PERIOD_MS   = 2000;
+    static constexpr size_t  HISTORY_CAPACITY    = 64;
+
+    /*
+     * Firmware fan levels accepted by fan_curve/current_value
+     */
+    static constexpr quint8  MIN_LEVEL           = 1;
+    static constexpr quint8  MAX_LEVEL           = 10;
+};
+
+}
@@ -8,6 +8,7 @@
 
 #include "SysFsDataProviderFanCurve.h"
 #include "SysFSDriverLegionFanMode.h"
+#include "ControlOwnership.h"
 
 #include "../LenovoLegion-PrepareBuild/FanControl.pb.h"
 
@@ -170,6 +171,13 @@ QByteArray SysFsDataProviderFanCurve::deserializeAndSetData(const QByteArray &da
     }
 
     if(fanCurveMsg.has_current_value()) {
+        const auto owner = ControlOwnership::conflict(ControlOwnership::caller(),ControlOwnership::FAN_CURVE);
+
+        if(owner.has_value())
+        {
+            THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Fan curve is controlled by " + owner->toStdString() + " !");
+        }
+
         setData(fanCurve.m_current_value,std::vector<quint8>{
                 static_cast<quint8>(fanCurveMsg.current_value().point1()),
                 static_cast<quint8>(fanCurveMsg.current_value().point2()),
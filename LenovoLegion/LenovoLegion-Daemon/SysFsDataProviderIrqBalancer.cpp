@@ -0,0 +1,445 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "SysFsDataProviderIrqBalancer.h"
+#include "CPUList.h"
+#include "SysFsDriverCPUXList.h"
+#include "SysFsDriverCPUAtom.h"
+
+#include "../LenovoLegion-PrepareBuild/IrqBalancer.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QTimer>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace LenovoLegionDaemon {
+
+SysFsDataProviderIrqBalancer::SysFsDataProviderIrqBalancer(SysFsDriverManager* sysFsDriverManager,QObject* parent,const std::filesystem::path& procRoot) :
+    SysFsDataProvider(sysFsDriverManager,parent,dataType),
+    m_timer(new QTimer(this)),
+    m_procRoot(procRoot),
+    m_enabled(false),
+    m_rebalances(0),
+    m_failures(0)
+{
+    connect(m_timer,&QTimer::timeout,this,&SysFsDataProviderIrqBalancer::rebalance);
+}
+
+QByteArray SysFsDataProviderIrqBalancer::serializeAndGetData() const
+{
+    legion::messages::IrqBalancer irqBalancer;
+    QByteArray                    byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    irqBalancer.set_enabled(m_enabled);
+    irqBalancer.set_rate_threshold(m_config.m_rateThreshold);
+    irqBalancer.set_period(m_config.m_period);
+
+    irqBalancer.set_hybrid(!m_eCores.empty());
+
+    for(const auto cpu : m_eCores)
+    {
+        irqBalancer.add_e_cores(cpu);
+    }
+
+    for(const auto& [irq,rate] : m_rates)
+    {
+        const auto steered = m_steered.find(irq);
+
+        if(steered == m_steered.end() && rate < m_config.m_rateThreshold)
+        {
+            continue;
+        }
+
+        auto irqMsg = irqBalancer.add_irqs();
+
+        irqMsg->set_irq(irq);
+        irqMsg->set_rate(rate);
+        irqMsg->set_steered(steered != m_steered.end());
+
+        if(const auto interrupt = m_lastInterrupts.find(irq); interrupt != m_lastInterrupts.end())
+        {
+            irqMsg->set_actions(interrupt->second.m_actions.toStdString());
+        }
+
+        if(steered != m_steered.end())
+        {
+            irqMsg->set_cpu(steered->second.m_cpu);
+            irqMsg->set_original_affinity(steered->second.m_original.toStdString());
+        }
+    }
+
+    irqBalancer.set_rebalances(m_rebalances);
+    irqBalancer.set_failures(m_failures);
+
+    for(const auto irq : m_unmovable)
+    {
+        irqBalancer.add_unmovable(irq);
+    }
+
+    byteArray.resize(irqBalancer.ByteSizeLong());
+    if(!irqBalancer.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray SysFsDataProviderIrqBalancer::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::IrqBalancer irqBalancer;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!irqBalancer.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    Config config = m_config;
+
+    if(irqBalancer.has_rate_threshold())
+    {
+        config.m_rateThreshold = irqBalancer.rate_threshold();
+    }
+
+    if(irqBalancer.has_period())
+    {
+        config.m_period = irqBalancer.period();
+    }
+
+    if(config.m_rateThreshold == 0 || config.m_period == 0 || config.m_period > 3600)
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid IRQ balancer configuration !");
+    }
+
+    m_config = config;
+    m_timer->setInterval(m_config.m_period * 1000);
+
+    if(irqBalancer.has_enabled() && irqBalancer.enabled() != m_enabled)
+    {
+        if(irqBalancer.enabled())
+        {
+            start();
+        }
+        else
+        {
+            stop();
+        }
+    }
+
+    return {};
+}
+
+void SysFsDataProviderIrqBalancer::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+}
+
+void SysFsDataProviderIrqBalancer::clean()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Never leave interrupts steered behind us
+     */
+    try {
+        stop();
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Restore of interrupts failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+void SysFsDataProviderIrqBalancer::start()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    m_eCores         = readTopology();
+    m_lastInterrupts = ProcInterrupts::read(m_procRoot);
+    m_lastInterruptsTimer.start();
+    m_rates.clear();
+    m_unmovable.clear();
+
+    LOGF_D("IRQ balancer: {} online E-cores, {} interrupts",m_eCores.size(),m_lastInterrupts.size());
+
+    m_enabled = true;
+
+    m_timer->setInterval(m_config.m_period * 1000);
+    m_timer->start();
+}
+
+void SysFsDataProviderIrqBalancer::stop()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!m_enabled)
+    {
+        return;
+    }
+
+    m_timer->stop();
+    m_enabled = false;
+
+    restoreAll();
+}
+
+void SysFsDataProviderIrqBalancer::rebalance()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Called from timer, nobody above us would handle the exception
+     */
+    try {
+        const auto   interrupts = ProcInterrupts::read(m_procRoot);
+        const qint64 elapsed    = std::max<qint64>(1,m_lastInterruptsTimer.restart());
+
+        m_rates.clear();
+
+        for(const auto& [irq,interrupt] : interrupts)
+        {
+            const auto last = m_lastInterrupts.find(irq);
+
+            if(last != m_lastInterrupts.end() && interrupt.m_count >= last->second.m_count)
+            {
+                m_rates[irq] = static_cast<quint32>(std::min<quint64>(std::numeric_limits<quint32>::max(),(interrupt.m_count - last->second.m_count) * 1000 / elapsed));
+            }
+        }
+
+        m_lastInterrupts = interrupts;
+
+        /*
+         * Parked or hot-unplugged E-cores must not keep interrupts
+         */
+        m_eCores = readTopology();
+
+        if(m_eCores.empty())
+        {
+            restoreAll();
+            return;
+        }
+
+        /*
+         * Half of the threshold as hysteresis, so interrupts around it do not move every period
+         */
+        std::vector<std::pair<quint32,quint32>> candidates;
+
+        for(auto it = m_steered.begin(); it != m_steered.end();)
+        {
+            const auto rate = m_rates.find(it->first);
+
+            if(rate == m_rates.end() || rate->second < m_config.m_rateThreshold / 2)
+            {
+                const quint32 irq = it->first;
+
+                ++it;
+                restore(irq);
+            }
+            else
+            {
+                candidates.emplace_back(rate->first,rate->second);
+                ++it;
+            }
+        }
+
+        for(const auto& [irq,rate] : m_rates)
+        {
+            if(rate >= m_config.m_rateThreshold && !m_steered.contains(irq) && !m_unmovable.contains(irq))
+            {
+                candidates.emplace_back(irq,rate);
+            }
+        }
+
+        std::sort(candidates.begin(),candidates.end(),[](const auto& a,const auto& b){ return a.second > b.second; });
+
+        /*
+         * Busiest interrupt first to the least loaded E-core, steered interrupts stay where they are
+         * while their E-core is not loaded more than the others
+         */
+        std::map<quint32,quint64> load;
+        bool                      changed = false;
+
+        for(const auto cpu : m_eCores)
+        {
+            load[cpu] = 0;
+        }
+
+        for(const auto& [irq,rate] : candidates)
+        {
+            const auto leastLoaded = std::min_element(load.begin(),load.end(),[](const auto& a,const auto& b){ return a.second < b.second; });
+            const auto steered     = m_steered.find(irq);
+            quint32    cpu         = leastLoaded->first;
+
+            if(steered != m_steered.end() && load.contains(steered->second.m_cpu) && load.at(steered->second.m_cpu) <= leastLoaded->second + rate)
+            {
+                cpu = steered->second.m_cpu;
+            }
+
+            if(steered == m_steered.end() || steered->second.m_cpu != cpu)
+            {
+                if(!steer(irq,cpu))
+                {
+                    continue;
+                }
+
+                changed = true;
+            }
+
+            load[cpu] += rate;
+        }
+
+        if(changed)
+        {
+            ++m_rebalances;
+        }
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Rebalance failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+std::set<quint32> SysFsDataProviderIrqBalancer::readTopology() const
+{
+    std::set<quint32> eCores;
+
+    try {
+        SysFsDriverCPUAtom::CPUAtom   atom(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPUAtom::DRIVER_NAME));
+        SysFsDriverCPUXList::CPUXList cpuXList(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXList::DRIVER_NAME));
+
+        for(const auto cpu : CPUList::parse(getData(atom.m_cpus)))
+        {
+            /*
+             * CPU without the online attribute can not go offline
+             */
+            if(cpu < cpuXList.cpuList().size() &&
+               (!cpuXList.cpuList().at(cpu).isOnlineAvailable() || getData(cpuXList.cpuList().at(cpu).m_cpuOnline.value()) == "1"))
+            {
+                eCores.insert(cpu);
+            }
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Hybrid topology Driver not available, nothing to balance");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    return eCores;
+}
+
+bool SysFsDataProviderIrqBalancer::steer(quint32 irq, quint32 cpu)
+{
+    const std::filesystem::path path = affinityPath(irq);
+
+    try {
+        const QString original = getData(path);
+
+        setData(path,std::string_view(std::to_string(cpu).append("\n")));
+
+        /*
+         * Write errors are reported on close only, the read back tells whether the kernel took it,
+         * managed interrupts (e.g. NVMe queues) refuse any change
+         */
+        if(CPUList::parse(getData(path)) != std::set<quint32> {cpu})
+        {
+            setData(path,std::string_view(original.toStdString()));
+
+            ++m_failures;
+            m_unmovable.insert(irq);
+            m_steered.erase(irq);
+
+            LOGF_D("IRQ balancer: interrupt {} refused affinity {}",irq,cpu);
+            return false;
+        }
+
+        if(!m_steered.contains(irq))
+        {
+            m_steered[irq].m_original = original;
+        }
+
+        m_steered[irq].m_cpu = cpu;
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        ++m_failures;
+        m_unmovable.insert(irq);
+
+        LOG_D(QString(__PRETTY_FUNCTION__) + "- Steering of interrupt failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        return false;
+    }
+
+    LOGF_D("IRQ balancer: interrupt {} steered to CPU {}",irq,cpu);
+
+    return true;
+}
+
+void SysFsDataProviderIrqBalancer::restore(quint32 irq)
+{
+    const auto steered = m_steered.find(irq);
+
+    if(steered == m_steered.end())
+    {
+        return;
+    }
+
+    const QString original = steered->second.m_original;
+
+    m_steered.erase(steered);
+
+    /*
+     * Interrupt can be gone with its device
+     */
+    if(std::filesystem::exists(affinityPath(irq)))
+    {
+        setData(affinityPath(irq),std::string_view(original.toStdString()));
+    }
+
+    LOGF_D("IRQ balancer: interrupt {} restored to {}",irq,original);
+}
+
+void SysFsDataProviderIrqBalancer::restoreAll()
+{
+    /*
+     * restore() forgets the interrupt before the write, one failing interrupt does not keep the others steered
+     */
+    while(!m_steered.empty())
+    {
+        const quint32 irq = m_steered.begin()->first;
+
+        try {
+            restore(irq);
+        }
+        catch(const bj::framework::exception::Exception& ex)
+        {
+            ++m_failures;
+
+            LOG_W(QString(__PRETTY_FUNCTION__) + "- Restore of interrupt " + QString::number(irq) + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        }
+    }
+}
+
+std::filesystem::path SysFsDataProviderIrqBalancer::affinityPath(quint32 irq) const
+{
+    return m_procRoot / "irq" / std::to_string(irq) / "smp_affinity_list";
+}
+
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <SysFsDataProvider.h>
+
+#include "ProcInterrupts.h"
+#include "SysFsDriver.h"
+
+#include <QElapsedTimer>
+
+#include <filesystem>
+#include <map>
+#include <set>
+
+class QTimer;
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Steers high rate interrupts (NVMe, Wi-Fi, GPU, ...) from the P-cores to the E-cores of a hybrid CPU
+ * through /proc/irq/<irq>/smp_affinity_list, the original affinity is restored when the rate drops
+ * and on exit
+ */
+class SysFsDataProviderIrqBalancer : public SysFsDataProvider
+{
+public:
+
+    struct Config {
+        quint32 m_rateThreshold     = 1000; // interrupts/s
+        quint32 m_period            = 5;    // s
+    };
+
+private:
+
+    struct Steered {
+        quint32 m_cpu = 0;
+        QString m_original;
+    };
+
+public:
+
+    SysFsDataProviderIrqBalancer(SysFsDriverManager* sysFsDriverManager,QObject* parent,const std::filesystem::path& procRoot = SysFsDriver::rootedPath("/proc"));
+
+    virtual QByteArray serializeAndGetData()                    const override;
+    virtual QByteArray deserializeAndSetData(const QByteArray&)       override;
+
+    virtual void init()  override;
+    virtual void clean() override;
+
+private:
+
+    void rebalance();
+
+    void start();
+    void stop();
+
+    /*
+     * Online E-cores, empty if the CPU is not hybrid
+     */
+    std::set<quint32> readTopology() const;
+
+    bool steer(quint32 irq,quint32 cpu);
+    void restore(quint32 irq);
+    void restoreAll();
+
+    std::filesystem::path affinityPath(quint32 irq) const;
+
+private:
+
+    QTimer*                                 m_timer;
+
+    const std::filesystem::path             m_procRoot;
+
+    bool                                    m_enabled;
+    Config                                  m_config;
+
+    std::set<quint32>                       m_eCores;
+
+    std::map<quint32,ProcInterrupts::Interrupt> m_lastInterrupts;
+    QElapsedTimer                           m_lastInterruptsTimer;
+    std::map<quint32,quint32>               m_rates;
+
+    std::map<quint32,Steered>               m_steered;
+    std::set<quint32>                       m_unmovable;
+
+    quint64                                 m_rebalances;
+    quint64                                 m_failures;
+
+public:
+
+    static constexpr quint8  dataType = 28;
+};
+
+}
@@ -0,0 +1,499 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "SysFsDataProviderLoadGenerator.h"
+#include "SysFsDriverIntelPowercapRapl.h"
+#include "SysFSDriverLegionHWMon.h"
+#include "SysFsDriverCPUCore.h"
+#include "SysFsDriverCPUAtom.h"
+#include "SysFsDriverCPU.h"
+#include "CPUList.h"
+#include "PeerCredentials.h"
+
+#include "../LenovoLegion-PrepareBuild/LoadGenerator.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QDateTime>
+#include <QTimer>
+
+namespace LenovoLegionDaemon {
+
+namespace {
+
+void fillRun(legion::messages::LoadGenerator::Run* runMsg,const SysFsDataProviderLoadGenerator::Run& run)
+{
+    const double seconds = run.m_duration / 1000.0;
+
+    runMsg->set_timestamp(run.m_timestamp);
+    runMsg->set_kernel(static_cast<legion::messages::LoadGenerator::Kernel>(run.m_kernel));
+    runMsg->set_core_type(static_cast<legion::messages::LoadGenerator::CoreType>(run.m_coreType));
+
+    for(const auto cpu : run.m_cpus)
+    {
+        runMsg->add_cpus(cpu);
+    }
+
+    runMsg->set_duty_cycle(run.m_dutyCycle);
+    runMsg->set_duration(run.m_duration);
+    runMsg->set_overheat(run.m_overheat);
+
+    if(seconds <= 0)
+    {
+        return;
+    }
+
+    runMsg->set_throughput(run.m_work / seconds / 1e9);
+
+    if(run.m_energy.has_value())
+    {
+        runMsg->set_energy(run.m_energy.value() / 1e6);
+        runMsg->set_power(runMsg->energy() / seconds);
+
+        if(runMsg->power() > 0)
+        {
+            runMsg->set_efficiency(runMsg->throughput() / runMsg->power());
+        }
+    }
+}
+
+}
+
+SysFsDataProviderLoadGenerator::SysFsDataProviderLoadGenerator(SysFsDriverManager* sysFsDriverManager,QObject* parent) :
+    SysFsDataProvider(sysFsDriverManager,parent,dataType),
+    m_timer(new QTimer(this)),
+    m_enabled(false),
+    m_lastWork(0),
+    m_throughput(0),
+    m_power(0),
+    m_temperature(0)
+{
+    m_timer->setInterval(SAMPLE_PERIOD_MS);
+
+    connect(m_timer,&QTimer::timeout,this,&SysFsDataProviderLoadGenerator::sample);
+}
+
+QByteArray SysFsDataProviderLoadGenerator::serializeAndGetData() const
+{
+    legion::messages::LoadGenerator loadGenerator;
+    QByteArray                      byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    loadGenerator.set_enabled(m_enabled);
+    loadGenerator.set_kernel(static_cast<legion::messages::LoadGenerator::Kernel>(m_config.m_kernel));
+    loadGenerator.set_core_type(static_cast<legion::messages::LoadGenerator::CoreType>(m_config.m_coreType));
+    loadGenerator.set_threads(m_config.m_threads);
+    loadGenerator.set_duty_cycle(m_config.m_dutyCycle);
+    loadGenerator.set_period(m_config.m_period);
+    loadGenerator.set_duration(m_config.m_duration);
+    loadGenerator.set_max_temperature(m_config.m_maxTemperature);
+
+    for(const auto kernel : {LoadGenerator::SCALAR_INTEGER,LoadGenerator::AVX2_FMA,LoadGenerator::AVX512_FMA,LoadGenerator::MEMORY_BANDWIDTH})
+    {
+        if(LoadGenerator::supported(kernel))
+        {
+            loadGenerator.add_supported_kernels(static_cast<legion::messages::LoadGenerator::Kernel>(kernel));
+        }
+    }
+
+    if(m_enabled)
+    {
+        loadGenerator.set_throughput(m_throughput);
+        loadGenerator.set_power(m_power);
+        loadGenerator.set_temperature(m_temperature);
+
+        fillRun(loadGenerator.mutable_current(),m_run);
+    }
+
+    for(const auto& run : m_runs)
+    {
+        fillRun(loadGenerator.add_runs(),run);
+    }
+
+    byteArray.resize(loadGenerator.ByteSizeLong());
+    if(!loadGenerator.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray SysFsDataProviderLoadGenerator::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::LoadGenerator loadGenerator;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!loadGenerator.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    Config config = m_config;
+
+    if(loadGenerator.has_kernel())
+    {
+        config.m_kernel = static_cast<LoadGenerator::Kernel>(loadGenerator.kernel());
+    }
+
+    if(loadGenerator.has_core_type())
+    {
+        config.m_coreType = static_cast<CoreType>(loadGenerator.core_type());
+    }
+
+    if(loadGenerator.has_threads())
+    {
+        config.m_threads = loadGenerator.threads();
+    }
+
+    if(loadGenerator.has_duty_cycle())
+    {
+        config.m_dutyCycle = loadGenerator.duty_cycle();
+    }
+
+    if(loadGenerator.has_period())
+    {
+        config.m_period = loadGenerator.period();
+    }
+
+    if(loadGenerator.has_duration())
+    {
+        config.m_duration = loadGenerator.duration();
+    }
+
+    if(loadGenerator.has_max_temperature())
+    {
+        config.m_maxTemperature = loadGenerator.max_temperature();
+    }
+
+    if(config.m_kernel > LoadGenerator::MEMORY_BANDWIDTH || config.m_coreType > EFFICIENT ||
+       config.m_dutyCycle == 0 || config.m_dutyCycle > 100 ||
+       config.m_period < 10 || config.m_period > 1000 ||
+       config.m_duration == 0 || config.m_duration > MAX_DURATION ||
+       config.m_maxTemperature < 60 || config.m_maxTemperature > 105)
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid load generator configuration !");
+    }
+
+    /*
+     * Applies to the next run
+     */
+    m_config = config;
+
+    if(loadGenerator.has_enabled() && loadGenerator.enabled() != m_enabled)
+    {
+        if(loadGenerator.enabled())
+        {
+            start();
+        }
+        else
+        {
+            stop();
+        }
+    }
+
+    return {};
+}
+
+void SysFsDataProviderLoadGenerator::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+}
+
+void SysFsDataProviderLoadGenerator::clean()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    stop();
+}
+
+void SysFsDataProviderLoadGenerator::start()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * A run loads every CPU of the core type, the memory kernel with 64 MiB of buffers per worker
+     */
+    if(!PeerCredentials::isPrivileged())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Load generator run requested by an unprivileged client !");
+    }
+
+    if(!LoadGenerator::supported(m_config.m_kernel))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Load kernel not supported by the CPU !");
+    }
+
+    /*
+     * Temperature is the thermal guard, no run without it
+     */
+    m_temperature = readTemperature();
+
+    if(m_temperature == 0)
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"CPU temperature not available !");
+    }
+
+    if(m_temperature >= m_config.m_maxTemperature)
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"CPU temperature at or above the maximum !");
+    }
+
+    m_run = Run {
+        .m_timestamp    = QDateTime::currentMSecsSinceEpoch(),
+        .m_kernel       = m_config.m_kernel,
+        .m_coreType     = m_config.m_coreType,
+        .m_cpus         = selectCPUs(),
+        .m_dutyCycle    = m_config.m_dutyCycle
+    };
+
+    m_lastEnergy = readEnergy();
+    m_lastWork   = 0;
+    m_throughput = 0;
+    m_power      = 0;
+
+    if(m_lastEnergy.has_value())
+    {
+        m_run.m_energy = 0;
+    }
+
+    m_generator.start(m_config.m_kernel,m_run.m_cpus,m_config.m_dutyCycle,std::chrono::milliseconds(m_config.m_period));
+
+    m_runTimer.start();
+    m_sampleTimer.start();
+    m_timer->start();
+    m_enabled = true;
+
+    LOGF_I("Load generator: kernel={}, cpus={}, duty cycle={}%, duration={}s, max temperature={}",m_config.m_kernel,m_run.m_cpus.size(),m_config.m_dutyCycle,m_config.m_duration,m_config.m_maxTemperature);
+}
+
+void SysFsDataProviderLoadGenerator::stop()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    m_timer->stop();
+
+    if(!m_enabled)
+    {
+        return;
+    }
+
+    m_generator.stop();
+    m_enabled = false;
+
+    /*
+     * Work done up to the join of the workers
+     */
+    sample();
+
+    legion::messages::LoadGenerator::Run result;
+    fillRun(&result,m_run);
+
+    LOGF_I("Load generator: kernel={}, duration={}ms, throughput={}, power={}W, efficiency={}",m_run.m_kernel,m_run.m_duration,result.throughput(),result.power(),result.efficiency());
+
+    m_runs.push_back(std::move(m_run));
+
+    if(m_runs.size() > RUNS_CAPACITY)
+    {
+        m_runs.pop_front();
+    }
+}
+
+void SysFsDataProviderLoadGenerator::sample()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Unknown until read, a failed read aborts the run
+     */
+    m_temperature = 0;
+
+    /*
+     * Called from timer, nobody above us would handle the exception
+     */
+    try {
+        m_temperature = readTemperature();
+
+        const quint64                work    = m_generator.work();
+        const double                 seconds = m_sampleTimer.restart() / 1000.0;
+        const std::optional<quint64> energy  = readEnergy();
+
+        m_run.m_work     = work;
+        m_run.m_duration = static_cast<quint64>(m_runTimer.elapsed());
+
+        if(seconds > 0)
+        {
+            m_throughput = (work - m_lastWork) / seconds / 1e9;
+        }
+
+        if(energy.has_value() && m_lastEnergy.has_value())
+        {
+            /*
+             * energy_uj wraps around at max_energy_range_uj
+             */
+            const quint64 delta = energy.value() >= m_lastEnergy.value() ? energy.value() - m_lastEnergy.value()
+                                                                         : maxEnergy() - m_lastEnergy.value() + energy.value();
+
+            if(seconds > 0)
+            {
+                m_power = delta / 1e6 / seconds;
+            }
+
+            if(m_run.m_energy.has_value())
+            {
+                m_run.m_energy = m_run.m_energy.value() + delta;
+            }
+        }
+        else
+        {
+            m_run.m_energy.reset();
+            m_power = 0;
+        }
+
+        m_lastWork   = work;
+        m_lastEnergy = energy;
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Sample failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+
+    if(m_enabled && (m_temperature == 0 || m_temperature >= m_config.m_maxTemperature))
+    {
+        LOGF_W("Load generator: CPU temperature {} out of the maximum {}, run aborted",m_temperature,m_config.m_maxTemperature);
+
+        m_run.m_overheat = true;
+        stop();
+        return;
+    }
+
+    if(m_enabled && m_run.m_duration >= static_cast<quint64>(m_config.m_duration) * 1000)
+    {
+        stop();
+    }
+}
+
+std::set<quint32> SysFsDataProviderLoadGenerator::selectCPUs() const
+{
+    SysFsDriverCPU::CPU cpu(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPU::DRIVER_NAME));
+    std::set<quint32>   cpus;
+
+    const std::set<quint32> online = CPUList::parse(getData(cpu.m_topology.m_online));
+
+    if(m_config.m_coreType == ALL)
+    {
+        cpus = online;
+    }
+    else
+    {
+        try {
+            SysFsDriverCPUCore::CPUCore core(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPUCore::DRIVER_NAME));
+            SysFsDriverCPUAtom::CPUAtom atom(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPUAtom::DRIVER_NAME));
+
+            for(const auto cpuId : CPUList::parse(getData(m_config.m_coreType == PERFORMANCE ? core.m_cpus : atom.m_cpus)))
+            {
+                if(online.contains(cpuId))
+                {
+                    cpus.insert(cpuId);
+                }
+            }
+        } catch(SysFsDriver::exception_T& ex)
+        {
+            if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+            {
+                LOG_D(QString(__PRETTY_FUNCTION__) + "- Hybrid topology Driver not available");
+            }
+            else
+            {
+                throw;
+            }
+        }
+    }
+
+    if(cpus.empty())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"No online CPU of the core type !");
+    }
+
+    if(m_config.m_threads > cpus.size())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"More threads than online CPUs of the core type !");
+    }
+
+    /*
+     * Lowest numbered CPUs, SMT siblings are numbered next to each other on the hybrid parts
+     */
+    if(m_config.m_threads != 0)
+    {
+        cpus.erase(std::next(cpus.begin(),m_config.m_threads),cpus.end());
+    }
+
+    return cpus;
+}
+
+std::optional<quint64> SysFsDataProviderLoadGenerator::readEnergy() const
+{
+    try {
+        SysFsDriverIntelPowercapRapl::IntelPowercapRapl intelPowercapRapl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+
+        return getData(intelPowercapRapl.m_powercapCPUEnergy).toULongLong();
+
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Intel Rapl Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    return std::nullopt;
+}
+
+quint64 SysFsDataProviderLoadGenerator::maxEnergy() const
+{
+    SysFsDriverIntelPowercapRapl::IntelPowercapRapl intelPowercapRapl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+
+    return getData(intelPowercapRapl.m_max_energy_range).toULongLong();
+}
+
+quint32 SysFsDataProviderLoadGenerator::readTemperature() const
+{
+    quint32 temperature = 0;
+
+    try {
+        SysFSDriverLegionHWMon::HWMon hwMon(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFSDriverLegionHWMon::DRIVER_NAME));
+
+        for(const auto& temp : hwMon.m_legion.m_temps)
+        {
+            if(getData(temp.m_label).startsWith("CPU"))
+            {
+                temperature = getData(temp.m_input).toUInt() / 1000;
+            }
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Legion HWMon Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    return temperature;
+}
+
+}
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <SysFsDataProvider.h>
+
+#include "LoadGenerator.h"
+
+#include <QElapsedTimer>
+
+#include <deque>
+#include <optional>
+#include <set>
+
+class QTimer;
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Reproducible load for power tuning. Runs a LoadGenerator kernel on the CPUs of a core type for the
+ * duration and measures the throughput together with the RAPL package energy, every finished run
+ * ends with a throughput per watt. The run is aborted when the CPU reaches the maximum temperature.
+ */
+class SysFsDataProviderLoadGenerator : public SysFsDataProvider
+{
+public:
+
+    /*
+     * Same values as legion::messages::LoadGenerator::CoreType
+     */
+    enum CoreType : quint8 {
+        ALL             = 0,
+        PERFORMANCE     = 1,
+        EFFICIENT       = 2
+    };
+
+    struct Config {
+        LoadGenerator::Kernel   m_kernel        = LoadGenerator::AVX2_FMA;
+        CoreType                m_coreType      = ALL;
+        quint32                 m_threads       = 0;        // 0 - every CPU of the core type
+        quint32                 m_dutyCycle     = 100;      // %
+        quint32                 m_period        = 100;      // ms
+        quint32                 m_duration      = 60;       // s
+        quint32                 m_maxTemperature = 95;      // °C
+    };
+
+    struct Run {
+        qint64                  m_timestamp     = 0;
+        LoadGenerator::Kernel   m_kernel        = LoadGenerator::AVX2_FMA;
+        CoreType                m_coreType      = ALL;
+        std::set<quint32>       m_cpus;
+        quint32                 m_dutyCycle     = 100;
+        quint64                 m_duration      = 0;        // ms
+        quint64                 m_work          = 0;
+        std::optional<quint64>  m_energy;                   // µJ
+        bool                    m_overheat      = false;
+    };
+
+public:
+
+    SysFsDataProviderLoadGenerator(SysFsDriverManager* sysFsDriverManager,QObject* parent);
+
+    virtual QByteArray serializeAndGetData()                    const override;
+    virtual QByteArray deserializeAndSetData(const QByteArray&)       override;
+
+    virtual void init()  override;
+    virtual void clean() override;
+
+private:
+
+    void sample();
+
+    void start();
+    void stop();
+
+    std::set<quint32> selectCPUs() const;
+
+    /*
+     * Package energy counter, nullopt without RAPL
+     */
+    std::optional<quint64> readEnergy() const;
+    quint64                maxEnergy()  const;
+
+    /*
+     * CPU temperature of the Legion HWMon, 0 if not available
+     */
+    quint32                readTemperature() const;
+
+private:
+
+    LoadGenerator               m_generator;
+
+    QTimer*                     m_timer;
+
+    bool                        m_enabled;
+    Config                      m_config;
+
+    Run                         m_run;
+    QElapsedTimer               m_runTimer;
+    QElapsedTimer               m_sampleTimer;
+    quint64                     m_lastWork;
+    std::optional<quint64>      m_lastEnergy;
+    double                      m_throughput;       // G per s, last sample period
+    double                      m_power;            // W, last sample period
+    quint32                     m_temperature;      // °C, last sample period
+
+    std::deque<Run>             m_runs;
+
+public:
+
+    static constexpr quint8  dataType = 32;
+
+    static constexpr int     SAMPLE_PERIOD_MS    = 1000;
+    static constexpr size_t  RUNS_CAPACITY       = 32;
+
+    static constexpr quint32 MAX_DURATION        = 3600;    // s
+};
+
+}
@@ -0,0 +1,582 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "SysFsDataProviderPowerArbiter.h"
+#include "SysFSDriverLegionGameZone.h"
+#include "SysFsDriverLegionOther.h"
+#include "SysFsDriverCPUXList.h"
+#include "DataProviderManager.h"
+#include "DataProviderNvidiaNvml.h"
+#include "ControlOwnership.h"
+
+#include "../LenovoLegion-PrepareBuild/PowerArbiter.pb.h"
+#include "../LenovoLegion-PrepareBuild/NvidiaNvml.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QDateTime>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace LenovoLegionDaemon {
+
+namespace {
+
+void fillLimits(legion::messages::PowerArbiter::Limits* limitsMsg,const SysFsDataProviderPowerArbiter::Limits& limits)
+{
+    limitsMsg->set_cpu_stp(limits.m_cpuStp);
+    limitsMsg->set_cpu_ltp(limits.m_cpuLtp);
+    limitsMsg->set_gpu_tgp(limits.m_gpuTgp);
+}
+
+}
+
+SysFsDataProviderPowerArbiter::SysFsDataProviderPowerArbiter(SysFsDriverManager* sysFsDriverManager,DataProviderManager* dataProviderManager) :
+    SysFsDataProvider(sysFsDriverManager,dataProviderManager,dataType),
+    m_dataProviderManager(dataProviderManager),
+    m_timer(new QTimer(this)),
+    m_enabled(false),
+    m_cpuLoad(0),
+    m_gpuLoad(0),
+    m_cpuFrequencyRatio(1),
+    m_gpuPowerRatio(0),
+    m_bottleneck(NONE),
+    m_gpuCeiling(0),
+    m_bias(0),
+    m_shifts(0)
+{
+    m_timer->setInterval(SAMPLE_PERIOD_MS);
+
+    connect(m_timer,&QTimer::timeout,this,&SysFsDataProviderPowerArbiter::sample);
+}
+
+QByteArray SysFsDataProviderPowerArbiter::serializeAndGetData() const
+{
+    legion::messages::PowerArbiter powerArbiter;
+    QByteArray                     byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    powerArbiter.set_enabled(m_enabled);
+    powerArbiter.set_busy_threshold(m_config.m_busyThreshold);
+    powerArbiter.set_hysteresis(m_config.m_hysteresis);
+    powerArbiter.set_step(m_config.m_step);
+    powerArbiter.set_max_shift(m_config.m_maxShift);
+    powerArbiter.set_dwell_time(m_config.m_dwellTime);
+
+    powerArbiter.set_cpu_utilization(static_cast<quint32>(m_cpuLoad + 0.5));
+    powerArbiter.set_cpu_frequency(static_cast<quint32>(m_cpuFrequencyRatio * 100 + 0.5));
+    powerArbiter.set_gpu_utilization(static_cast<quint32>(m_gpuLoad + 0.5));
+    powerArbiter.set_gpu_power(static_cast<quint32>(m_gpuPowerRatio * 100 + 0.5));
+    powerArbiter.set_bottleneck(static_cast<legion::messages::PowerArbiter::Bottleneck>(m_bottleneck));
+    powerArbiter.set_bias(m_bias);
+
+    if(m_enabled)
+    {
+        fillLimits(powerArbiter.mutable_baseline(),m_baseline);
+        fillLimits(powerArbiter.mutable_limits(),limitsForBias(m_bias));
+    }
+
+    powerArbiter.set_shifts(m_shifts);
+
+    for(const auto& item : m_history)
+    {
+        auto shiftMsg = powerArbiter.add_history();
+
+        shiftMsg->set_timestamp(item.m_timestamp);
+        shiftMsg->set_bias(item.m_bias);
+        fillLimits(shiftMsg->mutable_limits(),item.m_limits);
+        shiftMsg->set_cpu_utilization(item.m_cpuUtilization);
+        shiftMsg->set_gpu_utilization(item.m_gpuUtilization);
+        shiftMsg->set_reason(static_cast<legion::messages::PowerArbiter::Reason>(item.m_reason));
+    }
+
+    byteArray.resize(powerArbiter.ByteSizeLong());
+    if(!powerArbiter.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray SysFsDataProviderPowerArbiter::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::PowerArbiter powerArbiter;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!powerArbiter.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    Config config = m_config;
+
+    if(powerArbiter.has_busy_threshold())
+    {
+        config.m_busyThreshold = powerArbiter.busy_threshold();
+    }
+
+    if(powerArbiter.has_hysteresis())
+    {
+        config.m_hysteresis = powerArbiter.hysteresis();
+    }
+
+    if(powerArbiter.has_step())
+    {
+        config.m_step = powerArbiter.step();
+    }
+
+    if(powerArbiter.has_max_shift())
+    {
+        config.m_maxShift = powerArbiter.max_shift();
+    }
+
+    if(powerArbiter.has_dwell_time())
+    {
+        config.m_dwellTime = powerArbiter.dwell_time();
+    }
+
+    if(config.m_busyThreshold > 100 || config.m_hysteresis >= config.m_busyThreshold ||
+       config.m_step == 0 || config.m_step > config.m_maxShift)
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid power arbiter configuration !");
+    }
+
+    m_config = config;
+
+    if(powerArbiter.has_enabled() && powerArbiter.enabled() != m_enabled)
+    {
+        if(powerArbiter.enabled())
+        {
+            start();
+        }
+        else
+        {
+            stop();
+        }
+    }
+
+    return {};
+}
+
+void SysFsDataProviderPowerArbiter::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+}
+
+void SysFsDataProviderPowerArbiter::clean()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    stop();
+}
+
+void SysFsDataProviderPowerArbiter::start()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    const auto owner = ControlOwnership::conflict(OWNER,ControlOwnership::CPU_POWER_LIMITS | ControlOwnership::GPU_POWER_LIMIT);
+
+    if(owner.has_value())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Power limits are controlled by " + owner->toStdString() + " !");
+    }
+
+    rebase();
+
+    /*
+     * Seed the averages, the first shift waits for the dwell time anyway
+     */
+    m_lastCPUTimes      = ProcStat::read(SysFsDriver::rootedPath("/proc"));
+    m_cpuLoad           = 0;
+    m_gpuLoad           = 0;
+    m_cpuFrequencyRatio = 1;
+    m_gpuPowerRatio     = 0;
+    m_bottleneck        = NONE;
+
+    m_history.clear();
+    m_dwellTimer.start();
+    m_enabled           = true;
+
+    ControlOwnership::acquire(OWNER,ControlOwnership::CPU_POWER_LIMITS | ControlOwnership::GPU_POWER_LIMIT);
+
+    m_timer->start();
+}
+
+void SysFsDataProviderPowerArbiter::stop()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    m_timer->stop();
+
+    if(!m_enabled)
+    {
+        return;
+    }
+
+    m_enabled = false;
+
+    /*
+     * Baseline is restored unless the user took the limits over
+     */
+    try {
+        if(m_bias != 0 && m_writtenLimits.has_value() && readLimits() == m_writtenLimits.value())
+        {
+            writeLimits(m_baseline);
+
+            LOGF_I("Power arbiter: baseline restored, cpu_stp={}W, cpu_ltp={}W, gpu_tgp={}W",m_baseline.m_cpuStp,m_baseline.m_cpuLtp,m_baseline.m_gpuTgp);
+        }
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Restore of the baseline failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+
+    m_bias = 0;
+    m_writtenLimits.reset();
+
+    ControlOwnership::release(OWNER);
+}
+
+void SysFsDataProviderPowerArbiter::sample()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Called from timer, nobody above us would handle the exception
+     */
+    try {
+        quint32 cpuUtilization = 0, gpuUtilization = 0;
+        double  frequencyRatio = 1, powerRatio     = 0;
+
+        readCPU(cpuUtilization,frequencyRatio);
+
+        if(!readGPU(gpuUtilization,powerRatio))
+        {
+            gpuUtilization = 0;
+            powerRatio     = 0;
+        }
+
+        m_cpuLoad           += SMOOTHING * (cpuUtilization - m_cpuLoad);
+        m_cpuFrequencyRatio += SMOOTHING * (frequencyRatio - m_cpuFrequencyRatio);
+        m_gpuLoad           += SMOOTHING * (gpuUtilization - m_gpuLoad);
+        m_gpuPowerRatio     += SMOOTHING * (powerRatio - m_gpuPowerRatio);
+
+        if(m_writtenLimits.has_value() && readLimits() != m_writtenLimits.value())
+        {
+            /*
+             * Somebody else changed the limits (GUI, power mode), they are the new baseline
+             */
+            rebase();
+            addShift(USER);
+
+            m_dwellTimer.restart();
+        }
+
+        /*
+         * Bound side stays bound until its load drops by the hysteresis
+         */
+        const bool cpuBusy  = m_cpuLoad >= m_config.m_busyThreshold - (m_bottleneck == CPU ? m_config.m_hysteresis : 0);
+        const bool gpuBusy  = m_gpuLoad >= m_config.m_busyThreshold - (m_bottleneck == GPU ? m_config.m_hysteresis : 0);
+        const bool cpuBound = cpuBusy && m_cpuFrequencyRatio < CPU_FREQUENCY_BOUND;
+        const bool gpuBound = gpuBusy && m_gpuPowerRatio >= GPU_POWER_BOUND;
+
+        m_bottleneck = cpuBound == gpuBound ? NONE : (cpuBound ? CPU : GPU);
+
+        if(m_dwellTimer.elapsed() < static_cast<qint64>(m_config.m_dwellTime) * 1000)
+        {
+            return;
+        }
+
+        const qint32 step     = static_cast<qint32>(m_config.m_step);
+        const qint32 maxShift = static_cast<qint32>(m_config.m_maxShift);
+        qint32       target   = m_bias;
+        Reason       reason   = BALANCE;
+
+        if(m_bottleneck == GPU)
+        {
+            target = std::min(m_bias + step,maxShift);
+            reason = GPU_BOUND;
+        }
+        else if(m_bottleneck == CPU)
+        {
+            target = std::max(m_bias - step,-maxShift);
+            reason = CPU_BOUND;
+        }
+        else if(!cpuBusy && !gpuBusy)
+        {
+            /*
+             * Busy sides which are not bound got enough, only idle sides go back to the baseline
+             */
+            target = m_bias > 0 ? std::max(m_bias - step,0) : std::min(m_bias + step,0);
+        }
+
+        target = feasibleBias(target);
+
+        if(target == m_bias)
+        {
+            return;
+        }
+
+        m_bias = target;
+
+        writeLimits(limitsForBias(m_bias));
+        addShift(reason);
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Sample failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+void SysFsDataProviderPowerArbiter::readCPU(quint32 &utilization, double &frequencyRatio)
+{
+    const ProcStat::Snapshot snapshot = ProcStat::read(SysFsDriver::rootedPath("/proc"));
+    size_t                   busiest  = 0;
+
+    utilization    = 0;
+    frequencyRatio = 1;
+
+    /*
+     * Busiest core, one saturated thread of a game is a CPU bottleneck even at a low total load
+     */
+    for(size_t i = 0; i < snapshot.m_cpus.size() && i < m_lastCPUTimes.m_cpus.size(); ++i)
+    {
+        const quint32 cpuUtilization = ProcStat::utilization(m_lastCPUTimes.m_cpus[i],snapshot.m_cpus[i]);
+
+        if(cpuUtilization > utilization)
+        {
+            utilization = cpuUtilization;
+            busiest     = i;
+        }
+    }
+
+    m_lastCPUTimes = snapshot;
+
+    try {
+        SysFsDriverCPUXList::CPUXList cpus(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXList::DRIVER_NAME));
+
+        if(busiest < cpus.cpuList().size())
+        {
+            const auto&   cpu        = cpus.cpuList().at(busiest);
+            const quint32 maxFreq    = getData(cpu.m_freq.m_cpuInfoMaxFreq).toUInt();
+            const quint32 curFreq    = getData(cpu.m_freq.m_cpuScalingCurFreq).toUInt();
+
+            if(maxFreq > 0)
+            {
+                frequencyRatio = static_cast<double>(curFreq) / maxFreq;
+            }
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- CPUX Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+}
+
+bool SysFsDataProviderPowerArbiter::readGPU(quint32 &utilization, double &powerRatio) const
+{
+    const auto& nvml     = dynamic_cast<const DataProviderNvidiaNvml&>(m_dataProviderManager->getDataProvider(DataProviderNvidiaNvml::dataType));
+    const auto  snapshot = nvml.snapshot();
+
+    /*
+     * No NVIDIA GPU or it is suspended, it does not want any watts
+     */
+    if(snapshot == nullptr || !snapshot->has_hardware_monitor() || snapshot->power_state() == legion::messages::NvidiaNvml::POWER_STATE_SUSPENDED)
+    {
+        return false;
+    }
+
+    const auto& power = snapshot->hardware_monitor().power();
+
+    utilization = snapshot->hardware_monitor().gpu_utilization().value();
+    powerRatio  = power.enforced_value() > 0 ? static_cast<double>(power.value()) / power.enforced_value() : 0;
+
+    return true;
+}
+
+SysFsDataProviderPowerArbiter::Limits SysFsDataProviderPowerArbiter::readLimits() const
+{
+    SysFsDriverLegionOther::Other::CPU cpuControl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverLegionOther::DRIVER_NAME));
+    SysFsDriverLegionOther::Other::GPU gpuControl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverLegionOther::DRIVER_NAME));
+
+    return Limits {
+        .m_cpuStp = getData(cpuControl.m_cpu_stp_limit.m_current_value).toUInt(),
+        .m_cpuLtp = getData(cpuControl.m_cpu_ltp_limit.m_current_value).toUInt(),
+        .m_gpuTgp = getData(gpuControl.m_gpu_configurable_tgp.m_current_value).toUInt()
+    };
+}
+
+void SysFsDataProviderPowerArbiter::writeLimits(const Limits &limits)
+{
+    SysFsDriverLegionOther::Other::CPU cpuControl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverLegionOther::DRIVER_NAME));
+    SysFsDriverLegionOther::Other::GPU gpuControl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverLegionOther::DRIVER_NAME));
+
+    /*
+     * Lowered side first, the budget is not exceeded in between
+     */
+    if(limits.m_gpuTgp < readLimits().m_gpuTgp)
+    {
+        setData(gpuControl.m_gpu_configurable_tgp.m_current_value,limits.m_gpuTgp);
+        setData(cpuControl.m_cpu_ltp_limit.m_current_value,limits.m_cpuLtp);
+        setData(cpuControl.m_cpu_stp_limit.m_current_value,limits.m_cpuStp);
+    }
+    else
+    {
+        setData(cpuControl.m_cpu_ltp_limit.m_current_value,limits.m_cpuLtp);
+        setData(cpuControl.m_cpu_stp_limit.m_current_value,limits.m_cpuStp);
+        setData(gpuControl.m_gpu_configurable_tgp.m_current_value,limits.m_gpuTgp);
+    }
+
+    /*
+     * Firmware may round the values, the read back ones are compared in the next samples
+     */
+    m_writtenLimits = readLimits();
+    m_dwellTimer.restart();
+    ++m_shifts;
+}
+
+void SysFsDataProviderPowerArbiter::rebase()
+{
+    SysFSDriverLegionGameZone::GameZone::SmartFan smartFan(m_sysFsDriverManager->getDriverDesriptor(SysFSDriverLegionGameZone::DRIVER_NAME));
+    SysFsDriverLegionOther::Other::CPU            cpuControl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverLegionOther::DRIVER_NAME));
+    SysFsDriverLegionOther::Other::GPU            gpuControl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverLegionOther::DRIVER_NAME));
+
+    const quint32 mode = getData(smartFan.m_current_value).toUInt();
+
+    m_baseline      = readLimits();
+    m_writtenLimits = m_baseline;
+    m_bias          = 0;
+
+    /*
+     * Unknown range, the limit is not moved
+     */
+    m_stpRange = readRange(cpuControl.m_cpu_stp_limit.m_min_value,cpuControl.m_cpu_stp_limit.m_max_value,mode).value_or(Range{m_baseline.m_cpuStp,m_baseline.m_cpuStp});
+    m_ltpRange = readRange(cpuControl.m_cpu_ltp_limit.m_min_value,cpuControl.m_cpu_ltp_limit.m_max_value,mode).value_or(Range{m_baseline.m_cpuLtp,m_baseline.m_cpuLtp});
+    m_tgpRange = readRange(gpuControl.m_gpu_configurable_tgp.m_min_value,gpuControl.m_gpu_configurable_tgp.m_max_value,mode).value_or(Range{m_baseline.m_gpuTgp,m_baseline.m_gpuTgp});
+
+    /*
+     * TGP plus the dynamic boost must fit into the total GPU power
+     */
+    const quint32 totalOnAc    = getData(gpuControl.m_gpu_total_onac.m_current_value).toUInt();
+    const quint32 dynamicBoost = getData(gpuControl.m_gpu_to_cpu_dynamic_boost.m_current_value).toUInt();
+
+    m_gpuCeiling = totalOnAc > dynamicBoost ? totalOnAc - dynamicBoost : 0;
+
+    LOGF_D("Power arbiter baseline: mode={}, cpu_stp={}W [{}-{}], cpu_ltp={}W [{}-{}], gpu_tgp={}W [{}-{}], gpu_ceiling={}W",
+           mode,
+           m_baseline.m_cpuStp,m_stpRange.m_min,m_stpRange.m_max,
+           m_baseline.m_cpuLtp,m_ltpRange.m_min,m_ltpRange.m_max,
+           m_baseline.m_gpuTgp,m_tgpRange.m_min,m_tgpRange.m_max,
+           m_gpuCeiling);
+}
+
+qint32 SysFsDataProviderPowerArbiter::feasibleBias(qint32 bias) const
+{
+    const qint64 stp = m_baseline.m_cpuStp;
+    const qint64 ltp = m_baseline.m_cpuLtp;
+    const qint64 tgp = m_baseline.m_gpuTgp;
+
+    if(bias > 0)
+    {
+        const qint64 gpuMax = m_gpuCeiling > 0 ? std::min(m_tgpRange.m_max,m_gpuCeiling) : m_tgpRange.m_max;
+
+        /*
+         * GPU gets what the CPU gives, both CPU limits go down by the same watts
+         */
+        return static_cast<qint32>(std::max<qint64>(0,std::min({static_cast<qint64>(bias),
+                                                                gpuMax - tgp,
+                                                                stp - m_stpRange.m_min,
+                                                                ltp - m_ltpRange.m_min})));
+    }
+
+    if(bias < 0)
+    {
+        return -static_cast<qint32>(std::max<qint64>(0,std::min({static_cast<qint64>(-bias),
+                                                                 tgp - m_tgpRange.m_min,
+                                                                 m_stpRange.m_max - stp,
+                                                                 m_ltpRange.m_max - ltp})));
+    }
+
+    return 0;
+}
+
+SysFsDataProviderPowerArbiter::Limits SysFsDataProviderPowerArbiter::limitsForBias(qint32 bias) const
+{
+    return Limits {
+        .m_cpuStp = static_cast<quint32>(static_cast<qint64>(m_baseline.m_cpuStp) - bias),
+        .m_cpuLtp = static_cast<quint32>(static_cast<qint64>(m_baseline.m_cpuLtp) - bias),
+        .m_gpuTgp = static_cast<quint32>(static_cast<qint64>(m_baseline.m_gpuTgp) + bias)
+    };
+}
+
+std::optional<SysFsDataProviderPowerArbiter::Range> SysFsDataProviderPowerArbiter::readRange(const std::filesystem::path &minPath, const std::filesystem::path &maxPath, quint32 mode) const
+{
+    /*
+     * Values per power mode, e.g. "1=15,2=35,3=55,255=55"
+     */
+    auto valueForMode = [&](const std::filesystem::path& path) -> std::optional<quint32> {
+        for (const auto& item : getData(path).trimmed().split(',')) {
+            const auto pair = item.split('=');
+
+            if(pair.size() == 2 && pair.at(0).toUInt() == mode)
+            {
+                return pair.at(1).toUInt();
+            }
+        }
+
+        return std::nullopt;
+    };
+
+    const auto min = valueForMode(minPath);
+    const auto max = valueForMode(maxPath);
+
+    if(!min.has_value() || !max.has_value() || min.value() > max.value())
+    {
+        LOG_D(QString(__PRETTY_FUNCTION__) + "- No range of " + QString::fromStdString(minPath.parent_path().string()) + " for mode " + QString::number(mode));
+        return std::nullopt;
+    }
+
+    return Range {
+        .m_min = min.value(),
+        .m_max = max.value()
+    };
+}
+
+void SysFsDataProviderPowerArbiter::addShift(Reason reason)
+{
+    const Shift item {
+        .m_timestamp      = QDateTime::currentMSecsSinceEpoch(),
+        .m_bias           = m_bias,
+        .m_limits         = limitsForBias(m_bias),
+        .m_cpuUtilization = static_cast<quint32>(m_cpuLoad + 0.5),
+        .m_gpuUtilization = static_cast<quint32>(m_gpuLoad + 0.5),
+        .m_reason         = reason
+    };
+
+    LOGF_I("Power arbiter: bias={}W, cpu_stp={}W, cpu_ltp={}W, gpu_tgp={}W, cpu={}%, gpu={}%, reason={}",
+           item.m_bias,item.m_limits.m_cpuStp,item.m_limits.m_cpuLtp,item.m_limits.m_gpuTgp,item.m_cpuUtilization,item.m_gpuUtilization,item.m_reason);
+
+    m_history.push_back(item);
+
+    if(m_history.size() > HISTORY_CAPACITY)
+    {
+        m_history.pop_front();
+    }
+}
+
+}
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <SysFsDataProvider.h>
+
+#include "ProcStat.h"
+
+#include <QElapsedTimer>
+
+#include <deque>
+#include <optional>
+
+class QTimer;
+
+namespace LenovoLegionDaemon {
+
+class DataProviderManager;
+
+/*
+ * Shifts watts between the CPU (cpu_stp_limit, cpu_ltp_limit) and the GPU (gpu_configurable_tgp) inside
+ * the budget found at the start. A side is bound when it is busy and its clocks are held down by the
+ * power: the busiest core runs below its maximum frequency, the GPU draws its enforced power limit.
+ * The bias moves by one step per dwell time towards the bound side and back to the baseline when no
+ * side is bound, the GPU never gets more than gpu_total_onac minus the dynamic boost.
+ *
+ * Limits written by somebody else (GUI, power profile change) become the new baseline.
+ */
+class SysFsDataProviderPowerArbiter : public SysFsDataProvider
+{
+public:
+
+    /*
+     * Same values as legion::messages::PowerArbiter::Bottleneck
+     */
+    enum Bottleneck : quint8 {
+        NONE            = 0,
+        CPU             = 1,
+        GPU             = 2
+    };
+
+    /*
+     * Same values as legion::messages::PowerArbiter::Reason
+     */
+    enum Reason : quint8 {
+        CPU_BOUND       = 0,
+        GPU_BOUND       = 1,
+        BALANCE         = 2,
+        USER            = 3
+    };
+
+    struct Config {
+        quint32 m_busyThreshold         = 85;           // %
+        quint32 m_hysteresis            = 15;           // %
+        quint32 m_step                  = 5;            // W
+        quint32 m_maxShift              = 25;           // W
+        quint32 m_dwellTime             = 10;           // s
+    };
+
+    struct Limits {
+        quint32 m_cpuStp                = 0;            // W
+        quint32 m_cpuLtp                = 0;            // W
+        quint32 m_gpuTgp                = 0;            // W
+
+        bool operator==(const Limits&) const = default;
+    };
+
+    struct Shift {
+        qint64  m_timestamp             = 0;
+        qint32  m_bias                  = 0;
+        Limits  m_limits;
+        quint32 m_cpuUtilization        = 0;
+        quint32 m_gpuUtilization        = 0;
+        Reason  m_reason                = BALANCE;
+    };
+
+private:
+
+    struct Range {
+        quint32 m_min                   = 0;
+        quint32 m_max                   = 0;
+    };
+
+public:
+
+    SysFsDataProviderPowerArbiter(SysFsDriverManager* sysFsDriverManager,DataProviderManager* dataProviderManager);
+
+    virtual QByteArray serializeAndGetData()                    const override;
+    virtual QByteArray deserializeAndSetData(const QByteArray&)       override;
+
+    virtual void init()  override;
+    virtual void clean() override;
+
+private:
+
+    void sample();
+
+    void start();
+    void stop();
+
+    /*
+     * Busiest core utilization and the frequency of that core relative to its maximum
+     */
+    void readCPU(quint32& utilization,double& frequencyRatio);
+
+    /*
+     * GPU utilization and the power relative to the enforced limit, false without an active GPU
+     */
+    bool readGPU(quint32& utilization,double& powerRatio) const;
+
+    Limits readLimits() const;
+    void   writeLimits(const Limits& limits);
+
+    /*
+     * Current limits become the baseline, the ranges are read for the current power mode
+     */
+    void   rebase();
+
+    /*
+     * Bias limited so both sides can move by it inside their ranges, the budget stays the same
+     */
+    qint32 feasibleBias(qint32 bias) const;
+    Limits limitsForBias(qint32 bias) const;
+
+    std::optional<Range> readRange(const std::filesystem::path& minPath,const std::filesystem::path& maxPath,quint32 mode) const;
+
+    void   addShift(Reason reason);
+
+private:
+
+    DataProviderManager*        m_dataProviderManager;
+
+    QTimer*                     m_timer;
+
+    bool                        m_enabled;
+    Config                      m_config;
+
+    ProcStat::Snapshot          m_lastCPUTimes;
+    double                      m_cpuLoad;
+    double                      m_gpuLoad;
+    double                      m_cpuFrequencyRatio;
+    double                      m_gpuPowerRatio;
+
+    Bottleneck                  m_bottleneck;
+
+    Limits                      m_baseline;
+    Range                       m_stpRange;
+    Range                       m_ltpRange;
+    Range                       m_tgpRange;
+    quint32                     m_gpuCeiling;       // gpu_total_onac minus the dynamic boost, 0 - none
+    qint32                      m_bias;             // W, positive towards the GPU
+
+    /*
+     * Limits written by the arbiter, different values read back mean the user took over
+     */
+    std::optional<Limits>       m_writtenLimits;
+    QElapsedTimer               m_dwellTimer;
+    quint64                     m_shifts;
+
+    std::deque<Shift>           m_history;
+
+public:
+
+    static constexpr quint8  dataType = 30;
+
+    static constexpr const char* OWNER = "power arbiter";
+
+    static constexpr int     SAMPLE_PERIOD_MS        = 2000;
+    static constexpr size_t  HISTORY_CAPACITY        = 64;
+
+    /*
+     * Weight of the new sample in the exponential moving average
+     */
+    static constexpr double  SMOOTHING               = 0.3;
+
+    /*
+     * Busy side is power bound below these ratios (CPU frequency) or above them (GPU power)
+     */
+    static constexpr double  CPU_FREQUENCY_BOUND     = 0.9;
+    static constexpr double  GPU_POWER_BOUND         = 0.9;
+};
+
+}
@@ -9,6 +9,7 @@
 #include "SysFsDataProviderPowerProfile.h"
 #include "SysFSDriverLegionGameZone.h"
 #include "SysFsDriverLegionOther.h"
+#include "ControlOwnership.h"
 
 #include "../LenovoLegion-PrepareBuild/PowerProfile.pb.h"
 
@@ -89,6 +90,13 @@ QByteArray SysFsDataProviderPowerProfile::deserializeAndSetData(const QByteArray
     }
 
     if(powerProfile.has_current_value()) {
+        const auto owner = ControlOwnership::conflict(ControlOwnership::caller(),ControlOwnership::POWER_MODE);
+
+        if(owner.has_value())
+        {
+            THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Power mode is controlled by " + owner->toStdString() + " !");
+        }
+
         setData(smartFan.m_current_value,static_cast<quint8>(powerProfile.current_value()));
     }
 
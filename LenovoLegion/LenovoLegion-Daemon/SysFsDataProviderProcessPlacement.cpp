@@ -0,0 +1,372 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "SysFsDataProviderProcessPlacement.h"
+#include "SysFsDriverCPUCore.h"
+#include "SysFsDriverCPUAtom.h"
+#include "CPUList.h"
+#include "PeerCredentials.h"
+
+#include "../LenovoLegion-PrepareBuild/ProcessPlacement.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace LenovoLegionDaemon {
+
+SysFsDataProviderProcessPlacement::SysFsDataProviderProcessPlacement(SysFsDriverManager* sysFsDriverManager,QObject* parent) :
+    SysFsDataProvider(sysFsDriverManager,parent,dataType),
+    m_processMonitor(new ProcessMonitor(this)),
+    m_enabled(false),
+    m_failures(0)
+{
+    connect(m_processMonitor,&ProcessMonitor::processStarted,this,&SysFsDataProviderProcessPlacement::onProcessStarted);
+    connect(m_processMonitor,&ProcessMonitor::processExited,this,&SysFsDataProviderProcessPlacement::onProcessExited);
+}
+
+QByteArray SysFsDataProviderProcessPlacement::serializeAndGetData() const
+{
+    legion::messages::ProcessPlacement processPlacement;
+    QByteArray                         byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    processPlacement.set_enabled(m_enabled);
+
+    for(const auto& rule : m_rules)
+    {
+        auto ruleMsg = processPlacement.mutable_rule_set()->add_rules();
+
+        ruleMsg->set_name(rule.m_name.toStdString());
+        ruleMsg->set_match_type(static_cast<legion::messages::ProcessPlacement::MatchType>(rule.m_matchType));
+        ruleMsg->set_pattern(rule.m_pattern.pattern().toStdString());
+        ruleMsg->set_placement(static_cast<legion::messages::ProcessPlacement::Placement>(rule.m_placement));
+    }
+
+    processPlacement.set_hybrid(!m_pCores.empty() && !m_eCores.empty());
+
+    for(const auto cpu : m_pCores)
+    {
+        processPlacement.add_p_cores(cpu);
+    }
+
+    for(const auto cpu : m_eCores)
+    {
+        processPlacement.add_e_cores(cpu);
+    }
+
+    for(const auto& [pid,placed] : m_placed)
+    {
+        auto placedMsg = processPlacement.add_placed();
+
+        placedMsg->set_pid(pid);
+        placedMsg->set_placement(static_cast<legion::messages::ProcessPlacement::Placement>(placed.m_placement));
+        placedMsg->set_source(placed.m_source.toStdString());
+        placedMsg->set_threads(placed.m_threads);
+    }
+
+    processPlacement.set_failures(m_failures);
+
+    byteArray.resize(processPlacement.ByteSizeLong());
+    if(!processPlacement.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray SysFsDataProviderProcessPlacement::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::ProcessPlacement processPlacement;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!processPlacement.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    if(processPlacement.has_rule_set())
+    {
+        std::vector<Rule> rules;
+
+        for(const auto& ruleMsg : processPlacement.rule_set().rules())
+        {
+            const Rule rule {
+                .m_name      = QString::fromStdString(std::string(ruleMsg.name())),
+                .m_matchType = static_cast<MatchType>(ruleMsg.match_type()),
+                .m_pattern   = QRegularExpression(QString::fromStdString(std::string(ruleMsg.pattern()))),
+                .m_placement = static_cast<Placement>(ruleMsg.placement())
+            };
+
+            if(rule.m_name.isEmpty() || !rule.m_pattern.isValid() ||
+               (rule.m_matchType != EXECUTABLE && rule.m_matchType != CMDLINE) ||
+               (rule.m_placement != P_CORES && rule.m_placement != E_CORES))
+            {
+                THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid process placement rule !");
+            }
+
+            rules.push_back(rule);
+        }
+
+        restoreAll(true);
+
+        m_rules = std::move(rules);
+
+        if(m_enabled)
+        {
+            for(const auto& process : m_processMonitor->processes())
+            {
+                onProcessStarted(process);
+            }
+        }
+    }
+
+    if(processPlacement.has_enabled() && processPlacement.enabled() != m_enabled)
+    {
+        if(processPlacement.enabled())
+        {
+            start();
+        }
+        else
+        {
+            stop();
+        }
+    }
+
+    if(processPlacement.requests_size() > 0 && !m_enabled)
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Process placement is not enabled !");
+    }
+
+    /*
+     * All requests are checked before any of them is applied. Root may place any process,
+     * other clients only their own ones
+     */
+    for(const auto& request : processPlacement.requests())
+    {
+        const Placement placement = static_cast<Placement>(request.placement());
+
+        if(request.pid() <= 0 || (placement != DEFAULT && placement != P_CORES && placement != E_CORES))
+        {
+            THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid process placement request !");
+        }
+
+        if(!PeerCredentials::mayControl(request.pid(),m_processMonitor->procRoot()))
+        {
+            THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Process placement request for a process of another user !");
+        }
+    }
+
+    for(const auto& request : processPlacement.requests())
+    {
+        const Placement placement = static_cast<Placement>(request.placement());
+
+        if(placement == DEFAULT)
+        {
+            restore(request.pid());
+        }
+        else
+        {
+            place(request.pid(),placement,{});
+        }
+    }
+
+    return {};
+}
+
+void SysFsDataProviderProcessPlacement::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+}
+
+void SysFsDataProviderProcessPlacement::clean()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    stop();
+}
+
+void SysFsDataProviderProcessPlacement::start()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    readTopology();
+
+    m_processMonitor->start();
+    m_enabled = true;
+
+    for(const auto& process : m_processMonitor->processes())
+    {
+        onProcessStarted(process);
+    }
+}
+
+void SysFsDataProviderProcessPlacement::stop()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    m_processMonitor->stop();
+    m_enabled = false;
+
+    restoreAll(false);
+}
+
+void SysFsDataProviderProcessPlacement::readTopology()
+{
+    m_pCores.clear();
+    m_eCores.clear();
+
+    try {
+        SysFsDriverCPUCore::CPUCore core(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPUCore::DRIVER_NAME));
+        SysFsDriverCPUAtom::CPUAtom atom(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverCPUAtom::DRIVER_NAME));
+
+        m_pCores = CPUList::parse(getData(core.m_cpus));
+        m_eCores = CPUList::parse(getData(atom.m_cpus));
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Hybrid topology Driver not available, placement has no effect");
+        }
+        else
+        {
+            throw;
+        }
+    }
+}
+
+void SysFsDataProviderProcessPlacement::onProcessStarted(const ProcessMonitor::Process &process)
+{
+    /*
+     * Requested placement wins over the rules
+     */
+    auto placed = m_placed.find(process.m_pid);
+
+    if(m_pCores.empty() || m_eCores.empty())
+    {
+        return;
+    }
+
+    if(placed != m_placed.end() && placed->second.m_source.isEmpty())
+    {
+        return;
+    }
+
+    for(const auto& rule : m_rules)
+    {
+        if(rule.m_pattern.match(rule.m_matchType == EXECUTABLE ? process.m_executable : process.m_cmdline).hasMatch())
+        {
+            try {
+                place(process.m_pid,rule.m_placement,rule.m_name);
+            }
+            catch(const bj::framework::exception::Exception& ex)
+            {
+                LOG_D(QString(__PRETTY_FUNCTION__) + "- Placement by rule " + rule.m_name + " failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+            }
+
+            return;
+        }
+    }
+}
+
+void SysFsDataProviderProcessPlacement::onProcessExited(qint32 pid)
+{
+    m_placed.erase(pid);
+}
+
+void SysFsDataProviderProcessPlacement::place(qint32 pid, Placement placement, const QString &source)
+{
+    const std::set<quint32>& cpus = placement == P_CORES ? m_pCores : m_eCores;
+
+    if(m_pCores.empty() || m_eCores.empty())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Hybrid CPU not available !");
+    }
+
+    auto    placed = m_placed.find(pid);
+    Placed  item { .m_placement = placement, .m_source = source };
+
+    if(placed != m_placed.end())
+    {
+        item.m_original = placed->second.m_original;
+    }
+    else if(::sched_getaffinity(pid,sizeof(item.m_original),&item.m_original) != 0)
+    {
+        ++m_failures;
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,std::string("Read of affinity of process ").append(std::to_string(pid)).append(" failed: ").append(std::strerror(errno)).append(" !").c_str());
+    }
+
+    item.m_threads = setAffinity(pid,CPUList::toCpuSet(cpus));
+
+    if(item.m_threads == 0)
+    {
+        ++m_failures;
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,std::string("Placement of process ").append(std::to_string(pid)).append(" failed !").c_str());
+    }
+
+    LOGF_D("Process {} placed on {} ({} threads) by {}",pid,placement == P_CORES ? "P-cores" : "E-cores",item.m_threads,source.isEmpty() ? QString("request") : source);
+
+    m_placed[pid] = item;
+}
+
+void SysFsDataProviderProcessPlacement::restore(qint32 pid)
+{
+    auto placed = m_placed.find(pid);
+
+    if(placed == m_placed.end())
+    {
+        return;
+    }
+
+    setAffinity(pid,placed->second.m_original);
+
+    m_placed.erase(placed);
+}
+
+void SysFsDataProviderProcessPlacement::restoreAll(bool rulesOnly)
+{
+    for(auto it = m_placed.begin(); it != m_placed.end();)
+    {
+        if(!rulesOnly || !it->second.m_source.isEmpty())
+        {
+            setAffinity(it->first,it->second.m_original);
+            it = m_placed.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+quint32 SysFsDataProviderProcessPlacement::setAffinity(qint32 pid, const cpu_set_t &cpuSet) const
+{
+    std::error_code error;
+    quint32         threads = 0;
+
+    /*
+     * Affinity is per thread, threads created later inherit it from their creator
+     */
+    for(const auto& entry : std::filesystem::directory_iterator(m_processMonitor->procRoot() / std::to_string(pid) / "task",error))
+    {
+        const pid_t tid = static_cast<pid_t>(std::atoi(entry.path().filename().c_str()));
+
+        if(tid > 0 && ::sched_setaffinity(tid,sizeof(cpuSet),&cpuSet) == 0)
+        {
+            ++threads;
+        }
+    }
+
+    return threads;
+}
+
+}
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <SysFsDataProvider.h>
+
+#include "ProcessMonitor.h"
+
+#include <QRegularExpression>
+
+#include <sched.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace LenovoLegionDaemon {
+
+/*
+ * Pins processes to the P-cores or to the E-cores of a hybrid CPU with sched_setaffinity,
+ * by rules on process start or on request of a client
+ */
+class SysFsDataProviderProcessPlacement : public SysFsDataProvider
+{
+public:
+
+    /*
+     * Same values as legion::messages::ProcessPlacement::Placement
+     */
+    enum Placement : quint8 {
+        DEFAULT     = 0,
+        P_CORES     = 1,
+        E_CORES     = 2
+    };
+
+    /*
+     * Same values as legion::messages::ProcessPlacement::MatchType
+     */
+    enum MatchType : quint8 {
+        EXECUTABLE  = 0,
+        CMDLINE     = 1
+    };
+
+    struct Rule {
+        QString              m_name;
+        MatchType            m_matchType = EXECUTABLE;
+        QRegularExpression   m_pattern;
+        Placement            m_placement = DEFAULT;
+    };
+
+private:
+
+    struct Placed {
+        Placement   m_placement = DEFAULT;
+        QString     m_source;               // rule name, empty for a request
+        cpu_set_t   m_original;
+        quint32     m_threads   = 0;
+    };
+
+public:
+
+    SysFsDataProviderProcessPlacement(SysFsDriverManager* sysFsDriverManager,QObject* parent);
+
+    virtual QByteArray serializeAndGetData()                    const override;
+    virtual QByteArray deserializeAndSetData(const QByteArray&)       override;
+
+    virtual void init()  override;
+    virtual void clean() override;
+
+private:
+
+    void start();
+    void stop();
+
+    void readTopology();
+
+    void onProcessStarted(const LenovoLegionDaemon::ProcessMonitor::Process& process);
+    void onProcessExited(qint32 pid);
+
+    void place(qint32 pid,Placement placement,const QString& source);
+    void restore(qint32 pid);
+    void restoreAll(bool rulesOnly);
+
+    /*
+     * Affinity of every thread of the process, returns the number of threads set
+     */
+    quint32 setAffinity(qint32 pid,const cpu_set_t& cpuSet) const;
+
+private:
+
+    ProcessMonitor*             m_processMonitor;
+
+    bool                        m_enabled;
+    std::vector<Rule>           m_rules;
+
+    std::set<quint32>           m_pCores;
+    std::set<quint32>           m_eCores;
+
+    std::map<qint32,Placed>     m_placed;
+    quint64                     m_failures;
+
+public:
+
+    static constexpr quint8  dataType = 27;
+};
+
+}
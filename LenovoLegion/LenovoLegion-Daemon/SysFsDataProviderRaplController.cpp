@@ -0,0 +1,608 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "SysFsDataProviderRaplController.h"
+#include "SysFsDriverIntelPowercapRapl.h"
+#include "SysFSDriverLegionHWMon.h"
+#include "ControlOwnership.h"
+
+#include "../LenovoLegion-PrepareBuild/RaplController.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QDateTime>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+
+namespace LenovoLegionDaemon {
+
+namespace {
+
+void fillLimits(legion::messages::RaplController::Limits* limitsMsg,const SysFsDataProviderRaplController::Limits& limits)
+{
+    limitsMsg->set_pl1(limits.m_pl1);
+    limitsMsg->set_pl2(limits.m_pl2);
+}
+
+}
+
+SysFsDataProviderRaplController::SysFsDataProviderRaplController(SysFsDriverManager* sysFsDriverManager,QObject* parent) :
+    SysFsDataProvider(sysFsDriverManager,parent,dataType),
+    m_timer(new QTimer(this)),
+    m_enabled(false),
+    m_integral(0),
+    m_output(0),
+    m_state(REGULATING),
+    m_maxPowerPl1(0),
+    m_maxPowerPl2(0),
+    m_writes(0),
+    m_fallbacks(0)
+{
+    m_timer->setInterval(CONTROL_PERIOD_MS);
+
+    connect(m_timer,&QTimer::timeout,this,&SysFsDataProviderRaplController::control);
+}
+
+QByteArray SysFsDataProviderRaplController::serializeAndGetData() const
+{
+    legion::messages::RaplController raplController;
+    QByteArray                       byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    raplController.set_enabled(m_enabled);
+    raplController.set_mode(static_cast<legion::messages::RaplController::Mode>(m_config.m_mode));
+    raplController.set_target_temperature(m_config.m_targetTemperature);
+    raplController.set_max_fan_speed(m_config.m_maxFanSpeed);
+    raplController.set_kp(m_config.m_kp);
+    raplController.set_ki(m_config.m_ki);
+    raplController.set_max_slew(m_config.m_maxSlew);
+    raplController.set_min_pl1(m_config.m_minPl1);
+    raplController.set_max_pl1(m_config.m_maxPl1);
+
+    if(m_measurement.m_temperature.has_value())
+    {
+        raplController.set_temperature(m_measurement.m_temperature.value());
+    }
+
+    if(m_measurement.m_fanSpeed.has_value())
+    {
+        raplController.set_fan_speed(m_measurement.m_fanSpeed.value());
+    }
+
+    if(m_enabled)
+    {
+        raplController.set_integral(m_integral);
+        raplController.set_state(static_cast<legion::messages::RaplController::State>(m_state));
+
+        fillLimits(raplController.mutable_original_limits(),m_originalLimits);
+
+        if(m_writtenLimits.has_value())
+        {
+            fillLimits(raplController.mutable_limits(),m_writtenLimits->limits());
+        }
+    }
+
+    raplController.set_writes(m_writes);
+    raplController.set_fallbacks(m_fallbacks);
+
+    for(const auto& step : m_history)
+    {
+        auto stepMsg = raplController.add_history();
+
+        stepMsg->set_timestamp(step.m_timestamp);
+        stepMsg->set_measurement(step.m_measurement);
+        stepMsg->set_output(step.m_output);
+        fillLimits(stepMsg->mutable_limits(),step.m_limits);
+        stepMsg->set_state(static_cast<legion::messages::RaplController::State>(step.m_state));
+        stepMsg->set_written(step.m_written);
+    }
+
+    byteArray.resize(raplController.ByteSizeLong());
+    if(!raplController.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray SysFsDataProviderRaplController::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::RaplController raplController;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!raplController.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    Config config = m_config;
+
+    if(raplController.has_mode())
+    {
+        config.m_mode = static_cast<Mode>(raplController.mode());
+    }
+
+    if(raplController.has_target_temperature())
+    {
+        config.m_targetTemperature = raplController.target_temperature();
+    }
+
+    if(raplController.has_max_fan_speed())
+    {
+        config.m_maxFanSpeed = raplController.max_fan_speed();
+    }
+
+    if(raplController.has_kp())
+    {
+        config.m_kp = raplController.kp();
+    }
+
+    if(raplController.has_ki())
+    {
+        config.m_ki = raplController.ki();
+    }
+
+    if(raplController.has_max_slew())
+    {
+        config.m_maxSlew = raplController.max_slew();
+    }
+
+    if(raplController.has_min_pl1())
+    {
+        config.m_minPl1 = raplController.min_pl1();
+    }
+
+    if(raplController.has_max_pl1())
+    {
+        config.m_maxPl1 = raplController.max_pl1();
+    }
+
+    if(config.m_mode > ACOUSTIC ||
+       config.m_targetTemperature < 40 || config.m_targetTemperature > 105 ||
+       config.m_maxFanSpeed == 0 || config.m_maxFanSpeed > MAX_FAN_SPEED ||
+       !(config.m_kp >= 0) || !(config.m_ki >= 0) || config.m_kp + config.m_ki == 0 ||
+       config.m_maxSlew == 0 || config.m_minPl1 == 0 ||
+       (config.m_maxPl1 != 0 && config.m_maxPl1 < config.m_minPl1))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Invalid RAPL controller configuration !");
+    }
+
+    m_config = config;
+
+    if(raplController.has_enabled() && raplController.enabled() != m_enabled)
+    {
+        if(raplController.enabled())
+        {
+            start();
+        }
+        else
+        {
+            stop();
+        }
+    }
+
+    return {};
+}
+
+void SysFsDataProviderRaplController::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+}
+
+void SysFsDataProviderRaplController::clean()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    stop();
+}
+
+void SysFsDataProviderRaplController::start()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    const auto owner = ControlOwnership::conflict(OWNER,ControlOwnership::CPU_POWER_LIMITS);
+
+    if(owner.has_value())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"CPU power limits are controlled by " + owner->toStdString() + " !");
+    }
+
+    rebase(readLimits());
+
+    m_writtenLimits.reset();
+    m_history.clear();
+    m_state   = REGULATING;
+    m_enabled = true;
+
+    ControlOwnership::acquire(OWNER,ControlOwnership::CPU_POWER_LIMITS);
+
+    m_validTimer.start();
+    m_controlTimer.start();
+    m_timer->start();
+
+    control();
+}
+
+void SysFsDataProviderRaplController::stop()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    m_timer->stop();
+
+    if(!m_enabled)
+    {
+        return;
+    }
+
+    m_enabled = false;
+
+    /*
+     * Original limits are restored unless the user took the limits over
+     */
+    try {
+        if(m_writtenLimits.has_value() && m_writtenLimits.value() != m_originalInterfaceLimits && readLimits() == m_writtenLimits.value())
+        {
+            writeLimits(m_originalInterfaceLimits);
+
+            LOGF_I("RAPL controller: original limits restored, pl1={}W, pl2={}W",m_originalLimits.m_pl1,m_originalLimits.m_pl2);
+        }
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Restore of the original limits failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+
+    m_writtenLimits.reset();
+
+    ControlOwnership::release(OWNER);
+}
+
+void SysFsDataProviderRaplController::control()
+{
+    const qint64          timestamp = QDateTime::currentMSecsSinceEpoch();
+    std::optional<double> controlError;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Called from timer, nobody above us would handle the exception
+     */
+    try {
+        m_measurement = readMeasurement();
+        controlError  = error(m_measurement);
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Measurement failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        m_measurement = {};
+    }
+
+    try {
+        if(controlError.has_value())
+        {
+            regulate(timestamp,controlError.value());
+        }
+        else
+        {
+            stale(timestamp);
+        }
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Control step failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+}
+
+void SysFsDataProviderRaplController::regulate(qint64 timestamp, double error)
+{
+    /*
+     * Late timer after a stall must not turn into one huge integration step
+     */
+    const double dt = std::clamp<qint64>(m_controlTimer.restart(),0,2 * CONTROL_PERIOD_MS) / 1000.0;
+
+    m_validTimer.restart();
+
+    const InterfaceLimits current = readLimits();
+
+    if(m_writtenLimits.has_value() && current != m_writtenLimits.value())
+    {
+        /*
+         * Somebody else changed the limits (GUI, power mode), they are the new original ones
+         */
+        rebase(current);
+        addStep(timestamp,USER,false);
+    }
+
+    const double lower     = m_config.m_minPl1;
+    const double upper     = std::max(maxPl1(),lower);
+    const double unclamped = m_integral + m_config.m_ki * error * dt + m_config.m_kp * error;
+    double       output    = std::clamp(unclamped,lower,upper);
+    State        state     = output != unclamped ? SATURATED : REGULATING;
+
+    /*
+     * Slew from the previous output, on the way back from the fallback too
+     */
+    const double slew = m_config.m_maxSlew * dt;
+
+    if(output > m_output + slew)
+    {
+        output = m_output + slew;
+        state  = SLEW_LIMITED;
+    }
+    else if(output < m_output - slew)
+    {
+        output = m_output - slew;
+        state  = SLEW_LIMITED;
+    }
+
+    /*
+     * Back calculation, the integral is what the applied output needs, so it does not wind up
+     * while the output is clamped or slew limited
+     */
+    m_integral = output - m_config.m_kp * error;
+    m_output   = output;
+
+    const InterfaceLimits limits  = current.applied(limitsForOutput(output));
+    const bool            written = limits != current;
+
+    if(written)
+    {
+        writeLimits(limits);
+    }
+
+    /*
+     * Read back, the firmware rounds and clamps what is written and the next step would take
+     * the difference for a change of somebody else
+     */
+    m_writtenLimits = written ? readLimits() : current;
+
+    addStep(timestamp,state,written);
+}
+
+void SysFsDataProviderRaplController::stale(qint64 timestamp)
+{
+    if(m_state == FALLBACK)
+    {
+        return;
+    }
+
+    if(m_validTimer.elapsed() < STALE_TIMEOUT_MS)
+    {
+        if(m_state != STALE)
+        {
+            addStep(timestamp,STALE,false);
+        }
+
+        return;
+    }
+
+    /*
+     * Nothing tells us how hot the machine is, hand the limits back and resume from them. These are
+     * the limits of the power mode or the user from before the controller took over, the firmware
+     * defaults of the mode may be higher than limits the user lowered
+     */
+    writeLimits(m_originalInterfaceLimits);
+
+    m_writtenLimits = readLimits();
+    m_integral      = m_originalLimits.m_pl1;
+    m_output        = m_originalLimits.m_pl1;
+    ++m_fallbacks;
+
+    LOGF_W("RAPL controller: measurement stale for {}ms, original limits restored, pl1={}W, pl2={}W",m_validTimer.elapsed(),m_originalLimits.m_pl1,m_originalLimits.m_pl2);
+
+    addStep(timestamp,FALLBACK,true);
+}
+
+SysFsDataProviderRaplController::Measurement SysFsDataProviderRaplController::readMeasurement() const
+{
+    Measurement measurement;
+
+    try {
+        SysFSDriverLegionHWMon::HWMon hwMon(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFSDriverLegionHWMon::DRIVER_NAME));
+
+        for(const auto& temp : hwMon.m_legion.m_temps)
+        {
+            if(!getData(temp.m_label).startsWith("CPU"))
+            {
+                continue;
+            }
+
+            const quint32 value = getData(temp.m_input).toUInt() / 1000;
+
+            if(value != 0 && value <= MAX_TEMPERATURE)
+            {
+                measurement.m_temperature = value;
+            }
+        }
+
+        for(const auto& fan : hwMon.m_legion.m_fans)
+        {
+            bool          ok    = false;
+            const quint32 value = getData(fan.m_input).toUInt(&ok);
+
+            if(ok && value <= MAX_FAN_SPEED)
+            {
+                measurement.m_fanSpeed = std::max(measurement.m_fanSpeed.value_or(0),value);
+            }
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Legion HWMon Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    return measurement;
+}
+
+std::optional<double> SysFsDataProviderRaplController::error(const Measurement &measurement) const
+{
+    if(m_config.m_mode == TEMPERATURE)
+    {
+        if(!measurement.m_temperature.has_value())
+        {
+            return std::nullopt;
+        }
+
+        return static_cast<double>(m_config.m_targetTemperature) - measurement.m_temperature.value();
+    }
+
+    if(!measurement.m_fanSpeed.has_value())
+    {
+        return std::nullopt;
+    }
+
+    return (static_cast<double>(m_config.m_maxFanSpeed) - measurement.m_fanSpeed.value()) / 100;
+}
+
+SysFsDataProviderRaplController::InterfaceLimits SysFsDataProviderRaplController::InterfaceLimits::applied(const Limits &limits) const
+{
+    return InterfaceLimits {
+        .m_msr  = m_msr.has_value()  ? std::optional<Limits>(limits) : std::nullopt,
+        .m_mmio = m_mmio.has_value() ? std::optional<Limits>(limits) : std::nullopt
+    };
+}
+
+SysFsDataProviderRaplController::InterfaceLimits SysFsDataProviderRaplController::readLimits() const
+{
+    SysFsDriverIntelPowercapRapl::IntelPowercapRapl     rapl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+    SysFsDriverIntelPowercapRapl::IntelPowercapRaplMMIO raplMMIO(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+
+    const auto toWatts = [](const std::filesystem::path& path) {
+        return static_cast<quint32>((getData(path).toULongLong() + 500000) / 1000000);
+    };
+
+    InterfaceLimits limits;
+
+    if(!rapl.m_ltp_power_limit_uw.empty() && !rapl.m_stp_power_limit_uw.empty())
+    {
+        limits.m_msr = Limits {
+            .m_pl1 = toWatts(rapl.m_ltp_power_limit_uw),
+            .m_pl2 = toWatts(rapl.m_stp_power_limit_uw)
+        };
+    }
+
+    if(!raplMMIO.m_ltp_power_limit_uw.empty() && !raplMMIO.m_stp_power_limit_uw.empty())
+    {
+        limits.m_mmio = Limits {
+            .m_pl1 = toWatts(raplMMIO.m_ltp_power_limit_uw),
+            .m_pl2 = toWatts(raplMMIO.m_stp_power_limit_uw)
+        };
+    }
+
+    if(!limits.m_msr.has_value() && !limits.m_mmio.has_value())
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"RAPL power limits not available !");
+    }
+
+    return limits;
+}
+
+void SysFsDataProviderRaplController::writeLimits(const InterfaceLimits &limits)
+{
+    SysFsDriverIntelPowercapRapl::IntelPowercapRapl     rapl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+    SysFsDriverIntelPowercapRapl::IntelPowercapRaplMMIO raplMMIO(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+
+    const auto write = [](const std::filesystem::path& ltpPath,const std::filesystem::path& stpPath,const std::optional<Limits>& interfaceLimits) {
+        if(interfaceLimits.has_value())
+        {
+            setData(ltpPath,static_cast<quint64>(interfaceLimits->m_pl1) * 1000000);
+            setData(stpPath,static_cast<quint64>(interfaceLimits->m_pl2) * 1000000);
+        }
+    };
+
+    /*
+     * Both interfaces, the firmware enforces the lower one
+     */
+    write(rapl.m_ltp_power_limit_uw,rapl.m_stp_power_limit_uw,limits.m_msr);
+    write(raplMMIO.m_ltp_power_limit_uw,raplMMIO.m_stp_power_limit_uw,limits.m_mmio);
+
+    ++m_writes;
+
+    LOGF_D("RAPL controller: pl1={}W, pl2={}W",limits.limits().m_pl1,limits.limits().m_pl2);
+}
+
+void SysFsDataProviderRaplController::rebase(const InterfaceLimits &limits)
+{
+    SysFsDriverIntelPowercapRapl::IntelPowercapRapl     rapl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+    SysFsDriverIntelPowercapRapl::IntelPowercapRaplMMIO raplMMIO(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+
+    const auto maxPower = [](const std::filesystem::path& path,const std::filesystem::path& mmioPath) {
+        const std::filesystem::path& source = path.empty() ? mmioPath : path;
+
+        return source.empty() ? 0 : static_cast<quint32>(getData(source).toULongLong() / 1000000);
+    };
+
+    m_originalInterfaceLimits = limits;
+    m_originalLimits          = limits.limits();
+    m_maxPowerPl1             = maxPower(rapl.m_ltp_max_power_uw,raplMMIO.m_ltp_max_power_uw);
+    m_maxPowerPl2             = maxPower(rapl.m_stp_max_power_uw,raplMMIO.m_stp_max_power_uw);
+    m_integral                = m_originalLimits.m_pl1;
+    m_output                  = m_originalLimits.m_pl1;
+
+    LOGF_I("RAPL controller: original limits pl1={}W, pl2={}W, maximum pl1={}W, pl2={}W",m_originalLimits.m_pl1,m_originalLimits.m_pl2,m_maxPowerPl1,m_maxPowerPl2);
+}
+
+SysFsDataProviderRaplController::Limits SysFsDataProviderRaplController::limitsForOutput(double output) const
+{
+    Limits limits {
+        .m_pl1 = static_cast<quint32>(std::lround(output))
+    };
+
+    /*
+     * PL2 keeps the ratio of the original limits, never below PL1
+     */
+    limits.m_pl2 = m_originalLimits.m_pl1 != 0 ? static_cast<quint32>(std::lround(output * m_originalLimits.m_pl2 / m_originalLimits.m_pl1)) : limits.m_pl1;
+
+    if(m_maxPowerPl2 != 0)
+    {
+        limits.m_pl2 = std::min(limits.m_pl2,m_maxPowerPl2);
+    }
+
+    limits.m_pl2 = std::max(limits.m_pl2,limits.m_pl1);
+
+    return limits;
+}
+
+double SysFsDataProviderRaplController::maxPl1() const
+{
+    const quint32 maximum = m_config.m_maxPl1 != 0 ? m_config.m_maxPl1 : (m_maxPowerPl1 != 0 ? m_maxPowerPl1 : m_originalLimits.m_pl1);
+
+    return m_maxPowerPl1 != 0 ? std::min(maximum,m_maxPowerPl1) : maximum;
+}
+
+void SysFsDataProviderRaplController::addStep(qint64 timestamp, State state, bool written)
+{
+    m_state = state;
+
+    m_history.push_back(Step{
+        .m_timestamp    = timestamp,
+        .m_measurement  = m_config.m_mode == TEMPERATURE ? m_measurement.m_temperature.value_or(0) : m_measurement.m_fanSpeed.value_or(0),
+        .m_output       = m_output,
+        .m_limits       = m_writtenLimits.has_value() ? m_writtenLimits->limits() : m_originalLimits,
+        .m_state        = state,
+        .m_written      = written
+    });
+
+    if(m_history.size() > HISTORY_CAPACITY)
+    {
+        m_history.pop_front();
+    }
+}
+
+}
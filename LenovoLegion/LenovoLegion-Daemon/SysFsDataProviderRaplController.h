@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <SysFsDataProvider.h>
+
+#include <QElapsedTimer>
+
+#include <deque>
+#include <optional>
+
+class QTimer;
+
+namespace LenovoLegionDaemon {
+
+/*
+ * PI controller on the RAPL package limits. PL1 follows the controller output, so the CPU gets the
+ * highest sustained power that still holds the temperature at the target, or the fans under the
+ * speed ceiling. PL2 keeps the ratio to PL1 found at the start. Both the MSR and the MMIO RAPL
+ * interfaces are written, the lower of them is the enforced one.
+ *
+ * The integral tracks the applied output when it is clamped or slew limited (anti-windup). When no
+ * valid measurement arrives for STALE_TIMEOUT_MS the original limits are restored until it does.
+ */
+class SysFsDataProviderRaplController : public SysFsDataProvider
+{
+public:
+
+    /*
+     * Same values as legion::messages::RaplController::Mode
+     */
+    enum Mode : quint8 {
+        TEMPERATURE     = 0,
+        ACOUSTIC        = 1
+    };
+
+    /*
+     * Same values as legion::messages::RaplController::State
+     */
+    enum State : quint8 {
+        REGULATING      = 0,
+        SATURATED       = 1,
+        SLEW_LIMITED    = 2,
+        STALE           = 3,
+        FALLBACK        = 4,
+        USER            = 5
+    };
+
+    struct Config {
+        Mode    m_mode                  = TEMPERATURE;
+        quint32 m_targetTemperature     = 85;           // °C
+        quint32 m_maxFanSpeed           = 4000;         // RPM
+        double  m_kp                    = 1.0;          // W per °C (per 100 RPM)
+        double  m_ki                    = 0.5;          // W per °C (per 100 RPM) and second
+        quint32 m_maxSlew               = 10;           // W per second
+        quint32 m_minPl1                = 15;           // W
+        quint32 m_maxPl1                = 0;            // W, 0 - constraint maximum or the original limit
+    };
+
+    struct Limits {
+        quint32 m_pl1                   = 0;            // W
+        quint32 m_pl2                   = 0;            // W
+
+        bool operator==(const Limits&) const = default;
+    };
+
+    struct Step {
+        qint64  m_timestamp             = 0;
+        quint32 m_measurement           = 0;
+        double  m_output                = 0;
+        Limits  m_limits;
+        State   m_state                 = REGULATING;
+        bool    m_written               = false;
+    };
+
+private:
+
+    struct Measurement {
+        std::optional<quint32> m_temperature;   // °C
+        std::optional<quint32> m_fanSpeed;      // RPM
+    };
+
+    /*
+     * Limits of each powercap interface, empty when the interface does not exist
+     */
+    struct InterfaceLimits {
+        std::optional<Limits> m_msr;
+        std::optional<Limits> m_mmio;
+
+        bool operator==(const InterfaceLimits&) const = default;
+
+        /*
+         * Limits the controller regulates from, MSR with MMIO as fallback
+         */
+        Limits limits() const { return m_msr.value_or(m_mmio.value_or(Limits{})); }
+
+        /*
+         * Same interfaces, all of them with the limits
+         */
+        InterfaceLimits applied(const Limits& limits) const;
+    };
+
+public:
+
+    SysFsDataProviderRaplController(SysFsDriverManager* sysFsDriverManager,QObject* parent);
+
+    virtual QByteArray serializeAndGetData()                    const override;
+    virtual QByteArray deserializeAndSetData(const QByteArray&)       override;
+
+    virtual void init()  override;
+    virtual void clean() override;
+
+private:
+
+    void control();
+
+    /*
+     * One PI step on a valid measurement
+     */
+    void regulate(qint64 timestamp,double error);
+
+    /*
+     * No valid measurement, the original limits are restored after STALE_TIMEOUT_MS
+     */
+    void stale(qint64 timestamp);
+
+    void start();
+    void stop();
+
+    Measurement readMeasurement() const;
+
+    /*
+     * Error in the units of the gains, positive when there is headroom
+     */
+    std::optional<double> error(const Measurement& measurement) const;
+
+    InterfaceLimits readLimits() const;
+    void            writeLimits(const InterfaceLimits& limits);
+
+    /*
+     * Current limits become the original ones, the integral starts from them (bumpless)
+     */
+    void   rebase(const InterfaceLimits& limits);
+
+    Limits limitsForOutput(double output) const;
+    double maxPl1() const;
+
+    void   addStep(qint64 timestamp,State state,bool written);
+
+private:
+
+    QTimer*                     m_timer;
+
+    bool                        m_enabled;
+    Config                      m_config;
+
+    Measurement                 m_measurement;
+    double                      m_integral;         // W
+    double                      m_output;           // W
+    State                       m_state;
+
+    Limits                      m_originalLimits;
+
+    /*
+     * Original limits of every interface, restored each to its own values
+     */
+    InterfaceLimits             m_originalInterfaceLimits;
+    quint32                     m_maxPowerPl1;      // W, constraint maximum, 0 - unknown
+    quint32                     m_maxPowerPl2;      // W, constraint maximum, 0 - unknown
+
+    /*
+     * Limits written by the controller, different values read back mean the user took over
+     */
+    std::optional<InterfaceLimits> m_writtenLimits;
+
+    QElapsedTimer               m_controlTimer;
+    QElapsedTimer               m_validTimer;
+    quint64                     m_writes;
+    quint64                     m_fallbacks;
+
+    std::deque<Step>            m_history;
+
+public:
+
+    static constexpr quint8  dataType = 31;
+
+    static constexpr const char* OWNER = "RAPL controller";
+
+    static constexpr int     CONTROL_PERIOD_MS   = 250;
+    static constexpr qint64  STALE_TIMEOUT_MS    = 2000;
+    static constexpr size_t  HISTORY_CAPACITY    = 64;
+
+    /*
+     * Measurements outside of these are sensor errors
+     */
+    static constexpr quint32 MAX_TEMPERATURE     = 125;     // °C
+    static constexpr quint32 MAX_FAN_SPEED       = 10000;   // RPM
+};
+
+}
@@ -0,0 +1,433 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+
+#include "SysFsDataProviderThrottleDetector.h"
+#include "SysFsDriverCPUXList.h"
+#include "SysFSDriverLegionHWMon.h"
+#include "SysFsDriverIntelPowercapRapl.h"
+#include "SysFsDriverLegionOther.h"
+#include "DataProviderManager.h"
+#include "DataProviderNvidiaNvml.h"
+
+#include "../LenovoLegion-PrepareBuild/ThrottleDetector.pb.h"
+#include "../LenovoLegion-PrepareBuild/NvidiaNvml.pb.h"
+
+#include <Core/LoggerHolder.h>
+
+#include <QDateTime>
+#include <QTimer>
+
+namespace LenovoLegionDaemon {
+
+SysFsDataProviderThrottleDetector::SysFsDataProviderThrottleDetector(SysFsDriverManager* sysFsDriverManager,DataProviderManager* dataProviderManager) :
+    SysFsDataProvider(sysFsDriverManager,dataProviderManager,dataType),
+    m_dataProviderManager(dataProviderManager),
+    m_timer(new QTimer(this)),
+    m_enabled(false)
+{
+    m_timer->setInterval(SAMPLE_PERIOD_MS);
+
+    connect(m_timer,&QTimer::timeout,this,&SysFsDataProviderThrottleDetector::sample);
+}
+
+QByteArray SysFsDataProviderThrottleDetector::serializeAndGetData() const
+{
+    legion::messages::ThrottleDetector throttleDetector;
+    QByteArray                         byteArray;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    auto fillEpisode = [](legion::messages::ThrottleDetector::Episode* msg,const Episode& episode){
+        msg->set_reason(static_cast<legion::messages::ThrottleDetector::Reason>(episode.m_reason));
+        msg->set_start_timestamp(episode.m_startTimestamp);
+        msg->set_end_timestamp(episode.m_endTimestamp);
+        msg->set_min_frequency_ratio(episode.m_minFrequencyRatio);
+        msg->set_max_temperature(episode.m_maxTemperature);
+        msg->set_max_power(episode.m_maxPower);
+    };
+
+    throttleDetector.set_enabled(m_enabled);
+
+    for(const auto& state : m_episodes)
+    {
+        if(state.m_active.has_value())
+        {
+            fillEpisode(throttleDetector.add_active_episodes(),state.m_active.value());
+        }
+    }
+
+    for(const auto& episode : m_log)
+    {
+        fillEpisode(throttleDetector.add_episodes(),episode);
+    }
+
+    byteArray.resize(throttleDetector.ByteSizeLong());
+    if(!throttleDetector.SerializeToArray(byteArray.data(),byteArray.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::SERIALIZE_ERROR,"Serialize of data message error !");
+    }
+
+    return byteArray;
+}
+
+QByteArray SysFsDataProviderThrottleDetector::deserializeAndSetData(const QByteArray &data)
+{
+    legion::messages::ThrottleDetector throttleDetector;
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(!throttleDetector.ParseFromArray(data.data(),data.size()))
+    {
+        THROW_EXCEPTION(exception_T,DataProvider::ERROR_CODES::INVALID_DATA,"Parse of data message error !");
+    }
+
+    if(throttleDetector.has_clear_log() && throttleDetector.clear_log())
+    {
+        m_log.clear();
+    }
+
+    if(throttleDetector.has_enabled() && throttleDetector.enabled() != m_enabled)
+    {
+        m_enabled = throttleDetector.enabled();
+
+        if(m_enabled)
+        {
+            m_lastEnergy.reset();
+            m_lastEnergyTimer.invalidate();
+            m_lastCPUTimes = {};
+            m_timer->start();
+        }
+        else
+        {
+            m_timer->stop();
+            m_episodes = {};
+        }
+    }
+
+    return {};
+}
+
+void SysFsDataProviderThrottleDetector::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    if(m_enabled)
+    {
+        m_timer->start();
+    }
+}
+
+void SysFsDataProviderThrottleDetector::clean()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    m_timer->stop();
+}
+
+void SysFsDataProviderThrottleDetector::sample()
+{
+    Sample       sample;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    LOG_T(__PRETTY_FUNCTION__);
+
+    /*
+     * Called from timer, nobody above us would handle the exception
+     */
+    try {
+        readCPUFrequency(sample);
+        readCPUTemperatureAndLimits(sample);
+        readCPUPower(sample);
+        readCPUUtilization(sample);
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_W(QString(__PRETTY_FUNCTION__) + "- Sampling failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+        return;
+    }
+
+    /*
+     * GPU is optional, missing or failing NVML must not stop the CPU detection
+     */
+    try {
+        readGPU(sample);
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        LOG_D(QString(__PRETTY_FUNCTION__) + "- GPU sampling failed: " + bj::framework::exception::ExceptionBuilder::print(ex).c_str());
+    }
+
+    const bool thermal   = sample.m_cpuTemperature.has_value() && sample.m_cpuTemperatureLimit.has_value() &&
+                           sample.m_cpuTemperature.value() + THERMAL_MARGIN_C >= sample.m_cpuTemperatureLimit.value() &&
+                           sample.m_cpuFrequencyRatio < THERMAL_FREQUENCY_RATIO;
+
+    const bool powerLimit= sample.m_cpuPower.has_value() && sample.m_cpuPowerLimit.has_value() && sample.m_cpuPowerLimit.value() > 0 &&
+                           sample.m_cpuPower.value() * 100 >= sample.m_cpuPowerLimit.value() * POWER_LIMIT_RATIO &&
+                           sample.m_cpuFrequencyRatio < POWER_FREQUENCY_RATIO;
+
+    /*
+     * Package is busy and clocked down although neither temperature nor power is at its limit,
+     * what is left is the current (IccMax/EDP) or another platform limit
+     */
+    const bool current   = !thermal && !powerLimit &&
+                           sample.m_cpuUtilization >= CURRENT_UTILIZATION &&
+                           sample.m_cpuFrequencyRatio < CURRENT_FREQUENCY_RATIO;
+
+    updateEpisode(THERMAL,thermal,sample,now);
+    updateEpisode(POWER_LIMIT,powerLimit,sample,now);
+    updateEpisode(CURRENT,current,sample,now);
+    updateEpisode(GPU,sample.m_gpuThrottled,sample,now);
+}
+
+void SysFsDataProviderThrottleDetector::readCPUFrequency(Sample &sample) const
+{
+    try {
+        SysFsDriverCPUXList::CPUXList cpus(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFsDriverCPUXList::DRIVER_NAME));
+
+        quint64 ratioSum = 0;
+        quint64 count    = 0;
+
+        for(const auto& cpu : cpus.cpuList())
+        {
+            if(cpu.isOnlineAvailable() && getData(cpu.m_cpuOnline.value()).toUShort() != 1)
+            {
+                continue;
+            }
+
+            const quint64 maxFreq = getData(cpu.m_freq.m_cpuInfoMaxFreq).toULongLong();
+
+            if(maxFreq > 0)
+            {
+                ratioSum += std::min<quint64>(100,getData(cpu.m_freq.m_cpuScalingCurFreq).toULongLong() * 100 / maxFreq);
+                ++count;
+            }
+        }
+
+        if(count > 0)
+        {
+            sample.m_cpuFrequencyRatio = static_cast<quint32>(ratioSum / count);
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- CPUX Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+}
+
+void SysFsDataProviderThrottleDetector::readCPUTemperatureAndLimits(Sample &sample) const
+{
+    try {
+        SysFSDriverLegionHWMon::HWMon hwMon(m_sysFsDriverManager->getDriverDescriptorsInVector(SysFSDriverLegionHWMon::DRIVER_NAME));
+
+        for(const auto& temp : hwMon.m_legion.m_temps)
+        {
+            if(getData(temp.m_label).startsWith("CPU"))
+            {
+                sample.m_cpuTemperature = getData(temp.m_input).toUInt() / 1000;
+            }
+        }
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Legion HWMon Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+
+    try {
+        SysFsDriverLegionOther::Other::CPU cpuControl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverLegionOther::DRIVER_NAME));
+
+        sample.m_cpuTemperatureLimit = getData(cpuControl.m_cpu_tmp_limit.m_current_value).toUInt();
+
+        const quint32 stp = getData(cpuControl.m_cpu_stp_limit.m_current_value).toUInt();
+        const quint32 ltp = getData(cpuControl.m_cpu_ltp_limit.m_current_value).toUInt();
+
+        sample.m_cpuPowerLimit = (stp == 0 || ltp == 0) ? std::max(stp,ltp) : std::min(stp,ltp);
+
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Legion Other Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+}
+
+void SysFsDataProviderThrottleDetector::readCPUPower(Sample &sample)
+{
+    try {
+        SysFsDriverIntelPowercapRapl::IntelPowercapRapl intelPowercapRapl(m_sysFsDriverManager->getDriverDesriptor(SysFsDriverIntelPowercapRapl::DRIVER_NAME));
+
+        const quint64 energy  = getData(intelPowercapRapl.m_powercapCPUEnergy).toULongLong();
+        const qint64  elapsed = m_lastEnergyTimer.isValid() ? m_lastEnergyTimer.restart() : 0;
+
+        if(!m_lastEnergyTimer.isValid())
+        {
+            m_lastEnergyTimer.start();
+        }
+
+        if(m_lastEnergy.has_value() && elapsed > 0)
+        {
+            /*
+             * energy_uj wraps around at max_energy_range_uj
+             */
+            const quint64 delta = energy >= m_lastEnergy.value() ? energy - m_lastEnergy.value()
+                                                                 : getData(intelPowercapRapl.m_max_energy_range).toULongLong() - m_lastEnergy.value() + energy;
+
+            sample.m_cpuPower = static_cast<quint32>(delta / 1000 / elapsed);
+        }
+
+        m_lastEnergy = energy;
+
+        if(!sample.m_cpuPowerLimit.has_value())
+        {
+            sample.m_cpuPowerLimit = static_cast<quint32>(getData(intelPowercapRapl.m_ltp_power_limit_uw).toULongLong() / 1000000);
+        }
+
+    } catch(SysFsDriver::exception_T& ex)
+    {
+        if(ex.errcodeInfo().value() == SysFsDriver::ERROR_CODES::DRIVER_NOT_AVAILABLE)
+        {
+            LOG_D(QString(__PRETTY_FUNCTION__) + "- Intel Rapl Driver not available");
+        }
+        else
+        {
+            throw;
+        }
+    }
+}
+
+void SysFsDataProviderThrottleDetector::readCPUUtilization(Sample &sample)
+{
+    const ProcStat::CPUTimes times = ProcStat::read(SysFsDriver::rootedPath("/proc")).m_all;
+
+    sample.m_cpuUtilization = ProcStat::utilization(m_lastCPUTimes,times);
+
+    m_lastCPUTimes = times;
+}
+
+void SysFsDataProviderThrottleDetector::readGPU(Sample &sample) const
+{
+    const auto& nvml     = dynamic_cast<const DataProviderNvidiaNvml&>(m_dataProviderManager->getDataProvider(DataProviderNvidiaNvml::dataType));
+    const auto  snapshot = nvml.snapshot();
+
+    if(snapshot == nullptr || !snapshot->has_hardware_monitor())
+    {
+        return;
+    }
+
+    sample.m_gpuTemperature = snapshot->hardware_monitor().temperature().value();
+    sample.m_gpuThrottled   = gpuThrottled(*snapshot);
+}
+
+bool SysFsDataProviderThrottleDetector::gpuThrottled(const legion::messages::NvidiaNvml &gpuData)
+{
+    if(gpuData.throttle_reasons() != 0)
+    {
+        return true;
+    }
+
+    const auto& hwMonitor = gpuData.hardware_monitor();
+
+    const bool thermal = hwMonitor.temperature().slowdown() > 0 &&
+                         hwMonitor.temperature().value() + GPU_THERMAL_MARGIN_C >= hwMonitor.temperature().slowdown();
+
+    const bool power   = hwMonitor.power().enforced_value() > 0 &&
+                         static_cast<quint64>(hwMonitor.power().value()) * 100 >= static_cast<quint64>(hwMonitor.power().enforced_value()) * GPU_POWER_LIMIT_RATIO &&
+                         hwMonitor.gpu_clock().value() < hwMonitor.gpu_clock().max_value();
+
+    return thermal || power;
+}
+
+void SysFsDataProviderThrottleDetector::updateEpisode(Reason reason, bool throttled, const Sample &sample, qint64 now)
+{
+    EpisodeState& state = m_episodes.at(reason);
+
+    auto update = [&sample,reason](Episode& episode){
+        if(reason == GPU)
+        {
+            episode.m_maxTemperature    = std::max(episode.m_maxTemperature,sample.m_gpuTemperature);
+        }
+        else
+        {
+            episode.m_minFrequencyRatio = std::min(episode.m_minFrequencyRatio,sample.m_cpuFrequencyRatio);
+            episode.m_maxTemperature    = std::max(episode.m_maxTemperature,sample.m_cpuTemperature.value_or(0));
+            episode.m_maxPower          = std::max(episode.m_maxPower,sample.m_cpuPower.value_or(0));
+        }
+    };
+
+    if(throttled)
+    {
+        state.m_misses = 0;
+
+        if(state.m_active.has_value())
+        {
+            update(state.m_active.value());
+        }
+        else if(++state.m_hits >= EPISODE_START_SAMPLES)
+        {
+            state.m_hits   = 0;
+            state.m_active = Episode{
+                .m_reason           = reason,
+                .m_startTimestamp   = now - SAMPLE_PERIOD_MS * (EPISODE_START_SAMPLES - 1)
+            };
+
+            update(state.m_active.value());
+
+            LOG_D(QString("Throttle episode started, reason=") + QString::number(reason));
+
+            emit dataProviderEvent(DataProviderEvent{
+                .m_dataType     = dataType,
+                .m_eventType    = QString::number(EPISODE_STARTED),
+                .m_eventValue   = QString::number(reason)
+            });
+        }
+    }
+    else
+    {
+        state.m_hits = 0;
+
+        if(state.m_active.has_value() && ++state.m_misses >= EPISODE_END_SAMPLES)
+        {
+            state.m_misses = 0;
+            state.m_active.value().m_endTimestamp = now - SAMPLE_PERIOD_MS * (EPISODE_END_SAMPLES - 1);
+
+            LOG_D(QString("Throttle episode ended, reason=") + QString::number(reason));
+
+            m_log.push_back(state.m_active.value());
+            state.m_active.reset();
+
+            if(m_log.size() > LOG_CAPACITY)
+            {
+                m_log.pop_front();
+            }
+
+            emit dataProviderEvent(DataProviderEvent{
+                .m_dataType     = dataType,
+                .m_eventType    = QString::number(EPISODE_ENDED),
+                .m_eventValue   = QString::number(reason)
+            });
+        }
+    }
+}
+
+}
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <SysFsDataProvider.h>
+
+#include "ProcStat.h"
+
+#include <QElapsedTimer>
+
+#include <array>
+#include <deque>
+#include <optional>
+
+class QTimer;
+
+namespace legion::messages {
+class NvidiaNvml;
+}
+
+namespace LenovoLegionDaemon {
+
+class DataProviderManager;
+
+class SysFsDataProviderThrottleDetector : public SysFsDataProvider
+{
+public:
+
+    enum EventType : int {
+        EPISODE_STARTED = 0,
+        EPISODE_ENDED   = 1
+    };
+
+    /*
+     * Same values as legion::messages::ThrottleDetector::Reason
+     */
+    enum Reason : quint8 {
+        NONE         = 0,
+        THERMAL      = 1,
+        POWER_LIMIT  = 2,
+        CURRENT      = 3,
+        GPU          = 4
+    };
+
+    struct Episode {
+        Reason  m_reason                = NONE;
+        qint64  m_startTimestamp        = 0;
+        qint64  m_endTimestamp          = 0;
+        quint32 m_minFrequencyRatio     = 100;
+        quint32 m_maxTemperature        = 0;
+        quint32 m_maxPower              = 0;
+    };
+
+private:
+
+    struct Sample {
+        quint32 m_cpuFrequencyRatio     = 100;   // %
+        quint32 m_cpuUtilization        = 0;     // %
+        std::optional<quint32> m_cpuTemperature; // °C
+        std::optional<quint32> m_cpuTemperatureLimit;
+        std::optional<quint32> m_cpuPower;       // W
+        std::optional<quint32> m_cpuPowerLimit;  // W, the lower of cpu_stp_limit/cpu_ltp_limit
+        bool    m_gpuThrottled          = false;
+        quint32 m_gpuTemperature        = 0;
+    };
+
+    struct EpisodeState {
+        std::optional<Episode> m_active;
+        quint8                 m_hits   = 0;
+        quint8                 m_misses = 0;
+    };
+
+public:
+
+    SysFsDataProviderThrottleDetector(SysFsDriverManager* sysFsDriverManager,DataProviderManager* dataProviderManager);
+
+    virtual QByteArray serializeAndGetData()                    const override;
+    virtual QByteArray deserializeAndSetData(const QByteArray&)       override;
+
+    virtual void init()  override;
+    virtual void clean() override;
+
+    /*
+     * Throttle reasons reported by NVML, or the temperature resp. the power close to the slowdown
+     * temperature resp. the enforced limit
+     */
+    static bool gpuThrottled(const legion::messages::NvidiaNvml& gpuData);
+
+private:
+
+    void sample();
+
+    void readCPUFrequency(Sample& sample) const;
+    void readCPUTemperatureAndLimits(Sample& sample) const;
+    void readCPUPower(Sample& sample);
+    void readCPUUtilization(Sample& sample);
+    void readGPU(Sample& sample) const;
+
+    void updateEpisode(Reason reason,bool throttled,const Sample& sample,qint64 now);
+
+private:
+
+    DataProviderManager*        m_dataProviderManager;
+
+    QTimer*                     m_timer;
+
+    bool                        m_enabled;
+
+    /*
+     * Previous counters for rate computation
+     */
+    std::optional<quint64>      m_lastEnergy;
+    QElapsedTimer               m_lastEnergyTimer;
+    ProcStat::CPUTimes          m_lastCPUTimes;
+
+    std::array<EpisodeState,5>  m_episodes;
+    std::deque<Episode>         m_log;
+
+public:
+
+    static constexpr quint8  dataType = 20;
+
+    static constexpr int     SAMPLE_PERIOD_MS            = 1000;
+    static constexpr size_t  LOG_CAPACITY                = 256;
+    static constexpr quint8  EPISODE_START_SAMPLES       = 2;
+    static constexpr quint8  EPISODE_END_SAMPLES         = 2;
+
+    /*
+     * Classification thresholds
+     */
+    static constexpr quint32 THERMAL_MARGIN_C            = 2;
+    static constexpr quint32 THERMAL_FREQUENCY_RATIO     = 90;
+    static constexpr quint32 POWER_LIMIT_RATIO           = 95;
+    static constexpr quint32 POWER_FREQUENCY_RATIO       = 95;
+    static constexpr quint32 CURRENT_FREQUENCY_RATIO     = 75;
+    static constexpr quint32 CURRENT_UTILIZATION         = 80;
+    static constexpr quint32 GPU_THERMAL_MARGIN_C        = 2;
+    static constexpr quint32 GPU_POWER_LIMIT_RATIO       = 98;
+};
+
+}
@@ -10,7 +10,19 @@
 
 namespace LenovoLegionDaemon {
 
-SysFsDriver::SysFsDriver(const QString& name,const std::filesystem::path& path,const KernelEvent::Filter& filter,QObject *parent,QString module) : QObject (parent), m_name(name),m_path(path),m_filter(filter),m_module(module.isEmpty() ? name : module) {}
+SysFsDriver::SysFsDriver(const QString& name,const std::filesystem::path& path,const KernelEvent::Filter& filter,QObject *parent,QString module) : QObject (parent), m_name(name),m_path(rootedPath(path)),m_filter(filter),m_module(module.isEmpty() ? name : module) {}
+
+std::filesystem::path SysFsDriver::rootedPath(const std::filesystem::path &path)
+{
+    static const QByteArray root = qgetenv(SYSFS_ROOT_ENV);
+
+    if(root.isEmpty())
+    {
+        return path;
+    }
+
+    return std::filesystem::path(root.toStdString()) / path.relative_path();
+}
 
 void SysFsDriver::clean()
 {
@@ -112,6 +112,16 @@ public:
     virtual const DescriptorType& desriptor() const;
     virtual const DescriptorsInVectorType& descriptorsInVector() const;
 
+    /*
+     * Path under the sysfs root, the root is "/" unless LENOVO_LEGION_SYSFS_ROOT points to
+     * a virtual tree (e.g. the one of the thermal simulator)
+     */
+    static std::filesystem::path rootedPath(const std::filesystem::path& path);
+
+public:
+
+    static constexpr const char* SYSFS_ROOT_ENV = "LENOVO_LEGION_SYSFS_ROOT";
+
 protected:
 
     /*
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "SysFsDriverCPUXEnergyPerformance.h"
+#include "SysFsDriverCPUXList.h"
+
+#include <Core/LoggerHolder.h>
+
+namespace LenovoLegionDaemon {
+
+SysFsDriverCPUXEnergyPerformance::SysFsDriverCPUXEnergyPerformance(QObject *parrent) : SysFsDriver(DRIVER_NAME,"/sys/devices/system/cpu/",{"cpu",{}},parrent) {}
+
+void SysFsDriverCPUXEnergyPerformance::init()
+{
+    LOG_T(__PRETTY_FUNCTION__);
+
+    clean();
+
+    bool found = false;
+
+    /*
+     * CPUX energy performance driver, every CPU directory gets a descriptor so the index is the CPU number
+     */
+    for(const auto& entry : std::filesystem::directory_iterator(std::filesystem::path(m_path)))
+    {
+        if(entry.is_directory())
+        {
+            auto dir = (--entry.path().end())->string();
+            if(dir.find("cpu") != std::string::npos && dir.substr(std::string("cpu").size()).size() > 0 && std::isdigit(dir.substr(std::string("cpu").size())[0]))
+            {
+                qsizetype cpuIndex = std::stoi(dir.substr(std::string("cpu").size()));
+
+                m_descriptorsInVector.resize(std::max(cpuIndex + 1,m_descriptorsInVector.size()));
+
+                m_descriptorsInVector[cpuIndex]["cpu"] = std::filesystem::path(m_path).append(std::string("cpu") + std::to_string(cpuIndex));
+
+                if(std::filesystem::exists(std::filesystem::path(m_path).append(std::string("cpu") + std::to_string(cpuIndex)).append("cpufreq").append("energy_performance_preference")) &&
+                   std::filesystem::exists(std::filesystem::path(m_path).append(std::string("cpu") + std::to_string(cpuIndex)).append("cpufreq").append("energy_performance_available_preferences")))
+                {
+                    LOG_D(QString("Found CPUX energy performance preference in path: ") + std::filesystem::path(m_path).append(std::string("cpu") + std::to_string(cpuIndex)).append("cpufreq").c_str());
+
+                    m_descriptorsInVector[cpuIndex]["energyPerformancePreference"]          = std::filesystem::path(m_path).append(std::string("cpu") + std::to_string(cpuIndex)).append("cpufreq").append("energy_performance_preference");
+                    m_descriptorsInVector[cpuIndex]["energyPerformanceAvailablePreferences"] = std::filesystem::path(m_path).append(std::string("cpu") + std::to_string(cpuIndex)).append("cpufreq").append("energy_performance_available_preferences");
+                    found = true;
+                }
+
+                if(std::filesystem::exists(std::filesystem::path(m_path).append(std::string("cpu") + std::to_string(cpuIndex)).append("power").append("energy_perf_bias")))
+                {
+                    LOG_D(QString("Found CPUX energy perf bias in path: ") + std::filesystem::path(m_path).append(std::string("cpu") + std::to_string(cpuIndex)).append("power").c_str());
+
+                    m_descriptorsInVector[cpuIndex]["energyPerfBias"]                       = std::filesystem::path(m_path).append(std::string("cpu") + std::to_string(cpuIndex)).append("power").append("energy_perf_bias");
+                    found = true;
+                }
+            }
+        }
+    }
+
+    /*
+     * Neither EPP nor EPB, e.g. acpi-cpufreq or passive intel_pstate
+     */
+    if(!found)
+    {
+        LOG_T(QString("CPUX energy performance driver not found in path: ") + m_path.c_str());
+
+        clean();
+    }
+}
+
+void SysFsDriverCPUXEnergyPerformance::handleKernelEvent(const KernelEvent::Event &event)
+{
+    LOGF_D("{}: Kernel event received ACTION={}, DRIVER={}, SYSNAME={}, SUBSYSTEM={}, DEVPATH={}",__PRETTY_FUNCTION__,event.m_action,event.m_driver,event.m_sysName,event.m_subSystem,event.m_devPath);
+
+    if(m_blockKernelEvent)
+    {
+        LOG_T(QString("Kernel event blocked for driver: ") + m_name);
+        return;
+    }
+
+    /*
+     * Same events as the CPUX driver, cpufreq attributes come and go with the CPU online state
+     */
+    if(event.m_driver == SysFsDriverCPUXList::DRIVER_NAME)
+    {
+        init();
+        validate();
+
+        emit kernelEvent({
+            .m_driverName = DRIVER_NAME,
+            .m_action = SubsystemEvent::Action::RELOADED,
+            .m_DriverSpecificEventType = "reloaded",
+            .m_DriverSpecificEventValue = {}
+        });
+    }
+}
+
+}
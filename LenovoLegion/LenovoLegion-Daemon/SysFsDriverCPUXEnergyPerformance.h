@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include "SysFsDriver.h"
+
+
+#include <optional>
+
+
+namespace LenovoLegionDaemon {
+
+class SysFsDriverCPUXEnergyPerformance : public SysFsDriver
+{
+public:
+
+    struct CPUXEnergyPerformanceList {
+
+        struct CPUX {
+
+            CPUX(const SysFsDriver::DescriptorType& descriptor) :
+                m_energyPerformancePreference((descriptor.find("energyPerformancePreference") == descriptor.end()) ? std::optional<std::filesystem::path>() : descriptor["energyPerformancePreference"]),
+                m_energyPerformanceAvailablePreferences((descriptor.find("energyPerformanceAvailablePreferences") == descriptor.end()) ? std::optional<std::filesystem::path>() : descriptor["energyPerformanceAvailablePreferences"]),
+                m_energyPerfBias((descriptor.find("energyPerfBias") == descriptor.end()) ? std::optional<std::filesystem::path>() : descriptor["energyPerfBias"])
+            {}
+
+            CPUX(const CPUX& ) = default;
+
+            bool isPreferenceAvailable() const
+            {
+                return m_energyPerformancePreference.has_value() && m_energyPerformanceAvailablePreferences.has_value();
+            }
+
+            bool isBiasAvailable() const
+            {
+                return m_energyPerfBias.has_value();
+            }
+
+            const std::optional<std::filesystem::path> m_energyPerformancePreference;            //Current value of the energy vs performance hint for the CPUs of this policy (intel_pstate/amd-pstate active mode).
+            const std::optional<std::filesystem::path> m_energyPerformanceAvailablePreferences;  //List of the energy vs performance hint names accepted by energy_performance_preference.
+            const std::optional<std::filesystem::path> m_energyPerfBias;                         //Energy vs performance bias of cpuX (IA32_ENERGY_PERF_BIAS), 0 - highest performance, 15 - maximum energy savings.
+        };
+
+
+        CPUXEnergyPerformanceList(const SysFsDriver::DescriptorsInVectorType& descriptorsInVector)
+        {
+            for (const auto& descriptor : descriptorsInVector) {
+                m_cpus.emplace_back(descriptor);
+            }
+        }
+
+        const std::vector<CPUX>& cpuList() const
+        {
+            return m_cpus;
+        }
+
+    private:
+
+        std::vector<CPUX> m_cpus; //List of CPUs, index is the CPU number
+    };
+
+public:
+
+    SysFsDriverCPUXEnergyPerformance(QObject* parrent);
+
+
+    ~SysFsDriverCPUXEnergyPerformance() override = default;
+
+
+    /*
+     * Init Driver
+     */
+    virtual void init() override;
+
+
+    virtual void handleKernelEvent(const KernelEvent::Event& event) override;
+
+
+    /*
+     * Driver name, system driver __ prefix is used to mark  system driver no modprobe loadable
+     */
+    static constexpr const char* DRIVER_NAME =  "__cpu_energy_performance__";
+};
+
+}
@@ -6,6 +6,7 @@
  *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
  */
 #include "SysFsDriverManager.h"
+#include "Tracer.h"
 
 #include <Core/LoggerHolder.h>
 
@@ -212,6 +213,8 @@ void SysFsDriverManager::processAllUdevEvents(int timeoutInMiliseconds)
 
 void SysFsDriverManager::onDataReceived(int)
 {
+    TRACE_SPAN("udev","onDataReceived");
+
     struct udev_device *dev = udev_monitor_receive_device(m_mon);
 
     if(dev != nullptr)
@@ -225,7 +228,7 @@ void SysFsDriverManager::onDataReceived(int)
             .m_properties   = {}
         };
 
-         LOG_D(QString(__PRETTY_FUNCTION__) + ": Kernel event received ACTION=" + event.m_action + ", DRIVER=" + event.m_driver + ", SYSNAME=" + event.m_sysName + ", SUBSYSTEM=" + event.m_subSystem + ", DEVPATH=" + event.m_devPath);
+         LOGF_D("{}: Kernel event received ACTION={}, DRIVER={}, SYSNAME={}, SUBSYSTEM={}, DEVPATH={}",__PRETTY_FUNCTION__,event.m_action,event.m_driver,event.m_sysName,event.m_subSystem,event.m_devPath);
 
         if(event.m_subSystem == MODULE_SUBSYSTEM_EVENT_FILTER.m_subSystem)
         {
@@ -267,6 +270,7 @@ void SysFsDriverManager::onDataReceived(int)
                         event.m_properties[property] = udev_device_get_property_value(dev, property.toStdString().c_str());
                     }
 
+                    TRACE_SPAN("udev","handleKernelEvent");
                     driver.second->handleKernelEvent(event);
                 }
             }
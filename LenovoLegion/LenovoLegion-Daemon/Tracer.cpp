@@ -0,0 +1,285 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "Tracer.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <unistd.h>
+
+namespace LenovoLegionDaemon {
+
+namespace {
+
+/*
+ * Single producer (owning thread) ring, readers validate every slot by its sequence number
+ */
+struct ThreadBuffer {
+
+    struct Slot {
+        std::atomic<quint64> m_sequence {0};
+        Tracer::Event        m_event;
+    };
+
+    explicit ThreadBuffer(quint32 threadId) : m_threadId(threadId), m_slots(new Slot[Tracer::BUFFER_CAPACITY]) {}
+
+    void push(const Tracer::Event& event) noexcept
+    {
+        const quint64 index = m_head.load(std::memory_order_relaxed);
+        Slot&         slot  = m_slots[index % Tracer::BUFFER_CAPACITY];
+
+        slot.m_sequence.store(2 * index + 1,std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.m_event = event;
+        slot.m_sequence.store(2 * index + 2,std::memory_order_release);
+
+        m_head.store(index + 1,std::memory_order_release);
+    }
+
+    template<class F>
+    void forEach(F func) const
+    {
+        const quint64 head  = m_head.load(std::memory_order_acquire);
+        const quint64 begin = std::max<quint64>(head > Tracer::BUFFER_CAPACITY ? head - Tracer::BUFFER_CAPACITY : 0,m_clearedAt.load(std::memory_order_relaxed));
+
+        for(quint64 index = begin; index < head; ++index)
+        {
+            const Slot&   slot     = m_slots[index % Tracer::BUFFER_CAPACITY];
+            const quint64 sequence = slot.m_sequence.load(std::memory_order_acquire);
+
+            if(sequence != 2 * index + 2)
+            {
+                continue;
+            }
+
+            Tracer::Event event = slot.m_event;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if(slot.m_sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                func(event);
+            }
+        }
+    }
+
+    const quint32            m_threadId;
+    std::atomic<quint64>     m_head {0};
+    std::atomic<quint64>     m_clearedAt {0};
+    std::unique_ptr<Slot[]>  m_slots;
+};
+
+struct Registry {
+    std::mutex                                 m_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+ThreadBuffer& threadBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [](){
+        auto newBuffer = std::make_shared<ThreadBuffer>(static_cast<quint32>(gettid()));
+
+        std::lock_guard<std::mutex> lock(registry().m_mutex);
+        registry().m_buffers.push_back(newBuffer);
+
+        return newBuffer;
+    }();
+
+    return *buffer;
+}
+
+void copyDetail(char (&destination)[Tracer::DETAIL_SIZE],std::string_view detail) noexcept
+{
+    const size_t size = std::min(detail.size(),Tracer::DETAIL_SIZE - 1);
+
+    /*
+     * Keep the tail, it is the informative part of sysfs paths
+     */
+    std::memcpy(destination,detail.data() + detail.size() - size,size);
+    destination[size] = '\0';
+}
+
+void appendJsonString(std::string& json,std::string_view value)
+{
+    json.push_back('"');
+
+    for(const char c : value)
+    {
+        switch (c) {
+        case '"':  json.append("\\\""); break;
+        case '\\': json.append("\\\\"); break;
+        case '\n': json.append("\\n");  break;
+        case '\t': json.append("\\t");  break;
+        default:
+            if(static_cast<unsigned char>(c) >= 0x20)
+            {
+                json.push_back(c);
+            }
+            break;
+        }
+    }
+
+    json.push_back('"');
+}
+
+void appendMicroseconds(std::string& json,quint64 nsecs)
+{
+    std::array<char,32> buffer;
+
+    auto result = std::to_chars(buffer.data(),buffer.data() + buffer.size(),nsecs / 1000);
+    json.append(buffer.data(),result.ptr);
+    json.push_back('.');
+
+    result = std::to_chars(buffer.data(),buffer.data() + buffer.size(),nsecs % 1000 + 1000);
+    json.append(buffer.data() + 1,result.ptr);
+}
+
+}
+
+std::atomic<bool> Tracer::s_enabled {false};
+
+
+void Tracer::Span::begin(const char *category, const char *name) noexcept
+{
+    m_event.m_category  = category;
+    m_event.m_name      = name;
+    m_event.m_detail[0] = '\0';
+    m_event.m_start     = Tracer::now();
+}
+
+void Tracer::Span::begin(const char *category, const char *name, std::string_view detail) noexcept
+{
+    m_event.m_category  = category;
+    m_event.m_name      = name;
+    copyDetail(m_event.m_detail,detail);
+    m_event.m_start     = Tracer::now();
+}
+
+void Tracer::Span::begin(const char *category, const char *name, quint64 detail) noexcept
+{
+    m_event.m_category  = category;
+    m_event.m_name      = name;
+    *std::to_chars(m_event.m_detail,m_event.m_detail + DETAIL_SIZE - 1,detail).ptr = '\0';
+    m_event.m_start     = Tracer::now();
+}
+
+void Tracer::Span::end() noexcept
+{
+    m_event.m_duration = Tracer::now() - m_event.m_start;
+    Tracer::record(m_event);
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled,std::memory_order_relaxed);
+}
+
+void Tracer::clear()
+{
+    std::lock_guard<std::mutex> lock(registry().m_mutex);
+
+    for(const auto& buffer : registry().m_buffers)
+    {
+        buffer->m_clearedAt.store(buffer->m_head.load(std::memory_order_acquire),std::memory_order_relaxed);
+    }
+}
+
+quint64 Tracer::recordedEvents()
+{
+    quint64                     events = 0;
+    std::lock_guard<std::mutex> lock(registry().m_mutex);
+
+    for(const auto& buffer : registry().m_buffers)
+    {
+        events += buffer->m_head.load(std::memory_order_relaxed) - buffer->m_clearedAt.load(std::memory_order_relaxed);
+    }
+
+    return events;
+}
+
+quint64 Tracer::droppedEvents()
+{
+    quint64                     events = 0;
+    std::lock_guard<std::mutex> lock(registry().m_mutex);
+
+    for(const auto& buffer : registry().m_buffers)
+    {
+        const quint64 recorded = buffer->m_head.load(std::memory_order_relaxed) - buffer->m_clearedAt.load(std::memory_order_relaxed);
+
+        events += recorded > BUFFER_CAPACITY ? recorded - BUFFER_CAPACITY : 0;
+    }
+
+    return events;
+}
+
+std::string Tracer::chromeTraceJson()
+{
+    std::string                 json;
+    bool                        first = true;
+    const std::string           pid   = std::to_string(getpid());
+    std::lock_guard<std::mutex> lock(registry().m_mutex);
+
+    json.append("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    for(const auto& buffer : registry().m_buffers)
+    {
+        const std::string tid = std::to_string(buffer->m_threadId);
+
+        buffer->forEach([&](const Event& event){
+            json.append(first ? "\n" : ",\n");
+            first = false;
+
+            json.append("{\"ph\":\"X\",\"pid\":").append(pid).append(",\"tid\":").append(tid);
+            json.append(",\"cat\":");
+            appendJsonString(json,event.m_category);
+            json.append(",\"name\":");
+            appendJsonString(json,event.m_name);
+            json.append(",\"ts\":");
+            appendMicroseconds(json,event.m_start);
+            json.append(",\"dur\":");
+            appendMicroseconds(json,event.m_duration);
+
+            if(event.m_detail[0] != '\0')
+            {
+                json.append(",\"args\":{\"detail\":");
+                appendJsonString(json,event.m_detail);
+                json.append("}");
+            }
+
+            json.append("}");
+        });
+    }
+
+    json.append("\n]}\n");
+
+    return json;
+}
+
+quint64 Tracer::now() noexcept
+{
+    return static_cast<quint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Tracer::record(const Event &event) noexcept
+{
+    threadBuffer().push(event);
+}
+
+}
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <string>
+#include <string_view>
+
+/*
+ * Span of the enclosing scope, costs one load and branch while tracing is disabled
+ */
+#define TRACE_CONCAT_IMPL(a,b)  a##b
+#define TRACE_CONCAT(a,b)       TRACE_CONCAT_IMPL(a,b)
+#define TRACE_SPAN(category,name,...) LenovoLegionDaemon::Tracer::Span TRACE_CONCAT(traceSpan_,__LINE__)(category,name __VA_OPT__(,) __VA_ARGS__)
+
+namespace LenovoLegionDaemon {
+
+class Tracer
+{
+public:
+
+    static constexpr size_t  DETAIL_SIZE       = 64;
+    static constexpr size_t  BUFFER_CAPACITY   = 16384;    // events per thread, oldest are overwritten
+
+    struct Event {
+        const char* m_category;                             // string literal
+        const char* m_name;                                 // string literal
+        quint64     m_start;                                // ns, steady clock
+        quint64     m_duration;                             // ns
+        char        m_detail[DETAIL_SIZE];
+    };
+
+    class Span
+    {
+    public:
+        Span(const char* category,const char* name) noexcept : m_active(Tracer::isEnabled())
+        {
+            if(m_active) [[unlikely]]
+            {
+                begin(category,name);
+            }
+        }
+
+        Span(const char* category,const char* name,std::string_view detail) noexcept : m_active(Tracer::isEnabled())
+        {
+            if(m_active) [[unlikely]]
+            {
+                begin(category,name,detail);
+            }
+        }
+
+        Span(const char* category,const char* name,quint64 detail) noexcept : m_active(Tracer::isEnabled())
+        {
+            if(m_active) [[unlikely]]
+            {
+                begin(category,name,detail);
+            }
+        }
+
+        ~Span()
+        {
+            if(m_active) [[unlikely]]
+            {
+                end();
+            }
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+
+        /*
+         * Recording path, out of line to keep the disabled case small at every call site
+         */
+        void begin(const char* category,const char* name) noexcept;
+        void begin(const char* category,const char* name,std::string_view detail) noexcept;
+        void begin(const char* category,const char* name,quint64 detail) noexcept;
+        void end() noexcept;
+
+    private:
+        bool        m_active;
+        Event       m_event;
+    };
+
+public:
+
+    static bool isEnabled() noexcept { return s_enabled.load(std::memory_order_relaxed); }
+
+    static void setEnabled(bool enabled);
+
+    /*
+     * Drop all recorded events
+     */
+    static void clear();
+
+    static quint64 recordedEvents();
+    static quint64 droppedEvents();
+
+    /*
+     * Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev)
+     */
+    static std::string chromeTraceJson();
+
+    static quint64 now() noexcept;
+
+private:
+
+    static void record(const Event& event) noexcept;
+
+private:
+
+    static std::atomic<bool> s_enabled;
+};
+
+}
@@ -27,7 +27,23 @@ DISTFILES += \
     Other.proto \
     PowerProfile.proto \
     DaemonSettings.proto \
-    RGBController.proto
+    RGBController.proto \
+    ThrottleDetector.proto \
+    DaemonStats.proto \
+    DaemonTrace.proto \
+    FanController.proto \
+    AutoPowerProfile.proto \
+    ProcessRules.proto \
+    CoreParking.proto \
+    ProcessPlacement.proto \
+    IrqBalancer.proto \
+    SettingsSnapshot.proto \
+    GpuProcesses.proto \
+    PowerArbiter.proto \
+    RaplController.proto \
+    LoadGenerator.proto \
+    AutoTuner.proto \
+    CPUEnergyPerformance.proto
 
 for (PFILE, DISTFILES) {
     system($${SYSTEM_PROTOC} -I=$${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/ --cpp_out=$${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/$${PFILE})
@@ -0,0 +1,18 @@
+TEMPLATE        = lib
+CONFIG          += staticlib c++20
+TARGET          = LenovoLegion-Simulator
+
+QT       += core
+QT       -= gui
+
+DESTDIR = $${DESTINATION_LIB_PATH}
+
+SOURCES += \
+        PlantModel.cpp \
+        Simulator.cpp \
+        VirtualSysFs.cpp
+
+HEADERS += \
+        PlantModel.h \
+        Simulator.h \
+        VirtualSysFs.h
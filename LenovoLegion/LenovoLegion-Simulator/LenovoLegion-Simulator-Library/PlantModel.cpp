@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "PlantModel.h"
+
+#include <algorithm>
+
+namespace LenovoLegionSimulator {
+
+PlantModel::PlantModel(const Parameters &parameters) :
+    m_parameters(parameters)
+{
+    m_state.m_cpuTemperature      = m_parameters.m_ambient;
+    m_state.m_gpuTemperature      = m_parameters.m_ambient;
+    m_state.m_heatsinkTemperature = m_parameters.m_ambient;
+    m_state.m_sysTemperature      = m_parameters.m_ambient;
+    m_state.m_cpuFrequency        = m_parameters.m_cpuMinFrequency;
+}
+
+void PlantModel::step(const Inputs &inputs, double dt)
+{
+    /*
+     * Fans follow the firmware curve of the power mode with a first order lag
+     */
+    const FanCurve& curve  = inputs.m_powerMode == CUSTOM_POWER_MODE ? inputs.m_fanCurve : inputs.m_modeFanCurve;
+
+    m_state.m_cpuFanLevel  = fanLevel(curve,m_state.m_cpuTemperature);
+    m_state.m_gpuFanLevel  = fanLevel(curve,m_state.m_gpuTemperature);
+    m_state.m_cpuFanRpm   += (fanTargetRpm(m_state.m_cpuFanLevel) - m_state.m_cpuFanRpm) * std::min(1.0,dt / m_parameters.m_fanTimeConstant);
+    m_state.m_gpuFanRpm   += (fanTargetRpm(m_state.m_gpuFanLevel) - m_state.m_gpuFanRpm) * std::min(1.0,dt / m_parameters.m_fanTimeConstant);
+
+    /*
+     * Power
+     */
+    m_state.m_cpuFrequency     = cpuFrequency(inputs);
+    m_state.m_cpuPower         = cpuPower(m_state.m_cpuFrequency,inputs.m_cpuUtilization);
+    m_state.m_cpuPowerAverage += (m_state.m_cpuPower - m_state.m_cpuPowerAverage) * std::min(1.0,dt / std::max(inputs.m_cpuLongTermTau,dt));
+    m_state.m_gpuPower         = m_parameters.m_gpuIdlePower + std::clamp(inputs.m_gpuUtilization,0.0,1.0) * inputs.m_gpuPowerLimit *
+                                 std::clamp(1.0 - 0.2 * (m_state.m_gpuTemperature - (inputs.m_gpuTemperatureLimit - 2.0)),0.2,1.0);
+
+    /*
+     * Heat flows W
+     */
+    const double airflow       = (m_state.m_cpuFanRpm + m_state.m_gpuFanRpm) / m_parameters.m_fanMaxRpm;
+    const double cpuToHeatsink = m_parameters.m_cpuToHeatsink * (m_state.m_cpuTemperature - m_state.m_heatsinkTemperature);
+    const double gpuToHeatsink = m_parameters.m_gpuToHeatsink * (m_state.m_gpuTemperature - m_state.m_heatsinkTemperature);
+    const double toAmbient     = (m_parameters.m_heatsinkPassive + m_parameters.m_heatsinkPerFan * airflow) * (m_state.m_heatsinkTemperature - m_parameters.m_ambient);
+
+    m_state.m_cpuTemperature      += (m_state.m_cpuPower - cpuToHeatsink) / m_parameters.m_cpuCapacity * dt;
+    m_state.m_gpuTemperature      += (m_state.m_gpuPower - gpuToHeatsink) / m_parameters.m_gpuCapacity * dt;
+    m_state.m_heatsinkTemperature += (cpuToHeatsink + gpuToHeatsink - toAmbient) / m_parameters.m_heatsinkCapacity * dt;
+    m_state.m_sysTemperature       = m_parameters.m_ambient + m_parameters.m_sysCoupling * (m_state.m_heatsinkTemperature - m_parameters.m_ambient);
+
+    m_state.m_cpuEnergy += m_state.m_cpuPower * dt;
+    m_state.m_time      += dt;
+}
+
+const PlantModel::State &PlantModel::state() const
+{
+    return m_state;
+}
+
+const PlantModel::Parameters &PlantModel::parameters() const
+{
+    return m_parameters;
+}
+
+double PlantModel::cpuPower(double frequency, double utilization) const
+{
+    const double voltage = m_parameters.m_cpuVoltageOffset + m_parameters.m_cpuVoltageSlope * frequency;
+
+    return m_parameters.m_cpuIdlePower + std::clamp(utilization,0.0,1.0) * m_parameters.m_cpuCapacitance * frequency * voltage * voltage;
+}
+
+quint8 PlantModel::fanLevel(const FanCurve &curve, double temperature) const
+{
+    const auto& steps = m_parameters.m_curveTemperatures;
+    const auto  index = std::upper_bound(steps.begin(),steps.end(),temperature) - steps.begin();
+
+    return curve.at(std::clamp<std::ptrdiff_t>(index - 1,0,curve.size() - 1));
+}
+
+double PlantModel::fanTargetRpm(quint8 level) const
+{
+    if(level == 0)
+    {
+        return 0.0;
+    }
+
+    return m_parameters.m_fanMinRpm + (m_parameters.m_fanMaxRpm - m_parameters.m_fanMinRpm) * (std::min<quint8>(level,10) - 1) / 9.0;
+}
+
+double PlantModel::cpuFrequency(const Inputs &inputs) const
+{
+    /*
+     * RAPL: PL2 until the moving average reaches PL1
+     */
+    double limit = m_state.m_cpuPowerAverage < inputs.m_cpuLongTermLimit ? inputs.m_cpuShortTermLimit : inputs.m_cpuLongTermLimit;
+
+    /*
+     * Thermal control loop of the package, starts 2 °C below the limit
+     */
+    limit *= std::clamp(1.0 - 0.2 * (m_state.m_cpuTemperature - (inputs.m_cpuTemperatureLimit - 2.0)),0.2,1.0);
+
+    double low  = m_parameters.m_cpuMinFrequency;
+    double high = m_parameters.m_cpuMaxFrequency;
+
+    if(cpuPower(high,inputs.m_cpuUtilization) <= limit)
+    {
+        return high;
+    }
+
+    if(cpuPower(low,inputs.m_cpuUtilization) >= limit)
+    {
+        return low;
+    }
+
+    for (int i = 0; i < 24; ++i)
+    {
+        const double middle = (low + high) / 2;
+
+        if(cpuPower(middle,inputs.m_cpuUtilization) <= limit)
+        {
+            low  = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+}
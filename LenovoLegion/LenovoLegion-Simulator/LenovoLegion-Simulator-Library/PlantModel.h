@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <QtGlobal>
+
+#include <array>
+
+namespace LenovoLegionSimulator {
+
+/*
+ * Lumped thermal model of the laptop: CPU and GPU dies coupled to one shared heatsink,
+ * the heatsink is cooled by the airflow of the CPU and GPU fans. The power mode, the firmware fan curve,
+ * the CPU power limits (PL1/PL2, tau, temperature limit) and the GPU power limit are the inputs.
+ * Like the firmware, the fan curve is used in the custom power mode only.
+ */
+class PlantModel
+{
+public:
+
+    using FanCurve = std::array<quint8,10>;
+
+    static constexpr quint8 CUSTOM_POWER_MODE = 255;
+
+    struct Parameters {
+
+        double   m_ambient                  = 25.0;     // °C
+
+        /*
+         * Heat capacities J/K and conductances W/K
+         */
+        double   m_cpuCapacity              = 8.0;
+        double   m_gpuCapacity              = 12.0;
+        double   m_heatsinkCapacity         = 250.0;
+        double   m_cpuToHeatsink            = 3.0;
+        double   m_gpuToHeatsink            = 4.0;
+        double   m_heatsinkPassive          = 0.5;
+        double   m_heatsinkPerFan           = 2.2;      // at maximal RPM of one fan
+        double   m_sysCoupling              = 0.35;     // SYS sensor position between ambient and heatsink
+
+        /*
+         * Fans, level 0..10 of the firmware curve
+         */
+        double   m_fanMinRpm                = 1600.0;
+        double   m_fanMaxRpm                = 5400.0;
+        double   m_fanTimeConstant          = 3.0;      // s
+        std::array<double,10> m_curveTemperatures = {40,45,50,55,60,65,70,75,80,85}; // °C, firmware curve steps
+
+        /*
+         * CPU power P = idle + utilization * C * f * V(f)^2, V(f) = V0 + kV * f
+         */
+        double   m_cpuIdlePower             = 4.0;      // W
+        double   m_cpuCapacitance           = 18.0;
+        double   m_cpuVoltageOffset         = 0.7;      // V
+        double   m_cpuVoltageSlope          = 0.1;      // V/GHz
+        double   m_cpuMinFrequency          = 0.8;      // GHz
+        double   m_cpuMaxFrequency          = 5.0;      // GHz
+
+        /*
+         * GPU power P = idle + utilization * limit, reduced near the temperature limit
+         */
+        double   m_gpuIdlePower             = 6.0;      // W
+    };
+
+    struct Inputs {
+        quint8   m_powerMode                = CUSTOM_POWER_MODE;    // smart fan current_value
+        FanCurve m_fanCurve                 = {1,2,3,4,5,6,7,8,9,10};
+        FanCurve m_modeFanCurve             = {1,2,3,4,5,6,7,8,9,10}; // firmware curve of the other power modes
+        double   m_cpuLongTermLimit         = 65.0;     // W, PL1
+        double   m_cpuShortTermLimit        = 115.0;    // W, PL2
+        double   m_cpuLongTermTau           = 28.0;     // s
+        double   m_cpuTemperatureLimit      = 95.0;     // °C
+        double   m_gpuPowerLimit            = 115.0;    // W
+        double   m_gpuTemperatureLimit      = 87.0;     // °C
+        double   m_cpuUtilization           = 0.0;      // 0..1
+        double   m_gpuUtilization           = 0.0;      // 0..1
+    };
+
+    struct State {
+        double   m_time                     = 0.0;      // s
+        double   m_cpuTemperature           = 0.0;      // °C
+        double   m_gpuTemperature           = 0.0;      // °C
+        double   m_heatsinkTemperature      = 0.0;      // °C
+        double   m_sysTemperature           = 0.0;      // °C
+        double   m_cpuFanRpm                = 0.0;
+        double   m_gpuFanRpm                = 0.0;
+        quint8   m_cpuFanLevel              = 0;
+        quint8   m_gpuFanLevel              = 0;
+        double   m_cpuFrequency             = 0.0;      // GHz
+        double   m_cpuPower                 = 0.0;      // W
+        double   m_cpuPowerAverage          = 0.0;      // W, RAPL moving average compared to PL1
+        double   m_gpuPower                 = 0.0;      // W
+        double   m_cpuEnergy                = 0.0;      // J, since start
+    };
+
+public:
+
+    explicit PlantModel(const Parameters& parameters);
+
+    /*
+     * Advance the model by dt seconds (explicit Euler, keep dt <= 0.1 s)
+     */
+    void step(const Inputs& inputs,double dt);
+
+    const State& state() const;
+    const Parameters& parameters() const;
+
+    /*
+     * Power drawn by the CPU at the frequency and utilization
+     */
+    double cpuPower(double frequency,double utilization) const;
+
+private:
+
+    quint8 fanLevel(const FanCurve& curve,double temperature) const;
+    double fanTargetRpm(quint8 level) const;
+    double cpuFrequency(const Inputs& inputs) const;
+
+private:
+
+    const Parameters    m_parameters;
+    State               m_state;
+};
+
+}
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "Simulator.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+
+namespace LenovoLegionSimulator {
+
+Simulator::Simulator(const PlantModel::Parameters &parameters, const Workload &workload, const PlantModel::Inputs &inputs) :
+    m_plant(parameters),
+    m_workload(workload),
+    m_workloadPeriod(0.0),
+    m_inputs(inputs)
+{
+    for (const auto& phase : m_workload)
+    {
+        m_workloadPeriod += phase.m_duration;
+    }
+}
+
+void Simulator::attachSysFs(const std::filesystem::path &root)
+{
+    m_sysFs = std::make_unique<VirtualSysFs>(root);
+    m_sysFs->create(m_inputs);
+}
+
+Simulator::Statistics Simulator::run(const Options &options, const Policy &policy)
+{
+    Statistics     statistics;
+    QElapsedTimer  wallClock;
+    double         nextSysFs    = 0.0;
+    double         nextPolicy   = 0.0;
+    double         fanRpmSum    = 0.0;
+    double         frequencySum = 0.0;
+    quint64        steps        = 0;
+
+    const double   start        = m_plant.state().m_time;
+    const double   cpuEnergy    = m_plant.state().m_cpuEnergy;
+
+    wallClock.start();
+
+    while (m_plant.state().m_time - start < options.m_duration)
+    {
+        const double time = m_plant.state().m_time;
+
+        applyWorkload(time);
+
+        if(m_sysFs && time >= nextSysFs)
+        {
+            m_sysFs->collect(m_inputs);
+            m_sysFs->publish(m_plant.state());
+            nextSysFs = time + options.m_sysFsPeriod;
+        }
+
+        if(policy && time >= nextPolicy)
+        {
+            policy(m_plant.state(),m_inputs);
+            nextPolicy = time + options.m_policyPeriod;
+        }
+
+        m_plant.step(m_inputs,options.m_step);
+
+        const PlantModel::State& state = m_plant.state();
+
+        statistics.m_maxCpuTemperature  = std::max(statistics.m_maxCpuTemperature,state.m_cpuTemperature);
+        statistics.m_maxGpuTemperature  = std::max(statistics.m_maxGpuTemperature,state.m_gpuTemperature);
+        statistics.m_gpuEnergy         += state.m_gpuPower * options.m_step;
+
+        if(state.m_cpuTemperature + 1.0 >= m_inputs.m_cpuTemperatureLimit)
+        {
+            statistics.m_timeAtCpuLimit += options.m_step;
+        }
+
+        fanRpmSum    += (state.m_cpuFanRpm + state.m_gpuFanRpm) / 2;
+        frequencySum += state.m_cpuFrequency;
+        ++steps;
+
+        /*
+         * Pace against the wall clock, the daemon samples in real time
+         */
+        if(options.m_speedup > 0)
+        {
+            const qint64 ahead = static_cast<qint64>((state.m_time - start) / options.m_speedup * 1000) - wallClock.elapsed();
+
+            if(ahead > 0)
+            {
+                QThread::msleep(static_cast<unsigned long>(ahead));
+            }
+        }
+    }
+
+    statistics.m_simulatedTime       = m_plant.state().m_time - start;
+    statistics.m_wallTime            = wallClock.nsecsElapsed() / 1e9;
+    statistics.m_averageFanRpm       = steps > 0 ? fanRpmSum / steps : 0.0;
+    statistics.m_averageCpuFrequency = steps > 0 ? frequencySum / steps : 0.0;
+    statistics.m_cpuEnergy           = m_plant.state().m_cpuEnergy - cpuEnergy;
+
+    return statistics;
+}
+
+const PlantModel &Simulator::plant() const
+{
+    return m_plant;
+}
+
+const PlantModel::Inputs &Simulator::inputs() const
+{
+    return m_inputs;
+}
+
+Simulator::Workload Simulator::workload(const QString &name)
+{
+    if(name == "idle")
+    {
+        return {{60,0.02,0.01}};
+    }
+
+    if(name == "cpu")
+    {
+        return {{300,1.0,0.02},{60,0.05,0.02}};
+    }
+
+    if(name == "gpu")
+    {
+        return {{300,0.25,1.0},{60,0.05,0.05}};
+    }
+
+    if(name == "bursty")
+    {
+        return {{5,1.0,0.05},{15,0.1,0.05}};
+    }
+
+    /*
+     * mixed, gaming like load with CPU bursts
+     */
+    return {{120,0.6,0.95},{20,1.0,0.95},{60,0.1,0.1}};
+}
+
+void Simulator::applyWorkload(double time)
+{
+    if(m_workload.empty() || m_workloadPeriod <= 0)
+    {
+        return;
+    }
+
+    double offset = std::fmod(time,m_workloadPeriod);
+
+    for (const auto& phase : m_workload)
+    {
+        if(offset < phase.m_duration)
+        {
+            m_inputs.m_cpuUtilization = phase.m_cpuUtilization;
+            m_inputs.m_gpuUtilization = phase.m_gpuUtilization;
+            return;
+        }
+
+        offset -= phase.m_duration;
+    }
+}
+
+}
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include "PlantModel.h"
+#include "VirtualSysFs.h"
+
+#include <QString>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace LenovoLegionSimulator {
+
+class Simulator
+{
+public:
+
+    /*
+     * Workload is a repeated sequence of phases
+     */
+    struct Phase {
+        double m_duration           = 0.0;  // s
+        double m_cpuUtilization     = 0.0;  // 0..1
+        double m_gpuUtilization     = 0.0;  // 0..1
+    };
+
+    using Workload = std::vector<Phase>;
+
+    /*
+     * In process policy, called every policy period with the plant state. It changes
+     * the inputs the same way the daemon would change the sysfs attributes.
+     */
+    using Policy   = std::function<void (const PlantModel::State& state,PlantModel::Inputs& inputs)>;
+
+    struct Options {
+        double m_duration           = 600.0;    // simulated s
+        double m_step               = 0.05;     // s
+        double m_speedup            = 0.0;      // simulated s per wall clock s, 0 = as fast as possible
+        double m_sysFsPeriod        = 0.5;      // simulated s between virtual sysfs updates
+        double m_policyPeriod       = 1.0;      // simulated s between policy calls
+    };
+
+    struct Statistics {
+        double m_simulatedTime          = 0.0;  // s
+        double m_wallTime               = 0.0;  // s
+        double m_maxCpuTemperature      = 0.0;  // °C
+        double m_maxGpuTemperature      = 0.0;  // °C
+        double m_timeAtCpuLimit         = 0.0;  // s, CPU within 1 °C of cpu_tmp_limit
+        double m_averageFanRpm          = 0.0;
+        double m_averageCpuFrequency    = 0.0;  // GHz
+        double m_cpuEnergy              = 0.0;  // J
+        double m_gpuEnergy              = 0.0;  // J
+    };
+
+public:
+
+    Simulator(const PlantModel::Parameters& parameters,const Workload& workload,const PlantModel::Inputs& inputs = PlantModel::Inputs());
+
+    /*
+     * Expose the plant through a virtual sysfs tree below root
+     */
+    void attachSysFs(const std::filesystem::path& root);
+
+    Statistics run(const Options& options,const Policy& policy = Policy());
+
+    const PlantModel& plant() const;
+    const PlantModel::Inputs& inputs() const;
+
+    static Workload workload(const QString& name);
+
+private:
+
+    void applyWorkload(double time);
+
+private:
+
+    PlantModel                      m_plant;
+    const Workload                  m_workload;
+    double                          m_workloadPeriod;
+    PlantModel::Inputs              m_inputs;
+    std::unique_ptr<VirtualSysFs>   m_sysFs;
+};
+
+}
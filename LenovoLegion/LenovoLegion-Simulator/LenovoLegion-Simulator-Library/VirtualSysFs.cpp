@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "VirtualSysFs.h"
+
+#include <QFile>
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+
+namespace LenovoLegionSimulator {
+
+VirtualSysFs::VirtualSysFs(const std::filesystem::path &root) :
+    m_root(root),
+    m_hwmon(root / "sys/class/hwmon/hwmon0"),
+    m_smartFan(root / "sys/class/legion-firmware-attributes/legion-wmi-gamezone-0/attributes/smart_fan"),
+    m_fanCurve(root / "sys/class/legion-firmware-attributes/legion-wmi-fan-mode-0/attributes/fan_curve"),
+    m_other(root / "sys/class/legion-firmware-attributes/legion-wmi-other-0/attributes"),
+    m_rapl(root / "sys/class/powercap/intel-rapl:0")
+{}
+
+void VirtualSysFs::create(const PlantModel::Inputs &inputs) const
+{
+    for (const auto& dir : {m_hwmon,m_smartFan,m_fanCurve,m_other,m_rapl})
+    {
+        std::error_code error;
+
+        std::filesystem::create_directories(dir,error);
+
+        if(error)
+        {
+            THROW_EXCEPTION(exception_T,ERROR_CODES::CREATE_DIRECTORY_ERROR,std::string("I can not create directory: ").append(dir.string()).c_str());
+        }
+    }
+
+    /*
+     * HWMon, the same labels as legion-hwmon.c
+     */
+    writeFile(m_hwmon / "name","legion");
+    writeFile(m_hwmon / "temp1_label","CPU Temperature");
+    writeFile(m_hwmon / "temp2_label","GPU Temperature");
+    writeFile(m_hwmon / "temp3_label","SYS Temperature");
+    writeFile(m_hwmon / "fan1_label","CPU Fan");
+    writeFile(m_hwmon / "fan2_label","GPU Fan");
+
+    for (const auto& fan : {"fan1","fan2"})
+    {
+        writeFile(m_hwmon / (std::string(fan) + "_min"),"0");
+        writeFile(m_hwmon / (std::string(fan) + "_max"),"5400");
+    }
+
+    publish(PlantModel(PlantModel::Parameters()).state());
+
+    /*
+     * Power mode
+     */
+    writeFile(m_smartFan / "current_value",QString::number(inputs.m_powerMode));
+    writeFile(m_smartFan / "display_name","Smart fan mode");
+    writeFile(m_smartFan / "supported","1");
+    writeFile(m_smartFan / "extreme_supported","0");
+
+    /*
+     * Fan curve, no firmware default tables
+     */
+    QStringList points;
+
+    for (const auto point : inputs.m_fanCurve)
+    {
+        points.append(QString::number(point));
+    }
+
+    writeFile(m_fanCurve / "current_value",points.join(','));
+    writeFile(m_fanCurve / "display_name","FAN curve related settings");
+
+    for (const auto& name : {"cpu_fan_default","cpu_sensor_default","gpu_fan_default","gpu_sensor_default"})
+    {
+        writeFile(m_fanCurve / name,"");
+    }
+
+    /*
+     * Other attributes
+     */
+    createAttribute(m_other / "cpu_ltp_limit","CPU long term power limit",static_cast<quint32>(inputs.m_cpuLongTermLimit),5,200);
+    createAttribute(m_other / "cpu_stp_limit","CPU short term power limit",static_cast<quint32>(inputs.m_cpuShortTermLimit),5,200);
+    createAttribute(m_other / "cpu_clp_limit","CPU cross loading power limit",static_cast<quint32>(inputs.m_cpuShortTermLimit),5,200);
+    createAttribute(m_other / "cpu_pp_limit","CPU peak power limit",static_cast<quint32>(inputs.m_cpuShortTermLimit),5,200);
+    createAttribute(m_other / "cpu_pl1_tau","CPU PL1 tau",static_cast<quint32>(inputs.m_cpuLongTermTau),1,128);
+    createAttribute(m_other / "cpu_tmp_limit","CPU temperature limit",static_cast<quint32>(inputs.m_cpuTemperatureLimit),60,105);
+    createAttribute(m_other / "apus_pptp_limit","APU sPPT power limit",0,0,0);
+    createAttribute(m_other / "gpu_configurable_tgp","GPU configurable TGP",static_cast<quint32>(inputs.m_gpuPowerLimit),30,175);
+    createAttribute(m_other / "gpu_power_boost","GPU power boost",15,0,25);
+    createAttribute(m_other / "gpu_temperature_limit","GPU temperature limit",static_cast<quint32>(inputs.m_gpuTemperatureLimit),75,87);
+    createAttribute(m_other / "gpu_to_cpu_dynamic_boost","GPU to CPU dynamic boost",15,0,25);
+    createAttribute(m_other / "gpu_total_onac","GPU total power on AC",static_cast<quint32>(inputs.m_gpuPowerLimit),30,175);
+
+    /*
+     * RAPL
+     */
+    writeFile(m_rapl / "enabled","1");
+    writeFile(m_rapl / "max_energy_range_uj",QString::number(MAX_ENERGY_RANGE_UJ));
+    writeFile(m_rapl / "constraint_0_name","long_term");
+    writeFile(m_rapl / "constraint_0_power_limit_uw",QString::number(static_cast<quint64>(inputs.m_cpuLongTermLimit * 1000000)));
+    writeFile(m_rapl / "constraint_0_time_window_us",QString::number(static_cast<quint64>(inputs.m_cpuLongTermTau * 1000000)));
+    writeFile(m_rapl / "constraint_0_max_power_uw","200000000");
+    writeFile(m_rapl / "constraint_1_name","short_term");
+    writeFile(m_rapl / "constraint_1_power_limit_uw",QString::number(static_cast<quint64>(inputs.m_cpuShortTermLimit * 1000000)));
+    writeFile(m_rapl / "constraint_1_time_window_us","2440");
+    writeFile(m_rapl / "constraint_1_max_power_uw","0");
+}
+
+void VirtualSysFs::publish(const PlantModel::State &state) const
+{
+    writeFile(m_hwmon / "temp1_input",QString::number(std::lround(state.m_cpuTemperature * 1000)));
+    writeFile(m_hwmon / "temp2_input",QString::number(std::lround(state.m_gpuTemperature * 1000)));
+    writeFile(m_hwmon / "temp3_input",QString::number(std::lround(state.m_sysTemperature * 1000)));
+    writeFile(m_hwmon / "fan1_input",QString::number(std::lround(state.m_cpuFanRpm)));
+    writeFile(m_hwmon / "fan2_input",QString::number(std::lround(state.m_gpuFanRpm)));
+
+    if(std::filesystem::exists(m_rapl))
+    {
+        writeFile(m_rapl / "energy_uj",QString::number(static_cast<quint64>(state.m_cpuEnergy * 1000000) % MAX_ENERGY_RANGE_UJ));
+    }
+}
+
+void VirtualSysFs::collect(PlantModel::Inputs &inputs) const
+{
+    /*
+     * A file being rewritten by the daemon may be read empty, the previous value is kept then
+     */
+    if(auto value = readFile(m_smartFan / "current_value"); value.has_value())
+    {
+        bool          ok   = false;
+        const quint32 mode = value->toUInt(&ok);
+
+        if(ok && mode <= 255)
+        {
+            inputs.m_powerMode = static_cast<quint8>(mode);
+        }
+    }
+
+    if(auto value = readFile(m_fanCurve / "current_value"); value.has_value())
+    {
+        const QStringList points = value->split(',');
+
+        if(static_cast<size_t>(points.size()) == inputs.m_fanCurve.size())
+        {
+            for (size_t i = 0; i < inputs.m_fanCurve.size(); ++i)
+            {
+                inputs.m_fanCurve[i] = static_cast<quint8>(std::min(10u,points.at(i).toUInt()));
+            }
+        }
+    }
+
+    auto collectValue = [](const std::optional<QString>& value,double& target,double scale){
+        bool ok = false;
+
+        if(value.has_value())
+        {
+            const double number = value->toDouble(&ok) / scale;
+
+            if(ok && number > 0)
+            {
+                target = number;
+            }
+        }
+    };
+
+    double ltp = inputs.m_cpuLongTermLimit;
+    double stp = inputs.m_cpuShortTermLimit;
+    double pl1 = ltp;
+    double pl2 = stp;
+
+    collectValue(readFile(m_other / "cpu_ltp_limit/current_value"),ltp,1);
+    collectValue(readFile(m_other / "cpu_stp_limit/current_value"),stp,1);
+    collectValue(readFile(m_rapl  / "constraint_0_power_limit_uw"),pl1,1000000);
+    collectValue(readFile(m_rapl  / "constraint_1_power_limit_uw"),pl2,1000000);
+
+    /*
+     * Both the firmware and RAPL limit the package, the lower one wins
+     */
+    inputs.m_cpuLongTermLimit  = std::min(ltp,pl1);
+    inputs.m_cpuShortTermLimit = std::min(stp,pl2);
+
+    collectValue(readFile(m_other / "cpu_pl1_tau/current_value"),inputs.m_cpuLongTermTau,1);
+    collectValue(readFile(m_other / "cpu_tmp_limit/current_value"),inputs.m_cpuTemperatureLimit,1);
+    collectValue(readFile(m_other / "gpu_configurable_tgp/current_value"),inputs.m_gpuPowerLimit,1);
+    collectValue(readFile(m_other / "gpu_temperature_limit/current_value"),inputs.m_gpuTemperatureLimit,1);
+}
+
+const std::filesystem::path &VirtualSysFs::root() const
+{
+    return m_root;
+}
+
+void VirtualSysFs::createAttribute(const std::filesystem::path &path, const QString &name, quint32 value, quint32 min, quint32 max) const
+{
+    std::filesystem::create_directories(path);
+
+    writeFile(path / "current_value",QString::number(value));
+    writeFile(path / "default_value",QString::number(value));
+    writeFile(path / "display_name",name);
+    writeFile(path / "min_value",QString::number(min));
+    writeFile(path / "max_value",QString::number(max));
+    writeFile(path / "scalar_increment","1");
+    writeFile(path / "steps","");
+    writeFile(path / "supported",max > 0 ? "1" : "0");
+    writeFile(path / "type","integer");
+}
+
+void VirtualSysFs::writeFile(const std::filesystem::path &path, const QString &value)
+{
+    /*
+     * Readers must never see a half written file, write aside and rename
+     */
+    const std::filesystem::path temporary = std::filesystem::path(path).concat(".tmp");
+    QFile                       file(temporary);
+
+    if(!file.open(QIODeviceBase::WriteOnly | QIODeviceBase::Truncate) || file.write(value.toUtf8().append('\n')) < 0)
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::OPEN_FOR_WRITING_ERROR,std::string("I can not open file (").append(temporary.string()).append(") with permision=WriteOnly !").c_str());
+    }
+
+    file.close();
+
+    std::error_code error;
+
+    std::filesystem::rename(temporary,path,error);
+
+    if(error)
+    {
+        THROW_EXCEPTION(exception_T,ERROR_CODES::OPEN_FOR_WRITING_ERROR,std::string("I can not rename file (").append(temporary.string()).append(") !").c_str());
+    }
+}
+
+std::optional<QString> VirtualSysFs::readFile(const std::filesystem::path &path)
+{
+    QFile file(path);
+
+    if(!file.open(QIODeviceBase::ReadOnly))
+    {
+        return std::nullopt;
+    }
+
+    const QString value = QString::fromUtf8(file.readAll()).trimmed();
+
+    if(value.isEmpty())
+    {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+}
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include "PlantModel.h"
+
+#include <Core/ExceptionBuilder.h>
+
+#include <QString>
+
+#include <filesystem>
+#include <optional>
+
+namespace LenovoLegionSimulator {
+
+/*
+ * Sysfs tree of the legion module (hwmon, game zone smart fan, fan mode, other attributes) and of the
+ * intel-rapl powercap below a root directory. The daemon uses it when started
+ * with LENOVO_LEGION_SYSFS_ROOT=<root>.
+ */
+class VirtualSysFs
+{
+public:
+
+    DEFINE_EXCEPTION(VirtualSysFs);
+
+    enum ERROR_CODES : int {
+        OPEN_FOR_WRITING_ERROR  = 1,
+        CREATE_DIRECTORY_ERROR  = 2
+    };
+
+public:
+
+    explicit VirtualSysFs(const std::filesystem::path& root);
+
+    /*
+     * Create the tree, the actuator files are initialized from the inputs
+     */
+    void create(const PlantModel::Inputs& inputs) const;
+
+    /*
+     * Write the sensors (temperatures, fan RPMs, energy counter)
+     */
+    void publish(const PlantModel::State& state) const;
+
+    /*
+     * Read the actuators written by the daemon (power mode, fan curve, CPU/GPU power limits)
+     */
+    void collect(PlantModel::Inputs& inputs) const;
+
+    const std::filesystem::path& root() const;
+
+private:
+
+    void createAttribute(const std::filesystem::path& path,const QString& name,quint32 value,quint32 min,quint32 max) const;
+
+    static void writeFile(const std::filesystem::path& path,const QString& value);
+    static std::optional<QString> readFile(const std::filesystem::path& path);
+
+private:
+
+    const std::filesystem::path m_root;
+    const std::filesystem::path m_hwmon;
+    const std::filesystem::path m_smartFan;
+    const std::filesystem::path m_fanCurve;
+    const std::filesystem::path m_other;
+    const std::filesystem::path m_rapl;
+
+public:
+
+    static constexpr quint64 MAX_ENERGY_RANGE_UJ = 262143328850ULL;
+};
+
+}
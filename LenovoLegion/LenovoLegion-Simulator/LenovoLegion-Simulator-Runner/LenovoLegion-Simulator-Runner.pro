@@ -0,0 +1,16 @@
+TEMPLATE = app
+TARGET = LenovoLegion-Simulator
+
+QT       += core
+QT       -= gui
+
+CONFIG += c++20 cmdline
+
+DESTDIR = $${DESTINATION_BIN_PATH}
+
+INCLUDEPATH += ../LenovoLegion-Simulator-Library
+
+SOURCES += \
+        main.cpp
+
+LIBS += -lLenovoLegion-Simulator -l$${PROJECT_LIBS_NAME}
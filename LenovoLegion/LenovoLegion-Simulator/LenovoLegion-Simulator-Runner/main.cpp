@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include <Simulator.h>
+
+#include <Core/ExceptionBuilder.h>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+using namespace LenovoLegionSimulator;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication   app(argc,argv);
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription("Thermal plant simulator for offline testing of fan and power policies.\n"
+                                     "With --root the daemon can be started with LENOVO_LEGION_SYSFS_ROOT=<root> against the simulated machine.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"root",        "Create a virtual sysfs tree in <directory>.","directory"},
+        {"workload",    "Workload: idle, cpu, gpu, bursty or mixed.","name","mixed"},
+        {"duration",    "Simulated time in seconds.","seconds","600"},
+        {"step",        "Integration step in seconds.","seconds","0.05"},
+        {"speedup",     "Simulated seconds per wall clock second, 0 runs as fast as possible.","factor","0"},
+        {"fan-curve",   "Initial fan curve, 10 comma separated levels.","points","1,2,3,4,5,6,7,8,9,10"},
+        {"pl1",         "Initial CPU long term power limit in W.","watts","65"},
+        {"pl2",         "Initial CPU short term power limit in W.","watts","115"}
+    });
+    parser.process(app);
+
+    PlantModel::Inputs inputs;
+    const QStringList  points = parser.value("fan-curve").split(',');
+
+    if(points.size() != static_cast<qsizetype>(inputs.m_fanCurve.size()))
+    {
+        qCritical() << "Fan curve must have 10 points !";
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < inputs.m_fanCurve.size(); ++i)
+    {
+        inputs.m_fanCurve[i] = static_cast<quint8>(std::min(10u,points.at(i).toUInt()));
+    }
+
+    inputs.m_cpuLongTermLimit  = parser.value("pl1").toDouble();
+    inputs.m_cpuShortTermLimit = parser.value("pl2").toDouble();
+
+    Simulator::Options options;
+
+    options.m_duration = parser.value("duration").toDouble();
+    options.m_step     = parser.value("step").toDouble();
+    options.m_speedup  = parser.value("speedup").toDouble();
+
+    try {
+        Simulator simulator(PlantModel::Parameters(),Simulator::workload(parser.value("workload")),inputs);
+
+        if(parser.isSet("root"))
+        {
+            simulator.attachSysFs(parser.value("root").toStdString());
+        }
+
+        const Simulator::Statistics statistics = simulator.run(options);
+
+        QTextStream(stdout) << "simulated time [s]       : " << statistics.m_simulatedTime                           << Qt::endl
+                            << "wall time [s]            : " << statistics.m_wallTime                                << Qt::endl
+                            << "speedup                  : " << statistics.m_simulatedTime / statistics.m_wallTime   << Qt::endl
+                            << "max CPU temperature [°C] : " << statistics.m_maxCpuTemperature                       << Qt::endl
+                            << "max GPU temperature [°C] : " << statistics.m_maxGpuTemperature                       << Qt::endl
+                            << "time at CPU limit [s]    : " << statistics.m_timeAtCpuLimit                          << Qt::endl
+                            << "average fan [RPM]        : " << statistics.m_averageFanRpm                           << Qt::endl
+                            << "average CPU freq. [GHz]  : " << statistics.m_averageCpuFrequency                     << Qt::endl
+                            << "CPU energy [J]           : " << statistics.m_cpuEnergy                               << Qt::endl
+                            << "GPU energy [J]           : " << statistics.m_gpuEnergy                               << Qt::endl;
+    }
+    catch(const bj::framework::exception::Exception& ex)
+    {
+        qCritical() << bj::framework::exception::ExceptionBuilder::print(ex).c_str();
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
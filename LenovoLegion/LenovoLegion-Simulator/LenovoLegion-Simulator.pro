@@ -0,0 +1,9 @@
+TEMPLATE = subdirs
+
+CONFIG += c++20
+
+SUBDIRS +=  \
+            LenovoLegion-Simulator-Library\
+            LenovoLegion-Simulator-Runner
+
+LenovoLegion-Simulator-Runner.depends =  LenovoLegion-Simulator-Library
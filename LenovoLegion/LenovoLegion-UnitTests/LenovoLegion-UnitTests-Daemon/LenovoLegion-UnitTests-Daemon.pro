@@ -0,0 +1,129 @@
+TEMPLATE = app
+TARGET = $${PROJECT_TEST_NAME}
+
+DESTDIR = $${DESTINATION_LIB_PATH}
+
+
+QT += testlib
+QT -= gui
+
+CONFIG += qt console warn_on depend_includepath testcase c++20 link_pkgconfig
+CONFIG -= app_bundle
+
+PKGCONFIG += protobuf
+
+DAEMON_PATH = $${PROJECT_ROOT_PATH}/$${APPLICATION_NAME2}
+
+SOURCES += \
+    tst_LenovoLegionDaemon.cpp
+
+# Daemon sources under test, the daemon is an application and can not be linked
+SOURCES += \
+    $${DAEMON_PATH}/CPUList.cpp \
+    $${DAEMON_PATH}/ControlOwnership.cpp \
+    $${DAEMON_PATH}/DataProvider.cpp \
+    $${DAEMON_PATH}/DataProviderManager.cpp \
+    $${DAEMON_PATH}/DataProviderNvidiaNvml.cpp \
+    $${DAEMON_PATH}/LatencyHistogram.cpp \
+    $${DAEMON_PATH}/LatencyStatistics.cpp \
+    $${DAEMON_PATH}/LoadGenerator.cpp \
+    $${DAEMON_PATH}/NvmlLibrary.cpp \
+    $${DAEMON_PATH}/NvmlProcessAccounting.cpp \
+    $${DAEMON_PATH}/PeerCredentials.cpp \
+    $${DAEMON_PATH}/ProcInterrupts.cpp \
+    $${DAEMON_PATH}/ProcStat.cpp \
+    $${DAEMON_PATH}/Settings.cpp \
+    $${DAEMON_PATH}/SettingsStore.cpp \
+    $${DAEMON_PATH}/SysFsDataProvider.cpp \
+    $${DAEMON_PATH}/SysFsDataProviderAutoTuner.cpp \
+    $${DAEMON_PATH}/SysFsDataProviderFanController.cpp \
+    $${DAEMON_PATH}/SysFsDataProviderIrqBalancer.cpp \
+    $${DAEMON_PATH}/SysFsDataProviderThrottleDetector.cpp \
+    $${DAEMON_PATH}/SysFsDriver.cpp \
+    $${DAEMON_PATH}/SysFsDriverCPUAtom.cpp \
+    $${DAEMON_PATH}/SysFsDriverCPUXList.cpp \
+    $${DAEMON_PATH}/SysFSDriverLegionFanMode.cpp \
+    $${DAEMON_PATH}/SysFSDriverLegionGameZone.cpp \
+    $${DAEMON_PATH}/SysFSDriverLegionHWMon.cpp \
+    $${DAEMON_PATH}/SysFsDriverManager.cpp \
+    $${DAEMON_PATH}/Tracer.cpp
+
+HEADERS += \
+    $${DAEMON_PATH}/CPUList.h \
+    $${DAEMON_PATH}/ControlOwnership.h \
+    $${DAEMON_PATH}/DataProvider.h \
+    $${DAEMON_PATH}/DataProviderManager.h \
+    $${DAEMON_PATH}/DataProviderNvidiaNvml.h \
+    $${DAEMON_PATH}/LatencyHistogram.h \
+    $${DAEMON_PATH}/LatencyStatistics.h \
+    $${DAEMON_PATH}/LoadGenerator.h \
+    $${DAEMON_PATH}/NvmlLibrary.h \
+    $${DAEMON_PATH}/NvmlProcessAccounting.h \
+    $${DAEMON_PATH}/PeerCredentials.h \
+    $${DAEMON_PATH}/ProcInterrupts.h \
+    $${DAEMON_PATH}/ProcStat.h \
+    $${DAEMON_PATH}/Settings.h \
+    $${DAEMON_PATH}/SettingsStore.h \
+    $${DAEMON_PATH}/SysFsDataProvider.h \
+    $${DAEMON_PATH}/SysFsDataProviderAutoTuner.h \
+    $${DAEMON_PATH}/SysFsDataProviderFanController.h \
+    $${DAEMON_PATH}/SysFsDataProviderIrqBalancer.h \
+    $${DAEMON_PATH}/SysFsDataProviderThrottleDetector.h \
+    $${DAEMON_PATH}/SysFsDriver.h \
+    $${DAEMON_PATH}/SysFsDriverCPUAtom.h \
+    $${DAEMON_PATH}/SysFsDriverCPUXList.h \
+    $${DAEMON_PATH}/SysFSDriverLegionFanMode.h \
+    $${DAEMON_PATH}/SysFSDriverLegionGameZone.h \
+    $${DAEMON_PATH}/SysFSDriverLegionHWMon.h \
+    $${DAEMON_PATH}/SysFsDriverManager.h \
+    $${DAEMON_PATH}/Tracer.h
+
+SOURCES += \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/AutoTuner.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/CPUEnergyPerformance.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/CPUFrequency.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/CpuIntelMSR.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/CPUOptions.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/CpuPower.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/DaemonSettings.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/FanControl.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/FanController.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/GPUPower.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/IrqBalancer.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/NvidiaNvml.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/Other.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/PowerProfile.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/SettingsSnapshot.pb.cc \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/ThrottleDetector.pb.cc
+
+HEADERS += \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/AutoTuner.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/CPUEnergyPerformance.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/CPUFrequency.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/CpuIntelMSR.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/CPUOptions.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/CpuPower.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/DaemonSettings.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/FanControl.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/FanController.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/GPUPower.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/IrqBalancer.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/NvidiaNvml.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/Other.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/PowerProfile.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/SettingsSnapshot.pb.h \
+    $${PROJECT_ROOT_PATH}/LenovoLegion-PrepareBuild/ThrottleDetector.pb.h
+
+# NVML stub loaded instead of libnvidia-ml, its control functions are resolved with dlsym
+NVML_STUB_PATH = $${PROJECT_ROOT_PATH}/$${PROJECT_TEST_NAME}/$${PROJECT_TEST_NVML_STUB_NAME}
+
+HEADERS += \
+    $${NVML_STUB_PATH}/NvmlStub.h
+
+DEFINES += NVML_STUB_LIBRARY=\\\"$${DESTINATION_LIB_PATH}lib$${PROJECT_TEST_NVML_STUB_NAME}.so\\\"
+
+# Plant model the controllers run against, exposed through a virtual sysfs tree
+SIMULATOR_PATH = $${PROJECT_ROOT_PATH}/LenovoLegion-Simulator/LenovoLegion-Simulator-Library
+
+INCLUDEPATH += $${CUDA_PATH}/include $${NVML_STUB_PATH} $${SIMULATOR_PATH}
+LIBS += -lLenovoLegion-Simulator -l$${PROJECT_LIBS_NAME} -ludev -ldl
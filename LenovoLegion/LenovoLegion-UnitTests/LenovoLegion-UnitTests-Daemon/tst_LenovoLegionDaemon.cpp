@@ -0,0 +1,670 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include <QtTest>
+
+// add necessary includes here
+#include <Core/LoggerHolder.h>
+
+#include "DataProviderNvidiaNvml.h"
+#include "NvmlLibrary.h"
+#include "NvmlProcessAccounting.h"
+#include "NvmlStub.h"
+#include "PeerCredentials.h"
+#include "ProcStat.h"
+#include "SysFsDriver.h"
+#include "SysFsDriverManager.h"
+#include "SysFsDriverCPUXList.h"
+#include "SysFsDriverCPUAtom.h"
+#include "SysFSDriverLegionFanMode.h"
+#include "SysFSDriverLegionGameZone.h"
+#include "SysFSDriverLegionHWMon.h"
+#include "SysFsDataProviderAutoTuner.h"
+#include "SysFsDataProviderFanController.h"
+#include "SysFsDataProviderIrqBalancer.h"
+#include "SysFsDataProviderThrottleDetector.h"
+
+#include "../LenovoLegion-PrepareBuild/AutoTuner.pb.h"
+#include "../LenovoLegion-PrepareBuild/FanController.pb.h"
+#include "../LenovoLegion-PrepareBuild/IrqBalancer.pb.h"
+#include "../LenovoLegion-PrepareBuild/NvidiaNvml.pb.h"
+#include "../LenovoLegion-PrepareBuild/PowerProfile.pb.h"
+
+#include <Simulator.h>
+
+#include <algorithm>
+#include <filesystem>
+
+#include <dlfcn.h>
+
+using namespace LenovoLegionDaemon;
+
+/*
+ * The daemon runs against a fake sysfs and procfs tree below a temporary root (LENOVO_LEGION_SYSFS_ROOT)
+ * and the NVML stub instead of libnvidia-ml (LENOVO_LEGION_NVML_LIBRARY). Controllers run closed loop
+ * against the simulator plant exposed in the same tree, their timers are driven by the simulated time.
+ */
+class LenovoLegionDaemonTests : public QObject
+{
+    Q_OBJECT
+
+public:
+    LenovoLegionDaemonTests();
+    ~LenovoLegionDaemonTests();
+
+private slots:
+    void initTestCase();
+
+    void test_ProcStat();
+    void test_IrqBalancer();
+    void test_NvidiaNvmlSuspended();
+    void test_NvidiaNvml();
+    void test_ThrottleDetectorGpu();
+    void test_AutoTunerUnprivileged();
+    void test_FanControllerSimulated();
+
+private:
+
+    static void    writeFile(const std::filesystem::path& path,const QString& value);
+    static QString readFile(const std::filesystem::path& path);
+
+    /*
+     * Hybrid CPU, CPU0 - CPU1 are P-cores, CPU2 - CPU3 E-cores
+     */
+    void createCPUs() const;
+
+    void writeInterrupts(quint64 nvme,quint64 wifi,quint64 timer) const;
+
+    /*
+     * NVIDIA GPU on the PCI bus with the runtime PM status
+     */
+    void createGpu(const QString& runtimeStatus) const;
+
+    static QByteArray irqBalancerRequest(const legion::messages::IrqBalancer& irqBalancer);
+    static legion::messages::IrqBalancer irqBalancerState(const SysFsDataProviderIrqBalancer& balancer);
+    static legion::messages::NvidiaNvml  nvidiaNvmlState(const DataProviderNvidiaNvml& nvml);
+    static QByteArray autoTunerRequest(const legion::messages::AutoTuner& autoTuner);
+    static legion::messages::AutoTuner   autoTunerState(const SysFsDataProviderAutoTuner& tuner);
+    static QByteArray fanControllerRequest(const legion::messages::FanController& fanController);
+    static legion::messages::FanController fanControllerState(const SysFsDataProviderFanController& controller);
+
+private:
+
+    QTemporaryDir           m_root;
+    std::filesystem::path   m_sysRoot;
+    std::filesystem::path   m_procRoot;
+
+    /*
+     * Stub stays loaded between the tests, the daemon opens and closes the same library
+     */
+    void*                           m_nvmlStub;
+    NvmlStubReset                   m_nvmlStubReset;
+    NvmlStubInitCount               m_nvmlStubInitCount;
+    NvmlStubSetUtilization          m_nvmlStubSetUtilization;
+    NvmlStubAddSample               m_nvmlStubAddSample;
+    NvmlStubSetClocksEventReasons   m_nvmlStubSetClocksEventReasons;
+    NvmlStubInjectXid               m_nvmlStubInjectXid;
+    NvmlStubAddProcess              m_nvmlStubAddProcess;
+};
+
+LenovoLegionDaemonTests::LenovoLegionDaemonTests() :
+    m_nvmlStub(nullptr)
+{
+    LoggerHolder::getInstance().init("LenovoLegion-UnitTests.log");
+}
+
+LenovoLegionDaemonTests::~LenovoLegionDaemonTests()
+{
+    if(m_nvmlStub != nullptr)
+    {
+        dlclose(m_nvmlStub);
+    }
+}
+
+void LenovoLegionDaemonTests::initTestCase()
+{
+    QVERIFY(m_root.isValid());
+
+    /*
+     * SysFsDriver::rootedPath reads the root once, before any driver is created
+     */
+    qputenv(SysFsDriver::SYSFS_ROOT_ENV,m_root.path().toUtf8());
+
+    m_sysRoot  = SysFsDriver::rootedPath("/sys");
+    m_procRoot = SysFsDriver::rootedPath("/proc");
+
+    QVERIFY(m_procRoot == std::filesystem::path(m_root.path().toStdString()) / "proc");
+
+    createCPUs();
+
+    /*
+     * NvmlLibrary::path reads the library once too
+     */
+    qputenv(NvmlLibrary::LIBRARY_ENV,NVML_STUB_LIBRARY);
+
+    QCOMPARE(NvmlLibrary::path(),QString(NVML_STUB_LIBRARY));
+
+    m_nvmlStub = dlopen(NVML_STUB_LIBRARY,RTLD_NOW | RTLD_LOCAL);
+
+    QVERIFY2(m_nvmlStub != nullptr,dlerror());
+
+    QVERIFY((m_nvmlStubReset                 = reinterpret_cast<NvmlStubReset>(dlsym(m_nvmlStub,"nvmlStubReset")))                                   != nullptr);
+    QVERIFY((m_nvmlStubInitCount             = reinterpret_cast<NvmlStubInitCount>(dlsym(m_nvmlStub,"nvmlStubInitCount")))                           != nullptr);
+    QVERIFY((m_nvmlStubSetUtilization        = reinterpret_cast<NvmlStubSetUtilization>(dlsym(m_nvmlStub,"nvmlStubSetUtilization")))                 != nullptr);
+    QVERIFY((m_nvmlStubAddSample             = reinterpret_cast<NvmlStubAddSample>(dlsym(m_nvmlStub,"nvmlStubAddSample")))                           != nullptr);
+    QVERIFY((m_nvmlStubSetClocksEventReasons = reinterpret_cast<NvmlStubSetClocksEventReasons>(dlsym(m_nvmlStub,"nvmlStubSetClocksEventReasons"))) != nullptr);
+    QVERIFY((m_nvmlStubInjectXid             = reinterpret_cast<NvmlStubInjectXid>(dlsym(m_nvmlStub,"nvmlStubInjectXid")))                           != nullptr);
+    QVERIFY((m_nvmlStubAddProcess            = reinterpret_cast<NvmlStubAddProcess>(dlsym(m_nvmlStub,"nvmlStubAddProcess")))                         != nullptr);
+}
+
+void LenovoLegionDaemonTests::test_ProcStat()
+{
+    writeFile(m_procRoot / "stat","cpu  100 0 100 700 100 0 0 0 0 0\n"
+                                  "cpu0 50 0 50 350 50 0 0 0 0 0\n"
+                                  "cpu3 50 0 50 350 50 0 0 0 0 0\n"
+                                  "intr 12345\n");
+
+    const ProcStat::Snapshot first = ProcStat::read(m_procRoot);
+
+    QCOMPARE(first.m_all.m_total,quint64(1000));
+    QCOMPARE(first.m_all.m_busy,quint64(200));
+    QCOMPARE(first.m_cpus.size(),size_t(4));
+    QCOMPARE(first.m_cpus.at(3).m_total,quint64(500));
+
+    writeFile(m_procRoot / "stat","cpu  400 0 400 1000 200 0 0 0 0 0\n");
+
+    QCOMPARE(ProcStat::utilization(first.m_all,ProcStat::read(m_procRoot).m_all),quint32(60));
+
+    QVERIFY_THROWS_EXCEPTION(ProcStat::exception_T,ProcStat::read(m_procRoot / "missing"));
+}
+
+void LenovoLegionDaemonTests::test_IrqBalancer()
+{
+    SysFsDriverManager manager;
+
+    manager.addDriver(new SysFsDriverCPUXList(&manager));
+    manager.addDriver(new SysFsDriverCPUAtom(&manager));
+    manager.initDrivers();
+
+    for(const auto irq : {120,121,9})
+    {
+        writeFile(m_procRoot / "irq" / std::to_string(irq) / "smp_affinity_list","0-3\n");
+    }
+
+    writeInterrupts(0,0,0);
+
+    SysFsDataProviderIrqBalancer   balancer(&manager,nullptr,m_procRoot);
+    legion::messages::IrqBalancer  request;
+
+    request.set_rate_threshold(100);
+    request.set_period(1);
+    request.set_enabled(true);
+
+    balancer.deserializeAndSetData(irqBalancerRequest(request));
+
+    {
+        const auto state = irqBalancerState(balancer);
+
+        QVERIFY(state.enabled());
+        QVERIFY(state.hybrid());
+        QCOMPARE(state.e_cores_size(),2);
+    }
+
+    /*
+     * Busiest interrupt to the first E-core, the next one to the other, the slow one stays
+     */
+    writeInterrupts(200000,100000,10);
+
+    QTRY_COMPARE_WITH_TIMEOUT(readFile(m_procRoot / "irq" / "120" / "smp_affinity_list"),QString("2"),3000);
+    QCOMPARE(readFile(m_procRoot / "irq" / "121" / "smp_affinity_list"),QString("3"));
+    QCOMPARE(readFile(m_procRoot / "irq" / "9" / "smp_affinity_list"),QString("0-3"));
+
+    {
+        const auto state = irqBalancerState(balancer);
+
+        QCOMPARE(state.rebalances(),quint64(1));
+        QCOMPARE(state.failures(),quint64(0));
+    }
+
+    /*
+     * The attribute of IRQ 121 can not be written any more, the other interrupt is restored anyway
+     */
+    std::filesystem::remove(m_procRoot / "irq" / "121" / "smp_affinity_list");
+    std::filesystem::create_directory(m_procRoot / "irq" / "121" / "smp_affinity_list");
+
+    request.Clear();
+    request.set_enabled(false);
+
+    QVERIFY_THROWS_NO_EXCEPTION(balancer.deserializeAndSetData(irqBalancerRequest(request)));
+
+    QCOMPARE(readFile(m_procRoot / "irq" / "120" / "smp_affinity_list"),QString("0-3"));
+
+    {
+        const auto state = irqBalancerState(balancer);
+
+        QVERIFY(!state.enabled());
+        QCOMPARE(state.failures(),quint64(1));
+
+        for(const auto& irq : state.irqs())
+        {
+            QVERIFY(!irq.steered());
+        }
+    }
+
+    balancer.clean();
+}
+
+void LenovoLegionDaemonTests::test_NvidiaNvmlSuspended()
+{
+    m_nvmlStubReset();
+
+    createGpu("suspended");
+
+    DataProviderNvidiaNvml nvml(nullptr);
+
+    nvml.init();
+
+    const auto snapshot = nvml.snapshot();
+
+    QVERIFY(snapshot != nullptr);
+    QCOMPARE(snapshot->power_state(),legion::messages::NvidiaNvml::POWER_STATE_SUSPENDED);
+    QVERIFY(!snapshot->has_hardware_monitor());
+
+    /*
+     * Any NVML call would wake the GPU up
+     */
+    QCOMPARE(m_nvmlStubInitCount(),0u);
+
+    nvml.clean();
+}
+
+void LenovoLegionDaemonTests::test_NvidiaNvml()
+{
+    m_nvmlStubReset();
+    m_nvmlStubSetUtilization(50,20);
+
+    for(const auto& [timestamp,value] : std::initializer_list<std::pair<unsigned long long,unsigned int>>{{100,10},{200,20},{300,30}})
+    {
+        m_nvmlStubAddSample(NVML_GPU_UTILIZATION_SAMPLES,timestamp,value);
+    }
+
+    m_nvmlStubAddProcess(4242,0,256ULL << 20,70,10);
+    writeFile(m_procRoot / "4242" / "comm","stress\n");
+
+    createGpu("active");
+
+    DataProviderNvidiaNvml nvml(nullptr);
+
+    nvml.init();
+
+    {
+        const auto snapshot = nvml.snapshot();
+
+        QVERIFY(snapshot != nullptr);
+        QCOMPARE(snapshot->power_state(),legion::messages::NvidiaNvml::POWER_STATE_ACTIVE);
+        QCOMPARE(snapshot->name(),std::string("NVIDIA Stub GPU"));
+        QCOMPARE(snapshot->hardware_monitor().gpu_utilization().value(),50u);
+        QCOMPARE(m_nvmlStubInitCount(),1u);
+    }
+
+    /*
+     * NVML buffer drained once, later samples do not repeat it
+     */
+    {
+        const auto state = nvidiaNvmlState(nvml);
+
+        QCOMPARE(state.sample_series_size(),1);
+        QCOMPARE(state.sample_series(0).type(),legion::messages::NvidiaNvml::SampleSeries::SAMPLES_GPU_UTILIZATION);
+        QCOMPARE(state.sample_series(0).values_size(),3);
+        QCOMPARE(state.sample_series(0).timestamps(2),quint64(300));
+        QCOMPARE(state.sample_series(0).values(2),30.0);
+    }
+
+    {
+        const auto processes = nvml.processAccounting().processes();
+
+        QVERIFY(nvml.processAccounting().available());
+        QCOMPARE(processes.size(),size_t(1));
+        QCOMPARE(processes.front().m_pid,quint32(4242));
+        QCOMPARE(processes.front().m_name,QString("stress"));
+        QVERIFY(processes.front().m_compute);
+        QVERIFY(!processes.front().m_graphics);
+        QCOMPARE(processes.front().m_usedMemory,quint64(256) << 20);
+        QCOMPARE(processes.front().m_smUtilization,quint32(70));
+    }
+
+    /*
+     * Events between two samples, the throttle reasons are read on the clock change
+     */
+    m_nvmlStubSetClocksEventReasons(nvmlClocksEventReasonHwThermalSlowdown);
+    m_nvmlStubInjectXid(79);
+
+    QTRY_COMPARE_WITH_TIMEOUT(nvidiaNvmlState(nvml).events_size(),2,3000);
+
+    {
+        const auto state = nvidiaNvmlState(nvml);
+
+        QCOMPARE(state.events(0).type(),legion::messages::NvidiaNvml::Event::EVENT_THROTTLE_REASONS_CHANGED);
+        QCOMPARE(state.events(0).throttle_reasons(),quint64(nvmlClocksEventReasonHwThermalSlowdown));
+        QCOMPARE(state.events(1).type(),legion::messages::NvidiaNvml::Event::EVENT_XID_ERROR);
+        QCOMPARE(state.events(1).xid(),quint32(79));
+        QCOMPARE(state.clock_changes(),quint64(1));
+    }
+
+    nvml.clean();
+}
+
+void LenovoLegionDaemonTests::test_ThrottleDetectorGpu()
+{
+    m_nvmlStubReset();
+
+    createGpu("active");
+
+    DataProviderNvidiaNvml nvml(nullptr);
+
+    nvml.init();
+
+    /*
+     * Stub GPU is cool and far below its power limit, only a throttle reason throttles it
+     */
+    {
+        const auto snapshot = nvml.snapshot();
+
+        QVERIFY(snapshot != nullptr);
+        QVERIFY(snapshot->has_hardware_monitor());
+        QVERIFY(!SysFsDataProviderThrottleDetector::gpuThrottled(*snapshot));
+    }
+
+    m_nvmlStubSetClocksEventReasons(nvmlClocksEventReasonSwPowerCap);
+
+    QTRY_VERIFY_WITH_TIMEOUT(nvml.snapshot()->throttle_reasons() == nvmlClocksEventReasonSwPowerCap,3000);
+    QVERIFY(SysFsDataProviderThrottleDetector::gpuThrottled(*nvml.snapshot()));
+
+    /*
+     * Idle and application clock reasons are not throttling
+     */
+    m_nvmlStubSetClocksEventReasons(nvmlClocksEventReasonGpuIdle);
+
+    QTRY_VERIFY_WITH_TIMEOUT(nvml.snapshot()->throttle_reasons() == 0,3000);
+    QVERIFY(!SysFsDataProviderThrottleDetector::gpuThrottled(*nvml.snapshot()));
+
+    nvml.clean();
+}
+
+void LenovoLegionDaemonTests::test_AutoTunerUnprivileged()
+{
+    SysFsDriverManager          manager;
+    SysFsDataProviderAutoTuner  tuner(&manager,nullptr);
+    legion::messages::AutoTuner request;
+
+    const quint32 steps = autoTunerState(tuner).steps();
+
+    /*
+     * Refused before the configuration of the request is taken over
+     */
+    {
+        PeerCredentials::Scope scope(PeerCredentials::Credentials{.m_pid = 1000,.m_uid = 1000});
+
+        request.set_enabled(true);
+        request.set_steps(steps + 1);
+
+        QVERIFY_THROWS_EXCEPTION(SysFsDataProviderAutoTuner::exception_T,tuner.deserializeAndSetData(autoTunerRequest(request)));
+
+        request.clear_enabled();
+        request.set_apply_profile(legion::messages::AutoTuner::OBJECTIVE_BEST_EFFICIENCY);
+
+        QVERIFY_THROWS_EXCEPTION(SysFsDataProviderAutoTuner::exception_T,tuner.deserializeAndSetData(autoTunerRequest(request)));
+
+        const auto state = autoTunerState(tuner);
+
+        QVERIFY(!state.enabled());
+        QCOMPARE(state.state(),legion::messages::AutoTuner::STATE_IDLE);
+        QCOMPARE(state.steps(),steps);
+
+        /*
+         * Configuration alone is not a search
+         */
+        request.clear_apply_profile();
+
+        QVERIFY_THROWS_NO_EXCEPTION(tuner.deserializeAndSetData(autoTunerRequest(request)));
+        QCOMPARE(autoTunerState(tuner).steps(),steps + 1);
+    }
+}
+
+void LenovoLegionDaemonTests::test_FanControllerSimulated()
+{
+    using namespace LenovoLegionSimulator;
+
+    const std::filesystem::path smartFan = m_sysRoot / "class/legion-firmware-attributes/legion-wmi-gamezone-0/attributes/smart_fan/current_value";
+    const std::filesystem::path fanCurve = m_sysRoot / "class/legion-firmware-attributes/legion-wmi-fan-mode-0/attributes/fan_curve/current_value";
+
+    /*
+     * Balanced mode with a quiet firmware curve, sustained full CPU load
+     */
+    PlantModel::Inputs inputs;
+
+    inputs.m_powerMode = legion::messages::PowerProfile::POWER_PROFILE_BALANCED;
+    inputs.m_modeFanCurve.fill(1);
+
+    Simulator simulator(PlantModel::Parameters(),{{600,1.0,0.0}},inputs);
+
+    simulator.attachSysFs(m_root.path().toStdString());
+
+    SysFsDriverManager manager;
+
+    manager.addDriver(new SysFSDriverLegionHWMon(&manager));
+    manager.addDriver(new SysFSDriverLegionFanMode(&manager));
+    manager.addDriver(new SysFSDriverLegionGameZone(&manager));
+    manager.initDrivers();
+
+    /*
+     * The custom curve does nothing outside of the custom mode
+     */
+    simulator.run(Simulator::Options{.m_duration = 180.0});
+
+    const double uncontrolledTemperature = simulator.plant().state().m_cpuTemperature;
+
+    QCOMPARE(simulator.plant().state().m_cpuFanLevel,quint8(1));
+    QVERIFY(uncontrolledTemperature > 70.0);
+
+    SysFsDataProviderFanController   controller(&manager,nullptr);
+    legion::messages::FanController  request;
+
+    request.set_enabled(true);
+    request.set_min_temperature(50);
+    request.set_max_temperature(70);
+
+    controller.deserializeAndSetData(fanControllerRequest(request));
+
+    QCOMPARE(readFile(smartFan),QString::number(legion::messages::PowerProfile::POWER_PROFILE_CUSTOM));
+
+    QTimer* timer = controller.findChild<QTimer*>();
+
+    QVERIFY(timer != nullptr && timer->isActive());
+
+    /*
+     * One control period of simulated time between the control steps, the plant follows the written curve
+     */
+    for(int period = 0; period < 120; ++period)
+    {
+        const auto state = fanControllerState(controller);
+
+        QVERIFY(state.enabled());
+
+        simulator.run(Simulator::Options{.m_duration = SysFsDataProviderFanController::CONTROL_PERIOD_MS / 1000.0});
+
+        QCOMPARE(simulator.inputs().m_powerMode,PlantModel::CUSTOM_POWER_MODE);
+        QVERIFY(std::equal(simulator.inputs().m_fanCurve.begin(),simulator.inputs().m_fanCurve.end(),state.curve().begin(),state.curve().end()));
+
+        QVERIFY(QMetaObject::invokeMethod(timer,"timeout",Qt::DirectConnection));
+    }
+
+    {
+        const auto state = fanControllerState(controller);
+
+        QVERIFY(state.output_level() > SysFsDataProviderFanController::MIN_LEVEL);
+        QVERIFY(state.curve_writes() > 0);
+        QVERIFY(simulator.plant().state().m_cpuFanLevel > 1);
+        QVERIFY(simulator.plant().state().m_cpuTemperature < state.max_temperature());
+        QVERIFY(simulator.plant().state().m_cpuTemperature < uncontrolledTemperature);
+    }
+
+    /*
+     * The curve and the power mode of the user are back, the firmware curve of the mode applies again
+     */
+    request.Clear();
+    request.set_enabled(false);
+
+    controller.deserializeAndSetData(fanControllerRequest(request));
+
+    QCOMPARE(readFile(fanCurve),QString("1,2,3,4,5,6,7,8,9,10"));
+    QCOMPARE(readFile(smartFan),QString::number(legion::messages::PowerProfile::POWER_PROFILE_BALANCED));
+
+    simulator.run(Simulator::Options{.m_duration = 10.0});
+
+    QCOMPARE(simulator.inputs().m_powerMode,quint8(legion::messages::PowerProfile::POWER_PROFILE_BALANCED));
+    QCOMPARE(simulator.plant().state().m_cpuFanLevel,quint8(1));
+}
+
+void LenovoLegionDaemonTests::writeFile(const std::filesystem::path &path, const QString &value)
+{
+    std::filesystem::create_directories(path.parent_path());
+
+    QFile file(path);
+
+    QVERIFY(file.open(QIODeviceBase::WriteOnly | QIODeviceBase::Truncate));
+    QVERIFY(file.write(value.toUtf8()) == value.toUtf8().size());
+}
+
+QString LenovoLegionDaemonTests::readFile(const std::filesystem::path &path)
+{
+    QFile file(path);
+
+    if(!file.open(QIODeviceBase::ReadOnly))
+    {
+        return {};
+    }
+
+    return QString::fromUtf8(file.readAll()).trimmed();
+}
+
+void LenovoLegionDaemonTests::createCPUs() const
+{
+    const std::filesystem::path cpuRoot = m_sysRoot / "devices" / "system" / "cpu";
+
+    for(const auto cpu : {0,1,2,3})
+    {
+        const std::filesystem::path cpuPath = cpuRoot / ("cpu" + std::to_string(cpu));
+
+        for(const auto* attribute : {"affected_cpus","cpuinfo_min_freq","cpuinfo_max_freq","scaling_available_governors","scaling_governor","scaling_cur_freq","scaling_min_freq","scaling_max_freq"})
+        {
+            writeFile(cpuPath / "cpufreq" / attribute,"0\n");
+        }
+
+        /*
+         * CPU0 can not go offline
+         */
+        if(cpu != 0)
+        {
+            writeFile(cpuPath / "online","1\n");
+        }
+    }
+
+    writeFile(m_sysRoot / "devices" / "cpu_atom" / "cpus","2-3\n");
+}
+
+void LenovoLegionDaemonTests::writeInterrupts(quint64 nvme, quint64 wifi, quint64 timer) const
+{
+    writeFile(m_procRoot / "interrupts",QString("            CPU0       CPU1       CPU2       CPU3\n"
+                                                "   9: %1 0 0 0 IR-IO-APIC    9-fasteoi   acpi\n"
+                                                " 120: %2 0 0 0 IR-PCI-MSIX-0000:04:00.0    0-edge      nvme0q1\n"
+                                                " 121: %3 0 0 0 IR-PCI-MSIX-0000:00:14.3    0-edge      iwlwifi:default_queue\n"
+                                                " NMI: 1 1 1 1 Non-maskable interrupts\n").arg(timer).arg(nvme).arg(wifi));
+}
+
+void LenovoLegionDaemonTests::createGpu(const QString &runtimeStatus) const
+{
+    const std::filesystem::path gpuPath = m_sysRoot / "bus" / "pci" / "devices" / "0000:01:00.0";
+
+    writeFile(gpuPath / "vendor","0x10de\n");
+    writeFile(gpuPath / "class","0x030000\n");
+    writeFile(gpuPath / "power" / "runtime_status",runtimeStatus + "\n");
+}
+
+QByteArray LenovoLegionDaemonTests::irqBalancerRequest(const legion::messages::IrqBalancer &irqBalancer)
+{
+    QByteArray byteArray;
+
+    byteArray.resize(irqBalancer.ByteSizeLong());
+    irqBalancer.SerializeToArray(byteArray.data(),byteArray.size());
+
+    return byteArray;
+}
+
+legion::messages::IrqBalancer LenovoLegionDaemonTests::irqBalancerState(const SysFsDataProviderIrqBalancer &balancer)
+{
+    legion::messages::IrqBalancer irqBalancer;
+    const QByteArray              data = balancer.serializeAndGetData();
+
+    irqBalancer.ParseFromArray(data.data(),data.size());
+
+    return irqBalancer;
+}
+
+legion::messages::NvidiaNvml LenovoLegionDaemonTests::nvidiaNvmlState(const DataProviderNvidiaNvml &nvml)
+{
+    legion::messages::NvidiaNvml nvidiaNvml;
+    const QByteArray             data = nvml.serializeAndGetData();
+
+    nvidiaNvml.ParseFromArray(data.data(),data.size());
+
+    return nvidiaNvml;
+}
+
+QByteArray LenovoLegionDaemonTests::autoTunerRequest(const legion::messages::AutoTuner &autoTuner)
+{
+    QByteArray byteArray;
+
+    byteArray.resize(autoTuner.ByteSizeLong());
+    autoTuner.SerializeToArray(byteArray.data(),byteArray.size());
+
+    return byteArray;
+}
+
+legion::messages::AutoTuner LenovoLegionDaemonTests::autoTunerState(const SysFsDataProviderAutoTuner &tuner)
+{
+    legion::messages::AutoTuner autoTuner;
+    const QByteArray            data = tuner.serializeAndGetData();
+
+    autoTuner.ParseFromArray(data.data(),data.size());
+
+    return autoTuner;
+}
+
+QByteArray LenovoLegionDaemonTests::fanControllerRequest(const legion::messages::FanController &fanController)
+{
+    QByteArray byteArray;
+
+    byteArray.resize(fanController.ByteSizeLong());
+    fanController.SerializeToArray(byteArray.data(),byteArray.size());
+
+    return byteArray;
+}
+
+legion::messages::FanController LenovoLegionDaemonTests::fanControllerState(const SysFsDataProviderFanController &controller)
+{
+    legion::messages::FanController fanController;
+    const QByteArray                data = controller.serializeAndGetData();
+
+    fanController.ParseFromArray(data.data(),data.size());
+
+    return fanController;
+}
+
+QTEST_GUILESS_MAIN(LenovoLegionDaemonTests)
+
+#include "tst_LenovoLegionDaemon.moc"
@@ -0,0 +1,16 @@
+TEMPLATE = lib
+TARGET = $${PROJECT_TEST_NVML_STUB_NAME}
+
+DESTDIR = $${DESTINATION_LIB_PATH}
+
+# Plain lib<name>.so loaded with dlopen, no Qt
+CONFIG += plugin warn_on c++20
+CONFIG -= qt
+
+SOURCES += \
+    NvmlStub.cpp
+
+HEADERS += \
+    NvmlStub.h
+
+INCLUDEPATH += $${CUDA_PATH}/include
@@ -0,0 +1,549 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#include "NvmlStub.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+struct nvmlDevice_st {
+    unsigned int m_index;
+};
+
+struct nvmlEventSet_st {
+    unsigned long long m_types;
+};
+
+namespace {
+
+struct Process {
+    unsigned int        m_pid;
+    bool                m_graphics;
+    unsigned long long  m_usedMemory;
+    nvmlProcessUtilizationSample_t m_utilization;
+};
+
+struct State {
+    std::mutex                                              m_mutex;
+    std::condition_variable                                 m_eventQueued;
+
+    unsigned int                                            m_initCount     = 0;
+    nvmlUtilization_t                                       m_utilization   {};
+    unsigned long long                                      m_reasons       = 0;
+    int                                                     m_gpcOffset     = 0;
+    int                                                     m_memOffset     = 0;
+    std::map<nvmlSamplingType_t,std::vector<nvmlSample_t>>  m_samples;
+    std::vector<Process>                                    m_processes;
+    std::deque<nvmlEventData_t>                             m_events;
+    nvmlEventSet_st*                                        m_eventSet      = nullptr;
+};
+
+State& state()
+{
+    static State state;
+
+    return state;
+}
+
+nvmlDevice_st device { .m_index = 0 };
+
+void queueEvent(State& stub,unsigned long long type,unsigned long long data)
+{
+    if(stub.m_eventSet == nullptr || (stub.m_eventSet->m_types & type) == 0)
+    {
+        return;
+    }
+
+    nvmlEventData_t event {};
+
+    event.device    = &device;
+    event.eventType = type;
+    event.eventData = data;
+
+    stub.m_events.push_back(event);
+    stub.m_eventQueued.notify_all();
+}
+
+nvmlReturn_t runningProcesses(bool graphics,unsigned int *infoCount,nvmlProcessInfo_t *infos)
+{
+    State&                         stub = state();
+    std::lock_guard<std::mutex>    lock(stub.m_mutex);
+    std::vector<nvmlProcessInfo_t> result;
+
+    for(const auto& process : stub.m_processes)
+    {
+        if(process.m_graphics != graphics)
+        {
+            continue;
+        }
+
+        nvmlProcessInfo_t info {};
+
+        info.pid           = process.m_pid;
+        info.usedGpuMemory = process.m_usedMemory;
+
+        result.push_back(info);
+    }
+
+    if(*infoCount < result.size())
+    {
+        *infoCount = static_cast<unsigned int>(result.size());
+        return NVML_ERROR_INSUFFICIENT_SIZE;
+    }
+
+    *infoCount = static_cast<unsigned int>(result.size());
+    std::copy(result.begin(),result.end(),infos);
+
+    return NVML_SUCCESS;
+}
+
+}
+
+extern "C" {
+
+/*
+ * Control functions
+ */
+void nvmlStubReset(void)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    stub.m_initCount    = 0;
+    stub.m_utilization  = {};
+    stub.m_reasons      = 0;
+    stub.m_gpcOffset    = 0;
+    stub.m_memOffset    = 0;
+    stub.m_samples.clear();
+    stub.m_processes.clear();
+    stub.m_events.clear();
+}
+
+unsigned int nvmlStubInitCount(void)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    return stub.m_initCount;
+}
+
+void nvmlStubSetUtilization(unsigned int gpu, unsigned int memory)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    stub.m_utilization.gpu    = gpu;
+    stub.m_utilization.memory = memory;
+}
+
+void nvmlStubAddSample(nvmlSamplingType_t type, unsigned long long timestamp, unsigned int value)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+    nvmlSample_t                sample {};
+
+    sample.timeStamp         = timestamp;
+    sample.sampleValue.uiVal = value;
+
+    stub.m_samples[type].push_back(sample);
+}
+
+void nvmlStubSetClocksEventReasons(unsigned long long reasons)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    stub.m_reasons = reasons;
+
+    queueEvent(stub,nvmlEventTypeClock,0);
+}
+
+void nvmlStubInjectXid(unsigned long long xid)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    queueEvent(stub,nvmlEventTypeXidCriticalError,xid);
+}
+
+void nvmlStubAddProcess(unsigned int pid, int graphics, unsigned long long usedMemory, unsigned int smUtil, unsigned int memUtil)
+{
+    State&                         stub = state();
+    std::lock_guard<std::mutex>    lock(stub.m_mutex);
+    nvmlProcessUtilizationSample_t utilization {};
+
+    utilization.pid       = pid;
+    utilization.smUtil    = smUtil;
+    utilization.memUtil   = memUtil;
+
+    stub.m_processes.push_back(Process{
+        .m_pid          = pid,
+        .m_graphics     = graphics != 0,
+        .m_usedMemory   = usedMemory,
+        .m_utilization  = utilization
+    });
+}
+
+/*
+ * NVML
+ */
+nvmlReturn_t nvmlInit(void)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    ++stub.m_initCount;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlShutdown(void)
+{
+    return NVML_SUCCESS;
+}
+
+const char* nvmlErrorString(nvmlReturn_t)
+{
+    return "NVML stub error";
+}
+
+nvmlReturn_t nvmlDeviceGetCount(unsigned int *deviceCount)
+{
+    *deviceCount = 1;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetHandleByIndex(unsigned int index, nvmlDevice_t *handle)
+{
+    if(index != 0)
+    {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+
+    *handle = &device;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetName(nvmlDevice_t, char *name, unsigned int length)
+{
+    std::strncpy(name,"NVIDIA Stub GPU",length);
+    name[length - 1] = '\0';
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetMaxClockInfo(nvmlDevice_t, nvmlClockType_t type, unsigned int *clock)
+{
+    *clock = type == NVML_CLOCK_MEM ? 8000 : 2100;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetTemperatureThreshold(nvmlDevice_t, nvmlTemperatureThresholds_t thresholdType, unsigned int *temp)
+{
+    *temp = thresholdType == NVML_TEMPERATURE_THRESHOLD_SHUTDOWN ? 105 : 95;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetPowerManagementLimitConstraints(nvmlDevice_t, unsigned int *minLimit, unsigned int *maxLimit)
+{
+    *minLimit = 5000;
+    *maxLimit = 175000;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetMaxPcieLinkGeneration(nvmlDevice_t, unsigned int *maxLinkGen)
+{
+    *maxLinkGen = 4;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetMaxPcieLinkWidth(nvmlDevice_t, unsigned int *maxLinkWidth)
+{
+    *maxLinkWidth = 16;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetGpcClkMinMaxVfOffset(nvmlDevice_t, int *minOffset, int *maxOffset)
+{
+    *minOffset = -200;
+    *maxOffset = 300;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetMemClkMinMaxVfOffset(nvmlDevice_t, int *minOffset, int *maxOffset)
+{
+    *minOffset = -500;
+    *maxOffset = 1500;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetClockInfo(nvmlDevice_t, nvmlClockType_t type, unsigned int *clock)
+{
+    *clock = type == NVML_CLOCK_MEM ? 8000 : 1500;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetUtilizationRates(nvmlDevice_t, nvmlUtilization_t *utilization)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    *utilization = stub.m_utilization;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetTemperatureV(nvmlDevice_t, nvmlTemperature_t *temperature)
+{
+    temperature->temperature = 60;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetMemoryInfo(nvmlDevice_t, nvmlMemory_t *memory)
+{
+    memory->total = 8ULL << 30;
+    memory->used  = 1ULL << 30;
+    memory->free  = memory->total - memory->used;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetPowerUsage(nvmlDevice_t, unsigned int *power)
+{
+    *power = 80000;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetTotalEnergyConsumption(nvmlDevice_t, unsigned long long *energy)
+{
+    *energy = 1000000;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetPowerManagementDefaultLimit(nvmlDevice_t, unsigned int *defaultLimit)
+{
+    *defaultLimit = 140000;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetEnforcedPowerLimit(nvmlDevice_t, unsigned int *limit)
+{
+    *limit = 140000;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetCurrPcieLinkGeneration(nvmlDevice_t, unsigned int *currLinkGen)
+{
+    *currLinkGen = 4;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetCurrPcieLinkWidth(nvmlDevice_t, unsigned int *currLinkWidth)
+{
+    *currLinkWidth = 16;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetPcieThroughput(nvmlDevice_t, nvmlPcieUtilCounter_t, unsigned int *value)
+{
+    *value = 0;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetComputeRunningProcesses(nvmlDevice_t, unsigned int *infoCount, nvmlProcessInfo_t *infos)
+{
+    return runningProcesses(false,infoCount,infos);
+}
+
+nvmlReturn_t nvmlDeviceGetGraphicsRunningProcesses(nvmlDevice_t, unsigned int *infoCount, nvmlProcessInfo_t *infos)
+{
+    return runningProcesses(true,infoCount,infos);
+}
+
+nvmlReturn_t nvmlDeviceGetProcessUtilization(nvmlDevice_t, nvmlProcessUtilizationSample_t *utilization, unsigned int *processSamplesCount, unsigned long long lastSeenTimeStamp)
+{
+    State&                                      stub = state();
+    std::lock_guard<std::mutex>                 lock(stub.m_mutex);
+    std::vector<nvmlProcessUtilizationSample_t> result;
+
+    /*
+     * Processes are busy all the time, every query gets a sample newer than the last seen one
+     */
+    for(const auto& process : stub.m_processes)
+    {
+        nvmlProcessUtilizationSample_t sample = process.m_utilization;
+
+        sample.timeStamp = lastSeenTimeStamp + 1;
+
+        result.push_back(sample);
+    }
+
+    if(utilization == nullptr || *processSamplesCount < result.size())
+    {
+        *processSamplesCount = static_cast<unsigned int>(result.size());
+        return NVML_ERROR_INSUFFICIENT_SIZE;
+    }
+
+    *processSamplesCount = static_cast<unsigned int>(result.size());
+    std::copy(result.begin(),result.end(),utilization);
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetSamples(nvmlDevice_t, nvmlSamplingType_t type, unsigned long long lastSeenTimeStamp, nvmlValueType_t *sampleValType, unsigned int *sampleCount, nvmlSample_t *samples)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+    const auto&                 buffer = stub.m_samples[type];
+
+    *sampleValType = NVML_VALUE_TYPE_UNSIGNED_INT;
+
+    /*
+     * Size of the whole buffer, like NVML
+     */
+    if(samples == nullptr)
+    {
+        *sampleCount = static_cast<unsigned int>(buffer.size());
+        return NVML_SUCCESS;
+    }
+
+    unsigned int count = 0;
+
+    for(const auto& sample : buffer)
+    {
+        if(sample.timeStamp > lastSeenTimeStamp && count < *sampleCount)
+        {
+            samples[count++] = sample;
+        }
+    }
+
+    *sampleCount = count;
+
+    return count == 0 ? NVML_ERROR_NOT_FOUND : NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetGpcClkVfOffset(nvmlDevice_t, int *offset)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    *offset = stub.m_gpcOffset;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetMemClkVfOffset(nvmlDevice_t, int *offset)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    *offset = stub.m_memOffset;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceSetClockOffsets(nvmlDevice_t, nvmlClockOffset_t *info)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    (info->type == NVML_CLOCK_MEM ? stub.m_memOffset : stub.m_gpcOffset) = info->clockOffsetMHz;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetCurrentClocksEventReasons(nvmlDevice_t, unsigned long long *clocksEventReasons)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    *clocksEventReasons = stub.m_reasons;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetSupportedEventTypes(nvmlDevice_t, unsigned long long *eventTypes)
+{
+    *eventTypes = nvmlEventTypeClock | nvmlEventTypeXidCriticalError;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlEventSetCreate(nvmlEventSet_t *set)
+{
+    *set = new nvmlEventSet_st { .m_types = 0 };
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceRegisterEvents(nvmlDevice_t, unsigned long long eventTypes, nvmlEventSet_t set)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    set->m_types   |= eventTypes;
+    stub.m_eventSet = set;
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlEventSetWait(nvmlEventSet_t, nvmlEventData_t *data, unsigned int timeoutms)
+{
+    State&                       stub = state();
+    std::unique_lock<std::mutex> lock(stub.m_mutex);
+
+    if(!stub.m_eventQueued.wait_for(lock,std::chrono::milliseconds(timeoutms),[&stub]() { return !stub.m_events.empty(); }))
+    {
+        return NVML_ERROR_TIMEOUT;
+    }
+
+    *data = stub.m_events.front();
+    stub.m_events.pop_front();
+
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlEventSetFree(nvmlEventSet_t set)
+{
+    State&                      stub = state();
+    std::lock_guard<std::mutex> lock(stub.m_mutex);
+
+    if(stub.m_eventSet == set)
+    {
+        stub.m_eventSet = nullptr;
+        stub.m_events.clear();
+    }
+
+    delete set;
+
+    return NVML_SUCCESS;
+}
+
+}
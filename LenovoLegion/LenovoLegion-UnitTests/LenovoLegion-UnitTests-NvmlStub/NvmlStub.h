@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright Jaroslav Bolek 2025
+ *
+ * Author(s):
+ *   Jaroslav Bolek <jaroslav.bolek@gmail.com>
+ */
+#pragma once
+
+#include <nvml.h>
+
+/*
+ * Stub of libnvidia-ml with one GPU, loaded by the daemon through LENOVO_LEGION_NVML_LIBRARY. The tests
+ * script it through the functions below, resolved with dlsym from the same library so both see one state.
+ */
+extern "C" {
+
+/*
+ * Scripted state back to the defaults, the queued events and samples are dropped
+ */
+void         nvmlStubReset(void);
+
+/*
+ * nvmlInit calls since the reset, 0 if NVML was not touched
+ */
+unsigned int nvmlStubInitCount(void);
+
+void         nvmlStubSetUtilization(unsigned int gpu,unsigned int memory);
+
+/*
+ * Sample in the NVML buffer of the type, timestamps in us and ascending
+ */
+void         nvmlStubAddSample(nvmlSamplingType_t type,unsigned long long timestamp,unsigned int value);
+
+/*
+ * New clocks event reasons, a clock change event is queued if registered
+ */
+void         nvmlStubSetClocksEventReasons(unsigned long long reasons);
+
+/*
+ * XID error event queued if registered
+ */
+void         nvmlStubInjectXid(unsigned long long xid);
+
+/*
+ * Process running on the GPU, busy with the utilization
+ */
+void         nvmlStubAddProcess(unsigned int pid,int graphics,unsigned long long usedMemory,unsigned int smUtil,unsigned int memUtil);
+
+}
+
+using NvmlStubReset                 = decltype(&nvmlStubReset);
+using NvmlStubInitCount             = decltype(&nvmlStubInitCount);
+using NvmlStubSetUtilization        = decltype(&nvmlStubSetUtilization);
+using NvmlStubAddSample             = decltype(&nvmlStubAddSample);
+using NvmlStubSetClocksEventReasons = decltype(&nvmlStubSetClocksEventReasons);
+using NvmlStubInjectXid             = decltype(&nvmlStubInjectXid);
+using NvmlStubAddProcess            = decltype(&nvmlStubAddProcess);
@@ -0,0 +1,9 @@
+TEMPLATE = subdirs
+
+CONFIG += c++20
+
+SUBDIRS +=  \
+            LenovoLegion-UnitTests-NvmlStub \
+            LenovoLegion-UnitTests-Daemon
+
+LenovoLegion-UnitTests-Daemon.depends = LenovoLegion-UnitTests-NvmlStub
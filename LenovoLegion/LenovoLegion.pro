@@ -4,10 +4,14 @@ SUBDIRS +=                          \
     LenovoLegion-PrepareBuild       \
     BJLibs                          \
     LenovoLegion-Daemon             \
-    LenovoLegion-Application
+    LenovoLegion-Application        \
+    LenovoLegion-Simulator          \
+    LenovoLegion-UnitTests
 
 LenovoLegion-Application.depends = LenovoLegion-PrepareBuild BJLibs
 LenovoLegion-Daemon.depends = LenovoLegion-PrepareBuild BJLibs
+LenovoLegion-Simulator.depends = BJLibs
+LenovoLegion-UnitTests.depends = LenovoLegion-PrepareBuild BJLibs LenovoLegion-Simulator
 
 DISTFILES +=     \
     .qmake.conf  \